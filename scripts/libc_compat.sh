@@ -57,4 +57,6 @@ check_prototype sys/socket.h recvmmsg \
                 struct timespec*)"
 echo -n "#define CI_HAVE_NET_TSTAMP "
 check_header_presence linux/net_tstamp.h
+echo -n "#define CI_HAVE_IO_URING "
+check_header_presence linux/io_uring.h
 } >> $header
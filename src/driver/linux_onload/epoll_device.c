@@ -68,9 +68,11 @@ struct oo_epoll1_private {
   struct file *os_file;
 
 #if CI_CFG_EPOLL3
-  /* home stack support */
-  tcp_helper_resource_t* home_stack;
-  int ready_list;
+  /* home stack support: stacks whose ready lists UL collects from */
+  struct {
+    tcp_helper_resource_t* thr;
+    int ready_list;
+  } homes[CI_CFG_EPOLL3_MAX_HOMES];
   ci_uint32 flags;
 #define OO_EPOLL1_FLAG_HOME_STACK_CHANGED 1
   ci_waitable_t home_w;
@@ -688,8 +690,13 @@ static int oo_epoll1_release(struct oo_epoll_private* priv)
   __free_page(priv1->page);
 
 #if CI_CFG_EPOLL3
-  if( priv1->home_stack )
-    ci_netif_put_ready_list(&priv1->home_stack->netif, priv1->ready_list);
+  {
+    int i;
+    for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ )
+      if( priv1->homes[i].thr )
+        ci_netif_put_ready_list(&priv1->homes[i].thr->netif,
+                                priv1->homes[i].ready_list);
+  }
 #endif
 
   oo_epoll_release_common(priv);
@@ -734,26 +741,64 @@ static int oo_epoll1_wait(struct oo_epoll1_private *priv,
 }
 
 #if CI_CFG_EPOLL3
-static void oo_epoll1_set_home_stack(struct oo_epoll1_private* priv,
+static void oo_epoll1_set_home_stack(struct oo_epoll1_private* priv, int home,
                                      tcp_helper_resource_t* thr, int ready_list)
 {
-  tcp_helper_resource_t* old_thr = priv->home_stack;
-  int old_ready_list = priv->ready_list;
-
-  /* We do not lock home_stack field.  It UL corrupts it - is is too bad
+  /* We do not lock homes[].  It UL corrupts it - is is too bad
    * for this UL, because we'll malfunction but never crash.
    * Behaving UL has epoll lock to protect it from simultaneous changes of
-   * the home stack. */
-  priv->home_stack = thr;
-  priv->ready_list = ready_list;
+   * the home stacks.
+   *
+   * We never release stacks after oo_epoll_add_stack(), so we definitely
+   * keep a reference to the old stack. */
+  priv->homes[home].thr = thr;
+  priv->homes[home].ready_list = ready_list;
 
   priv->flags = OO_EPOLL1_FLAG_HOME_STACK_CHANGED;
-  /* We never release stacks after oo_epoll_add_stack(), so we definitely
-   * keep a reference to old_thr. */
-  if( old_thr != NULL )
-    ci_waitable_wakeup_all(&old_thr->ready_list_waitqs[old_ready_list]);
+  /* Any blocked waiter is on home_w as well as on the ready lists, so
+   * this makes it look at the new set of homes. */
+  ci_waitable_wakeup_all(&priv->home_w);
+}
+
+static int oo_epoll1_is_home(struct oo_epoll1_private* priv,
+                             tcp_helper_resource_t* thr)
+{
+  int i;
+  for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ )
+    if( priv->homes[i].thr == thr )
+      return 1;
+  return 0;
+}
+
+/* Make the stack of [sockfd] home number [home], using [ready_list]. */
+static int oo_epoll1_ioctl_set_home(struct oo_epoll_private* priv,
+                                    ci_fixed_descriptor_t sockfd,
+                                    ci_int32 ready_list, ci_int32 home)
+{
+  struct file *stack_file;
+  ci_private_t *stack_priv;
+  int rc = 0;
+
+  if( home < 0 || home >= CI_CFG_EPOLL3_MAX_HOMES ||
+      ready_list < 0 || ready_list >= CI_CFG_N_READY_LISTS )
+    return -EINVAL;
+
+  stack_file = fget(sockfd);
+  if( stack_file == NULL )
+    return -EINVAL;
+  if( stack_file->f_op != &oo_fops ) {
+    fput(stack_file);
+    return -EINVAL;
+  }
+  stack_priv = stack_file->private_data;
+
+  if( oo_epoll_add_stack(priv, stack_priv->thr) )
+    oo_epoll1_set_home_stack(&priv->p.p1, home, stack_priv->thr, ready_list);
   else
-    ci_waitable_wakeup_all(&priv->home_w);
+    rc = -ENOSPC;
+
+  fput(stack_file);
+  return rc;
 }
 #endif
 
@@ -778,30 +823,45 @@ static void oo_epoll_prime_all_stacks(struct oo_epoll_private* priv)
 static unsigned oo_epoll1_poll(struct file* filp, poll_table* wait)
 {
   struct oo_epoll_private *priv = filp->private_data;
-  tcp_helper_resource_t* thr = priv->p.p1.home_stack;
-  int ready_list = priv->p.p1.ready_list;
+  tcp_helper_resource_t* thr;
+  int i, ready_list;
   unsigned mask = 0;
 
-  if( thr ) {
+  /* Wake up if the set of homes changes */
+  poll_wait(filp, &priv->p.p1.home_w.wq, wait);
+
+  for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ ) {
+    thr = priv->p.p1.homes[i].thr;
+    if( thr == NULL )
+      continue;
+    ready_list = priv->p.p1.homes[i].ready_list;
     ci_atomic32_or(&thr->netif.state->ready_list_flags[ready_list],
                    CI_NI_READY_LIST_FLAG_WAKE);
     poll_wait(filp, &thr->ready_list_waitqs[ready_list].wq, wait);
 
-    mask = efab_tcp_helper_ready_list_events(thr, ready_list);
+    mask |= efab_tcp_helper_ready_list_events(thr, ready_list);
     /* no need to prime the stack - it is done
      * from oo_epoll_prime_all_stacks() */
   }
-  else
-    poll_wait(filp, &priv->p.p1.home_w.wq, wait);
 
   return mask;
 }
 #endif
 
+/* Wait queue entries: home_w and one per home stack from
+ * oo_epoll1_poll(), then the other (kernel) epoll file. */
+#if CI_CFG_EPOLL3
+#define OO_EPOLL1_WAIT_OTHER (CI_CFG_EPOLL3_MAX_HOMES + 1)
+#else
+#define OO_EPOLL1_WAIT_OTHER 1
+#endif
+#define OO_EPOLL1_N_WAITS    (OO_EPOLL1_WAIT_OTHER + 1)
+
 struct oo_epoll_poll_table {
   poll_table pt;
-  wait_queue_entry_t wq[2];
-  wait_queue_head_t* w[2];
+  wait_queue_entry_t wq[OO_EPOLL1_N_WAITS];
+  wait_queue_head_t* w[OO_EPOLL1_N_WAITS];
+  int n_home_waits;
   struct task_struct* task;
   struct file* filp;
   int rc;
@@ -812,11 +872,14 @@ static void oo_epoll1_block_on_callback(struct file* filp,
                                         poll_table* pt)
 {
   struct oo_epoll_poll_table* ept;
-  int i = 0;
+  int i = OO_EPOLL1_WAIT_OTHER;
 
   ept = container_of(pt, struct oo_epoll_poll_table, pt);
-  if( filp != ept->filp )
-    i = 1;
+  if( filp == ept->filp ) {
+    if( ept->n_home_waits == OO_EPOLL1_WAIT_OTHER )
+      return;
+    i = ept->n_home_waits++;
+  }
 
   ept->w[i] = w;
   add_wait_queue(w, &ept->wq[i]);
@@ -826,9 +889,8 @@ static inline int oo_epoll1_wake_home_callback(wait_queue_entry_t* wait,
                                                unsigned mode, int sync,
                                                void* key)
 {
-  struct oo_epoll_poll_table* ept;
+  struct oo_epoll_poll_table* ept = wait->private;
 
-  ept = container_of(wait, struct oo_epoll_poll_table, wq[0]);
   ept->rc |= OO_EPOLL1_EVENT_ON_HOME;
   return wake_up_process(ept->task);
 }
@@ -838,11 +900,37 @@ static inline int oo_epoll1_wake_other_callback(wait_queue_entry_t* wait,
 {
   struct oo_epoll_poll_table* ept;
 
-  ept = container_of(wait, struct oo_epoll_poll_table, wq[1]);
+  ept = container_of(wait, struct oo_epoll_poll_table,
+                     wq[OO_EPOLL1_WAIT_OTHER]);
   ept->rc |= OO_EPOLL1_EVENT_ON_OTHER;
   return wake_up_process(ept->task);
 }
 
+static void oo_epoll1_poll_table_init(struct oo_epoll_poll_table* ept)
+{
+  int i;
+
+  for( i = 0; i < OO_EPOLL1_N_WAITS; i++ )
+    ept->w[i] = NULL;
+  ept->n_home_waits = 0;
+  init_poll_funcptr(&ept->pt, oo_epoll1_block_on_callback);
+  for( i = 0; i < OO_EPOLL1_WAIT_OTHER; i++ ) {
+    init_waitqueue_func_entry(&ept->wq[i], oo_epoll1_wake_home_callback);
+    ept->wq[i].private = ept;
+  }
+  init_waitqueue_func_entry(&ept->wq[OO_EPOLL1_WAIT_OTHER],
+                            oo_epoll1_wake_other_callback);
+}
+
+static void oo_epoll1_poll_table_fini(struct oo_epoll_poll_table* ept)
+{
+  int i;
+
+  for( i = 0; i < OO_EPOLL1_N_WAITS; i++ )
+    if( ept->w[i] != NULL )
+      remove_wait_queue(ept->w[i], &ept->wq[i]);
+}
+
 /* this is essentially sys_poll([home_filp,other_filp], timeout_ms) */
 static int oo_epoll1_block_on(struct file* home_filp,
                               struct file* other_filp,
@@ -854,11 +942,8 @@ static int oo_epoll1_block_on(struct file* home_filp,
   ept.rc = 0;
   ept.filp = home_filp;
   ept.task = current;
-  ept.w[0] = ept.w[1] = NULL;
-  init_poll_funcptr(&ept.pt, oo_epoll1_block_on_callback);
+  oo_epoll1_poll_table_init(&ept);
 #if CI_CFG_EPOLL3
-  init_waitqueue_func_entry(&ept.wq[0], oo_epoll1_wake_home_callback);
-
   rc = oo_epoll1_poll(home_filp, &ept.pt);
 
   if( rc != 0 ) {
@@ -870,7 +955,6 @@ static int oo_epoll1_block_on(struct file* home_filp,
   else
 #endif
   {
-    init_waitqueue_func_entry(&ept.wq[1], oo_epoll1_wake_other_callback);
     rc = other_filp->f_op->poll(other_filp, &ept.pt);
     if( rc )
       ret = OO_EPOLL1_EVENT_ON_OTHER;
@@ -895,10 +979,7 @@ static int oo_epoll1_block_on(struct file* home_filp,
     }
   }
 
-  if( ept.w[0] != NULL )
-    remove_wait_queue(ept.w[0], &ept.wq[0]);
-  if( ept.w[1] != NULL )
-    remove_wait_queue(ept.w[1], &ept.wq[1]);
+  oo_epoll1_poll_table_fini(&ept);
 
   return ret;
 }
@@ -914,7 +995,7 @@ static int oo_epoll_has_event(struct file* filp)
   OO_EPOLL_FOR_EACH_STACK(priv, i, thr, ni) {
     if( ci_netif_has_event(ni) )
       return OO_EPOLL1_EVENT_ON_EVQ | (
-             (thr == priv->p.p1.home_stack) ?
+             oo_epoll1_is_home(&priv->p.p1, thr) ?
                OO_EPOLL1_EVENT_ON_HOME :
                OO_EPOLL1_EVENT_ON_OTHER);
   }
@@ -929,10 +1010,13 @@ static int oo_epoll1_spin_on(struct file* home_filp,
   struct oo_epoll_poll_table ept;
   int rc, ret = 0;
   struct oo_epoll_private *priv = home_filp->private_data;
-  tcp_helper_resource_t* thr = priv->p.p1.home_stack;
   s64 end;
+  int i;
 
-  if( ! thr )
+  for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ )
+    if( priv->p.p1.homes[i].thr != NULL )
+      break;
+  if( i == CI_CFG_EPOLL3_MAX_HOMES )
     return 0;
 
   ept.rc = 0;
@@ -941,10 +1025,7 @@ static int oo_epoll1_spin_on(struct file* home_filp,
   end = ktime_to_ns(ktime_add_ns(ktime_get(), timeout_ns));
 
 again:
-  ept.w[0] = ept.w[1] = NULL;
-
-  init_poll_funcptr(&ept.pt, oo_epoll1_block_on_callback);
-  init_waitqueue_func_entry(&ept.wq[0], oo_epoll1_wake_home_callback);
+  oo_epoll1_poll_table_init(&ept);
 
   if( (ret = oo_epoll_has_event(home_filp)) != 0 )
     goto out;
@@ -960,7 +1041,6 @@ again:
     goto out;
   }
 
-  init_waitqueue_func_entry(&ept.wq[1], oo_epoll1_wake_other_callback);
   rc = other_filp->f_op->poll(other_filp, &ept.pt);
   if( rc ) {
     ret = OO_EPOLL1_EVENT_ON_OTHER;
@@ -990,10 +1070,7 @@ again:
 
   ret = ept.rc;
 out:
-  if( ept.w[0] != NULL )
-    remove_wait_queue(ept.w[0], &ept.wq[0]);
-  if( ept.w[1] != NULL )
-    remove_wait_queue(ept.w[1], &ept.wq[1]);
+  oo_epoll1_poll_table_fini(&ept);
   /* FIXME optimize use of wqs */
   if( ret == 0 && ktime_to_ns(ktime_get()) < end )
     goto again;
@@ -1123,42 +1200,52 @@ static long oo_epoll_fop_unlocked_ioctl(struct file* filp,
 #if CI_CFG_EPOLL3
   case OO_EPOLL1_IOC_SET_HOME_STACK: {
     struct oo_epoll1_set_home_arg local_arg;
-    struct file *stack_file;
-    ci_private_t *stack_priv;
 
     ci_assert_equal(_IOC_SIZE(cmd), sizeof(local_arg));
     if( priv->type != OO_EPOLL_TYPE_1 )
       return -EINVAL;
     if( copy_from_user(&local_arg, argp, _IOC_SIZE(cmd)) )
       return -EFAULT;
+    rc = oo_epoll1_ioctl_set_home(priv, local_arg.sockfd,
+                                  local_arg.ready_list, 0);
+    break;
+  }
 
-    stack_file = fget(local_arg.sockfd);
-    if( stack_file == NULL )
-      return -EINVAL;
-    if( stack_file->f_op != &oo_fops ) {
-      fput(stack_file);
-      return -EINVAL;
-    }
-    stack_priv = stack_file->private_data;
-
-    rc = 0;
-    if( oo_epoll_add_stack(priv, stack_priv->thr) )
-      oo_epoll1_set_home_stack(&priv->p.p1, stack_priv->thr,
-                               local_arg.ready_list);
-    else
-      rc = -ENOSPC;
+  case OO_EPOLL1_IOC_SET_HOME_SLOT: {
+    struct oo_epoll1_set_home_slot_arg local_arg;
 
-    fput(stack_file);
+    ci_assert_equal(_IOC_SIZE(cmd), sizeof(local_arg));
+    if( priv->type != OO_EPOLL_TYPE_1 )
+      return -EINVAL;
+    if( copy_from_user(&local_arg, argp, _IOC_SIZE(cmd)) )
+      return -EFAULT;
+    rc = oo_epoll1_ioctl_set_home(priv, local_arg.sockfd,
+                                  local_arg.ready_list, local_arg.home);
     break;
   }
 
   case OO_EPOLL1_IOC_REMOVE_HOME_STACK:
     if( priv->type != OO_EPOLL_TYPE_1 )
       return -EINVAL;
-    oo_epoll1_set_home_stack(&priv->p.p1, NULL, 0);
+    oo_epoll1_set_home_stack(&priv->p.p1, 0, NULL, 0);
     rc = 0;
     break;
 
+  case OO_EPOLL1_IOC_REMOVE_HOME_SLOT: {
+    ci_int32 home;
+
+    ci_assert_equal(_IOC_SIZE(cmd), sizeof(home));
+    if( priv->type != OO_EPOLL_TYPE_1 )
+      return -EINVAL;
+    if( copy_from_user(&home, argp, _IOC_SIZE(cmd)) )
+      return -EFAULT;
+    if( home < 0 || home >= CI_CFG_EPOLL3_MAX_HOMES )
+      return -EINVAL;
+    oo_epoll1_set_home_stack(&priv->p.p1, home, NULL, 0);
+    rc = 0;
+    break;
+  }
+
   case OO_EPOLL1_IOC_SPIN_ON: {
     struct oo_epoll1_spin_on_arg local_arg;
     struct file* other_filp;
@@ -305,6 +305,58 @@ static struct proc_ops efab_stacks_k_seq_fops = {
 };
 
 
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+/* /proc/driver/onload/placement - for each stack, the CPU on which the
+ * application last blocked, where the stack's work and interrupts are, and
+ * whether they share a last-level cache with the application
+ * (EF_STACK_PLACEMENT). */
+
+static int
+efab_placement_seq_show(struct seq_file *seq, void *v)
+{
+  ci_netif *ni = v;
+  tcp_helper_resource_t* thr = netif2tcp_helper_resource(ni);
+  struct oo_placement* pl = &thr->placement;
+  int app_cpu = READ_ONCE(pl->app_cpu);
+  int work_cpu = READ_ONCE(pl->work_cpu);
+  int intf_i, irq_llc = 1;
+
+  seq_printf(seq, "%d: app=%d work=%d irq=", NI_ID(ni), app_cpu,
+             work_cpu == WORK_CPU_UNBOUND ? -1 : work_cpu);
+  OO_STACK_FOR_EACH_INTF_I(ni, intf_i) {
+    seq_printf(seq, "%s%d", intf_i ? "," : "", pl->irq_cpu[intf_i]);
+    if( pl->irq_cpu[intf_i] >= 0 &&
+        ! tcp_helper_placement_same_llc(app_cpu, pl->irq_cpu[intf_i]) )
+      irq_llc = 0;
+  }
+  seq_printf(seq, " work_llc=%d irq_llc=%d moves=%u\n",
+             tcp_helper_placement_same_llc(app_cpu, work_cpu), irq_llc,
+             pl->n_moves);
+  return 0;
+}
+
+static struct seq_operations efab_placement_seq_ops = {
+  .start    = efab_stacks_seq_start,
+  .next     = efab_stacks_seq_next,
+  .stop     = efab_stacks_seq_stop,
+  .show     = efab_placement_seq_show,
+};
+
+static int
+efab_placement_seq_open(struct inode *inode, struct file *file)
+{
+  return seq_open(file, &efab_placement_seq_ops);
+}
+static struct proc_ops efab_placement_seq_fops = {
+  PROC_OPS_SET_OWNER
+  .proc_open     = efab_placement_seq_open,
+  .proc_read     = seq_read,
+  .proc_lseek    = seq_lseek,
+  .proc_release  = seq_release_private,
+};
+#endif
+
+
 #endif
 
 
@@ -484,6 +536,9 @@ ci_install_proc_entries(void)
   proc_create("stacks", 0, oo_proc_root, &efab_stacks_seq_fops);
   proc_create("stacks_ul", 0, oo_proc_root, &efab_stacks_ul_seq_fops);
   proc_create("stacks_k", 0, oo_proc_root, &efab_stacks_k_seq_fops);
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+  proc_create("placement", 0, oo_proc_root, &efab_placement_seq_fops);
+#endif
 #endif
 
 #if CI_MEMLEAK_DEBUG_ALLOC_TABLE
@@ -522,6 +577,9 @@ void ci_uninstall_proc_entries(void)
   remove_proc_entry("stacks_ul", oo_proc_root);
   remove_proc_entry("stacks_k", oo_proc_root);
   remove_proc_entry("stacks", oo_proc_root);
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+  remove_proc_entry("placement", oo_proc_root);
+#endif
 #endif
 #if CI_MEMLEAK_DEBUG_ALLOC_TABLE
   remove_proc_entry("mem", oo_proc_root);
@@ -55,6 +55,12 @@ static void oo_timesync_stabilize_cpu_khz(struct oo_timesync* oo_ts)
 {
   static int cpu_khz_warned = 0;
 
+#ifdef CI_HAVE_FRC64_KHZ
+  /* The exact rate was set by oo_timesync_ctor(). */
+  if( ci_frc64_khz() != 0 )
+    return;
+#endif
+
   /* Want at least two data points in oo_ts (oo_timesync_update called
    * twice) before computing cpu_khz */
   if( signal_cpu_khz_stabilized == 0 ) {
@@ -130,6 +136,16 @@ int oo_timesync_ctor(struct oo_timesync *oo_ts)
 
   spin_lock_init(&timesync_lock);
 
+#ifdef CI_HAVE_FRC64_KHZ
+  /* The platform reports the counter rate, so there is nothing to wait
+   * for. */
+  oo_timesync_cpu_khz = ci_frc64_khz();
+  if( oo_timesync_cpu_khz != 0 ) {
+    signal_cpu_khz_stabilized = 2;
+    complete_all(&cpu_khz_stabilized_completion);
+  }
+#endif
+
   timer_setup(&timer_node, stabilize_cpu_khz_timer, 0);
   timer_node.expires = jiffies + 1;
   add_timer(&timer_node);
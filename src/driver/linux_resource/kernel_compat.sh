@@ -183,6 +183,9 @@ EFRM_HAVE_GET_FILE_RCU_FUNC symtype get_file_rcu include/linux/fs.h struct file*
 EFRM_HAVE_SKB_RECV_NOBLOCK_PARAM	symtype	skb_recv_datagram	include/linux/skbuff.h	struct sk_buff *(struct sock *, unsigned, int, int *)
 EFRM_HAVE_TIMER_DELETE_SYNC	export	timer_delete_sync	include/linux/timer.h	kernel/time/timer.c
 
+EFRM_HAVE_CPU_TOPOLOGY_LLC_SIBLING	member	struct_cpu_topology	llc_sibling	include/linux/arch_topology.h
+EFRM_HAVE_CPU_LLC_SHARED_MAP	export	cpu_llc_shared_map	arch/x86/include/asm/smp.h	arch/x86/kernel/smpboot.c
+
 # TODO move onload-related stuff from net kernel_compat
 " | grep -E -v -e '^#' -e '^$' | sed 's/[ \t][ \t]*/:/g'
 }
@@ -513,7 +513,12 @@ ci_inline void ci_netif_send(ci_netif* ni, ci_ip_pkt_fmt* pkt)
   pkt->flags |= CI_PKT_FLAG_TX_PENDING;
   __ci_netif_send(ni, pkt);
 }
+/* Send a list of packets linked by [next] through the same interface,
+ * ringing the doorbell once for the whole list. */
+extern void ci_netif_send_list(ci_netif* ni, ci_ip_pkt_fmt* head) CI_HF;
 extern void ci_netif_rx_post(ci_netif* netif, int nic_index) CI_HF;
+extern void ci_netif_rx_adapt_init(ci_netif* ni, int intf_i) CI_HF;
+extern void ci_netif_rx_adapt(ci_netif* ni, int intf_i) CI_HF;
 extern int  ci_netif_set_rxq_limit(ci_netif*) CI_HF;
 #ifdef __KERNEL__
 extern int  ci_netif_init_fill_rx_rings(ci_netif*) CI_HF;
@@ -647,6 +652,8 @@ CI_DEBUG(extern void ci_netif_verify_freepkts(ci_netif *, const char *, int);)
 
 
 extern int ci_netif_pktset_best(ci_netif* ni) CI_HF;
+extern int ci_netif_pktset_best_node(ci_netif* ni, int node,
+                                     int min_free) CI_HF;
 extern void ci_netif_pkt_free(ci_netif* ni, ci_ip_pkt_fmt* pkt
                               CI_KERNEL_ARG(int* p_netif_is_locked)) CI_HF;
 
@@ -922,7 +929,8 @@ extern void ci_put_cmsg(struct cmsg_state *cmsg_state, int level, int type,
                         socklen_t len, const void *data) CI_HF;
 /* info_out contains a pointer to struct in_pktinfo or struct in6_pktinfo */
 extern int ci_ip_cmsg_send(const struct msghdr*, void** info_out,
-                           void** ts_pktinfo_out) CI_HF;
+                           void** ts_pktinfo_out, int* gso_size_out,
+                           ci_uint64* txtime_out) CI_HF;
 extern void ci_ip_cmsg_finish(struct cmsg_state* cmsg_state) CI_HF;
 extern bool ci_ip_cmsg_is_custom_tx(int level, int type) CI_HF;
 extern void ci_ip_cmsg_filter_custom_tx(struct msghdr*,
@@ -996,6 +1004,11 @@ extern int ci_udp_recvmmsg(ci_udp_iomsg_args *a, struct mmsghdr* mmsg,
                            unsigned int vlen, int flags, 
                            const struct timespec* timeout
                            CI_KERNEL_ARG(ci_addr_spc_t addr_spc)) CI_HF;
+extern int ci_udp_sendmmsg(ci_udp_iomsg_args *a, struct mmsghdr* mmsg,
+                           unsigned int vlen, int flags) CI_HF;
+extern int ci_tcp_recvmmsg(ci_netif* ni, ci_tcp_state* ts,
+                           struct mmsghdr* mmsg, unsigned int vlen,
+                           int flags) CI_HF;
 
 struct onload_zc_mmsg;
 extern int ci_tcp_zc_send(ci_netif* ni, ci_tcp_state* ts, 
@@ -1024,7 +1037,7 @@ ci_netif_raw_send(ci_netif* ni, int intf_i,
 
 extern void ci_ip_cmsg_recv(ci_netif*, ci_udp_state*, const ci_ip_pkt_fmt*,
                             struct msghdr*, int netif_locked,
-                            int *p_msg_flags) CI_HF;
+                            int *p_msg_flags, int gro_size) CI_HF;
 #if OO_DO_STACK_POLL
 extern void ci_udp_all_fds_gone(ci_netif* netif, oo_sp, int do_free);
 #endif
@@ -1034,6 +1047,8 @@ extern int ci_udp_csum_correct(ci_ip_pkt_fmt* pkt, ci_udp_hdr* udp) CI_HF;
 
 extern void ci_udp_sendmsg_send_async_q(ci_netif*, ci_udp_state*) CI_HF;
 extern void ci_udp_perform_deferred_socket_work(ci_netif*, ci_udp_state*)CI_HF;
+extern void ci_udp_txtime_release(ci_netif*) CI_HF;
+extern void ci_udp_txtime_purge(ci_netif*, ci_udp_state*) CI_HF;
 extern int ci_udp_try_to_free_pkts(ci_netif*, ci_udp_state*,
                                     int desperation) CI_HF;
 
@@ -1661,6 +1676,7 @@ extern int ci_tcp_tx_split(ci_netif* ni, ci_tcp_state* ts, ci_ip_pkt_queue* qu,
 extern void ci_tcp_tx_advance(ci_tcp_state* ts, ci_netif* netif) CI_HF;
 extern void ci_tcp_tx_advance_to(ci_netif* ni, ci_tcp_state* ts,
                             unsigned right_edge, ci_uint32* p_stop_cntr) CI_HF;
+extern ci_uint64 ci_tcp_pacing_rate(ci_netif* ni, ci_tcp_state* ts) CI_HF;
 extern void ci_tcp_send_rst_with_flags(ci_netif*, ci_tcp_state*,
                                        ci_uint8 extra_flags) CI_HF;
 extern void ci_tcp_send_rst(ci_netif* netif, ci_tcp_state* ts) CI_HF;
@@ -1869,6 +1885,7 @@ extern void ci_tcp_timeout_zwin(ci_netif* netif, ci_tcp_state* ts) CI_HF;
 extern void ci_tcp_timeout_delack(ci_netif* netif, ci_tcp_state* ts) CI_HF;
 extern void ci_tcp_timeout_rto(ci_netif* netif, ci_tcp_state* ts) CI_HF;
 extern void ci_tcp_timeout_cork(ci_netif* netif, ci_tcp_state* ts) CI_HF;
+extern void ci_tcp_timeout_pacing(ci_netif* netif, ci_tcp_state* ts) CI_HF;
 extern void ci_tcp_stop_timers(ci_netif* netif, ci_tcp_state* ts) CI_HF;
 extern void ci_tcp_send_corked_packets(ci_netif* netif, ci_tcp_state* ts) CI_HF;
 
@@ -2207,6 +2224,98 @@ extern int ci_setup_ipstack_params(void);
 # define CITP_STATS_NETIF_ADD(ni,x,v)
 #endif
 
+#if CI_CFG_STATS_NETIF
+/* Latency histograms (EF_LATENCY_HIST).  See struct oo_lat_hist. */
+
+ci_inline unsigned oo_lat_hist_bucket(ci_uint64 v)
+{
+  unsigned e;
+  if( v < (1u << OO_LAT_HIST_SUB_LG2) )
+    return (unsigned) v;
+  e = 63 - __builtin_clzll(v);
+  if( e >= OO_LAT_HIST_MAX_LG2 )
+    return OO_LAT_HIST_N_BUCKETS - 1;
+  return ((e - OO_LAT_HIST_SUB_LG2 + 1) << OO_LAT_HIST_SUB_LG2) |
+         ((v >> (e - OO_LAT_HIST_SUB_LG2)) &
+          ((1u << OO_LAT_HIST_SUB_LG2) - 1));
+}
+
+/* The smallest value that goes in bucket [b]. */
+ci_inline ci_uint64 oo_lat_hist_bucket_lo(unsigned b)
+{
+  unsigned e;
+  if( b < (1u << OO_LAT_HIST_SUB_LG2) )
+    return b;
+  e = (b >> OO_LAT_HIST_SUB_LG2) + OO_LAT_HIST_SUB_LG2 - 1;
+  return (ci_uint64) ((1u << OO_LAT_HIST_SUB_LG2) |
+                      (b & ((1u << OO_LAT_HIST_SUB_LG2) - 1)))
+         << (e - OO_LAT_HIST_SUB_LG2);
+}
+
+/* Not atomic: a thread racing with another on the same shard may lose a
+ * count, which we can live with. */
+ci_inline void oo_lat_hist_add(struct oo_lat_hist* h, ci_uint64 start,
+                               ci_uint64 end)
+{
+  ++h->bucket[oo_lat_hist_bucket(end > start ? end - start : 0)];
+}
+
+extern const char* const oo_lat_hist_names[OO_LAT_HIST_N];
+extern ci_uint64 ci_netif_lat_hist_sum(ci_netif* ni, int which,
+                                       struct oo_lat_hist* out) CI_HF;
+extern unsigned oo_lat_hist_quantile(const struct oo_lat_hist* h,
+                                     ci_uint64 total, unsigned ppm) CI_HF;
+extern ci_uint64 ci_netif_lat_hist_ns(ci_netif* ni, ci_uint64 cycles) CI_HF;
+extern void ci_netif_dump_lat_hists(ci_netif* ni, oo_dump_log_fn_t logger,
+                                    void* log_arg) CI_HF;
+
+extern void __ci_netif_lat_hist_rx(ci_netif* ni, ci_uint64 rx_frc) CI_HF;
+
+/* Record the time from polling a packet (stamped in pkt->tstamp_frc) to
+ * handing it to the application. */
+ci_inline void ci_netif_lat_hist_rx(ci_netif* ni, ci_uint64 rx_frc)
+{
+  if(CI_UNLIKELY( NI_OPTS(ni).latency_hist ))
+    __ci_netif_lat_hist_rx(ni, rx_frc);
+}
+
+#ifndef __KERNEL__
+extern void __ci_netif_lat_hist_send_begin(void) CI_HF;
+extern void __ci_netif_lat_hist_send_end(void) CI_HF;
+extern void __ci_netif_lat_hist_tx_doorbell(ci_netif* ni) CI_HF;
+
+/* A send call runs from ci_netif_lat_hist_send_begin() to _send_end().  The
+ * first doorbell rung by the calling thread in between records the time
+ * since the call started. */
+ci_inline void ci_netif_lat_hist_send_begin(ci_netif* ni)
+{
+  if(CI_UNLIKELY( NI_OPTS(ni).latency_hist ))
+    __ci_netif_lat_hist_send_begin();
+}
+
+ci_inline void ci_netif_lat_hist_send_end(ci_netif* ni)
+{
+  if(CI_UNLIKELY( NI_OPTS(ni).latency_hist ))
+    __ci_netif_lat_hist_send_end();
+}
+
+ci_inline void ci_netif_lat_hist_tx_doorbell(ci_netif* ni)
+{
+  if(CI_UNLIKELY( NI_OPTS(ni).latency_hist ))
+    __ci_netif_lat_hist_tx_doorbell(ni);
+}
+#else
+# define ci_netif_lat_hist_send_begin(ni)   do{}while(0)
+# define ci_netif_lat_hist_send_end(ni)     do{}while(0)
+# define ci_netif_lat_hist_tx_doorbell(ni)  do{}while(0)
+#endif
+#else
+# define ci_netif_lat_hist_rx(ni, rx_frc)   do{}while(0)
+# define ci_netif_lat_hist_send_begin(ni)   do{}while(0)
+# define ci_netif_lat_hist_send_end(ni)     do{}while(0)
+# define ci_netif_lat_hist_tx_doorbell(ni)  do{}while(0)
+#endif
+
 #if CI_CFG_STATS_TCP_LISTEN
 # define CITP_STATS_TCP_LISTEN(x)	x
 #else
@@ -2319,6 +2428,23 @@ extern void ci_ipcache_update_flowlabel(ci_netif* ni, ci_sock_cmn* s) CI_HF;
 ci_inline int ci_netif_rx_vi_space(ci_netif* ni, ef_vi* vi)
 { return ni->state->rxq_limit - ef_vi_receive_fill_level(vi); }
 
+/* Fill level up to which we refill [intf_i]'s RX ring. */
+ci_inline int ci_netif_rx_intf_limit(ci_netif* ni, int intf_i)
+{ return CI_MIN(ni->state->rxq_limit, ni->state->nic[intf_i].rxq_target); }
+
+ci_inline int ci_netif_rx_intf_space(ci_netif* ni, int intf_i)
+{
+  return ci_netif_rx_intf_limit(ni, intf_i) -
+         ef_vi_receive_fill_level(ci_netif_vi(ni, intf_i));
+}
+
+/* Is there enough room in [intf_i]'s RX ring to be worth refilling? */
+ci_inline int ci_netif_rx_want_post(ci_netif* ni, int intf_i)
+{
+  return ci_netif_rx_intf_space(ni, intf_i) >=
+         ni->state->nic[intf_i].rxq_batch;
+}
+
 
 /**********************************************************************
  * Handling return from ci_netif_pkt_wait() and ci_netif_lock().
@@ -2765,10 +2891,19 @@ ci_inline int ci_netif_need_timer_prime(ci_netif* ni, ci_uint64 frc_now) {
 }
 
 
+/* Returns true if a UDP datagram held for SO_TXTIME is due.  The stack's
+** [udp_txtime_next] is 0 when nothing is held, which wraps to the largest
+** value here.
+*/
+ci_inline int ci_udp_txtime_due(ci_netif* ni, ci_uint64 frc_now)
+{ return ni->state->udp_txtime_next - 1 < frc_now; }
+
+
 ci_inline int ci_netif_need_poll_spinning(ci_netif* ni, ci_uint64 frc_now)
 {
   return ci_netif_has_event(ni) ||
-         ci_netif_need_timer_prime(ni, frc_now);
+         ci_netif_need_timer_prime(ni, frc_now) ||
+         ci_udp_txtime_due(ni, frc_now);
 }
 
 
@@ -3501,6 +3636,13 @@ ci_inline int ci_udp_tx_advertise_space(ci_udp_state* us)
 { return (int) (us->s.so.sndbuf - us->tx_count) > (int) (us->tx_count >> 1u); }
 
 
+/* Returns true if SO_TXTIME drops are waiting to be read from the error
+** queue.
+*/
+ci_inline int ci_udp_txtime_err_pending(ci_udp_state* us)
+{ return OO_ACCESS_ONCE(us->txtime_err_put) != us->txtime_err_get; }
+
+
 /*********************************************************************
 ************************** UDP Receive queue *************************
 *********************************************************************/
@@ -4200,6 +4342,53 @@ ci_inline unsigned ci_tcp_losswnd(ci_tcp_state* ts) {
 }
 
 
+/* Congestion control algorithm.  The shared state holds only the index
+ * (ts->c.cong_alg) as the stack is mapped into several address spaces;
+ * the table itself lives in tcp_cong.c.
+ *
+ * [cong_avoid] is called on ACK of new data once cwnd >= ssthresh; slow
+ * start is common to all algorithms.  [ssthresh] returns the new slow
+ * start threshold on loss.  [event] is told about CI_TCP_CONG_EV_* after
+ * the generic code has reduced cwnd.
+ */
+struct ci_tcp_cong_ops {
+  const char* name;
+  void (*init)(ci_netif* ni, ci_tcp_state* ts);
+  void (*cong_avoid)(ci_netif* ni, ci_tcp_state* ts, unsigned acked);
+  ci_uint32 (*ssthresh)(ci_netif* ni, ci_tcp_state* ts);
+  void (*event)(ci_netif* ni, ci_tcp_state* ts, int ev);
+};
+
+extern const struct ci_tcp_cong_ops* const
+  ci_tcp_cong_ops_tbl[CI_TCP_CONG_ALG_N];
+
+/* [alg] comes from shared state that the application can write, and the
+ * kernel calls through the table too, so bound it in every build.  An
+ * out-of-range value falls back to Reno.
+ */
+ci_inline const struct ci_tcp_cong_ops* ci_tcp_cong_alg_ops(unsigned alg)
+{
+  if(CI_UNLIKELY( alg >= CI_TCP_CONG_ALG_N ))
+    alg = CI_TCP_CONG_ALG_RENO;
+  return ci_tcp_cong_ops_tbl[alg];
+}
+
+ci_inline const struct ci_tcp_cong_ops* ci_tcp_cong_ops(ci_tcp_state* ts)
+{
+  return ci_tcp_cong_alg_ops(ts->c.cong_alg);
+}
+
+extern ci_uint32 ci_tcp_cubic_root(ci_uint64 a) CI_HF;
+/* Returns CI_TCP_CONG_ALG_* for [name], or -ENOENT. */
+extern int ci_tcp_cong_alg_lookup(const char* name, int len) CI_HF;
+extern void ci_tcp_cong_set_alg(ci_netif* ni, ci_tcp_state* ts,
+                                int alg) CI_HF;
+extern void ci_tcp_cong_event(ci_netif* ni, ci_tcp_state* ts, int ev) CI_HF;
+extern void ci_tcp_cong_log_dump(ci_netif* ni, oo_sp sock,
+                                 oo_dump_log_fn_t logger,
+                                 void* log_arg) CI_HF;
+
+
 #if CI_CFG_BURST_CONTROL
 ci_inline unsigned ci_tcp_burst_exhausted(ci_netif* ni, ci_tcp_state* ts) {
   int extra, retrans_data;
@@ -4302,7 +4491,7 @@ ci_inline int ci_sock_trylock(ci_netif* ni, citp_waitable* w)
 {
   ci_uint32 l = w->lock.wl_val;
   return ! (l & OO_WAITABLE_LK_LOCKED) &&
-    ci_cas32u_succeed(&w->lock.wl_val, l, l | OO_WAITABLE_LK_LOCKED);
+    ci_cas32u_succeed_acquire(&w->lock.wl_val, l, l | OO_WAITABLE_LK_LOCKED);
 }
 
 /* Always returns 0 (success) at userland.  Returns -ERESTARTSYS if
@@ -4314,7 +4503,8 @@ ci_inline int ci_sock_lock(ci_netif*, citp_waitable*)
   OO_MUST_CHECK_RET_IN_KERNEL;
 ci_inline int ci_sock_lock(ci_netif* ni, citp_waitable* w)
 {
-  if(CI_LIKELY( ci_cas32u_succeed(&w->lock.wl_val, 0, OO_WAITABLE_LK_LOCKED) ))
+  if(CI_LIKELY( ci_cas32u_succeed_acquire(&w->lock.wl_val, 0,
+                                          OO_WAITABLE_LK_LOCKED) ))
     return 0;
 #ifdef __KERNEL__
   return ci_sock_lock_slow(ni, w);
@@ -4329,7 +4519,8 @@ ci_inline int ci_sock_lock(ci_netif* ni, citp_waitable* w)
 
 ci_inline void ci_sock_unlock(ci_netif* ni, citp_waitable* w)
 {
-  if(CI_UNLIKELY( ci_cas32u_fail(&w->lock.wl_val, OO_WAITABLE_LK_LOCKED, 0) ))
+  if(CI_UNLIKELY( ci_cas32u_fail_release(&w->lock.wl_val,
+                                         OO_WAITABLE_LK_LOCKED, 0) ))
     ci_sock_unlock_slow(ni, w);
 }
 
@@ -5040,58 +5231,34 @@ ci_inline void ci_tcp_recvmsg_args_init(ci_tcp_recvmsg_args* a,
 ***************************** Tcpdump support ************************
 *********************************************************************/
 #if CI_CFG_TCPDUMP
-/** Current length of dump queue. */
-ci_inline ci_uint16 oo_tcpdump_queue_len(ci_netif* ni)
+/** Number of packets in the capture ring not yet read by onload_tcpdump. */
+ci_inline ci_uint32 oo_tcpdump_queue_len(ci_netif* ni)
 {
   return ni->state->dump_write_i - ni->state->dump_read_i;
 }
 
-/* Should we dump this packet? */
+/* Should we dump this packet?  When no one is capturing, this test is all
+ * that onload_tcpdump support costs per packet. */
 ci_inline int oo_tcpdump_check(ci_netif *ni, ci_ip_pkt_fmt *pkt, int intf_i)
 {
-  if( ni->state->dump_intf[intf_i] == OO_INTF_I_DUMP_ALL ) {
-    if( oo_tcpdump_queue_len(ni) < CI_CFG_DUMPQUEUE_LEN - 1 )
-      return 1;
-    else
-      CITP_STATS_NETIF_INC(ni, tcpdump_missed);
-  }
-  return 0;
+  return ni->state->dump_intf[intf_i] == OO_INTF_I_DUMP_ALL;
 }
 
 /* Should we dump this no_match */
 ci_inline int oo_tcpdump_check_no_match(ci_netif *ni, ci_ip_pkt_fmt *pkt,
                                         int intf_i)
 {
-  if( ni->state->dump_intf[intf_i] == OO_INTF_I_DUMP_NO_MATCH ) {
-    if( oo_tcpdump_queue_len(ni) < CI_CFG_DUMPQUEUE_LEN - 1 )
-      return 1;
-    else
-      CITP_STATS_NETIF_INC(ni, tcpdump_missed);
-  }
-  return 0;
+  return ni->state->dump_intf[intf_i] == OO_INTF_I_DUMP_NO_MATCH;
 }
 
-/* Release all the packets up to dump_read_i */
-extern void oo_tcpdump_free_pkts(ci_netif* ni, ci_uint16 i);
-
-/* Dump this packet */
-ci_inline void oo_tcpdump_dump_pkt(ci_netif *ni, ci_ip_pkt_fmt *pkt)
-{
-  ci_uint16 write_i = ni->state->dump_write_i;
-  oo_pkt_p* dq = ni->state->dump_queue;
-
-  if(CI_UNLIKELY( pkt->flags & CI_PKT_FLAG_MSG_WARM ))
-    return;
+/* Release the packets that onload_tcpdump has read, up to dump_read_i */
+extern void oo_tcpdump_free_pkts(ci_netif* ni);
 
-  if( dq[write_i % CI_CFG_DUMPQUEUE_LEN] != OO_PP_NULL )
-    oo_tcpdump_free_pkts(ni, write_i);
+/* Run the pre-filter installed by onload_tcpdump over this packet */
+extern int oo_tcpdump_filter(ci_netif* ni, ci_ip_pkt_fmt* pkt);
 
-  ci_assert_equal(dq[write_i % CI_CFG_DUMPQUEUE_LEN], OO_PP_NULL);
-  ci_netif_pkt_hold(ni, pkt);
-  dq[write_i % CI_CFG_DUMPQUEUE_LEN] = OO_PKT_P(pkt);
-  ci_wmb();
-  ni->state->dump_write_i = write_i + 1;
-}
+/* Dump this packet, if it passes the pre-filter and there is room */
+extern void oo_tcpdump_dump_pkt(ci_netif *ni, ci_ip_pkt_fmt *pkt);
 #else
 #define oo_tcpdump_check(ni, pkt, intf_i) 0
 #define oo_tcpdump_dump_pkt(ni, pkt)
@@ -326,7 +326,7 @@
  * UDP
  */
 
-#define CI_UDP_STATE_FLAGS_FMT		"%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s"
+#define CI_UDP_STATE_FLAGS_FMT		"%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s"
 #define CI_UDP_STATE_FLAGS_PRI_ARG(ts)				\
   (UDP_FLAGS(ts) & CI_UDPF_FILTERED     ? "FILT ":""),          \
   (UDP_FLAGS(ts) & CI_UDPF_MCAST_LOOP   ? "MCAST_LOOP ":""),    \
@@ -342,7 +342,8 @@
   (UDP_FLAGS(ts) & CI_UDPF_MCAST_FILTER ? "MC_FILT ":""),       \
   (UDP_FLAGS(ts) & CI_UDPF_NO_UCAST_FILTER ? "NO_UC_FILT ":""), \
   (UDP_FLAGS(ts) & CI_UDPF_LAST_SEND_NOMAC ? "LAST_SEND_NOMAC":""), \
-  (UDP_FLAGS(ts) & CI_UDPF_NO_MCAST_FILTER ? "NO_MC_FILT ":"") \
+  (UDP_FLAGS(ts) & CI_UDPF_NO_MCAST_FILTER ? "NO_MC_FILT ":""), \
+  (UDP_FLAGS(ts) & CI_UDPF_TXTIME       ? "TXTIME ":"") \
 
 
 extern unsigned ci_tp_log CI_HV;
@@ -363,7 +364,7 @@ extern unsigned ci_tp_log CI_HV;
   ((flags) & CI_PKT_FLAG_TX_PSH_ON_ACK   ? "PshOnAck ":"")
 
 
-#define CI_NETIF_LOCK_FMT         "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s"
+#define CI_NETIF_LOCK_FMT         "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s"
 #define CI_NETIF_LOCK_PRI_ARG(v)                                        \
   ((v) & CI_EPLOCK_LOCKED                ? "LOCKED ":"UNLOCKED"),       \
   ((v) & CI_EPLOCK_FL_NEED_WAKE          ? "CONTENDED ":""),            \
@@ -380,6 +381,7 @@ extern unsigned ci_tp_log CI_HV;
   ((v) & CI_EPLOCK_NETIF_PURGE_TXQS      ? "PURGE_TXQ ":""),            \
   ((v) & CI_EPLOCK_NETIF_KERNEL_PACKETS  ? "KPKTS ":""),                \
   ((v) & CI_EPLOCK_NETIF_FREE_READY_LIST ? "FREE_RLIST ":""),           \
+  ((v) & CI_EPLOCK_NETIF_DEFER_RING      ? "DEFER_RING ":""),           \
   ((v) & CI_EPLOCK_NETIF_SOCKET_LIST     ? "DEFERRED ":"")
 
 
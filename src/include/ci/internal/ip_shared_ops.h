@@ -54,15 +54,42 @@ ci_netif_unlock_slow_common(ci_netif*, ci_uint64 lock_val,
  * called at userlevel, this is the only possible outcome.  In the kernel,
  * they return -EINTR if interrupted by a signal.
  */
+#if CI_CFG_STATS_NETIF && ! defined(__KERNEL__)
+/* Note when we took the lock, for the lock hold time histogram
+ * (EF_LATENCY_HIST).  ci_netif_unlock() records and clears it.  Only
+ * userlevel holds are timed.
+ */
+ci_inline void ci_netif_lock_stamp(ci_netif* ni)
+{
+  if(CI_UNLIKELY( ni->state->opts.latency_hist ))
+    ni->lock_frc = ci_frc64_get();
+}
+
+ci_inline int ci_netif_lock(ci_netif* ni)
+{
+  int rc = ef_eplock_lock(ni);
+  ci_netif_lock_stamp(ni);
+  return rc;
+}
+
+ci_inline int ci_netif_trylock(ci_netif* ni)
+{
+  if( ! ef_eplock_trylock(&ni->state->lock) )
+    return 0;
+  ci_netif_lock_stamp(ni);
+  return 1;
+}
+#else
 #if ! defined(__KERNEL__) || ! CI_CFG_UL_INTERRUPT_HELPER
 #define ci_netif_lock(ni)        ef_eplock_lock(ni)
 #endif
+#define ci_netif_trylock(ni)     ef_eplock_trylock(&(ni)->state->lock)
+#endif
 
 #ifdef __KERNEL__
 #define ci_netif_lock_maybe_wedged(ni) ef_eplock_lock_maybe_wedged(ni)
 #endif
 #define ci_netif_lock_id(ni,id)  ef_eplock_lock(ni)
-#define ci_netif_trylock(ni)     ef_eplock_trylock(&(ni)->state->lock)
 
 #define ci_netif_lock_fdi(epi)   ci_netif_lock_id((epi)->sock.netif,    \
                                                   SC_SP((epi)->sock.s))
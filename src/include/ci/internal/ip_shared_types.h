@@ -80,13 +80,28 @@
 
 /* Timer wheels are used to schedule the timers. There are 4 level's on
 ** the wheel each of 256 buckets each bucket is a doubly linked list
-** of timers
+** of timers.
+**
+** All but the top wheel have two sets of buckets ("slots"): one for the
+** current revolution of the wheel and one for the next.  The next
+** revolution is filled from the wheel above a few timers at a time, so
+** that a wheel wrapping does not have to move every timer at once.
 */
 #define CI_IPTIME_WHEELS      4
 #define CI_IPTIME_BUCKETS     256
 #define CI_IPTIME_BUCKETMASK  255
 #define CI_IPTIME_BUCKETBITS  8
-#define CI_IPTIME_WHEELSIZE   (CI_IPTIME_WHEELS*CI_IPTIME_BUCKETS)
+#define CI_IPTIME_SLOTS       (2*CI_IPTIME_BUCKETS)
+#define CI_IPTIME_SLOTMASK    (CI_IPTIME_SLOTS - 1)
+#define CI_IPTIME_WHEELSIZE   ((CI_IPTIME_WHEELS - 1)*CI_IPTIME_SLOTS + \
+                               CI_IPTIME_BUCKETS)
+
+/* Most timers moved from one wheel to the next in each tick, other than
+** when a wheel wraps. */
+#define CI_IPTIME_DRAIN_BUDGET  64
+
+/* One more than the largest timer callback code, CI_IP_TIMER_* */
+#define CI_IP_TIMER_N_FN      0xe
 
 
 /* ========= Field Protection ======== */
@@ -246,6 +261,10 @@ typedef union {
     ci_int32          tx_length;
     oo_sp             tx_sock_id; /* The socket this pkt is tx'd on:  
                                    * used in oo_deferred_arp_failed() */
+    /* SO_TXTIME launch time as a frc value, or 0; and as given by the
+     * application, for the error queue. */
+    ci_uint64         txtime CI_ALIGN(8);
+    ci_uint64         txtime_ns;
   } udp;
   struct {
     ci_uint32         base;       /* Offset of start of data from dma_start. */
@@ -729,16 +748,16 @@ typedef struct {
 # define CI_IP_TIME_APP_GRANULARITY  1000u   /* approx tick in us     */
 # define CI_IP_TIME_MAX_FRCSHIFT     31u     /* largest tick shift    */
 
-  ci_uint32   khz;                     /* processor speed in khz */
+  ci_uint32   khz;                     /* ci_frc64() rate in khz */
                                        /* ticks expressed in 1/(2^32) of ms */
   ci_uint64   ci_ip_time_ms2tick_fxp CI_ALIGN(8);
-  /* list of timers currently firing */
-  struct oo_p_dllink fire_list;
+  /* lists of timers currently firing, one per callback code */
+  struct oo_p_dllink fire_list[CI_IP_TIMER_N_FN];
   /* holds the timer wheels in a flat array */
   struct oo_p_dllink warray[CI_IPTIME_WHEELSIZE];  
 
-  /* bitmask of non-empty buckets in the lowest weel */
-  ci_uint64 busy_mask[4] CI_ALIGN(8);
+  /* bitmask of non-empty slots in the lowest weel */
+  ci_uint64 busy_mask[CI_IPTIME_SLOTS / 64] CI_ALIGN(8);
 } ci_ip_timer_state;
 
 
@@ -765,6 +784,8 @@ typedef struct {
 # define CI_IP_TIMER_DEBUG_HOOK         0x9  /* Hook for timer debugging */
 # define CI_IP_TIMER_NETIF_STATS        0xa  /* netif statistics timer   */
 # define CI_IP_TIMER_TCP_CORK           0xb  /* TCP_CORK timer           */
+# define CI_IP_TIMER_TCP_PACING         0xc  /* TCP pacing release timer */
+# define CI_IP_TIMER_UDP_TXTIME         0xd  /* UDP SO_TXTIME release    */
 } ci_ip_timer;
 
 
@@ -799,6 +820,7 @@ typedef struct {
                                          containing page allocation, e.g. if
                                          packet buffers are 2K and pages are
                                          2MB then 10. */
+  CI_ULCONST ci_int16   numa_node;  /**< NUMA node of the buffers */
 } oo_pktbuf_set;
 
 typedef struct {
@@ -808,6 +830,11 @@ typedef struct {
   CI_ULCONST ci_uint32 sets_max; /**< max number of packet sets */
   /* Packet buffers allocated.  This is [sets_n * PKTS_PER_SET]. */
   CI_ULCONST ci_int32  n_pkts_allocated;
+  /* NUMA node wanted for the next packet set, or -1 to let the driver
+   * choose.  The driver resets it once the set is allocated. */
+  ci_int32 alloc_node;
+  /* When alloc_node was last set, to rate-limit the requests. */
+  ci_iptime_t alloc_node_time;
 
   CI_DECLARE_FLEX_ARRAY(oo_pktbuf_set, set);
 } oo_pktbuf_manager;
@@ -850,6 +877,72 @@ struct oo_deferred_pkt {
 **********************************************************************/
 
 
+/* Multi-producer, single-consumer ring of sockets with deferred work.
+ * Producers claim a slot by advancing [head] and then fill it in; the lock
+ * holder empties filled slots from [tail].  A slot holds a socket id plus
+ * one, so that zero means claimed but not yet filled in, or
+ * OO_DEFER_RING_DONE if its work was done out of order by
+ * ci_netif_purge_deferred_socket_list() or past a stalled slot.
+ *
+ * [hole] is the position of a claimed slot at which a drain last stopped,
+ * [hole_time] when that was first seen, and [hole_state] one of
+ * OO_DEFER_RING_HOLE_*.  These are only used by the lock holder. */
+#define OO_DEFER_RING_DONE  0xffffffffu
+#define OO_DEFER_RING_HOLE_NONE     0
+#define OO_DEFER_RING_HOLE_SEEN     1
+#define OO_DEFER_RING_HOLE_STALLED  2
+struct oo_defer_ring {
+  volatile ci_uint32  head CI_ALIGN(CI_CACHE_LINE_SIZE);
+  volatile ci_uint32  tail CI_ALIGN(CI_CACHE_LINE_SIZE);
+  ci_uint32           hole;
+  ci_iptime_t         hole_time;
+  ci_uint8            hole_state;
+  volatile ci_uint32  slot[CI_CFG_DEFER_RING_SIZE];
+} CI_ALIGN(CI_CACHE_LINE_SIZE);
+
+
+/**********************************************************************
+************************* Latency histograms **************************
+**********************************************************************/
+
+/* Log-linear histogram of latencies in cycles (EF_LATENCY_HIST).  Each
+ * power of 2 is split into 1 << OO_LAT_HIST_SUB_LG2 linear buckets, so a
+ * bucket is at most 12.5% wide.  Values below 1 << OO_LAT_HIST_SUB_LG2 get
+ * a bucket each, and values of 1 << OO_LAT_HIST_MAX_LG2 and above all go
+ * in the last bucket. */
+#define OO_LAT_HIST_SUB_LG2     3
+#define OO_LAT_HIST_MAX_LG2     32
+#define OO_LAT_HIST_N_BUCKETS \
+  ((OO_LAT_HIST_MAX_LG2 - OO_LAT_HIST_SUB_LG2 + 1) << OO_LAT_HIST_SUB_LG2)
+
+struct oo_lat_hist {
+  ci_uint32  bucket[OO_LAT_HIST_N_BUCKETS];
+};
+
+/* Delivery to the application happens without the stack lock, so the
+ * RX-to-app histogram is sharded by thread.  The others are updated only
+ * by the lock holder. */
+struct oo_lat_hists {
+  /* Poll of a received packet to delivery by recv() */
+  struct oo_lat_hist  rx_app[CI_CFG_LAT_HIST_SHARDS]
+                        CI_ALIGN(CI_CACHE_LINE_SIZE);
+  /* Entry to send() to the doorbell for its first packet */
+  struct oo_lat_hist  app_tx CI_ALIGN(CI_CACHE_LINE_SIZE);
+  /* Duration of ci_netif_poll_n() calls that handled events */
+  struct oo_lat_hist  poll;
+  /* Hold time of the stack lock */
+  struct oo_lat_hist  lock;
+};
+
+enum {
+  OO_LAT_HIST_RX_APP,
+  OO_LAT_HIST_APP_TX,
+  OO_LAT_HIST_POLL,
+  OO_LAT_HIST_LOCK,
+  OO_LAT_HIST_N,
+};
+
+
 /*! Comment? */
 typedef struct {
   volatile ci_uint64  lock;
@@ -900,18 +993,20 @@ typedef struct {
 #define CI_EPLOCK_NETIF_HAS_DEFERRED_PKTS  0x0004000000000000ULL
   /* Have ICMP message to handle */
 #define CI_EPLOCK_NETIF_HANDLE_ICMP        0x0001000000000000ULL
+  /* sockets with deferred work in ci_netif_state::defer_ring */
+#define CI_EPLOCK_NETIF_DEFER_RING         0x0040000000000000ULL
   /* have to allocate more socket buffers */
 #define CI_EPLOCK_NETIF_NEED_SOCK_BUFS     0x0002000000000000ULL
   /* if CI_EPLOCK_NETIF_NEED_POLL did nothing then prime */
 #define CI_EPLOCK_NETIF_PRIME_IF_IDLE      0x0000800000000000ULL
 
   /* mask for the above flags that must be handled before dropping lock */
-# define CI_EPLOCK_NETIF_UNLOCK_FLAGS      0xff3b800000000000ULL
+# define CI_EPLOCK_NETIF_UNLOCK_FLAGS      0xff7b800000000000ULL
 
   /* these flags can be handled in UL */
 #define CI_EPLOCK_NETIF_UL_COMMON_MASK \
     (CI_EPLOCK_NETIF_IS_PKT_WAITER | CI_EPLOCK_NETIF_NEED_POLL | \
-     CI_EPLOCK_NETIF_HAS_DEFERRED_PKTS | \
+     CI_EPLOCK_NETIF_HAS_DEFERRED_PKTS | CI_EPLOCK_NETIF_DEFER_RING | \
      CI_EPLOCK_NETIF_MERGE_ATOMIC_COUNTERS | \
      CI_EPLOCK_NETIF_PRIME_IF_IDLE)
 #if ! CI_CFG_UL_INTERRUPT_HELPER
@@ -990,6 +1085,8 @@ typedef struct {
   CI_ULCONST ci_uint8   vi_revision;
   CI_ULCONST ci_uint8   vi_nic_flags;
   CI_ULCONST char       dev_name[20];
+  /* NUMA node of the NIC, or -1 if not known. */
+  CI_ULCONST ci_int16   numa_node;
   /* Transmit overflow queue.  Packets here are ready to send. */
   oo_pktq               dmaq;
   /* Counts bytes of packet payload into and out of the TX descriptor ring. */
@@ -1003,6 +1100,18 @@ typedef struct {
   ci_uint32             tx_dmaq_done_seq;
   /* Holds partially received RX packet fragments. */
   oo_pkt_p              rx_frags;
+  /* The RX ring is refilled up to [rxq_target] (capped by rxq_limit) once
+   * there is room for [rxq_batch] buffers.  These are fixed unless
+   * EF_RXQ_ADAPT is set, in which case ci_netif_rx_adapt() tunes them from
+   * the other fields below, which cover the current interval. */
+  ci_int32              rxq_target;
+  ci_int32              rxq_batch;
+  ci_uint32             rxq_adapt_removed;  /* rxq.removed at last refill */
+  ci_iptime_t           rxq_adapt_start;    /* start of interval */
+  ci_uint32             rxq_adapt_start_removed; /* rxq.removed at start */
+  ci_uint32             rxq_adapt_rate;     /* smoothed packets per interval */
+  ci_uint32             rxq_adapt_drain;    /* most used between refills */
+  ci_uint32             rxq_adapt_low;      /* lowest fill level seen */
   /* Owner of EFRM PD */
   ci_uint32             pd_owner;
 #if CI_CFG_TIMESTAMPING
@@ -1023,6 +1132,38 @@ typedef struct {
 } ci_netif_state_nic_t;
 
 
+/* Stack-wide log of congestion window changes, shown by onload_stackdump.
+ * Entries are written under the stack lock. */
+#define CI_TCP_CONG_LOG_LEN     256
+
+struct oo_tcp_cong_log_entry {
+  oo_sp                sock;
+  ci_iptime_t          time;
+  ci_uint32            cwnd;
+  ci_uint32            ssthresh;
+  ci_uint8             event;   /* CI_TCP_CONG_EV_* */
+  ci_uint8             alg;     /* CI_TCP_CONG_ALG_* */
+};
+#define CI_TCP_CONG_EV_SAMPLE   0   /* once-per-RTT sample while growing */
+#define CI_TCP_CONG_EV_LOSS     1   /* entered fast recovery */
+#define CI_TCP_CONG_EV_RTO      2   /* retransmit timeout */
+
+struct oo_tcp_cong_log {
+  ci_uint32                    n;  /* total entries ever written */
+  struct oo_tcp_cong_log_entry ent[CI_TCP_CONG_LOG_LEN];
+};
+
+
+/* An instruction of a classic BPF program, laid out as in libpcap's
+ * struct bpf_insn. */
+struct oo_bpf_insn {
+  ci_uint16  code;
+  ci_uint8   jt;
+  ci_uint8   jf;
+  ci_uint32  k;
+};
+
+
 struct ci_netif_state_s {
 
   ci_netif_state_nic_t  nic[CI_CFG_MAX_INTERFACES];
@@ -1202,6 +1343,9 @@ struct ci_netif_state_s {
 #endif
   CI_ULCONST ci_uint32  seq_table_ofs;   /**< offset of seq no table */
   CI_ULCONST ci_uint32  deferred_pkts_ofs; /**< offset of deferred pkts array */
+#if CI_CFG_TCPDUMP
+  CI_ULCONST ci_uint32  dump_queue_ofs;  /**< offset of capture ring */
+#endif
   CI_ULCONST ci_uint32  buf_ofs;         /**< offset of packet metadata */
   CI_ULCONST ci_uint32  dma_ofs;         /**< offset of dma_addrs */
 
@@ -1237,6 +1381,14 @@ struct ci_netif_state_s {
   /* List of sockets that may have reapable buffers. */
   struct oo_p_dllink        reap_list;
 
+  /* SO_TXTIME: UDP sockets holding datagrams until their launch time, the
+   * earliest such launch time (frc) or 0 if none, and the timer that
+   * releases them if nothing polls the stack sooner.
+   */
+  struct oo_p_dllink    udp_txtime_list;
+  ci_uint64             udp_txtime_next CI_ALIGN(8);
+  ci_ip_timer           udp_txtime_tid CI_ALIGN(8);
+
 #if CI_CFG_SUPPORT_STATS_COLLECTION
   ci_int32              stats_fmt; /**< Output format */
   ci_ip_timer           stats_tid CI_ALIGN(8); /**< NETIF statistics timer id */
@@ -1348,23 +1500,36 @@ struct ci_netif_state_s {
   
   ci_uint32             defer_work_count;
 
+  struct oo_defer_ring  defer_ring[CI_CFG_DEFER_RING_SHARDS];
+
   CI_ULCONST ci_uint8   hash_salt[16];
 
 #if CI_CFG_STATS_NETIF
   ci_netif_stats        stats;
+  struct oo_lat_hists   lat_hist;
 #endif
 
+  struct oo_tcp_cong_log tcp_cong_log;
+
 #define OO_INTF_I_SEND_VIA_OS   CI_CFG_MAX_INTERFACES
 #define OO_INTF_I_LOOPBACK      (CI_CFG_MAX_INTERFACES+1)
 #define OO_INTF_I_NUM           (CI_CFG_MAX_INTERFACES+2)
 #if CI_CFG_TCPDUMP
-  oo_pkt_p              dump_queue[CI_CFG_DUMPQUEUE_LEN];
 #define OO_INTF_I_DUMP_NONE 0
 #define OO_INTF_I_DUMP_ALL 1
 #define OO_INTF_I_DUMP_NO_MATCH 2
   ci_uint8              dump_intf[OO_INTF_I_NUM];
-  volatile ci_uint16    dump_read_i;
-  volatile ci_uint16    dump_write_i;
+  /* The capture ring at dump_queue_ofs has EF_TCPDUMP_RING entries, each
+   * holding a reference to a packet.  The stack adds entries at
+   * dump_write_i, and onload_tcpdump advances dump_read_i past those it
+   * has written out.  The stack releases the packets of entries from
+   * dump_free_i up to dump_read_i in batches. */
+  volatile ci_uint32    dump_read_i;
+  volatile ci_uint32    dump_write_i;
+  ci_uint32             dump_free_i;
+  /* BPF pre-filter installed by onload_tcpdump, or none if zero length. */
+  volatile ci_uint32    dump_filter_len;
+  struct oo_bpf_insn    dump_filter[CI_CFG_TCPDUMP_FILTER_LEN];
 #endif
 
   ef_vi_stats           vi_stats CI_ALIGN(8);
@@ -1988,6 +2153,8 @@ struct ci_sock_cmn_s {
 # define CI_IPV6_CMSG_PKTINFO    0x0100
 # define CI_IPV6_CMSG_HOPLIMIT   0x0200
 # define CI_IPV6_CMSG_TCLASS     0x0400
+  /* UDP_GRO: coalesce received datagrams and report the segment size */
+# define CI_UDP_CMSG_GRO         0x0800
 
 #if CI_CFG_TIMESTAMPING
   /* timestamping_flags relate to flags provided with socket option
@@ -2124,6 +2291,8 @@ typedef struct {
   ci_uint32 n_rx_mem_drop;    /* datagrams dropped due to out-of-mem   */
   ci_uint32 n_rx_pktinfo;     /* n times IP/IPV6_PKTINFO retrieved     */
   ci_uint32 max_recvq_pkts;   /* maximum packets queued for recv       */
+  ci_uint32 n_rx_gro;         /* receives coalesced by UDP_GRO         */
+  ci_uint32 n_rx_gro_segs;    /* datagrams in coalesced receives       */
 
   ci_uint32 n_tx_os;          /* datagrams send via OS socket          */
   ci_uint32 n_tx_os_slow;     /* datagrams send via OS socket (slower) */
@@ -2147,6 +2316,12 @@ typedef struct {
   ci_uint32 n_tx_msg_confirm; /* onload send with MSG_CONFIRM          */
   ci_uint32 n_tx_os_late;     /* sent via OS, after copying            */
   ci_uint32 n_tx_unconnect_late; /* concurrent send and unconnect      */
+  ci_uint32 n_tx_gso;         /* sends split by UDP_SEGMENT            */
+  ci_uint32 n_tx_gso_segs;    /* datagrams produced by UDP_SEGMENT     */
+  ci_uint32 n_tx_mmsg;        /* batches sent by sendmmsg()            */
+  ci_uint32 n_tx_mmsg_dgrams; /* datagrams in sendmmsg() batches       */
+  ci_uint32 n_tx_txtime;      /* datagrams held for SO_TXTIME          */
+  ci_uint32 n_tx_txtime_drop; /* SO_TXTIME launch time missed/invalid  */
 } ci_udp_socket_stats;
 
 struct  ci_udp_state_s {
@@ -2173,6 +2348,7 @@ struct  ci_udp_state_s {
 #define CI_UDPF_NO_UCAST_FILTER 0x00020000  /*!< don't add unicast filters */
 #define CI_UDPF_LAST_SEND_NOMAC 0x00040000  /*!< last send was via nomac path */
 #define CI_UDPF_NO_MCAST_FILTER 0x00080000  /*!< don't add multicast filters */
+#define CI_UDPF_TXTIME          0x00100000  /*!< SO_TXTIME */
 
   ci_uint32 future_intf_i; /* Interface to check for incoming future packets */
 
@@ -2213,6 +2389,35 @@ struct  ci_udp_state_s {
    */
   ci_uint32 tx_count;
 
+  /* UDP_SEGMENT: payload bytes per datagram when a send is to be split
+   * into several, or 0.
+   */
+  ci_uint16 gso_size;
+
+  /* SO_TXTIME: clock and SOF_TXTIME_* flags given by the application. */
+  ci_int16  txtime_clockid;
+  ci_uint16 txtime_flags;
+
+  /* SO_TXTIME: datagrams held until their launch time, earliest first,
+   * linked by [pkt->netif.tx.dmaq_next].  The socket is on the stack's
+   * [udp_txtime_list] while this is not empty.  Protected by the stack
+   * lock.
+   */
+  oo_pkt_p  txtime_q;
+  struct oo_p_dllink txtime_link;
+
+  /* SO_TXTIME: datagrams dropped for their launch time, to be reported on
+   * the error queue.  [txtime_err_put] advances under the stack lock and
+   * [txtime_err_get] under the socket lock.
+   */
+#define CI_UDP_TXTIME_ERR_Q_LEN  8
+  ci_uint32 txtime_err_put;
+  ci_uint32 txtime_err_get;
+  struct {
+    ci_uint64 txtime;           /* as given by the application */
+    ci_uint32 code;             /* SO_EE_CODE_TXTIME_* */
+  } txtime_err[CI_UDP_TXTIME_ERR_Q_LEN] CI_ALIGN(8);
+
   /* Cache for IP_PKTINFO and IPV6_PKTINFO */
   struct {
     /* PKT info: */
@@ -2421,6 +2626,24 @@ typedef struct {
 } ci_ni_aux_mem;
 
 
+/* Congestion control algorithms, see tcp_cong.c. */
+#define CI_TCP_CONG_ALG_RENO    0
+#define CI_TCP_CONG_ALG_CUBIC   1
+#define CI_TCP_CONG_ALG_N       2
+
+/* Per-connection CUBIC state (RFC 9438).  Windows are in segments and
+ * [k] in units of 2^-10 seconds.  [epoch_start] is zero when there is no
+ * growth epoch in progress. */
+typedef struct {
+  ci_uint32            last_max_cwnd; /* W_max: cwnd before last reduction */
+  ci_uint32            origin_point;  /* plateau of the cubic function */
+  ci_uint32            k;             /* time from epoch to plateau */
+  ci_iptime_t          epoch_start;   /* start of growth epoch, in ticks */
+  ci_uint32            tcp_cwnd;      /* Reno-friendly cwnd estimate */
+  ci_uint32            ack_cnt;       /* segments acked for [tcp_cwnd] */
+} ci_tcp_cubic_state;
+
+
 /* TCP options which must survive when CLOSED endpoint (i.e. ci_tcp_state)
  * is transformed into LISTEN (i.e. ci_tcp_socket_listen). */
 typedef struct {
@@ -2434,6 +2657,11 @@ typedef struct {
   ci_uint16            user_mss;            /* user-provided maximum MSS */
   ci_uint8             tcp_defer_accept;    /* TCP_DEFER_ACCEPT sockopt  */
 #define OO_TCP_DEFER_ACCEPT_OFF 0xff
+  ci_uint8             cong_alg;            /* TCP_CONGESTION sockopt    */
+
+  /* SO_MAX_PACING_RATE in bytes per second, or OO_TCP_PACING_RATE_UNLIMITED */
+  ci_uint64            max_pacing_rate CI_ALIGN(8);
+#define OO_TCP_PACING_RATE_UNLIMITED ((ci_uint64) -1)
 
 } ci_tcp_socket_cmn;
 
@@ -2448,6 +2676,8 @@ struct oo_tcp_socket_stats {
 #if CI_CFG_BURST_CONTROL
   ci_uint32  tx_stop_burst;   /* TX stopped by burst control       */
 #endif
+  ci_uint32  tx_stop_pacing;  /* TX stopped by the pacer           */
+  ci_uint32  tx_pacing_held_us; /* total time TX was held by pacer */
   ci_uint32  tx_nomac_defer;  /* Deferred send waiting for ARP     */
   ci_uint32  tx_defer;        /* Deferred send to avoid lock contention */
   ci_uint32  tx_msg_warm_abort;/* Number of MSG_WARM aborted early */
@@ -2670,6 +2900,10 @@ struct ci_tcp_state_s {
   ci_uint32            cwnd_extra;  /* adjustments when congested         */
   ci_uint32            ssthresh;    /* slow-start threshold               */
   ci_uint32            bytes_acked; /* bytes acked but not yet added to cwnd */
+  ci_iptime_t          cong_sample_t; /* time of last CI_TCP_CONG_EV_SAMPLE */
+  union {
+    ci_tcp_cubic_state cubic;
+  } cong;                           /* per-algorithm state, see [c.cong_alg] */
   
 #if CI_CFG_TCP_FASTSTART  
   ci_uint32            faststart_acks; /* Bytes to ack before leaving faststart */
@@ -2768,6 +3002,13 @@ struct ci_tcp_state_s {
   ci_ip_timer          stats_tid;   /* Statistics report timer            */
 #endif
   ci_ip_timer          cork_tid;    /* TCP timer for TCP_CORK/MSG_MORE   */
+  ci_ip_timer          pacing_tid;  /* releases segments held by pacer   */
+
+  /* Pacing state.  [pacing_edt] is the earliest departure time (in frc
+   * cycles) of the next segment; [pacing_hold_frc] is the time at which
+   * the pacer started holding the send queue, or zero if it is not. */
+  ci_uint64            pacing_edt CI_ALIGN(8);
+  ci_uint64            pacing_hold_frc;
 
 
 #if CI_CFG_TCP_SOCK_STATS
@@ -184,6 +184,16 @@ struct ci_netif_s {
 
   struct oo_deferred_pkt* deferred_pkts;
 
+#if CI_CFG_TCPDUMP
+  oo_pkt_p*            dump_queue;
+#endif
+
+#if CI_CFG_STATS_NETIF
+  /* When this process took the stack lock, for the lock hold time
+   * histogram (EF_LATENCY_HIST).  Zero if not measuring this hold. */
+  ci_uint64            lock_frc;
+#endif
+
 #ifdef __ci_driver__
   unsigned             pkt_sets_n;
   unsigned             pkt_sets_max;
@@ -20,16 +20,22 @@
 #define TIME_GE(x, y)  ((ci_int32)((x)-(y)) >= 0)
 
 
-/* gives a bucket no for a given wheelno */
+/* gives a bucket no (position within a revolution) for a given wheelno */
 #define IPTIMER_BUCKETNO(wheelno, abs)                          \
         (((abs) >> ((wheelno)*CI_IPTIME_BUCKETBITS)) & CI_IPTIME_BUCKETMASK)
 
+/* gives the slot for abs in a given wheelno.  The slot includes the low
+ * bit of the revolution, except for the top wheel which has one slot per
+ * bucket. */
+#define IPTIMER_SLOTNO(wheelno, abs)                            \
+        (((abs) >> ((wheelno)*CI_IPTIME_BUCKETBITS)) & CI_IPTIME_SLOTMASK)
+
 /* get the bucket for a given wheelno and abs */
 #define IPTIMER_BUCKET(netif, wheelno, abs)                     \
   oo_p_dllink_ptr(netif,                                        \
                   &(IPTIMER_STATE((netif))->warray[             \
-                                  (wheelno)*CI_IPTIME_BUCKETS + \
-                                  IPTIMER_BUCKETNO((wheelno), (abs))]))
+                                  (wheelno)*CI_IPTIME_SLOTS +   \
+                                  IPTIMER_SLOTNO((wheelno), (abs))]))
 
 #define IPTIMER_WHEEL2_MASK (CI_IPTIME_BUCKETMASK << (CI_IPTIME_BUCKETBITS*3))
 #define IPTIMER_WHEEL1_MASK (IPTIMER_WHEEL2_MASK + \
@@ -37,34 +43,39 @@
 #define IPTIMER_WHEEL0_MASK (IPTIMER_WHEEL1_MASK + \
                             (CI_IPTIME_BUCKETMASK << (CI_IPTIME_BUCKETBITS*1)))
 
-/* Mark a wheel0 bucket as busy adding a timer with the given time */
+/* Number of revolutions of the given wheel (not the top one) from the one
+ * containing [from] to the one containing [to]. */
+ci_inline ci_uint32 ci_ip_timer_revs(int wheelno, ci_iptime_t from,
+                                     ci_iptime_t to)
+{
+  int shift = (wheelno + 1) * CI_IPTIME_BUCKETBITS;
+  ci_assert_lt(wheelno, CI_IPTIME_WHEELS - 1);
+  return ((to >> shift) - (from >> shift)) & (0xffffffffu >> shift);
+}
+
+/* Mark a wheel0 slot as busy adding a timer with the given time */
 ci_inline void __ci_timer_busy_set(ci_netif* netif, ci_iptime_t time)
 {
-  int b = IPTIMER_BUCKETNO(0, time);
-  ci_assert_equal(IPTIMER_STATE(netif)->sched_ticks & IPTIMER_WHEEL0_MASK,
-                  time & IPTIMER_WHEEL0_MASK);
+  int b = IPTIMER_SLOTNO(0, time);
+  ci_assert_le(ci_ip_timer_revs(0, IPTIMER_STATE(netif)->sched_ticks, time),
+               1);
   IPTIMER_STATE(netif)->busy_mask[b/64] |= 1ULL << (b%64);
 }
 
-/*  Mark a wheel0 bucket as non-busy when removing a timer */
+/*  Mark a wheel0 slot as non-busy when removing a timer */
 ci_inline void __ci_timer_busy_unset(ci_netif* netif, ci_iptime_t time)
 {
-  int b = IPTIMER_BUCKETNO(0, time);
-  ci_assert_equal(IPTIMER_STATE(netif)->sched_ticks & IPTIMER_WHEEL0_MASK,
-                  time & IPTIMER_WHEEL0_MASK);
+  int b = IPTIMER_SLOTNO(0, time);
+  ci_assert_le(ci_ip_timer_revs(0, IPTIMER_STATE(netif)->sched_ticks, time),
+               1);
   IPTIMER_STATE(netif)->busy_mask[b/64] &=~ (1ULL << (b%64));
 }
 
 ci_inline void ci_timer_busy_maybe_unset(ci_netif* netif, ci_iptime_t time)
 {
-  int b;
-  if( (IPTIMER_STATE(netif)->sched_ticks & IPTIMER_WHEEL0_MASK) !=
-      (time & IPTIMER_WHEEL0_MASK) )
+  if( ci_ip_timer_revs(0, IPTIMER_STATE(netif)->sched_ticks, time) > 1 )
     return;
-  b = IPTIMER_BUCKETNO(0, time);
-  if( oo_p_dllink_is_empty(netif,
-                           oo_p_dllink_ptr(netif,
-                                           &IPTIMER_STATE(netif)->warray[b])) )
+  if( oo_p_dllink_is_empty(netif, IPTIMER_BUCKET(netif, 0, time)) )
     __ci_timer_busy_unset(netif, time);
 }
 
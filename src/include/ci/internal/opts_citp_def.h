@@ -155,6 +155,18 @@ CI_CFG_OPT("EF_EPOLL_MT_SAFE", ul_epoll_mt_safe, ci_uint32,
 "EF_UL_EPOLL=2 and EF_EPOLL_CTL_FAST=1.",
            1, , 0, 0, 1, yesno)
 
+CI_CFG_OPT("EF_EPOLL_MAX_HOMES", ul_epoll_max_homes, ci_uint32,
+"With EF_UL_EPOLL=3, the number of Onload stacks that an epoll set can treat "
+"as home stacks.  Readiness of sockets in a home stack is collected from a "
+"ready list that the stack maintains for the set, so their cost does not grow "
+"with the size of the set.  Sockets in any other stack are checked one by one "
+"on each call to epoll_wait().\n"
+"Set this to the number of stacks in use (for example one per interface) when "
+"a single epoll set monitors sockets in several stacks.  Each home stack uses "
+"one of the stack's ready lists, and a stack has only a few of them, so "
+"raising this can leave later epoll sets without a home stack.",
+           3, , 1, 1, CI_CFG_EPOLL3_MAX_HOMES, count)
+
 CI_CFG_OPT("EF_WODA_SINGLE_INTERFACE", woda_single_if, ci_uint32,
 "This option alters the behaviour of onload_ordered_epoll_wait().  This "
 "function would normally ensure correct ordering across multiple interfaces. "
@@ -273,6 +285,28 @@ CI_CFG_OPT("EF_TCP_SEND_SPIN", tcp_send_spin, ci_uint32,
 "is set by EF_SPIN_USEC or EF_POLL_USEC.",
            1, , 0, 0, 1, yesno)
 
+CI_CFG_OPT("EF_TCP_SENDFILE", tcp_sendfile, ci_uint32,
+"Handle sendfile() from a regular file to an accelerated TCP socket at user "
+"level.  The file is mapped and its page cache pages are copied straight "
+"into packet buffers, avoiding the per-page kernel entry of the default "
+"path.  The file must not be truncated while sendfile() is in progress: as "
+"with any mapped file, access beyond the new end raises SIGBUS.",
+           1, , 0, 0, 1, yesno)
+
+CI_CFG_OPT("EF_IO_URING", io_uring, ci_uint32,
+"Handle io_uring send, recv, accept and poll-add requests on accelerated "
+"sockets at user level.  The SQEs are completed against the Onload stack "
+"when io_uring_enter() is called and their CQEs are posted to the ring "
+"without involving the kernel socket; requests that cannot complete "
+"immediately are completed by Onload while the application waits for "
+"completions.  All other requests are passed to the kernel unchanged.  Only "
+"rings created and entered through the libc syscall() function are handled; "
+"liburing 2.2 and later make these system calls directly unless built with "
+"--use-libc, and a warning is logged at startup if such a liburing is "
+"loaded.  Rings using SQPOLL, IOPOLL, 128-byte SQEs or 32-byte CQEs are "
+"always left to the kernel.  Requires Linux 5.18 or later.",
+           1, , 0, 0, 1, yesno)
+
 CI_CFG_OPT("EF_TCP_ACCEPT_SPIN", tcp_accept_spin, ci_uint32,
 "Spin in blocking TCP accept() calls until incoming connection is "
 "established, the spin timeout "
@@ -944,6 +944,23 @@ CI_CFG_OPT("EF_RXQ_LIMIT", rxq_limit, ci_int32,
 "when it has a value larger than the ring size (EF_RXQ_SIZE).",
            , , 65535, CI_CFG_RX_DESC_BATCH, 65535, level)
 
+CI_CFG_OPT("EF_RXQ_ADAPT", rxq_adapt, ci_uint32,
+"When set, Onload tracks the rate at which packets arrive on each interface "
+"and how far each RX ring drains between refills, and adjusts the fill "
+"level of the ring to suit.  The fill level is kept between EF_RXQ_MIN and "
+"EF_RXQ_LIMIT: it is raised quickly when a ring runs low during a burst, "
+"and lowered slowly when traffic is quiet, so that the packet buffers are "
+"available to other users.  The number of buffers that are posted at a time "
+"is also raised when packets arrive quickly, up to EF_RXQ_ADAPT_BATCH_MAX.\n"
+"When not set, each RX ring is refilled to EF_RXQ_LIMIT whenever there is "
+"room for a batch of buffers.",
+           1, , 0, 0, 1, yesno)
+
+CI_CFG_OPT("EF_RXQ_ADAPT_BATCH_MAX", rxq_adapt_batch_max, ci_uint32,
+"The largest number of free descriptors that EF_RXQ_ADAPT waits for before "
+"refilling an RX ring.",
+           , , 64, CI_CFG_RX_DESC_BATCH, 4096, count)
+
 CI_CFG_OPT("EF_SHARED_RXQ_NUM", shared_rxq_num, ci_int32,
 "Experimental option: this option may be changed or removed in future "
 "releases. For adapters using shared receive queues for their traffic (X3), "
@@ -1115,6 +1132,17 @@ CI_CFG_OPT("EF_DEFER_ARP_TIMEOUT", defer_arp_timeout, ci_uint16,
 "(via ARP protocol for IPv4 or Neighbor Discovery for IPv6).",
           , , 60, 1, 600, time:sec)
 
+#if CI_CFG_TCPDUMP
+CI_CFG_OPT("EF_TCPDUMP_RING", tcpdump_ring, ci_uint32,
+"Number of entries in the ring through which the stack passes packets to "
+"onload_tcpdump.  Each entry holds a reference to a packet buffer until "
+"onload_tcpdump has written it out, so a larger ring rides out longer "
+"stalls of onload_tcpdump without losing packets, at the cost of holding "
+"more packet buffers.  Packets are not captured while the stack is short of "
+"packet buffers.  Rounded up to a power of 2.",
+          , , 1024, 128, 65536, count)
+#endif
+
 
 CI_CFG_OPT("EF_TCP_SNDBUF_ESTABLISHED_DEFAULT", tcp_sndbuf_est_def, ci_uint32,
 "Overrides the OS default SO_SNDBUF value for TCP sockets in the ESTABLISHED "
@@ -1343,6 +1371,27 @@ CI_CFG_OPT("EF_BURST_CONTROL_LIMIT", burst_control_limit, ci_uint32,
            , , CI_CFG_TCP_BURST_CONTROL_LIMIT, MIN, MAX, count)
 #endif
 
+CI_CFG_OPT("EF_TCP_CONGESTION", tcp_congestion, ci_uint32,
+"Selects the default TCP congestion control algorithm: NewReno (the "
+"default), or CUBIC as described in RFC 9438.  CUBIC grows the congestion "
+"window independently of RTT, which gives better throughput on paths with "
+"a long RTT.  Applications can override this per socket with the "
+"TCP_CONGESTION socket option, using the names \"reno\" and \"cubic\".",
+           1, , CI_TCP_CONG_ALG_RENO, 0, CI_TCP_CONG_ALG_N - 1, oneof:reno;cubic)
+
+CI_CFG_OPT("EF_TCP_PACING", tcp_pacing, ci_uint32,
+"When set, TCP sockets pace their transmissions at a rate derived from the "
+"congestion window and smoothed RTT, in the same way as Linux: twice "
+"cwnd/srtt in slow start and 1.2 times cwnd/srtt thereafter.  The rate is "
+"further limited by SO_MAX_PACING_RATE where the application has set it.  "
+"Sockets with SO_MAX_PACING_RATE set are paced at that rate even when this "
+"option is not set.\n"
+"Held segments are released by the stack's periodic timer, so up to one "
+"timer tick worth of data may be sent back-to-back, and connections whose "
+"RTT is below one tick are only paced by SO_MAX_PACING_RATE.  This can help "
+"avoid drops on switches with shallow buffers.",
+           1, , 0, 0, 1, yesno)
+
 #if CI_CFG_CONG_AVOID_NOTIFIED
 CI_CFG_OPT("EF_CONG_NOTIFY_THRESH", cong_notify_thresh, ci_uint32,
 /* FIXME: need to introduce concept of burst control. */
@@ -1422,6 +1471,17 @@ CI_CFG_OPT("EF_LOG", log_category, ci_uint32,
 "EF_LOG=conn_drop,-resource_warnings",
            , , CI_EF_LOG_DEFAULT, 0, MAX, count)
 
+#if CI_CFG_STATS_NETIF
+CI_CFG_OPT("EF_LATENCY_HIST", latency_hist, ci_uint32,
+"When set, the stack keeps log-linear histograms of the time from polling a "
+"received packet to delivering it to the application, from entering send() "
+"to ringing the doorbell for the first packet sent, of the duration of "
+"event queue polls that found work, and of the time for which the stack "
+"lock is held.  Show them with \"onload_stackdump histograms\".  This "
+"costs a few timestamp reads per packet, so is off by default.",
+           1, , 0, 0, 1, yesno)
+#endif
+
 
 #if CI_CFG_TCP_SHARED_LOCAL_PORTS
 CI_CFG_OPT("EF_TCP_SHARED_LOCAL_PORTS", tcp_shared_local_ports, ci_uint32,
@@ -1574,6 +1634,17 @@ CI_CFG_OPT("EF_PERIODIC_TIMER_CPU", periodic_timer_cpu, ci_int32,
            "periodic timer ticks."
            , , , -1, -1, SMAX, count)
 
+CI_CFG_OPT("EF_STACK_PLACEMENT", stack_placement, ci_uint32,
+"When set, the driver keeps the stack's work near the application threads "
+"that use it.  It notes the CPU on which a thread last blocked in the "
+"stack, and runs the stack's periodic timer and deferred work on another "
+"CPU that shares a last-level cache with that one, moving the work if the "
+"application migrates.  Each interface's interrupt is also requested on "
+"such a CPU when the stack is created; interrupts cannot be moved later.\n"
+"EF_IRQ_CORE, EF_IRQ_CHANNEL and EF_PERIODIC_TIMER_CPU take precedence.  "
+"The choices made are shown in /proc/driver/onload/placement.",
+           1, , 0, 0, 1, yesno)
+
 #define CITP_SCALABLE_FILTERS_DISABLE 0
 #define CITP_SCALABLE_FILTERS_ENABLE  1
 #define CITP_SCALABLE_FILTERS_ENABLE_WORKER  2
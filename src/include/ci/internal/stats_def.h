@@ -78,6 +78,11 @@ OO_STAT("Number of times an interrupt polled for network events.  If "
 OO_STAT("Number of network events handled in interrupts.  Roughly "
         "proportional to traffic levels.",
         ci_uint32, interrupt_evs, count)
+OO_STAT("Number of timers moved to a lower timer wheel ahead of time, to "
+        "spread out the work of the wheel wrapping.",
+        ci_uint32, timer_drained, count)
+OO_STAT("Largest number of timers moved at once when a timer wheel wrapped.",
+        ci_uint32, timer_cascade_max, val)
 OO_STAT("Number of times an interrupt woke one or more processes.  i.e. "
         "threads were sleeping (not spinning) waiting for this data.",
         ci_uint32, interrupt_wakes, count)
@@ -218,6 +223,15 @@ OO_STAT("Times work has been done by the lock holder for another thread.  "
         "This is a mitigation mechanism for contention - which means that "
         "multiple threads are accessing this stack simultaneously.",
         ci_uint32, deferred_work, count)
+OO_STAT("Times a thread has passed deferred work to the lock holder through "
+        "the lock-free defer rings rather than the list in the lock word.",
+        ci_uint32, defer_ring_queued, count)
+OO_STAT("Times a defer ring was full, so deferred work went onto the list in "
+        "the lock word instead.",
+        ci_uint32, defer_ring_full, count)
+OO_STAT("Times a claimed slot of a defer ring stayed empty for so long that "
+        "its producer was assumed to have died.",
+        ci_uint32, defer_ring_stalled, count)
 OO_STAT("Times a thread has slept waiting for a socket lock.",
         ci_uint32, sock_lock_sleeps, count)
 OO_STAT("Times a thread has spun waiting for a socket lock.",
@@ -228,6 +242,12 @@ OO_STAT("Number of times TCP sendmsg() contended the stack lock.",
         ci_uint32, tcp_send_ni_lock_contends, count)
 OO_STAT("Number of times TCP sendmsg() failed to find an acceleratable route.",
         ci_uint32, tcp_send_fail_noroute, count)
+OO_STAT("Number of times TCP transmit was held back by the pacer.  See "
+        "EF_TCP_PACING and SO_MAX_PACING_RATE.",
+        ci_uint32, tcp_pacing_holds, count)
+OO_STAT("Total time, in microseconds, that TCP send queues were held back by "
+        "the pacer.",
+        ci_uint64, tcp_pacing_held_us, count)
 OO_STAT("Number of times UDP sendmsg() contended the stack lock.",
         ci_uint32, udp_send_ni_lock_contends, count)
 OO_STAT("Number of times getsockopt() contended the stack lock.",
@@ -553,6 +573,17 @@ OO_STAT("We wanted to refill the RX ring, but lacked available buffers to "
         ci_uint32, refill_rx_limited, count)
 OO_STAT("Number of times we could not refill RX ring due to lack of buffers.",
         ci_uint32, refill_buf_limited, count)
+OO_STAT("Number of times we refilled an RX ring from a packet set on a "
+        "different NUMA node from the NIC, because no set on the NIC's node "
+        "had enough free buffers.",
+        ci_uint32, refill_remote_node, count)
+OO_STAT("Number of times EF_RXQ_ADAPT raised an RX ring's fill target.",
+        ci_uint32, rxq_adapt_grow, count)
+OO_STAT("Number of times EF_RXQ_ADAPT lowered an RX ring's fill target.",
+        ci_uint32, rxq_adapt_shrink, count)
+OO_STAT("Number of times EF_RXQ_ADAPT found that an RX ring had run empty "
+        "between refills.",
+        ci_uint32, rxq_adapt_empty, count)
 OO_STAT("Deferred work is used to mitigate jitter due to contention.  But "
         "to prevent a thread monopolising the lock completely, there is a "
         "cap - which has been reached.  See EF_DEFER_WORK_LIMIT.",
@@ -866,6 +897,17 @@ OO_STAT("Number of packets received via discard that subsequently passed sw "
 OO_STAT("Number of packets not captured by onload_tcpdump because the "
         "dump ring was full.",
         ci_uint32, tcpdump_missed, count)
+OO_STAT("Number of packets passed to onload_tcpdump.",
+        ci_uint32, tcpdump_captured, count)
+OO_STAT("Number of packets not captured by onload_tcpdump because the "
+        "stack was short of packet buffers.",
+        ci_uint32, tcpdump_holdoff, count)
+OO_STAT("Number of packets not captured by onload_tcpdump because they did "
+        "not match its pre-filter.",
+        ci_uint32, tcpdump_filtered, count)
+OO_STAT("Number of pre-filter instructions run by the stack for "
+        "onload_tcpdump.",
+        ci_uint64, tcpdump_filter_insns, count)
 #endif
 
 OO_STAT("Lowest recorded number of free packets",
@@ -44,6 +44,23 @@
  * this number.*/
 #define CI_CFG_NETIF_MAX_ENDPOINTS_MAX (1<<21)
 
+/* Rings through which threads that find the stack locked pass sockets with
+ * deferred work to the lock holder.  Sockets are spread over the shards by
+ * id, and each shard holds up to CI_CFG_DEFER_RING_SIZE sockets (a power
+ * of 2).  When a shard is full the socket goes on the list in the lock
+ * word instead. */
+#define CI_CFG_DEFER_RING_SHARDS        8
+#define CI_CFG_DEFER_RING_SIZE          32
+
+/* How long a claimed defer ring slot may stay empty before the lock holder
+ * assumes that its producer has died, and stops waiting for it. */
+#define CI_CFG_DEFER_RING_STALL_MS      1000
+
+/* Number of shards of the RX-to-application latency histogram
+ * (EF_LATENCY_HIST).  Receiving threads record without the stack lock, so
+ * each thread picks a shard to keep them off each other's cache lines. */
+#define CI_CFG_LAT_HIST_SHARDS          4
+
 /* ANVL assumes the 2MSL time is 60 secs. Set slightly smaller */
 #define CI_CFG_TCP_TCONST_MSL		25
 
@@ -159,6 +176,9 @@
 /* How many RX descriptors to push at a time. */
 #define CI_CFG_RX_DESC_BATCH		16
 
+/* How often, in ms, EF_RXQ_ADAPT reviews each RX ring's fill target. */
+#define CI_CFG_RXQ_ADAPT_INTERVAL_MS	10
+
 /* How many packets to fill on TX path before pushing them out. */
 #define CI_CFG_TCP_TX_BATCH		8
 
@@ -476,8 +496,9 @@
 #define CI_CFG_TCPDUMP 1
 
 #if CI_CFG_TCPDUMP
-/* Dump queue length, should be 2^x, x <= 16 */
-#define CI_CFG_DUMPQUEUE_LEN 128
+/* The capture ring is EF_TCPDUMP_RING entries long.  Max length of the
+ * BPF pre-filter that onload_tcpdump may install in the stack. */
+#define CI_CFG_TCPDUMP_FILTER_LEN 128
 #endif /* CI_CFG_TCPDUMP */
 
 
@@ -513,6 +534,10 @@
  * set. */
 #define CI_CFG_PKT_SET_HIGH_WATER (PKTS_PER_SET - PKTS_PER_SET / 32)
 
+/* Minimum interval between requests for a packet set on a NIC's NUMA node
+ * made because RX refill had to use a set on another node. */
+#define CI_CFG_PKT_SET_NODE_REQ_MS 100
+
 /* Whether to include code to transmit small packets via PIO */
 #define CI_CFG_PIO 1
 #define CI_CFG_MIN_PIO_BLOCK_ORDER 7
@@ -540,6 +565,9 @@
 /* Most users want epoll2 and epoll3 modes */
 #define CI_CFG_EPOLL2 1
 #define CI_CFG_EPOLL3 1
+/* How many stacks an epoll3 set can collect ready lists from.  Each one
+ * uses up one of the stack's CI_CFG_N_READY_LISTS. */
+#define CI_CFG_EPOLL3_MAX_HOMES 4
 
 /* Inject packets into kernel if they match hardware filters but do not
  * match software ones.  See inject_kernel_gid module parameter. */
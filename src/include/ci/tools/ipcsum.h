@@ -238,6 +238,53 @@ extern unsigned ci_ip_csum_copy_asm(void* dest, const void* src,
 				    int n, unsigned sum) CI_HF;
 
 
+/****************************************************************************
+ * Bulk checksum engine
+ ***************************************************************************/
+
+  /*! Buffers shorter than this are not worth handing to the bulk engine. */
+#define CI_IP_CSUM_ENGINE_MIN_BYTES  64
+
+  /*! Checksum [n] bytes at [data] using the fastest kernel available on
+  ** this CPU.  A trailing odd byte is padded with zero.  The result is a
+  ** 64-bit partial checksum; reduce it with ci_ip_csum64_fold().
+  */
+extern ci_uint64 ci_ip_csum64(const void* data, size_t n) CI_HF;
+
+  /*! As ci_ip_csum64(), copying from [src] to [dest] at the same time. */
+extern ci_uint64 ci_ip_csum64_copy(void* dest, const void* src,
+                                   size_t n) CI_HF;
+
+#if ! defined(__KERNEL__)
+  /*! Name of the kernel used by ci_ip_csum64().  The kernel is chosen
+  ** according to CPU features on first use.
+  */
+extern const char* ci_ip_csum_engine_name(void) CI_HF;
+
+  /*! Force use of the named kernel ("scalar", "avx2" or "neon").  Returns
+  ** -ENOENT if unknown, or -ENOTSUP if this CPU cannot run it.  Intended
+  ** for benchmarks and tests.
+  */
+extern int ci_ip_csum_engine_select(const char* name) CI_HF;
+#endif
+
+  /*! Reduce a 64-bit partial checksum to 16 bits. */
+ci_inline unsigned ci_ip_csum64_fold(ci_uint64 sum64)
+{
+  sum64 = (sum64 & 0xffffffffu) + (sum64 >> 32u);
+  sum64 = (sum64 & 0xffffffffu) + (sum64 >> 32u);
+  sum64 = (sum64 & 0xffff) + (sum64 >> 16u);
+  return (unsigned) ((sum64 & 0xffff) + (sum64 >> 16u));
+}
+
+  /*! Checksum the [iovlen] buffers in [iov] as if they were one contiguous
+  ** buffer, using ci_ip_csum64(), and reduce it to 16 bits.  The result is
+  ** summed as the data is, so a half-word holding it can stand in for the
+  ** data when checksumming a packet.
+  */
+extern ci_uint16 ci_ip_csum_iov16(const ci_iovec* iov, int iovlen) CI_HF;
+
+
 /****************************************************************************
  * Other functions
  ***************************************************************************/
@@ -21,9 +21,17 @@
  *
  */
 
-/* ARM64 version based on cntvec_el0 counter running at 20MHz as no
- * x86-style FRC available at user-level, but make it look the same to
- * callers
+/* ARM64 version based on the generic timer's virtual count (cntvct_el0),
+ * as no x86-style FRC is available at user-level, but make it look the
+ * same to callers.
+ *
+ * The counter runs at a fixed rate which is much lower than the cpu clock
+ * (typically 25-100MHz, and 1GHz from ARMv8.6).  The PMU cycle counter
+ * would be finer, but it is per-cpu, stops in WFI and is usually not
+ * readable at EL0, so it cannot be shared between the kernel and
+ * user-level views of a stack.  Instead the rate is read directly from
+ * cntfrq_el0, so no measurement is needed and there is no calibration
+ * error.
  */
 
 static __inline__ ci_uint64 __rdtsc(void)
@@ -50,11 +58,35 @@ ci_inline void ci_frc64(ci_uint64* pval)
 
 #define ci_frc_flush()  ci_mb()
 
+/* Rate of the counter read by ci_frc64(), as programmed by firmware. */
+#define CI_HAVE_FRC64_KHZ
+
+ci_inline unsigned ci_frc64_khz(void)
+{
+  ci_uint64 hz;
+  __asm__ __volatile__ ("mrs %0, cntfrq_el0": "=r" (hz));
+  return (unsigned) (hz / 1000);
+}
+
+
+/* NEON is architecturally mandatory on ARMv8-A.  Optional extensions such
+ * as PMULL must still be checked for at runtime with ci_cpu_has_feature().
+ */
+#if ! defined(__KERNEL__)
+#define CI_HAVE_AARCH64_NEON
+#endif
+
 
 
 #define CI_HAVE_COMPARE_AND_SWAP
 
-/* We use gcc builtins for these */
+/* We use gcc builtins for these.  When the compiler targets ARMv8.1 or
+ * later (e.g. -march=armv8.1-a, or -mcpu=neoverse-n1) they compile to the
+ * LSE instructions (CASAL, LDADDAL, SWPA, ...), which scale far better
+ * under contention than LDXR/STXR loops.  We build with
+ * -mno-outline-atomics, so there is no runtime selection: other targets
+ * get LDXR/STXR.
+ */
 
 /* ARM64 TODO this could be optimised by using the __sync_bool... gcc
  * builtin versions where we want a boolean output
@@ -120,6 +152,39 @@ ci_inline int ci_cas64u_fail(volatile ci_uint64* p, ci_uint64 oldval,
 # define ci_cas_uintptr_fail(p,o,n)                     \
   ci_cas64u_fail((volatile ci_uint64*) (p), (o), (n))
 
+/* Compare-and-swap with only acquire (for taking a lock) or release (for
+ * dropping it) ordering.  The plain versions above are full barriers, which
+ * costs an extra DMB on the LDXR/STXR path, and CASAL rather than CASA or
+ * CASL with LSE.
+ */
+#define CI_HAVE_CAS_ACQUIRE_RELEASE
+
+#define __ci_aarch64_cas_ordered(_name, _type, _succ, _fail)            \
+  ci_inline int _name(volatile _type* p, _type oldval, _type newval)    \
+  {                                                                     \
+    return __atomic_compare_exchange_n(p, &oldval, newval, 0,           \
+                                       _succ, _fail);                   \
+  }
+
+__ci_aarch64_cas_ordered(ci_cas32u_succeed_acquire, ci_uint32,
+                         __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)
+__ci_aarch64_cas_ordered(ci_cas32u_succeed_release, ci_uint32,
+                         __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+__ci_aarch64_cas_ordered(ci_cas64u_succeed_acquire, ci_uint64,
+                         __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)
+__ci_aarch64_cas_ordered(ci_cas64u_succeed_release, ci_uint64,
+                         __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+
+#define ci_cas32u_fail_acquire(p,o,n)  (! ci_cas32u_succeed_acquire((p),(o),(n)))
+#define ci_cas32u_fail_release(p,o,n)  (! ci_cas32u_succeed_release((p),(o),(n)))
+#define ci_cas64u_fail_acquire(p,o,n)  (! ci_cas64u_succeed_acquire((p),(o),(n)))
+#define ci_cas64u_fail_release(p,o,n)  (! ci_cas64u_succeed_release((p),(o),(n)))
+
+#define ci_cas_uintptr_succeed_acquire(p,o,n)                   \
+  ci_cas64u_succeed_acquire((volatile ci_uint64*) (p), (o), (n))
+#define ci_cas_uintptr_succeed_release(p,o,n)                   \
+  ci_cas64u_succeed_release((volatile ci_uint64*) (p), (o), (n))
+
 /**********************************************************************
  * Atomic integer.
  */
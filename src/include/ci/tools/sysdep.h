@@ -125,6 +125,24 @@ typedef ci_int32 ci_kerr_t; /* range of OS kernel-mode return codes */
 #endif
 
 
+/* Acquire- and release-ordered compare-and-swap for lock paths.  Platforms
+ * whose atomic read-modify-writes are full barriers anyway (x86) don't
+ * provide these, and get the plain versions.
+ */
+#if defined(CI_HAVE_COMPARE_AND_SWAP) && ! defined(CI_HAVE_CAS_ACQUIRE_RELEASE)
+# define ci_cas32u_succeed_acquire       ci_cas32u_succeed
+# define ci_cas32u_succeed_release       ci_cas32u_succeed
+# define ci_cas32u_fail_acquire          ci_cas32u_fail
+# define ci_cas32u_fail_release          ci_cas32u_fail
+# define ci_cas64u_succeed_acquire       ci_cas64u_succeed
+# define ci_cas64u_succeed_release       ci_cas64u_succeed
+# define ci_cas64u_fail_acquire          ci_cas64u_fail
+# define ci_cas64u_fail_release          ci_cas64u_fail
+# define ci_cas_uintptr_succeed_acquire  ci_cas_uintptr_succeed
+# define ci_cas_uintptr_succeed_release  ci_cas_uintptr_succeed
+#endif
+
+
 #endif  /* __CI_TOOLS_SYSDEP_H__ */
 
 /*! \cidoxg_end */
@@ -579,6 +579,32 @@ int64_t ef_cp_resolve(struct ef_cp_handle *cp, void *ip_hdr,
  * only if EF_CP_RESOLVE_F_NO_ARP was used. */
 #define EF_CP_RESOLVE_S_ARP_INVALID       0x0004
 
+/* Determines the network routes to use for a burst of packets
+ *
+ * Equivalent to calling ef_cp_resolve() for each i in [0, n) with
+ * ip_hdrs[i], &prefix_space[i], &meta[i] and &ver[i], and storing each return
+ * value in rc[i], but cheaper for an application which routes packets in
+ * bursts (e.g. one per event-queue poll). The cached routing information is
+ * checked with a single memory barrier for the whole burst, and consecutive
+ * entries with the same \p ver contents share their checks, so it pays to
+ * group packets for the same destination together.
+ *
+ * Entries which need the slow path (because \p ver is not valid) are
+ * resolved in turn, so with EF_CP_RESOLVE_F_NO_CTXT_SW unset the call may
+ * block once per such entry.
+ *
+ * Returns the number of entries for which rc[i] is not negative.
+ *
+ * Thread-safety: As ef_cp_resolve().
+ *
+ * Performance: As ef_cp_resolve(), less a few tens of nanoseconds per entry
+ * when the routes are cached.
+ */
+size_t ef_cp_resolve_batch(struct ef_cp_handle *cp, void *const *ip_hdrs,
+                           size_t *prefix_space, struct ef_cp_fwd_meta *meta,
+                           struct ef_cp_route_verinfo *ver, int64_t *rc,
+                           size_t n, uint64_t flags);
+
 /* Checks whether the information returned by a previous ef_cp_resolve() has
  * become out of date.
  *
@@ -133,6 +133,7 @@ ci_inline int oo_iobufset_npages(struct oo_buffer_pages *pages)
 #define OO_IOBUFSET_FLAG_HUGE_PAGE_FORCE  0x2 /* EF_USE_HUGE_PAGES=2 */
 #define OO_IOBUFSET_FLAG_HUGE_PAGE_FAILED 0x4
 #endif
+#define OO_IOBUFSET_FLAG_NODE_STRICT      0x8 /* no fallback to other nodes */
 #define OO_IOBUFSET_FLAG_COMPOUND_PAGE_NONE  0x20 /* EF_COMPOUND_PAGES_MODE=2 */
 #define OO_IOBUFSET_FLAG_COMPOUND_SHIFT 4
 #define OO_IOBUFSET_FLAG_COMPOUND_MASK  0x30
@@ -145,6 +146,10 @@ void oo_iobufset_kfree(struct oo_buffer_pages *pages);
  * \param order         page order to allocate
  * \param min_nic_order minimum NIC page order
  * \param flags         see OO_IOBUFSET_FLAG_*, in/out
+ * \param numa_node     node to allocate on, or NUMA_NO_NODE for the local
+ *                      node; not honoured for huge pages.  Other nodes are
+ *                      used if it is short of memory, unless flags has
+ *                      OO_IOBUFSET_FLAG_NODE_STRICT.
  * \param pages_out     pointer to return the allocated pages
  * \param hugetlb_alloc pointer to the allocator, can be NULL
  *
@@ -156,7 +161,7 @@ void oo_iobufset_kfree(struct oo_buffer_pages *pages);
  */
 extern int
 oo_iobufset_pages_alloc(int nic_order, int min_nic_order, int *flags,
-                        struct oo_buffer_pages **pages_out,
+                        int numa_node, struct oo_buffer_pages **pages_out,
                         struct oo_hugetlb_allocator *hugetlb_alloc);
 extern void oo_iobufset_pages_release(struct oo_buffer_pages *);
 
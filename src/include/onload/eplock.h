@@ -47,7 +47,7 @@ __ef_eplock_lock_slow(ci_netif *, long tiemout, int maybe_wedged) CI_HF;
 ci_inline int ef_eplock_trylock(ci_eplock_t* l) {
   ci_uint64 v = l->lock;
   return !(v & CI_EPLOCK_LOCKED) &&
-    ci_cas64u_succeed(&l->lock, v, v | CI_EPLOCK_LOCKED);
+    ci_cas64u_succeed_acquire(&l->lock, v, v | CI_EPLOCK_LOCKED);
 }
 
   /* Always returns 0 (success) at userland.  Returns -EINTR if interrupted
@@ -57,7 +57,7 @@ ci_inline int ef_eplock_trylock(ci_eplock_t* l) {
 ci_inline int ef_eplock_lock(ci_netif *ni) OO_MUST_CHECK_RET_IN_KERNEL;
 ci_inline int ef_eplock_lock(ci_netif *ni) {
   int rc = 0;
-  if( ci_cas64u_fail(&ni->state->lock.lock, 0, CI_EPLOCK_LOCKED) )
+  if( ci_cas64u_fail_acquire(&ni->state->lock.lock, 0, CI_EPLOCK_LOCKED) )
     rc = __ef_eplock_lock_slow(ni, OO_EPLOCK_TIMEOUT_INFTY, 0);
 #ifdef __KERNEL__
   return rc;
@@ -75,7 +75,7 @@ ci_inline int ef_eplock_lock(ci_netif *ni) {
 ci_inline int ef_eplock_lock_maybe_wedged(ci_netif *ni) OO_MUST_CHECK_RET;
 ci_inline int ef_eplock_lock_maybe_wedged(ci_netif *ni) {
   int rc = 0;
-  if( ci_cas64u_fail(&ni->state->lock.lock, 0, CI_EPLOCK_LOCKED) )
+  if( ci_cas64u_fail_acquire(&ni->state->lock.lock, 0, CI_EPLOCK_LOCKED) )
     rc = __ef_eplock_lock_slow(ni, OO_EPLOCK_TIMEOUT_INFTY, 1);
   return rc;
 }
@@ -220,7 +220,7 @@ ci_inline int ef_eplock_try_unlock(ci_eplock_t* l,
   ci_uint64 lv = *lock_val_out = l->lock;
   ci_uint64 unlock = lv &~ (CI_EPLOCK_LOCKED | CI_EPLOCK_FL_NEED_WAKE);
   return (lv & flag_mask) ? 0 :
-    ci_cas64u_succeed(&l->lock, lv, unlock);
+    ci_cas64u_succeed_release(&l->lock, lv, unlock);
 }
 
   /*! Return the flags which are currently set (including need-wakeup).
@@ -90,6 +90,12 @@ struct oo_epoll1_set_home_arg {
   ci_int32              ready_list;  /**< id of ready list to use */
 };
 
+struct oo_epoll1_set_home_slot_arg {
+  ci_fixed_descriptor_t sockfd CI_ALIGN(8); /**< descriptor for fd in stack */
+  ci_int32              ready_list;  /**< id of ready list to use */
+  ci_int32              home;        /**< home slot, < CI_CFG_EPOLL3_MAX_HOMES */
+};
+
 struct oo_epoll1_spin_on_arg {
   ci_uint64     timeout_ns CI_ALIGN(8);
   ci_fixed_descriptor_t epoll_fd;
@@ -163,6 +169,18 @@ enum {
   OO_EPOLL1_OP_INIT,
 #define OO_EPOLL1_IOC_INIT \
   _IO(OO_EPOLL_IOC_BASE, OO_EPOLL1_OP_INIT)
+
+#if CI_CFG_EPOLL3
+  /* As SET_HOME_STACK and REMOVE_HOME_STACK, which act on home slot 0,
+   * for any of the CI_CFG_EPOLL3_MAX_HOMES slots. */
+  OO_EPOLL1_OP_SET_HOME_SLOT,
+#define OO_EPOLL1_IOC_SET_HOME_SLOT \
+  _IOW(OO_EPOLL_IOC_BASE, OO_EPOLL1_OP_SET_HOME_SLOT, \
+       struct oo_epoll1_set_home_slot_arg)
+  OO_EPOLL1_OP_REMOVE_HOME_SLOT,
+#define OO_EPOLL1_IOC_REMOVE_HOME_SLOT \
+  _IOW(OO_EPOLL_IOC_BASE, OO_EPOLL1_OP_REMOVE_HOME_SLOT, ci_int32)
+#endif
 };
 
 #endif /* __ONLOAD_EPOLL_H__ */
@@ -49,6 +49,21 @@ struct tcp_helper_nic {
 };
 
 
+/* Where the stack's work runs relative to its application threads, when
+ * EF_STACK_PLACEMENT is set.  See tcp_helper_placement.c. */
+struct oo_placement {
+  /* CPU on which an application thread last blocked in the stack. */
+  int       app_cpu;
+  /* CPU near which the stack's work items are queued, or WORK_CPU_UNBOUND
+   * if we have no preference. */
+  int       work_cpu;
+  /* CPU asked for when allocating each interface's interrupt, or -1. */
+  int       irq_cpu[CI_CFG_MAX_INTERFACES];
+  /* Number of times the work has moved to follow the application. */
+  unsigned  n_moves;
+};
+
+
 /* Keeps reference to os socket bound to an ephemeral port.
  * This is to allow reuse in multiple stacks.
  *
@@ -199,6 +214,7 @@ typedef struct tcp_helper_resource_s {
 #if ! CI_CFG_UL_INTERRUPT_HELPER
   /* For pinning periodic work */
   int periodic_timer_cpu;
+  struct oo_placement placement;
 
   /* For deferring work to a non-atomic context. */
 #define ONLOAD_WQ_NAME "onload-wq:%s"
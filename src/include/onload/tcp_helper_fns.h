@@ -419,6 +419,35 @@ oo_os_sock_status_bit_clear_handled(tcp_helper_endpoint_t *ep,
 #if ! CI_CFG_UL_INTERRUPT_HELPER
 extern void
 tcp_helper_defer_dl2work(tcp_helper_resource_t* trs, ci_uint32 flag);
+
+/* Placement of the stack's work near its application threads
+ * (EF_STACK_PLACEMENT), in tcp_helper_placement.c. */
+struct efhw_nic;
+extern void tcp_helper_placement_init(tcp_helper_resource_t* trs);
+extern int tcp_helper_placement_irq_cpu(tcp_helper_resource_t* trs,
+                                        int intf_i, struct efhw_nic* nic);
+extern void tcp_helper_placement_update(tcp_helper_resource_t* trs);
+extern int tcp_helper_placement_same_llc(int cpu_a, int cpu_b);
+
+/* Record that an application thread is about to block in [trs] on this
+ * CPU.  Kernel threads do not count. */
+ci_inline void tcp_helper_placement_note_thread(tcp_helper_resource_t* trs)
+{
+  int cpu = raw_smp_processor_id();
+  if( current->mm != NULL && trs->placement.app_cpu != cpu )
+    WRITE_ONCE(trs->placement.app_cpu, cpu);
+}
+
+/* Queue [work] on the stack's workqueue, near its application threads if
+ * EF_STACK_PLACEMENT has chosen a CPU that is still online. */
+ci_inline bool tcp_helper_queue_work(tcp_helper_resource_t* trs,
+                                     struct work_struct* work)
+{
+  int cpu = READ_ONCE(trs->placement.work_cpu);
+  if( cpu != WORK_CPU_UNBOUND && ! cpu_online(cpu) )
+    cpu = WORK_CPU_UNBOUND;
+  return queue_work_on(cpu, trs->wq, work);
+}
 #endif
 
 
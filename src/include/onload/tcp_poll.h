@@ -152,6 +152,7 @@ ci_udp_poll_events(ci_netif* ni, ci_udp_state* us)
 #if CI_CFG_TIMESTAMPING
      ci_udp_recv_q_not_empty(&us->timestamp_q) ||
 #endif
+      ci_udp_txtime_err_pending(us) ||
       (us->s.os_sock_status & OO_OS_STATUS_ERR) ) {
     events |= POLLERR;
     if( us->s.s_aflags & CI_SOCK_AFLAG_SELECT_ERR_QUEUE )
@@ -44,6 +44,10 @@ struct oo_per_thread {
   struct oo_stackname_state  stackname;
   ci_uint64                  poll_nonblock_fast_frc;
   ci_uint64                  select_nonblock_fast_frc;
+  /* EF_LATENCY_HIST: start of the current send call, and this thread's
+   * shard of the RX-to-app histogram plus one (zero until chosen) */
+  ci_uint64                  lat_send_frc;
+  unsigned                   lat_hist_shard;
   struct oo_timesync         timesync;
   unsigned                   spinstate; 
   int                        in_vfork_child;
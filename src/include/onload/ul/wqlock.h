@@ -54,7 +54,7 @@ static inline int oo_wqlock_is_locked(struct oo_wqlock* wql)
 static inline int oo_wqlock_try_lock(struct oo_wqlock* wql)
 {
   return wql->lock == 0 &&
-    ci_cas_uintptr_succeed(&wql->lock, 0, OO_WQLOCK_LOCKED);
+    ci_cas_uintptr_succeed_acquire(&wql->lock, 0, OO_WQLOCK_LOCKED);
 }
 
 
@@ -75,7 +75,7 @@ static inline int oo_wqlock_try_queue(struct oo_wqlock* wql,
 static inline void oo_wqlock_lock(struct oo_wqlock* wql)
 {
   if( wql->lock == 0 &&
-      ci_cas_uintptr_succeed(&wql->lock, 0, OO_WQLOCK_LOCKED) )
+      ci_cas_uintptr_succeed_acquire(&wql->lock, 0, OO_WQLOCK_LOCKED) )
     return;
   oo_wqlock_lock_slow(wql);
 }
@@ -110,7 +110,7 @@ static inline void oo_wqlock_unlock(struct oo_wqlock* wql,
                                     void* unlock_param)
 {
   if( wql->lock == OO_WQLOCK_LOCKED &&
-      ci_cas_uintptr_succeed(&wql->lock, OO_WQLOCK_LOCKED, 0) )
+      ci_cas_uintptr_succeed_release(&wql->lock, OO_WQLOCK_LOCKED, 0) )
     return;
   oo_wqlock_unlock_slow(wql, unlock_param);
 }
@@ -15,6 +15,19 @@
 
 #include "citools_internal.h"
 
+#if defined(__aarch64__) && ! defined(__KERNEL__)
+#include <sys/auxv.h>
+#ifndef HWCAP_ASIMD
+#define HWCAP_ASIMD (1 << 1)
+#endif
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#ifndef HWCAP_ATOMICS
+#define HWCAP_ATOMICS (1 << 8)
+#endif
+#endif
+
 
 /* Test that procesor specific instructions setup during the build match the
    CPU we're running on */
@@ -152,6 +165,37 @@ get_cpuid(int op, int *eax, int *ebx, int *ecx, int *edx)
                         : "a" (op));
 }
 
+ci_inline void
+get_cpuid_count(int op, int count, int *eax, int *ebx, int *ecx, int *edx)
+{
+  __asm__ __volatile__ ("cpuid\n\t"
+                        : "=a" (*eax), "=b" (*ebx), "=c" (*ecx), "=d" (*edx)
+                        : "a" (op), "c" (count));
+}
+
+/* AVX state must be enabled by the OS as well as supported by the CPU */
+static int cpu_has_avx2(int leaf1_ecx)
+{
+  int eax, ebx, ecx, edx;
+  ci_uint32 xcr0_lo, xcr0_hi;
+
+  /* OSXSAVE and AVX */
+  if( (leaf1_ecx & 0x18000000) != 0x18000000 )
+    return 0;
+
+  __asm__ __volatile__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+  /* XMM and YMM state */
+  if( (xcr0_lo & 0x6) != 0x6 )
+    return 0;
+
+  /* Leaf 7 = structured extended feature flags */
+  get_cpuid(0, &eax, &ebx, &ecx, &edx);
+  if( eax < 7 )
+    return 0;
+  get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+  return ebx & 0x00000020;
+}
+
 #else
 
 /*****************************************************************************
@@ -177,9 +221,24 @@ int ci_cpu_has_feature(char* feature)
 
   if( ! strcmp(feature, "pclmul") )
     return ecx & 0x00000002;
+#if defined(__x86_64__)
+  if( ! strcmp(feature, "avx2") )
+    return cpu_has_avx2(ecx);
+#endif
+#elif defined(__aarch64__) && ! defined(__KERNEL__)
+  /* ARM doesn't let us read the ID registers directly from user-level, so
+   * rely on the kernel's view of the CPU instead. */
+  unsigned long hwcap = getauxval(AT_HWCAP);
+
+  if( ! strcmp(feature, "pmull") )
+    return (hwcap & HWCAP_PMULL) != 0;
+  if( ! strcmp(feature, "asimd") )
+    return (hwcap & HWCAP_ASIMD) != 0;
+  if( ! strcmp(feature, "lse") )
+    return (hwcap & HWCAP_ATOMICS) != 0;
 #endif
 
-  /* Not supported on platforms that don't implement the CPUID instruction */
+  /* Unknown feature, or no means of detecting it on this platform */
   return 0;
 }
 
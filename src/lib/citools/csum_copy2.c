@@ -34,6 +34,12 @@ unsigned ci_ip_csum_copy2(void* dest, const void* src, int n, unsigned sum)
   ci_assert(n >= 0);
   ci_assert(CI_OFFSET(n, 2) == 0);
 
+  if( n >= CI_IP_CSUM_ENGINE_MIN_BYTES ) {
+    v = ci_ip_csum64_fold(ci_ip_csum64_copy(dest, src, n));
+    ci_add_carry32(sum, v);
+    return sum;
+  }
+
   es4 = s4 + (n >> 2);
 
   while( s4 != es4 ) {
@@ -41,7 +41,13 @@ int ci_ip_csum_copy_iovec(void* dest, int dest_len, int dest_unalign,
     n = CI_ALIGN_BACK( CI_IOVEC_LEN(&src->io), 2);
     if( n > dest_len ) n = dest_len;
 
-    sum = ci_ip_csum_copy_aligned(dest, CI_IOVEC_BASE(&src->io), n, sum); 
+    /* [n] is odd only if it is the last of [dest_len]: ci_ip_csum_copy2()
+     * takes whole half-words, so pad the final byte separately. */
+    sum = ci_ip_csum_copy2(dest, CI_IOVEC_BASE(&src->io), n & ~1, sum);
+    if( n & 1 )
+      sum = ci_ip_csum_copy_aligned((char*) dest + n - 1,
+                                    (char*) CI_IOVEC_BASE(&src->io) + n - 1,
+                                    1, sum);
     dest_len -= n;
     total += n;
 
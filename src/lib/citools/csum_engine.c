@@ -0,0 +1,385 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/**************************************************************************\
+*//*! \file
+** <L5_PRIVATE L5_SOURCE>
+**  \brief  Bulk Internet checksum with run-time selected SIMD kernels.
+** </L5_PRIVATE>
+*//*
+\**************************************************************************/
+
+/*! \cidoxg_lib_citools */
+
+#include "citools_internal.h"
+
+#if ! defined(__KERNEL__)
+# if defined(CI_HAVE_X86INTRIN)
+#  include <x86intrin.h>
+# elif defined(CI_HAVE_AARCH64_NEON)
+#  include <arm_neon.h>
+# endif
+#endif
+
+
+/* All kernels accumulate native-endian 32-bit words into 64-bit sums.  The
+ * one's-complement sum of the 32-bit words folds down to the same value as
+ * the sum of the 16-bit words, and no carries need to be tracked until the
+ * end.
+ */
+
+/* Handles the final [n] < 32 bytes of a buffer.  A lone final byte is
+ * treated as if it was padded by an extra zero byte. */
+ci_inline ci_uint64 ci_ip_csum64_tail(ci_uint64 sum, const ci_uint8* p,
+                                      size_t n)
+{
+  for( ; n >= 4; n -= 4, p += 4 )
+    sum += *(const ci_uint32*) p;
+  if( n & 2 ) {
+    sum += *(const ci_uint16*) p;
+    p += 2;
+  }
+  if( n & 1 )
+    sum += CI_BSWAP_LE16(*p);
+  return sum;
+}
+
+
+ci_inline ci_uint64 ci_ip_csum64_tail_copy(ci_uint64 sum, ci_uint8* d,
+                                           const ci_uint8* s, size_t n)
+{
+  ci_uint32 v;
+
+  for( ; n >= 4; n -= 4, s += 4, d += 4 ) {
+    *(ci_uint32*) d = v = *(const ci_uint32*) s;
+    sum += v;
+  }
+  if( n & 2 ) {
+    *(ci_uint16*) d = v = *(const ci_uint16*) s;
+    sum += v;
+    s += 2;
+    d += 2;
+  }
+  if( n & 1 ) {
+    *d = *s;
+    sum += CI_BSWAP_LE16(*s);
+  }
+  return sum;
+}
+
+
+/**********************************************************************
+ * Portable scalar kernel
+ */
+
+static ci_uint64 ci_ip_csum64_scalar(const void* data, size_t n)
+{
+  const ci_uint8* p = data;
+  ci_uint64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+  /* Four independent accumulators let the adds overlap. */
+  for( ; n >= 16; n -= 16, p += 16 ) {
+    s0 += ((const ci_uint32*) p)[0];
+    s1 += ((const ci_uint32*) p)[1];
+    s2 += ((const ci_uint32*) p)[2];
+    s3 += ((const ci_uint32*) p)[3];
+  }
+  return ci_ip_csum64_tail(s0 + s1 + s2 + s3, p, n);
+}
+
+
+static ci_uint64 ci_ip_csum64_copy_scalar(void* dest, const void* src,
+                                          size_t n)
+{
+  ci_uint8* d = dest;
+  const ci_uint8* s = src;
+  ci_uint64 s0 = 0, s1 = 0;
+  ci_uint32 v0, v1;
+
+  for( ; n >= 8; n -= 8, s += 8, d += 8 ) {
+    ((ci_uint32*) d)[0] = v0 = ((const ci_uint32*) s)[0];
+    ((ci_uint32*) d)[1] = v1 = ((const ci_uint32*) s)[1];
+    s0 += v0;
+    s1 += v1;
+  }
+  return ci_ip_csum64_tail_copy(s0 + s1, d, s, n);
+}
+
+
+#if ! defined(__KERNEL__)
+
+/**********************************************************************
+ * AVX2 kernel
+ */
+
+#if defined(CI_HAVE_X86INTRIN)
+
+/* Zero-extend each 32-bit lane of [v] to 64 bits and add into [acc_lo] and
+ * [acc_hi]. */
+#define CI_CSUM_AVX2_ACC(acc_lo, acc_hi, v, zero)                       \
+  do {                                                                  \
+    (acc_lo) = _mm256_add_epi64((acc_lo), _mm256_unpacklo_epi32((v), (zero))); \
+    (acc_hi) = _mm256_add_epi64((acc_hi), _mm256_unpackhi_epi32((v), (zero))); \
+  } while( 0 )
+
+
+__attribute__((target("avx2"))) ci_inline ci_uint64
+ci_ip_csum64_avx2_reduce(__m256i acc)
+{
+  __m128i a = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                            _mm256_extracti128_si256(acc, 1));
+  return (ci_uint64) _mm_cvtsi128_si64(a) +
+         (ci_uint64) _mm_extract_epi64(a, 1);
+}
+
+
+__attribute__((target("avx2"))) static ci_uint64
+ci_ip_csum64_avx2(const void* data, size_t n)
+{
+  const ci_uint8* p = data;
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+  __m256i v0, v1;
+
+  for( ; n >= 64; n -= 64, p += 64 ) {
+    v0 = _mm256_loadu_si256((const __m256i*) p);
+    v1 = _mm256_loadu_si256((const __m256i*) (p + 32));
+    CI_CSUM_AVX2_ACC(acc0, acc1, v0, zero);
+    CI_CSUM_AVX2_ACC(acc2, acc3, v1, zero);
+  }
+  if( n >= 32 ) {
+    v0 = _mm256_loadu_si256((const __m256i*) p);
+    CI_CSUM_AVX2_ACC(acc0, acc1, v0, zero);
+    n -= 32;
+    p += 32;
+  }
+
+  acc0 = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1),
+                          _mm256_add_epi64(acc2, acc3));
+  return ci_ip_csum64_tail(ci_ip_csum64_avx2_reduce(acc0), p, n);
+}
+
+
+__attribute__((target("avx2"))) static ci_uint64
+ci_ip_csum64_copy_avx2(void* dest, const void* src, size_t n)
+{
+  ci_uint8* d = dest;
+  const ci_uint8* s = src;
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc0 = zero, acc1 = zero, acc2 = zero, acc3 = zero;
+  __m256i v0, v1;
+
+  for( ; n >= 64; n -= 64, s += 64, d += 64 ) {
+    v0 = _mm256_loadu_si256((const __m256i*) s);
+    v1 = _mm256_loadu_si256((const __m256i*) (s + 32));
+    _mm256_storeu_si256((__m256i*) d, v0);
+    _mm256_storeu_si256((__m256i*) (d + 32), v1);
+    CI_CSUM_AVX2_ACC(acc0, acc1, v0, zero);
+    CI_CSUM_AVX2_ACC(acc2, acc3, v1, zero);
+  }
+  if( n >= 32 ) {
+    v0 = _mm256_loadu_si256((const __m256i*) s);
+    _mm256_storeu_si256((__m256i*) d, v0);
+    CI_CSUM_AVX2_ACC(acc0, acc1, v0, zero);
+    n -= 32;
+    s += 32;
+    d += 32;
+  }
+
+  acc0 = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1),
+                          _mm256_add_epi64(acc2, acc3));
+  return ci_ip_csum64_tail_copy(ci_ip_csum64_avx2_reduce(acc0), d, s, n);
+}
+
+#endif /* CI_HAVE_X86INTRIN */
+
+
+/**********************************************************************
+ * NEON kernel
+ */
+
+#if defined(CI_HAVE_AARCH64_NEON)
+
+/* UADALP does the widening pairwise add-accumulate in one instruction. */
+
+static ci_uint64 ci_ip_csum64_neon(const void* data, size_t n)
+{
+  const ci_uint8* p = data;
+  uint64x2_t acc0 = vdupq_n_u64(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+  for( ; n >= 64; n -= 64, p += 64 ) {
+    acc0 = vpadalq_u32(acc0, vld1q_u32((const uint32_t*) p));
+    acc1 = vpadalq_u32(acc1, vld1q_u32((const uint32_t*) (p + 16)));
+    acc2 = vpadalq_u32(acc2, vld1q_u32((const uint32_t*) (p + 32)));
+    acc3 = vpadalq_u32(acc3, vld1q_u32((const uint32_t*) (p + 48)));
+  }
+  for( ; n >= 16; n -= 16, p += 16 )
+    acc0 = vpadalq_u32(acc0, vld1q_u32((const uint32_t*) p));
+
+  acc0 = vaddq_u64(vaddq_u64(acc0, acc1), vaddq_u64(acc2, acc3));
+  return ci_ip_csum64_tail(vaddvq_u64(acc0), p, n);
+}
+
+
+static ci_uint64 ci_ip_csum64_copy_neon(void* dest, const void* src, size_t n)
+{
+  ci_uint8* d = dest;
+  const ci_uint8* s = src;
+  uint64x2_t acc0 = vdupq_n_u64(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+  uint32x4_t v0, v1, v2, v3;
+
+  for( ; n >= 64; n -= 64, s += 64, d += 64 ) {
+    v0 = vld1q_u32((const uint32_t*) s);
+    v1 = vld1q_u32((const uint32_t*) (s + 16));
+    v2 = vld1q_u32((const uint32_t*) (s + 32));
+    v3 = vld1q_u32((const uint32_t*) (s + 48));
+    vst1q_u32((uint32_t*) d, v0);
+    vst1q_u32((uint32_t*) (d + 16), v1);
+    vst1q_u32((uint32_t*) (d + 32), v2);
+    vst1q_u32((uint32_t*) (d + 48), v3);
+    acc0 = vpadalq_u32(acc0, v0);
+    acc1 = vpadalq_u32(acc1, v1);
+    acc2 = vpadalq_u32(acc2, v2);
+    acc3 = vpadalq_u32(acc3, v3);
+  }
+  for( ; n >= 16; n -= 16, s += 16, d += 16 ) {
+    v0 = vld1q_u32((const uint32_t*) s);
+    vst1q_u32((uint32_t*) d, v0);
+    acc0 = vpadalq_u32(acc0, v0);
+  }
+
+  acc0 = vaddq_u64(vaddq_u64(acc0, acc1), vaddq_u64(acc2, acc3));
+  return ci_ip_csum64_tail_copy(vaddvq_u64(acc0), d, s, n);
+}
+
+#endif /* CI_HAVE_AARCH64_NEON */
+
+
+/**********************************************************************
+ * Engine selection
+ */
+
+struct ci_ip_csum_engine {
+  const char* name;
+  /* Argument to ci_cpu_has_feature(), or NULL if always available */
+  const char* feature;
+  ci_uint64 (*csum)(const void* data, size_t n);
+  ci_uint64 (*csum_copy)(void* dest, const void* src, size_t n);
+};
+
+/* In order of preference */
+static const struct ci_ip_csum_engine ci_ip_csum_engines[] = {
+#if defined(CI_HAVE_X86INTRIN)
+  { "avx2", "avx2", ci_ip_csum64_avx2, ci_ip_csum64_copy_avx2 },
+#endif
+#if defined(CI_HAVE_AARCH64_NEON)
+  { "neon", "asimd", ci_ip_csum64_neon, ci_ip_csum64_copy_neon },
+#endif
+  { "scalar", NULL, ci_ip_csum64_scalar, ci_ip_csum64_copy_scalar },
+};
+
+#define CI_IP_CSUM_N_ENGINES \
+  (sizeof(ci_ip_csum_engines) / sizeof(ci_ip_csum_engines[0]))
+
+static const struct ci_ip_csum_engine* ci_ip_csum_engine;
+
+
+static int ci_ip_csum_engine_usable(const struct ci_ip_csum_engine* e)
+{
+  return e->feature == NULL || ci_cpu_has_feature((char*) e->feature);
+}
+
+
+static const struct ci_ip_csum_engine* ci_ip_csum_engine_init(void)
+{
+  const struct ci_ip_csum_engine* e = ci_ip_csum_engines;
+
+  /* The scalar engine is last and always usable, so this terminates.  Racing
+   * initialisers all pick the same engine. */
+  while( ! ci_ip_csum_engine_usable(e) )
+    ++e;
+  ci_ip_csum_engine = e;
+  return e;
+}
+
+
+ci_inline const struct ci_ip_csum_engine* ci_ip_csum_engine_get(void)
+{
+  const struct ci_ip_csum_engine* e = ci_ip_csum_engine;
+  if(CI_UNLIKELY( e == NULL ))
+    e = ci_ip_csum_engine_init();
+  return e;
+}
+
+
+ci_uint64 ci_ip_csum64(const void* data, size_t n)
+{
+  return ci_ip_csum_engine_get()->csum(data, n);
+}
+
+
+ci_uint64 ci_ip_csum64_copy(void* dest, const void* src, size_t n)
+{
+  return ci_ip_csum_engine_get()->csum_copy(dest, src, n);
+}
+
+
+const char* ci_ip_csum_engine_name(void)
+{
+  return ci_ip_csum_engine_get()->name;
+}
+
+
+int ci_ip_csum_engine_select(const char* name)
+{
+  unsigned i;
+
+  for( i = 0; i < CI_IP_CSUM_N_ENGINES; ++i )
+    if( ! strcmp(ci_ip_csum_engines[i].name, name) ) {
+      if( ! ci_ip_csum_engine_usable(&ci_ip_csum_engines[i]) )
+        return -ENOTSUP;
+      ci_ip_csum_engine = &ci_ip_csum_engines[i];
+      return 0;
+    }
+  return -ENOENT;
+}
+
+#else  /* __KERNEL__ */
+
+/* SIMD state is not available in the kernel without kernel_fpu_begin(), and
+ * the kernel only checksums control packets, so stick to the scalar code. */
+
+ci_uint64 ci_ip_csum64(const void* data, size_t n)
+{
+  return ci_ip_csum64_scalar(data, n);
+}
+
+
+ci_uint64 ci_ip_csum64_copy(void* dest, const void* src, size_t n)
+{
+  return ci_ip_csum64_copy_scalar(dest, src, n);
+}
+
+#endif /* __KERNEL__ */
+
+
+ci_uint16 ci_ip_csum_iov16(const ci_iovec* iov, int iovlen)
+{
+  ci_uint64 sum64 = 0;
+  size_t off = 0;
+  unsigned s;
+  int i;
+
+  for( i = 0; i < iovlen; ++i ) {
+    s = ci_ip_csum64_fold(ci_ip_csum64(CI_IOVEC_BASE(&iov[i]),
+                                       CI_IOVEC_LEN(&iov[i])));
+    /* A buffer that starts at an odd offset has each of its bytes in the
+     * other half of the half-word, which swaps the bytes of its sum. */
+    if( off & 1 )
+      s = ((s & 0xff) << 8) | (s >> 8);
+    sum64 += s;
+    off += CI_IOVEC_LEN(&iov[i]);
+  }
+  return ci_ip_csum64_fold(sum64);
+}
+
+/*! \cidoxg_end */
@@ -20,10 +20,11 @@ unsigned ci_cpu_khz;
 
 /* Throughout the code is the assumption that the value returned by ci_frc64()
  * has the same frequency as the cpu.  However, on aarch64 the only timer we
- * have available for this purpose actually runs at a fixed 20MHz.  That means
- * that although the value returned from this function on arm isn't really
- * the cpu frequency, it is really the value that is desired, which is the
- * ci_frc64() frequency.
+ * have available for this purpose runs at a fixed rate set by firmware.  That
+ * means that although the value returned from this function on arm isn't
+ * really the cpu frequency, it is really the value that is desired, which is
+ * the ci_frc64() frequency.  Where the platform reports that rate
+ * (CI_HAVE_FRC64_KHZ) we use it rather than measuring.
  *
  * Revision history contains an implementation for aarch64 that actually does
  * calculate the cpu frequency.
@@ -34,9 +35,9 @@ unsigned ci_cpu_khz;
 
 /*
  * No CPU frequency is reported in /proc/cpuinfo for ARM64,
- * but this function is never actually called, because
- * ci_measure_cpu_khz should always succeed, as it's calculating
- * a stable timer value.
+ * but this function is never actually called, because the rate
+ * is read from cntfrq_el0, and failing that ci_measure_cpu_khz
+ * should always succeed, as it's calculating a stable timer value.
  */
 ci_inline int try_get_hz(const char* line, unsigned* cpu_khz_out)
 {
@@ -132,6 +133,10 @@ ci_get_cpu_khz(unsigned* cpu_khz_out)
   FILE* f;
   char buf[80];
 
+#ifdef CI_HAVE_FRC64_KHZ
+  if( ! ci_cpu_khz )
+    ci_cpu_khz = ci_frc64_khz();
+#endif
   if( ! ci_cpu_khz ) {
     /* On powerpc /proc/cpuinfo gives reliable information, hence no need to
      * measure.
@@ -25,6 +25,9 @@ unsigned ci_ip_csum_partial(unsigned sum, const volatile void* in_buf,
   ci_assert(in_buf || bytes == 0);
   ci_assert(bytes >= 0);
 
+  if( bytes >= CI_IP_CSUM_ENGINE_MIN_BYTES )
+    return sum + ci_ip_csum64_fold(ci_ip_csum64((const void*) in_buf, bytes));
+
   while( bytes > 1 ) {
     sum += *buf++;
     bytes -= 2;
@@ -32,6 +32,7 @@ LIB_SRCS	:= \
 		pktdump.c \
 		ip_addr.c \
 		csum_copy2.c \
+		csum_engine.c \
 		csum_copy_iovec.c \
 		csum_copy_to_iovec.c \
 		copy_iovec.c \
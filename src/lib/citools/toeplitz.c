@@ -42,6 +42,16 @@ ci_uint32 ci_toeplitz_hash(const ci_uint8 *key, const ci_uint8 *input, int n)
 
 #if !defined(__KERNEL__)
 
+/* Reverse the bits of the low byte of [v]. */
+ci_inline ci_uint32 ci_toeplitz_bitrev8(ci_uint32 v)
+{
+  return ((v * 0x80200802ULL) & 0x0884422110) * 0x0101010101ULL >> 32;
+}
+
+#if defined(CI_CFG_IPV6) && CI_CFG_IPV6
+#define IPV6_TUPLE_SIZE 36
+#endif
+
 #if defined(CI_HAVE_X86INTRIN)
 
 #include <x86intrin.h>
@@ -58,7 +68,7 @@ ci_toeplitz_hash_sse_finish(const ci_uint32 *key, ci_uint32 result)
   result = _mm_extract_epi8(_mm_clmulepi64_si128(vkey, vkey, 0x01), 5);
 
   /* Perform a bit-reversal before returning */
-  return ((result * 0x80200802ULL) & 0x0884422110) * 0x0101010101ULL >> 32;
+  return ci_toeplitz_bitrev8(result);
 }
 
 static ci_uint32
@@ -71,9 +81,6 @@ ci_toeplitz_hash_sse_ip4(const ci_uint32 *key, const ci_uint32 *input, int size)
 }
 
 #if defined(CI_CFG_IPV6) && CI_CFG_IPV6
-
-#define IPV6_TUPLE_SIZE 36
-
 __attribute__((target("pclmul,sse4.1"))) static uint32_t
 ci_toeplitz_hash_sse_ip6(const uint32_t *key, const uint32_t *input, int size)
 {
@@ -89,32 +96,92 @@ ci_toeplitz_hash_sse_ip6(const uint32_t *key, const uint32_t *input, int size)
 }
 #endif
 
-#endif /* CI_HAVE_X86INTRIN */
+#define CI_TOEPLITZ_ACCEL_FEATURE "pclmul"
+#define ci_toeplitz_hash_accel_ip4 ci_toeplitz_hash_sse_ip4
+#define ci_toeplitz_hash_accel_ip6 ci_toeplitz_hash_sse_ip6
 
-ci_uint32 ci_toeplitz_hash_ul(const ci_uint8 *key, const ci_uint8 *sse_key,
-                              const ci_uint8 *input, int size)
+#elif defined(CI_HAVE_AARCH64_NEON)
+
+#include <arm_neon.h>
+
+/* As ci_toeplitz_hash_sse_finish(), using PMULL for the carry-less
+ * multiply.  Key requirements and accuracy are the same.
+ */
+__attribute__((target("+crypto"))) ci_inline ci_uint32
+ci_toeplitz_hash_pmull_finish(const ci_uint32 *key, ci_uint32 result)
 {
-#if defined(CI_HAVE_X86INTRIN)
-  static int pclmul_support = -1;
+  poly128_t prod = vmull_p64((poly64_t) result,
+                             (poly64_t) (((ci_uint64) key[0] << 32) | key[1]));
+
+  result = (ci_uint8) (vgetq_lane_u64(vreinterpretq_u64_p128(prod), 0) >> 40);
+  return ci_toeplitz_bitrev8(result);
+}
+
+__attribute__((target("+crypto"))) static ci_uint32
+ci_toeplitz_hash_pmull_ip4(const ci_uint32 *key, const ci_uint32 *input,
+                           int size)
+{
+  ci_assert_equal(size, 12);
+
+  return ci_toeplitz_hash_pmull_finish(key, input[0] ^ input[1] ^ input[2]);
+}
+
+#if defined(CI_CFG_IPV6) && CI_CFG_IPV6
+__attribute__((target("+crypto"))) static ci_uint32
+ci_toeplitz_hash_pmull_ip6(const ci_uint32 *key, const ci_uint32 *input,
+                           int size)
+{
+  uint32x4_t a;
+  uint32x2_t b;
+
+  ci_assert_equal(size, IPV6_TUPLE_SIZE);
+
+  a = veorq_u32(vld1q_u32(input), vld1q_u32(input + 4));
+  b = veor_u32(vget_low_u32(a), vget_high_u32(a));
+  return ci_toeplitz_hash_pmull_finish(key, vget_lane_u32(b, 0) ^
+                                       vget_lane_u32(b, 1) ^ input[8]);
+}
+#endif
+
+#define CI_TOEPLITZ_ACCEL_FEATURE "pmull"
+#define ci_toeplitz_hash_accel_ip4 ci_toeplitz_hash_pmull_ip4
+#define ci_toeplitz_hash_accel_ip6 ci_toeplitz_hash_pmull_ip6
+
+#endif /* CI_HAVE_AARCH64_NEON */
 
-  if(CI_UNLIKELY( pclmul_support < 0 ))
-    pclmul_support = ci_cpu_has_feature("pclmul");
 
-  if( pclmul_support ) {
+#if defined(CI_TOEPLITZ_ACCEL_FEATURE)
+static int ci_toeplitz_hash_accel_supported(void)
+{
+  static int support = -1;
+
+  if(CI_UNLIKELY( support < 0 ))
+    support = !! ci_cpu_has_feature(CI_TOEPLITZ_ACCEL_FEATURE);
+  return support;
+}
+#endif
+
+
+ci_uint32 ci_toeplitz_hash_ul(const ci_uint8 *key, const ci_uint8 *sse_key,
+                              const ci_uint8 *input, int size)
+{
+#if defined(CI_TOEPLITZ_ACCEL_FEATURE)
+  if( ci_toeplitz_hash_accel_supported() ) {
 #if defined(CI_CFG_IPV6) && CI_CFG_IPV6
     if( size == IPV6_TUPLE_SIZE )
-      return ci_toeplitz_hash_sse_ip6((ci_uint32*) sse_key, (ci_uint32*) input,
-                                      size);
+      return ci_toeplitz_hash_accel_ip6((ci_uint32*) sse_key,
+                                        (ci_uint32*) input, size);
     else
 #endif
-      return ci_toeplitz_hash_sse_ip4((ci_uint32*) sse_key, (ci_uint32*) input,
-                                      size);
+      return ci_toeplitz_hash_accel_ip4((ci_uint32*) sse_key,
+                                        (ci_uint32*) input, size);
   }
   else
-#endif /* CI_HAVE_X86INTRIN */
+#endif
     return ci_toeplitz_hash(key, input, size);
 }
 
+
 #endif /* __KERNEL__ */
 
 /*! \cidoxg_end */
@@ -5,27 +5,10 @@
 #include <netinet/ip.h>
 #include <netinet/ip6.h>
 #include <endian.h>
-#if defined(__x86_64__) || defined(__i386__)
+#ifdef __BMI2__
 #include <immintrin.h>
 #endif
 
-#if !defined(__x86_64__) && !defined(__i386__)
-/* ARM64/other architectures don't have _pdep_u32, provide fallback implementation */
-static inline uint32_t _pdep_u32(uint32_t src, uint32_t mask) {
-  uint32_t result = 0;
-  uint32_t bb = 1;
-  for (uint32_t i = 0; i < 32; i++) {
-    if (mask & (1u << i)) {
-      if (src & bb) {
-        result |= (1u << i);
-      }
-      bb <<= 1;
-    }
-  }
-  return result;
-}
-#endif
-
 #define VLAN_HLEN 4
 
 static unsigned ip_ver(const void *ip_hdr)
@@ -45,6 +28,26 @@ static unsigned swizzle_hashify(uint32_t x, unsigned nports)
   return ((uint64_t)(x * 0xc1c1c1c1) * nports) >> 32;
 }
 
+/* The position (from 1, as for ffs()) of the [n]th set bit (from 0) of
+ * [mask], which must have more than [n] bits set. */
+static inline int nth_set_bit(uint32_t mask, unsigned n)
+{
+#ifdef __BMI2__
+  /* Cunning use of rarely-encountered CPU instructions: the pdep opcode
+   * 'expands out' a dense value in to a sparse set of bits, for example given
+   * an input of 0bABC and a mask of 0b0010'1100 it'll produce 0b00A0'BC00. So
+   * set the nth bit of the input, expand that using the mask, then count the
+   * trailing zeros. 5 cycles latency. */
+  return ffs(_pdep_u32(1u << n, mask));
+#else
+  /* Without pdep, drop the lowest set bit n times. n is less than the number
+   * of ports in the bond, so this is a handful of iterations at most. */
+  while( n-- )
+    mask &= mask - 1;
+  return ffs(mask);
+#endif
+}
+
 static int bond_hash_route(struct ef_cp_handle *cp, const void *ip_hdr,
                            const struct cp_fwd_data *data,
                            cicp_hwport_mask_t hwports)
@@ -95,17 +98,12 @@ static int bond_hash_route(struct ef_cp_handle *cp, const void *ip_hdr,
   }
   index = swizzle_hashify(hash_input, nports);
   assert(index < nports);
-  /* Cunning use of rarely-encountered CPU instructions: we have an input mask
-   * of (e.g.) 0b0010'1100, nports will be 3 (using the popcount opcode). We
-   * generate a number in [0,3) by multiplying a well-distributed 32-bit hash
-   * value by 3 and taking the top 32-bits.
+  /* We have an input mask of (e.g.) 0b0010'1100, nports will be 3 (using the
+   * popcount opcode). We generate a number in [0,3) by multiplying a
+   * well-distributed 32-bit hash value by 3 and taking the top 32-bits.
    * So given a value in [0,3) we need to find the index of the nth set bit of
-   * that original hwports mask. The pdep opcode is exactly what we want: it
-   * 'expands out' a dense value in to a sparse set of bits, for example given
-   * an input of 0bABC and a mask of 0b0010'1100 it'll produce 0b00A0'BC00. The
-   * way to use this then becomes clear: set the nth bit of the input, expand
-   * that using the mask, then count the trailing zeros. 5 cycles latency. */
-  hwport = ffs(_pdep_u32(1 << index, hwports));
+   * that original hwports mask. */
+  hwport = nth_set_bit(hwports, index);
   return cp->hwport_ifindex[hwport];
 }
 
@@ -224,6 +222,34 @@ static struct cp_fwd_key build_key(const void *ip_hdr,
   return key;
 }
 
+/* Route [ip_hdr] by asking the cplane, which may in turn ask the kernel. */
+static int64_t resolve_slow(struct ef_cp_handle *cp, void *ip_hdr,
+                            size_t *prefix_space, struct ef_cp_fwd_meta *meta,
+                            struct ef_cp_route_verinfo *ver, uint64_t flags)
+{
+  /* The fwd-table ID is meaningless at UL, but we have to pass something. */
+  const cp_fwd_table_id fwd_table_id = CP_FWD_TABLE_ID_INVALID;
+  cicp_verinfo_t *verinfo = (cicp_verinfo_t*)ver;
+  struct cp_fwd_key key = build_key(ip_hdr, meta, flags);
+  struct cp_fwd_data data;
+  int64_t rc;
+
+  rc = __oo_cp_route_resolve(&cp->cp, verinfo, &key,
+                             (flags & EF_CP_RESOLVE_F_NO_CTXT_SW) == 0,
+                             &data, fwd_table_id);
+  if( rc >= 0 ) {
+    /* verinfo::generation is intended to be used to support cplane server
+     * restarts. That's not currently implemented, but we still use it to
+     * allow a zero-initialized verinfo to be classed as invalid (thus making
+     * the API harder to misuse). */
+    ver->generation = 1;
+    rc = apply_fwd_result(cp, ip_hdr, prefix_space, meta, &data, flags);
+  }
+  if( rc < 0 )
+    ver->generation = 0;
+  return rc;
+}
+
 EF_CP_PUBLIC_API
 int64_t ef_cp_resolve(struct ef_cp_handle *cp, void *ip_hdr,
                       size_t *prefix_space, struct ef_cp_fwd_meta *meta,
@@ -259,25 +285,98 @@ int64_t ef_cp_resolve(struct ef_cp_handle *cp, void *ip_hdr,
   }
 
   /* We are unlucky. Let's go via slow path. */
-  {
-    struct cp_fwd_key key = build_key(ip_hdr, meta, flags);
-    struct cp_fwd_data data;
+  return resolve_slow(cp, ip_hdr, prefix_space, meta, ver, flags);
+}
+
+/* ef_cp_resolve_batch() works on this many entries at a time, so that what
+ * it must remember between the optimistic pass and the version checks fits
+ * on the stack. */
+#define RESOLVE_BATCH_CHUNK 64
+
+static size_t resolve_chunk(struct ef_cp_handle *cp, void *const *ip_hdrs,
+                            size_t *prefix_space, struct ef_cp_fwd_meta *meta,
+                            struct ef_cp_route_verinfo *ver, int64_t *rc,
+                            size_t n, uint64_t flags)
+{
+  const cp_fwd_table_id fwd_table_id = CP_FWD_TABLE_ID_INVALID;
+  struct cp_mibs *mib = &cp->cp.mib[0];
+  size_t space_in[RESOLVE_BATCH_CHUNK];
+  int ifindex_in[RESOLVE_BATCH_CHUNK];
+  bool fast[RESOLVE_BATCH_CHUNK];
+  const cicp_verinfo_t *last = NULL;
+  uint64_t now = 0;
+  size_t i, n_ok = 0;
+
+  /* Optimistic pass: apply the cached result for each entry whose verinfo
+   * looks valid.  A burst typically holds runs of packets for the same
+   * route, so an entry with the same row and version as the last valid one
+   * needs no check of its own, and frc_used is written once per run. */
+  for( i = 0; i < n; ++i ) {
+    cicp_verinfo_t *verinfo = (cicp_verinfo_t*)&ver[i];
 
-    rc = __oo_cp_route_resolve(&cp->cp, verinfo, &key,
-                               (flags & EF_CP_RESOLVE_F_NO_CTXT_SW) == 0,
-                               &data, fwd_table_id);
-    if( rc >= 0 ) {
-      /* verinfo::generation is intended to be used to support cplane server
-       * restarts. That's not currently implemented, but we still use it to
-       * allow a zero-initialized verinfo to be classed as invalid (thus making
-       * the API harder to misuse). */
-      ver->generation = 1;
-      rc = apply_fwd_result(cp, ip_hdr, prefix_space, meta, &data, flags);
+    assert(prefix_space[i] >= ETH_HLEN);
+    assert(ip_ver(ip_hdrs[i]) == 4 || ip_ver(ip_hdrs[i]) == 6);
+    space_in[i] = prefix_space[i];
+    ifindex_in[i] = meta[i].ifindex;
+    fast[i] = false;
+    if( ver[i].generation == 0 )
+      continue;
+    if( last == NULL || verinfo->id != last->id ||
+        verinfo->version != last->version ) {
+      if( ! oo_cp_verinfo_is_valid(&cp->cp, verinfo, fwd_table_id) )
+        continue;
+      if( last == NULL )
+        now = ci_frc64_get();
+      cp_get_fwd_rw(&mib->fwd_table, verinfo)->frc_used = now;
+      last = verinfo;
     }
-    if( rc < 0 )
-      ver->generation = 0;
-    return rc;
+    rc[i] = apply_fwd_result(cp, ip_hdrs[i], &prefix_space[i], &meta[i],
+                             cp_get_fwd_data(&mib->fwd_table, verinfo),
+                             flags);
+    fast[i] = true;
+  }
+
+  /* One barrier for the whole chunk, then confirm that no row we read from
+   * changed under us.  Anything that did, or that had no valid verinfo,
+   * goes via the slow path with its inputs restored. */
+  ci_rmb();
+  last = NULL;
+  for( i = 0; i < n; ++i ) {
+    cicp_verinfo_t *verinfo = (cicp_verinfo_t*)&ver[i];
+
+    if( fast[i] &&
+        ((last != NULL && verinfo->id == last->id &&
+          verinfo->version == last->version) ||
+         cp_fwd_version_matches(&mib->fwd_table, verinfo)) ) {
+      last = verinfo;
+      if( rc[i] < 0 )
+        ver[i].generation = 0;
+    }
+    else {
+      prefix_space[i] = space_in[i];
+      meta[i].ifindex = ifindex_in[i];
+      rc[i] = resolve_slow(cp, ip_hdrs[i], &prefix_space[i], &meta[i],
+                           &ver[i], flags);
+    }
+    n_ok += rc[i] >= 0;
+  }
+  return n_ok;
+}
+
+EF_CP_PUBLIC_API
+size_t ef_cp_resolve_batch(struct ef_cp_handle *cp, void *const *ip_hdrs,
+                           size_t *prefix_space, struct ef_cp_fwd_meta *meta,
+                           struct ef_cp_route_verinfo *ver, int64_t *rc,
+                           size_t n, uint64_t flags)
+{
+  size_t i, n_ok = 0;
+
+  for( i = 0; i < n; i += RESOLVE_BATCH_CHUNK ) {
+    size_t len = n - i < RESOLVE_BATCH_CHUNK ? n - i : RESOLVE_BATCH_CHUNK;
+    n_ok += resolve_chunk(cp, ip_hdrs + i, prefix_space + i, meta + i,
+                          ver + i, rc + i, len, flags);
   }
+  return n_ok;
 }
 
 EF_CP_PUBLIC_API
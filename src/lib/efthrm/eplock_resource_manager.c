@@ -171,6 +171,9 @@ efab_eplock_lock_wait(ci_netif* ni, int maybe_wedged)
 #if CI_CFG_EFAB_EPLOCK_RECORD_CONTENTIONS
   efab_eplock_record_pid(ni);
 #endif
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+  tcp_helper_placement_note_thread(netif2tcp_helper_resource(ni));
+#endif
 
   init_waitqueue_entry(&wait, current);
   add_wait_queue(&ni->eplock_helper.wq, &wait);
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* X-SPDX-Copyright-Text: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Placement of a stack's work near the application threads that use it
+ * (EF_STACK_PLACEMENT).
+ *
+ * Every wakeup of a blocked thread, and every run of the stack's periodic
+ * timer or deferred work, touches the same socket and stack state as the
+ * application.  If that work runs on the far side of a last-level cache
+ * boundary, the state bounces between caches each time.
+ *
+ * We note the CPU on which an application thread last blocked in the stack
+ * (tcp_helper_placement_note_thread()), and choose a CPU that shares a
+ * last-level cache with it for:
+ *
+ * - the interrupt of each interface, when its VI is allocated, unless the
+ *   application is on a different NUMA node from the NIC, in which case
+ *   the interrupt stays on the NIC's node with its event queue and packet
+ *   buffers;
+ * - the stack's periodic timer and deferred work.  The stack's workqueue
+ *   is per-CPU rather than unbound in this mode, so that queueing work on
+ *   a CPU runs it there.
+ *
+ * The periodic timer calls tcp_helper_placement_update(), which moves the
+ * work if the application has moved to a different cache.  Interrupts are
+ * fixed once the VI exists, so for those we can only report that they have
+ * been left behind, in /proc/driver/onload/placement.
+ */
+
+#include <ci/internal/transport_config_opt.h>
+
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+#include <onload/tcp_helper_fns.h>
+#include <onload/debug.h>
+#include <ci/efhw/nic.h>
+#include <linux/topology.h>
+#ifdef EFRM_HAVE_CPU_TOPOLOGY_LLC_SIBLING
+#include <linux/arch_topology.h>
+#endif
+
+
+/* CPUs that share a last-level cache with [cpu].  x86 keeps this mask
+ * itself, but not every kernel exports it to modules.  Architectures using
+ * the generic topology code (arm64, riscv) build it from the firmware's
+ * cache description; if that was missing the mask is empty.  Failing
+ * those, we assume that the package shares a cache. */
+static const struct cpumask* oo_cpu_llc_mask(int cpu)
+{
+#if defined(CONFIG_X86) && defined(EFRM_HAVE_CPU_LLC_SHARED_MAP)
+  return cpu_llc_shared_mask(cpu);
+#else
+# if ! defined(CONFIG_X86) && defined(EFRM_HAVE_CPU_TOPOLOGY_LLC_SIBLING)
+  if( ! cpumask_empty(&cpu_topology[cpu].llc_sibling) )
+    return &cpu_topology[cpu].llc_sibling;
+# endif
+  return topology_core_cpumask(cpu);
+#endif
+}
+
+
+int tcp_helper_placement_same_llc(int cpu_a, int cpu_b)
+{
+  if( cpu_a < 0 || cpu_a >= nr_cpu_ids || cpu_b < 0 || cpu_b >= nr_cpu_ids )
+    return 0;
+  return cpumask_test_cpu(cpu_b, oo_cpu_llc_mask(cpu_a));
+}
+
+
+/* An online CPU in the same last-level cache as [app_cpu], other than
+ * [app_cpu] itself if there is one, so that our work does not preempt the
+ * application. */
+static int tcp_helper_placement_pick(int app_cpu)
+{
+  int cpu;
+
+  for_each_cpu_and(cpu, oo_cpu_llc_mask(app_cpu), cpu_online_mask)
+    if( cpu != app_cpu )
+      return cpu;
+  return app_cpu;
+}
+
+
+/* NUMA node of [nic], or NUMA_NO_NODE if not known. */
+static int tcp_helper_placement_nic_node(struct efhw_nic* nic)
+{
+  struct net_device* net_dev = efhw_nic_get_net_dev(nic);
+  int node = NUMA_NO_NODE;
+
+  if( net_dev != NULL ) {
+    if( net_dev->dev.parent != NULL )
+      node = dev_to_node(net_dev->dev.parent);
+    dev_put(net_dev);
+  }
+  return node;
+}
+
+
+void tcp_helper_placement_init(tcp_helper_resource_t* trs)
+{
+  struct oo_placement* pl = &trs->placement;
+  int intf_i;
+
+  pl->app_cpu = raw_smp_processor_id();
+  pl->work_cpu = WORK_CPU_UNBOUND;
+  for( intf_i = 0; intf_i < CI_CFG_MAX_INTERFACES; ++intf_i )
+    pl->irq_cpu[intf_i] = -1;
+  pl->n_moves = 0;
+}
+
+
+/* The CPU to ask for when allocating the interrupt of interface [intf_i]
+ * on [nic].  The caller has already checked that EF_IRQ_CORE and
+ * EF_IRQ_CHANNEL are not set. */
+int tcp_helper_placement_irq_cpu(tcp_helper_resource_t* trs, int intf_i,
+                                 struct efhw_nic* nic)
+{
+  int cpu = raw_smp_processor_id();
+  int node, nic_cpu;
+
+  if( ! NI_OPTS(&trs->netif).stack_placement )
+    return cpu;
+
+  node = tcp_helper_placement_nic_node(nic);
+  if( node == NUMA_NO_NODE || cpu_to_node(cpu) == node )
+    cpu = tcp_helper_placement_pick(cpu);
+  else if( (nic_cpu = cpumask_any_and(cpumask_of_node(node),
+                                      cpu_online_mask)) < nr_cpu_ids )
+    cpu = nic_cpu;
+  else
+    cpu = tcp_helper_placement_pick(cpu);
+  trs->placement.irq_cpu[intf_i] = cpu;
+  return cpu;
+}
+
+
+/* Called from the periodic timer.  If the application has moved to a
+ * different last-level cache from our work, move the work to follow it. */
+void tcp_helper_placement_update(tcp_helper_resource_t* trs)
+{
+  struct oo_placement* pl = &trs->placement;
+  ci_netif* ni = &trs->netif;
+  int app_cpu = READ_ONCE(pl->app_cpu);
+  int cpu;
+
+  if( ! NI_OPTS(ni).stack_placement || NI_OPTS(ni).periodic_timer_cpu >= 0 )
+    return;
+  if( app_cpu < 0 || app_cpu >= nr_cpu_ids || ! cpu_online(app_cpu) )
+    return;
+  if( pl->work_cpu != WORK_CPU_UNBOUND &&
+      tcp_helper_placement_same_llc(app_cpu, pl->work_cpu) )
+    return;
+
+  cpu = tcp_helper_placement_pick(app_cpu);
+  OO_DEBUG_TCPH(ci_log("%s: [%d] application on CPU %d, work moves from %d "
+                       "to %d", __FUNCTION__, trs->id, app_cpu,
+                       pl->work_cpu, cpu));
+  WRITE_ONCE(pl->work_cpu, cpu);
+  trs->periodic_timer_cpu = cpu;
+  ++pl->n_moves;
+}
+
+#endif /* ! CI_CFG_UL_INTERRUPT_HELPER */
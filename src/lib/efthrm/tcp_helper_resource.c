@@ -1395,7 +1395,13 @@ get_vi_settings(ci_netif* ni, struct efhw_nic* nic,
   info->log_resource_warnings = NI_OPTS(ni).log_category &
                               (1 << (EF_LOG_RESOURCE_WARNINGS));
   if( NI_OPTS(ni).irq_core < 0 && NI_OPTS(ni).irq_channel < 0 ) {
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+    info->wakeup_cpu_core =
+      tcp_helper_placement_irq_cpu(netif2tcp_helper_resource(ni),
+                                   info->intf_i, nic);
+#else
     info->wakeup_cpu_core = raw_smp_processor_id();
+#endif
     info->log_resource_warnings = 0;
   }
   /* Enable RX merge if we've requested it, or we don't support cut-through */
@@ -1688,6 +1694,9 @@ static int allocate_vi(ci_netif* ni, struct vi_allocate_info* info)
       info_base.wakeup_cpu_core = NI_OPTS(ni).irq_core;
       info_base.log_resource_warnings = NI_OPTS(ni).log_category &
                                         (1 << (EF_LOG_RESOURCE_WARNINGS));
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+      netif2tcp_helper_resource(ni)->placement.irq_cpu[info->intf_i] = -1;
+#endif
       /* Fake out the loop counter to give us one more shot. */
       ++feature_mask;
     }
@@ -1996,6 +2005,7 @@ static int allocate_vis(tcp_helper_resource_t* trs,
 #endif
     dev = efrm_vi_get_dev(vi_rs);
     strncpy(nsn->dev_name, dev ? dev_name(dev) : "?", sizeof(nsn->dev_name));
+    nsn->numa_node = dev ? dev_to_node(dev) : NUMA_NO_NODE;
     if( dev )
       put_device(dev);
     nsn->dev_name[sizeof(nsn->dev_name) - 1] = '\0';
@@ -2497,6 +2507,10 @@ allocate_netif_resources(ci_resource_onload_alloc_t* alloc,
   sz += sizeof(ci_tcp_prev_seq_t) * no_seq_table_entries;
   sz = CI_ROUND_UP(sz, __alignof__(struct oo_deferred_pkt));
   sz += sizeof(struct oo_deferred_pkt) * NI_OPTS(ni).defer_arp_pkts;
+#if CI_CFG_TCPDUMP
+  sz = CI_ROUND_UP(sz, __alignof__(oo_pkt_p));
+  sz += sizeof(oo_pkt_p) * NI_OPTS(ni).tcpdump_ring;
+#endif
   sz = CI_ROUND_UP(sz, __alignof__(ci_netif_filter_table));
   sz += filter_table_size;
   sz = CI_ROUND_UP(sz, __alignof__(ci_netif_filter_table_entry_ext));
@@ -2614,6 +2628,12 @@ allocate_netif_resources(ci_resource_onload_alloc_t* alloc,
   ns->deferred_pkts_ofs = ns_ofs;
   ns_ofs += sizeof(struct oo_deferred_pkt) * NI_OPTS(ni).defer_arp_pkts;
 
+#if CI_CFG_TCPDUMP
+  ns_ofs = CI_ROUND_UP(ns_ofs, __alignof__(oo_pkt_p));
+  ns->dump_queue_ofs = ns_ofs;
+  ns_ofs += sizeof(oo_pkt_p) * NI_OPTS(ni).tcpdump_ring;
+#endif
+
   ns_ofs = CI_ROUND_UP(ns_ofs, __alignof__(ci_netif_filter_table));
   ns->table_ofs = ns_ofs;
   ns_ofs += filter_table_size;
@@ -2651,6 +2671,9 @@ allocate_netif_resources(ci_resource_onload_alloc_t* alloc,
 #endif
   ni->seq_table = (void*) ((char*) ns + ns->seq_table_ofs);
   ni->deferred_pkts = (void*) ((char*) ns + ns->deferred_pkts_ofs);
+#if CI_CFG_TCPDUMP
+  ni->dump_queue = (void*) ((char*) ns + ns->dump_queue_ofs);
+#endif
   ni->filter_table = (void*) ((char*) ns + ns->table_ofs);
   ni->filter_table_ext = (void*) ((char*) ns + ns->table_ext_ofs);
 
@@ -2673,6 +2696,8 @@ allocate_netif_resources(ci_resource_onload_alloc_t* alloc,
   ni->packets->sets_max = ni->pkt_sets_max;
   ni->packets->sets_n = 0;
   ni->packets->n_pkts_allocated = 0;
+  ni->packets->alloc_node = -1;
+  ni->packets->alloc_node_time = 0;
 
   /* Initialize the free list of synrecv/aux bufs */
   oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &ni->state->free_aux_mem));
@@ -3287,7 +3312,7 @@ tcp_helper_defer_dl2work(tcp_helper_resource_t* trs, ci_uint32 flag)
    * ci_atomic32_or+ci_wmb do not create any additional barrier in the
    * asm code.  But this barrier is really needed on ppc. */
   ci_wmb();
-  queue_work(trs->wq, &trs->non_atomic_work);
+  tcp_helper_queue_work(trs, &trs->non_atomic_work);
 }
 
 static void
@@ -3414,7 +3439,7 @@ void tcp_helper_endpoint_queue_non_atomic(tcp_helper_endpoint_t* ep,
   prev_aflags = tcp_helper_endpoint_set_aflags(ep, why_aflag);
   if( ! (prev_aflags & OO_THR_EP_AFLAG_NON_ATOMIC) ) {
     ci_sllist_push(&ep->thr->non_atomic_list, &ep->non_atomic_link);
-    queue_work(ep->thr->wq, &ep->thr->non_atomic_work);
+    tcp_helper_queue_work(ep->thr, &ep->thr->non_atomic_work);
   }
   ci_irqlock_unlock(&ep->thr->lock, &lock_flags);
 }
@@ -4494,6 +4519,9 @@ int tcp_helper_rm_alloc(ci_resource_onload_alloc_t* alloc,
 #endif
   strcpy(rs->name, alloc->in_name);
   generate_efct_filter_irqmask(&rs->filter_irqmask);
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+  tcp_helper_placement_init(rs);
+#endif
 
   spin_lock_init(&ni->swf_update_lock);
   ni->swf_update_last =  ni->swf_update_first = NULL;
@@ -4555,10 +4583,12 @@ int tcp_helper_rm_alloc(ci_resource_onload_alloc_t* alloc,
    * Users want to set cpu affinity => WQ_SYSFS
    * Long running CPU intensive workloads which can be better
    * managed by the system scheduler => WQ_UNBOUND
+   * EF_STACK_PLACEMENT picks the CPU for each work item, which an unbound
+   * workqueue would only use to choose a NUMA node => not WQ_UNBOUND
    */
   rs->wq = alloc_workqueue(rs->wq_name,
-                           WQ_UNBOUND | WQ_CPU_INTENSIVE |
-                           WQ_HIGHPRI | WQ_SYSFS, 0);
+                           (NI_OPTS(ni).stack_placement ? 0 : WQ_UNBOUND) |
+                           WQ_CPU_INTENSIVE | WQ_HIGHPRI | WQ_SYSFS, 0);
   if( rs->wq == NULL ) {
     OO_DEBUG_ERR(ci_log("%s: [%d] Failed to allocate stack due to workqueue "
                         "allocation failure", __func__, NI_ID(ni)));
@@ -5002,8 +5032,10 @@ static inline int thr_queue_delayed_work(tcp_helper_resource_t* thr,
                                          struct delayed_work *dwork,
                                          unsigned long delay)
 {
-  return queue_delayed_work_on(thr->periodic_timer_cpu, thr->wq,
-                               dwork, delay);
+  int cpu = thr->periodic_timer_cpu;
+  if( cpu != WORK_CPU_UNBOUND && ! cpu_online(cpu) )
+    cpu = WORK_CPU_UNBOUND;
+  return queue_delayed_work_on(cpu, thr->wq, dwork, delay);
 }
 #endif
 
@@ -6346,6 +6378,63 @@ efab_tcp_helper_min_nics_order(tcp_helper_resource_t* trs)
 }
 
 
+static int efab_tcp_helper_valid_numa_node(int node)
+{
+  return node >= 0 && node < nr_node_ids && node_online(node);
+}
+
+
+/* Whether some packet set has enough free buffers to refill an RX ring. */
+static int efab_tcp_helper_has_rx_set(ci_netif* ni)
+{
+  int i;
+
+  for( i = 0; i < ni->pkt_sets_n; ++i )
+    if( ni->packets->set[i].n_free >= CI_CFG_RX_DESC_BATCH )
+      return 1;
+  return 0;
+}
+
+
+/* Choose the NUMA node for a new packet set: the node that the stack asked
+ * for, if any, or else the node of one of the stack's NICs that has the
+ * fewest packet sets so far.  NUMA_NO_NODE means the local node.
+ *
+ * The stack asks for a node both when RX refill is using a set elsewhere
+ * and when it has run out of buffers.  Only in the first case is a set on
+ * some other node of no use, and then [*strict] is set.
+ */
+static int efab_tcp_helper_pktset_node(tcp_helper_resource_t* trs,
+                                       int* strict)
+{
+  ci_netif* ni = &trs->netif;
+  int node = READ_ONCE(ni->packets->alloc_node);
+  int best = NUMA_NO_NODE, best_n = INT_MAX;
+  int intf_i, i, n;
+
+  ni->packets->alloc_node = -1;
+  *strict = 0;
+  if( efab_tcp_helper_valid_numa_node(node) ) {
+    *strict = efab_tcp_helper_has_rx_set(ni);
+    return node;
+  }
+
+  OO_STACK_FOR_EACH_INTF_I(ni, intf_i) {
+    node = ni->state->nic[intf_i].numa_node;
+    if( ! efab_tcp_helper_valid_numa_node(node) )
+      continue;
+    n = 0;
+    for( i = 0; i < ni->pkt_sets_n; ++i )
+      n += ni->packets->set[i].numa_node == node;
+    if( n < best_n ) {
+      best = node;
+      best_n = n;
+    }
+  }
+  return best;
+}
+
+
 static int
 efab_tcp_helper_iobufset_alloc(tcp_helper_resource_t* trs,
                                struct oo_iobufset** all_out,
@@ -6356,7 +6445,7 @@ efab_tcp_helper_iobufset_alloc(tcp_helper_resource_t* trs,
   ci_netif* ni = &trs->netif;
   int rc, intf_i;
   struct oo_buffer_pages *pages;
-  int flags;
+  int flags, node, strict;
   int min_nics_order = efab_tcp_helper_min_nics_order(trs);
 
   OO_STACK_FOR_EACH_INTF_I(ni, intf_i)
@@ -6396,8 +6485,11 @@ efab_tcp_helper_iobufset_alloc(tcp_helper_resource_t* trs,
 #endif
   }
 #endif
+  node = efab_tcp_helper_pktset_node(trs, &strict);
+  if( strict )
+    flags |= OO_IOBUFSET_FLAG_NODE_STRICT;
   rc = oo_iobufset_pages_alloc(HW_PAGES_PER_SET_S, min_nics_order, &flags,
-                               &pages, trs->thc_pktbuf_alloc);
+                               node, &pages, trs->thc_pktbuf_alloc);
   if( rc != 0 )
     return rc;
 #if CI_CFG_PKTS_AS_HUGE_PAGES
@@ -6433,7 +6525,7 @@ efab_tcp_helper_more_bufs(tcp_helper_resource_t* trs)
   uint64_t *hw_addrs;
   ci_irqlock_state_t lock_flags;
   ci_netif* ni = &trs->netif;
-  int i, rc, bufset_id, intf_i, page_order = 0;
+  int i, rc, bufset_id, intf_i, numa_node, page_order = 0;
 
   ci_assert(ci_netif_is_locked(ni));
 
@@ -6537,6 +6629,10 @@ efab_tcp_helper_more_bufs(tcp_helper_resource_t* trs)
   else
     page_order += ci_log2_ge(PAGE_SIZE / CI_CFG_PKT_BUF_SIZE, 0);
   ni->packets->set[bufset_id].page_order = page_order;
+  /* Huge pages come from wherever the hugetlb allocator found them, so
+   * record where the buffers actually are rather than where we asked. */
+  numa_node = page_to_nid(pages->pages[0]);
+  ni->packets->set[bufset_id].numa_node = numa_node;
   ni->dma_addr_next += (PKTS_PER_SET >> page_order) * CI_CFG_MAX_INTERFACES;
   ni->packets->n_free += PKTS_PER_SET;
 
@@ -6564,7 +6660,8 @@ efab_tcp_helper_more_bufs(tcp_helper_resource_t* trs)
   }
   ci_vfree(hw_addrs);
 
-  trs->netif.state->packet_alloc_numa_nodes |= 1 << numa_node_id();
+  if( numa_node < 32 )
+    trs->netif.state->packet_alloc_numa_nodes |= 1u << numa_node;
   CHECK_FREEPKTS(ni);
   return 0;
 }
@@ -7065,6 +7162,7 @@ linux_tcp_timer_do(tcp_helper_resource_t* rs, unsigned long* next_timer)
   OO_DEBUG_VERB(ci_log("%s: running", __FUNCTION__));
 
   oo_timesync_update(efab_tcp_driver.timesync);
+  tcp_helper_placement_update(rs);
 
   /* Avoid interfering if stack has been active recently.  This code path
    * is only for handling time-related events that have not been handled in
@@ -8233,7 +8331,7 @@ void oo_inject_packets_kernel(tcp_helper_resource_t* trs, int sync)
   }
   else {
     /* Push data to kernel without holding the stack lock */
-    queue_work(trs->wq, &data->work);
+    tcp_helper_queue_work(trs, &data->work);
   }
 }
 #endif /* CI_CFG_INJECT_PACKETS */
@@ -122,6 +122,9 @@ efab_tcp_helper_sock_sleep(tcp_helper_resource_t* trs,
   }
 
   ci_waitable_init_timeout_from_ms(&timeout, op->timeout_ms);
+#if ! CI_CFG_UL_INTERRUPT_HELPER
+  tcp_helper_placement_note_thread(trs);
+#endif
 
   if( ! ci_netif_is_spinner(ni) ) {
     CITP_STATS_NETIF(++trs->netif.state->stats.sock_sleep_primes);
@@ -1837,6 +1837,17 @@ int ci_set_sol_socket(ci_netif* netif, ci_sock_cmn* s,
     break;
 #endif
 
+#ifdef SO_ZEROCOPY
+  case SO_ZEROCOPY:
+    /* Not supported.  Sends always copy the payload into packet buffers, as
+     * there is no way to DMA from arbitrary unregistered user pages, so we
+     * fail as kernels without SO_ZEROCOPY do.  Applications then fall back
+     * to ordinary sends.  Zero-copy TX is available through onload_zc_send()
+     * with buffers registered up front.
+     */
+    goto fail_noopt;
+#endif
+
   default:
     /* SOL_SOCKET options that are defined to fail with ENOPROTOOPT:
      *  SO_TYPE,  CI_SOSNDLOWAT,
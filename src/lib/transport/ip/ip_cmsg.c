@@ -461,9 +461,13 @@ void ci_ip_cmsg_finish(struct cmsg_state* cmsg_state)
 /**
  * Fill in the msg ancillary data buffer with all control messages
  * according to cmsg_flags the user has set beforehand.
+ *
+ * \param gro_size  Payload size of each datagram when several have been
+ * coalesced for UDP_GRO, else 0.
  */
 void ci_ip_cmsg_recv(ci_netif* ni, ci_udp_state* us, const ci_ip_pkt_fmt *pkt,
-                     struct msghdr *msg, int netif_locked, int *p_msg_flags)
+                     struct msghdr *msg, int netif_locked, int *p_msg_flags,
+                     int gro_size)
 {
   unsigned flags = us->s.cmsg_flags;
   struct cmsg_state cmsg_state;
@@ -509,6 +513,12 @@ void ci_ip_cmsg_recv(ci_netif* ni, ci_udp_state* us, const ci_ip_pkt_fmt *pkt,
     ip_cmsg_recv_timestamping(ni, pkt, us->s.timestamping_flags, &cmsg_state);
 #endif
 
+  if( gro_size != 0 ) {
+    ci_assert_flags(flags, CI_UDP_CMSG_GRO);
+    ci_put_cmsg(&cmsg_state, IPPROTO_UDP, UDP_GRO, sizeof(gro_size),
+                &gro_size);
+  }
+
   ci_ip_cmsg_finish(&cmsg_state);
 }
 
@@ -520,9 +530,14 @@ void ci_ip_cmsg_recv(ci_netif* ni, ci_udp_state* us, const ci_ip_pkt_fmt *pkt,
  *
  * \param info_out    Must be a valid pointer. Contains a pointer to
  * struct in_pktinfo or struct in6_pktinfo.
+ * \param gso_size_out  Must be a valid pointer. Left unchanged unless a
+ * UDP_SEGMENT control message is present.
+ * \param txtime_out  Must be a valid pointer. Left unchanged unless an
+ * SCM_TXTIME control message is present.
  */
 int ci_ip_cmsg_send(const struct msghdr* msg, void** info_out,
-                    void** ts_pktinfo_out)
+                    void** ts_pktinfo_out, int* gso_size_out,
+                    ci_uint64* txtime_out)
 {
   struct cmsghdr *cmsg;
 
@@ -579,6 +594,18 @@ int ci_ip_cmsg_send(const struct msghdr* msg, void** info_out,
 
         *ts_pktinfo_out = CMSG_DATA(cmsg);
       }
+      else if( cmsg->cmsg_type == SCM_TXTIME ) {
+        if( cmsg->cmsg_len != CMSG_LEN(sizeof(ci_uint64)) )
+          return -EINVAL;
+        memcpy(txtime_out, CMSG_DATA(cmsg), sizeof(ci_uint64));
+      }
+    }
+    else if( cmsg->cmsg_level == IPPROTO_UDP ) {
+      if( cmsg->cmsg_type == UDP_SEGMENT ) {
+        if( cmsg->cmsg_len != CMSG_LEN(sizeof(ci_uint16)) )
+          return -EINVAL;
+        *gso_size_out = *(ci_uint16*) CMSG_DATA(cmsg);
+      }
     }
   }
 
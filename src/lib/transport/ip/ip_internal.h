@@ -398,6 +398,24 @@ ci_tcp_ep_mcast_add_del(ci_netif*         ni,
 # define SO_REUSEPORT   15
 #endif
 
+#ifndef SO_MAX_PACING_RATE
+# define SO_MAX_PACING_RATE 47
+#endif
+
+#ifndef TCP_CONGESTION
+# define TCP_CONGESTION 13
+#endif
+#ifndef TCP_CA_NAME_MAX
+# define TCP_CA_NAME_MAX 16
+#endif
+
+#ifndef UDP_SEGMENT
+# define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+# define UDP_GRO 104
+#endif
+
 #if CI_CFG_TIMESTAMPING
 /* The following value needs to match its counterpart
  * in kernel headers.
@@ -424,6 +442,25 @@ struct oo_sock_extended_err {
 #define SO_EE_ORIGIN_TIMESTAMPING 4
 #endif
 
+/* SO_TXTIME needs linux>=4.19 headers, and struct sock_txtime and its
+ * flags are in linux/net_tstamp.h, which we do not include. */
+#ifndef SO_TXTIME
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+#ifndef SO_EE_ORIGIN_TXTIME
+#define SO_EE_ORIGIN_TXTIME 6
+#define SO_EE_CODE_TXTIME_INVALID_PARAM 1
+#define SO_EE_CODE_TXTIME_MISSED 2
+#endif
+struct oo_sock_txtime {
+  ci_int32  clockid;
+  ci_uint32 flags;
+};
+#define OO_SOF_TXTIME_DEADLINE_MODE  0x1
+#define OO_SOF_TXTIME_REPORT_ERRORS  0x2
+#define OO_SOF_TXTIME_FLAGS_MASK     0x3
+
 /* The following value needs to match its counterpart
  * in kernel headers.
  */
@@ -685,6 +722,10 @@ extern ci_ip_pkt_fmt* ci_pkt_alloc_n_nnl(ci_netif* ni, int n) CI_HF;
 #define UDP_HAS_SENDQ_SPACE(us,l) \
   ((us)->s.so.sndbuf >= (int)((us)->tx_count + (l)))
 
+/* Most datagrams one UDP_SEGMENT send is split into, or one UDP_GRO
+ * receive hands back, as Linux. */
+#define CI_UDP_MAX_SEGMENTS  64
+
 
 /* Linux sets twice the buffer size that the application requests. */
 #define oo_adjust_SO_XBUF(v)  ((v) * 2)
@@ -284,3 +284,43 @@ static inline int ci_ip_tx_timestamping_to_cmsg(int proto, ci_netif* ni,
 }
 #endif
 #endif
+
+
+#ifndef __KERNEL__
+/* Report a datagram dropped for its SO_TXTIME launch time, as Linux's etf
+ * qdisc does, except that the datagram itself is not returned.
+ */
+static inline void ci_ip_txtime_err_to_cmsg(ci_udp_state* us,
+                                            struct cmsg_state* cmsg_state)
+{
+  struct {
+    struct oo_sock_extended_err ee;
+    union {
+      struct sockaddr_in        offender;
+#if CI_CFG_IPV6
+      struct sockaddr_in6       offender6;
+#endif
+    };
+  } __attribute__((packed, aligned(sizeof(ci_uint32)))) errhdr;
+  unsigned i = us->txtime_err_get % CI_UDP_TXTIME_ERR_Q_LEN;
+  ci_uint64 txtime = us->txtime_err[i].txtime;
+
+  memset(&errhdr, 0, sizeof(errhdr));
+  errhdr.ee.ee_errno = ECANCELED;
+  errhdr.ee.ee_origin = SO_EE_ORIGIN_TXTIME;
+  errhdr.ee.ee_code = us->txtime_err[i].code;
+  errhdr.ee.ee_info = (ci_uint32) txtime;
+  errhdr.ee.ee_data = (ci_uint32) (txtime >> 32);
+  ci_mb(); /* we are done with the entry - it can be reused now */
+  us->txtime_err_get++;
+
+#if CI_CFG_IPV6
+  if( IS_AF_INET6(us->s.domain) )
+    ci_put_cmsg(cmsg_state, SOL_IPV6, IPV6_RECVERR,
+                sizeof(errhdr.ee) + sizeof(errhdr.offender6), &errhdr);
+  else
+#endif
+    ci_put_cmsg(cmsg_state, SOL_IP, IP_RECVERR,
+                sizeof(errhdr.ee) + sizeof(errhdr.offender), &errhdr);
+}
+#endif
@@ -35,6 +35,8 @@
 #define LINK2TIMER(lnk)				\
   CI_CONTAINER(ci_ip_timer, link, (lnk))
 
+CI_BUILD_ASSERT(CI_IP_TIMER_UDP_TXTIME < CI_IP_TIMER_N_FN);
+
 
 #if CI_CFG_IP_TIMER_DEBUG
 
@@ -139,7 +141,8 @@ void ci_ip_timer_state_init(ci_netif* netif, unsigned cpu_khz)
   /* set module specific time constants dependent on frc2tick */
   ci_tcp_timer_init(netif);
 
-  oo_p_dllink_init(netif, oo_p_dllink_ptr(netif, &ipts->fire_list));
+  for( i = 0; i < CI_IP_TIMER_N_FN; i++ )
+    oo_p_dllink_init(netif, oo_p_dllink_ptr(netif, &ipts->fire_list[i]));
 
   /* Initialise the wheel lists. */
   for( i=0; i < CI_IPTIME_WHEELSIZE; i++)
@@ -165,20 +168,21 @@ void __ci_ip_timer_set(ci_netif *netif, ci_ip_timer *ts, ci_iptime_t t)
 
   /* Previous error in this code was to choose wheel based on time delta 
    * before timer fires (ts->time - stime). This is bogus as the timer wheels
-   * work like a clock and we need to find wheel based on the absolute time
+   * work like a clock and we need to find wheel based on the absolute time.
+   *
+   * Each wheel below the top one takes timers for its current revolution
+   * and the next.  Putting next-revolution timers straight into the lower
+   * wheel means the bucket being drained into it (see
+   * ci_ip_timer_drain()) never grows.
    */
-
-  /* insert in wheel 0 if the top 3 wheels have the same time */
-  if ((stime & IPTIMER_WHEEL0_MASK) == (t & IPTIMER_WHEEL0_MASK)) {
+  if( ci_ip_timer_revs(0, stime, t) <= 1 ) {
     w = 0;
     __ci_timer_busy_set(netif, t);
   }
-  /* else, insert in wheel 1 if the top 2 wheels have the same time */
-  else if ((stime & IPTIMER_WHEEL1_MASK) == (t & IPTIMER_WHEEL1_MASK)) {
+  else if( ci_ip_timer_revs(1, stime, t) <= 1 ) {
     w = 1;
   }
-  /* else, insert in wheel 2 if the top wheel has the same time */
-  else if ((stime & IPTIMER_WHEEL2_MASK) == (t & IPTIMER_WHEEL2_MASK)) {
+  else if( ci_ip_timer_revs(2, stime, t) <= 1 ) {
     w = 2;
   }
   else {
@@ -190,7 +194,7 @@ void __ci_ip_timer_set(ci_netif *netif, ci_ip_timer *ts, ci_iptime_t t)
   LOG_ITV(log("%s: delta=0x%x (t=0x%x-s=0x%x), w=0x%x, b=0x%x", 
          __FUNCTION__, 
          ts->time-stime, ts->time, stime, 
-         w, IPTIMER_BUCKETNO(w, ts->time)));
+         w, IPTIMER_SLOTNO(w, ts->time)));
 
   /* append onto the correct bucket 
   **
@@ -204,63 +208,39 @@ void __ci_ip_timer_set(ci_netif *netif, ci_ip_timer *ts, ci_iptime_t t)
 }
 
 
-/* take the bucket corresponding to time t in the given wheel and 
-** reinsert them back into the wheel (i.e. into wheelno -1)
+/* take up to [budget] timers from the bucket corresponding to time t in
+** the given wheel and reinsert them into the wheel below.  Returns the
+** number of timers moved.
 */
-static int ci_ip_timer_cascadewheel(ci_netif* netif, int wheelno,
-				     ci_iptime_t stime)
+static int ci_ip_timer_cascade(ci_netif* netif, int wheelno, ci_iptime_t t,
+                               int budget)
 {
   ci_ip_timer* ts;
   struct oo_p_dllink_state bucket;
-  struct oo_p_dllink_state cur;
-  oo_p lastp;
-  int changed = 0;
+  struct oo_p_dllink_state link;
+  int moved = 0;
 
   ci_assert(wheelno > 0 && wheelno < CI_IPTIME_WHEELS);
   /* check time is on the boundary expected by the wheel number passed in */
-  ci_assert( (stime & ((unsigned)(-1) << (CI_IPTIME_BUCKETBITS*wheelno))) == stime );
+  ci_assert_equal(IPTIMER_BUCKETNO(wheelno - 1, t), 0);
 
-  /* bucket to empty */
-  bucket = IPTIMER_BUCKET(netif, wheelno, stime);
+  bucket = IPTIMER_BUCKET(netif, wheelno, t);
 
-  LOG_ITV(log(LN_FMT "cascading wheel=%u sched_ticks=0x%x bucket=%i",
-	      LN_PRI_ARGS(netif), wheelno, stime, IPTIMER_BUCKETNO(wheelno, stime)));
+  LOG_ITV(log(LN_FMT "cascading wheel=%u t=0x%x slot=%i budget=%d",
+	      LN_PRI_ARGS(netif), wheelno, t, IPTIMER_SLOTNO(wheelno, t),
+              budget));
 
-  /* ditch the timers in this dll, pointers held in cur & lastp */
-  cur = oo_p_dllink_statep(netif, bucket.l->next);
-  lastp = bucket.p;
-  oo_p_dllink_init(netif, bucket);
+  while( moved != budget && ! oo_p_dllink_is_empty(netif, bucket) ) {
+    link = oo_p_dllink_statep(netif, bucket.l->next);
+    ts = LINK2TIMER(link.l);
 
-  while( ! OO_P_EQ(cur.p, lastp) ) {
-    ts = LINK2TIMER(cur.l);
-
-    /* get next in linked list */
-    cur = oo_p_dllink_statep(netif, cur.l->next);
-
-#ifndef NDEBUG
-    {
-      /* if inserting in wheel 0 - top 3 wheels must have the same time */
-      if (wheelno == 1) {
-        ci_assert_equal(stime & IPTIMER_WHEEL0_MASK,
-                        ts->time & IPTIMER_WHEEL0_MASK);
-      }
-      /* else, if inserting in wheel 1 - top 2 wheels must have the same time */
-      else if (wheelno == 2) {
-        ci_assert_equal(stime & IPTIMER_WHEEL1_MASK,
-                        ts->time & IPTIMER_WHEEL1_MASK);
-      }
-      /* else, if inserting in wheel 2 - the top wheel must have the same time */
-      else {
-        ci_assert(wheelno == 3);
-        ci_assert_equal(stime & IPTIMER_WHEEL2_MASK,
-                        ts->time & IPTIMER_WHEEL2_MASK);
-      }
-    }    
-#endif
-
-    /* insert ts into wheel below */
-    bucket = IPTIMER_BUCKET(netif, wheelno-1, ts->time);
-    changed = 1;
+    /* the whole bucket belongs to one revolution of the wheel below, which
+     * must be the current or the next */
+    ci_assert_equal(ts->time >> (CI_IPTIME_BUCKETBITS * wheelno),
+                    t >> (CI_IPTIME_BUCKETBITS * wheelno));
+    ci_assert_le(ci_ip_timer_revs(wheelno - 1,
+                                  IPTIMER_STATE(netif)->sched_ticks,
+                                  ts->time), 1);
 
     /* append onto the correct bucket 
     **
@@ -268,12 +248,60 @@ static int ci_ip_timer_cascadewheel(ci_netif* netif, int wheelno,
     ** smaller relative time will be before an earlier insert with a
     ** larger relative time. Oh well doesn't really matter
     */
-    oo_p_dllink_add_tail(netif, bucket, oo_p_dllink_statep(netif, ts->statep));
+    oo_p_dllink_del(netif, link);
+    oo_p_dllink_add_tail(netif,
+                         IPTIMER_BUCKET(netif, wheelno - 1, ts->time), link);
 
     if( wheelno == 1 )
       __ci_timer_busy_set(netif, ts->time);
+    ++moved;
+  }
+  return moved;
+}
+
+
+/* Fill the next revolution of each wheel from the wheel above, a few timers
+** at a time.  Whatever is left when the wheel wraps is moved then, so this
+** only spreads the work out.  Returns non-zero if timers were added to
+** wheel 0.
+*/
+static int ci_ip_timer_drain(ci_netif* netif, ci_iptime_t stime)
+{
+  ci_iptime_t next;
+  int w, shift, moved, moved0 = 0;
+
+  for( w = 1; w < CI_IPTIME_WHEELS; w++ ) {
+    /* start of the next revolution of wheel w-1 */
+    shift = CI_IPTIME_BUCKETBITS * w;
+    next = ((stime >> shift) + 1u) << shift;
+    moved = ci_ip_timer_cascade(netif, w, next, CI_IPTIME_DRAIN_BUDGET);
+    if( w == 1 )
+      moved0 = moved;
+    CITP_STATS_NETIF_ADD(netif, timer_drained, moved);
+  }
+  return moved0;
+}
+
+
+/* Find the first busy wheel0 slot in the [n] slots from the one for time
+** [t].  Returns its distance from [t], or -1 if there is none.
+*/
+static int ci_ip_timer_busy_find(ci_ip_timer_state* ipts, ci_iptime_t t,
+                                 unsigned n)
+{
+  unsigned i = 0, b;
+  ci_uint64 m;
+
+  while( i < n ) {
+    b = IPTIMER_SLOTNO(0, t + i);
+    m = ipts->busy_mask[b / 64] >> (b % 64);
+    if( m != 0 ) {
+      i += ci_ffs64(m) - 1;
+      return i < n ? (int) i : -1;
+    }
+    i += 64 - b % 64;
   }
-  return changed;
+  return -1;
 }
 
 /* unpick the ci_ip_timer structure to actually do the callback */ 
@@ -313,6 +341,14 @@ static void ci_ip_timer_docallback(ci_netif *netif, ci_ip_timer* ts)
     sp = oo_statep_to_sockp(netif, ts->statep);
     ci_tcp_timeout_cork(netif, SP_TO_TCP(netif, sp));
     break;
+  case CI_IP_TIMER_TCP_PACING:
+    sp = oo_statep_to_sockp(netif, ts->statep);
+    CHECK_TS(netif, SP_TO_TCP(netif, sp));
+    ci_tcp_timeout_pacing(netif, SP_TO_TCP(netif, sp));
+    break;
+  case CI_IP_TIMER_UDP_TXTIME:
+    ci_udp_txtime_release(netif);
+    break;
   case CI_IP_TIMER_NETIF_TIMEOUT:
     ci_netif_timeout_state(netif);
     break;
@@ -350,6 +386,18 @@ static void ci_ip_timer_docallback(ci_netif *netif, ci_ip_timer* ts)
   }  
 }
 
+/* move the rest of the bucket for time t in the given wheel down when the
+** wheel below wraps */
+static int ci_ip_timer_cascade_all(ci_netif* netif, int wheelno, ci_iptime_t t)
+{
+  int moved = ci_ip_timer_cascade(netif, wheelno, t, -1);
+#if CI_CFG_STATS_NETIF
+  if( moved > netif->state->stats.timer_cascade_max )
+    netif->state->stats.timer_cascade_max = moved;
+#endif
+  return moved;
+}
+
 /* run any pending timers */
 void ci_ip_timer_poll(ci_netif *netif) {
   ci_ip_timer_state* ipts = IPTIMER_STATE(netif); 
@@ -357,10 +405,11 @@ void ci_ip_timer_poll(ci_netif *netif) {
   ci_ip_timer* ts;
   ci_iptime_t rtime;
   int changed = 0;
-  struct oo_p_dllink_state fire_list = oo_p_dllink_ptr(netif,
-                                                       &ipts->fire_list);
+  struct oo_p_dllink_state fire_list;
   struct oo_p_dllink_state bucket;
   struct oo_p_dllink_state link;
+  unsigned fn, n;
+  int d;
 
   /* The caller is expected to ensure that the current time is sufficiently
   ** up-to-date.
@@ -369,9 +418,6 @@ void ci_ip_timer_poll(ci_netif *netif) {
   /* check for sanity i.e. time always goes forwards */
   ci_assert( TIME_GE(rtime, *stime) );
 
-  /* check the temp list used is OK before we start */
-  OO_P_DLLINK_ASSERT_EMPTY(netif, fire_list);
-
   while( TIME_LT(*stime, rtime) ) {
 
     DETAILED_CHECK_TIMERS(netif);
@@ -383,11 +429,11 @@ void ci_ip_timer_poll(ci_netif *netif) {
     if(IPTIMER_BUCKETNO(0, *stime) == 0) {
       if(IPTIMER_BUCKETNO(1, *stime) == 0) {
 	if(IPTIMER_BUCKETNO(2, *stime) == 0) {
-	  ci_ip_timer_cascadewheel(netif, 3, *stime);
+	  ci_ip_timer_cascade_all(netif, 3, *stime);
 	}
-	ci_ip_timer_cascadewheel(netif, 2, *stime);
+	ci_ip_timer_cascade_all(netif, 2, *stime);
       }
-      changed = ci_ip_timer_cascadewheel(netif, 1, *stime);
+      changed |= ci_ip_timer_cascade_all(netif, 1, *stime);
     }
 
 
@@ -397,70 +443,70 @@ void ci_ip_timer_poll(ci_netif *netif) {
         - however, they could be in this bucket
        In summary, need to ensure the dllist stays valid at all times so 
        safe to call. Slightly complicated by the case that its not possible to
-       hold indirected linked lists on the stack */
-    OO_P_DLLINK_ASSERT_EMPTY(netif, fire_list);
+       hold indirected linked lists on the stack.
 
-    /* run timers in the current bucket */
-    bucket = oo_p_dllink_ptr(netif,
-                             &ipts->warray[IPTIMER_BUCKETNO(0, *stime)]),
-    oo_p_dllink_splice(netif, bucket, fire_list);
-    oo_p_dllink_init(netif, bucket);
+       The timers are sorted by callback first, so that all the timers of
+       one kind run together. */
+    bucket = IPTIMER_BUCKET(netif, 0, *stime);
+    while( ! oo_p_dllink_is_empty(netif, bucket) ) {
+      link = oo_p_dllink_statep(netif, bucket.l->next);
+      ts = LINK2TIMER(link.l);
+      ci_assert_equal(ts->time, *stime);
+      /* unknown codes are reported by ci_ip_timer_docallback() */
+      fn = ts->fn < CI_IP_TIMER_N_FN ? ts->fn : 0;
+      oo_p_dllink_del(netif, link);
+      oo_p_dllink_add_tail(netif,
+                           oo_p_dllink_ptr(netif, &ipts->fire_list[fn]), link);
+    }
 
     __ci_timer_busy_unset(netif, *stime);
     DETAILED_CHECK_TIMERS(netif);
 
-    while( ! oo_p_dllink_is_empty(netif, fire_list) ) {
-      link = oo_p_dllink_statep(netif, fire_list.l->next);
-      oo_p_dllink_del_init(netif, link);
+    for( fn = 0; fn < CI_IP_TIMER_N_FN; fn++ ) {
+      fire_list = oo_p_dllink_ptr(netif, &ipts->fire_list[fn]);
+      while( ! oo_p_dllink_is_empty(netif, fire_list) ) {
+        link = oo_p_dllink_statep(netif, fire_list.l->next);
+        oo_p_dllink_del_init(netif, link);
 
-      ts = LINK2TIMER(link.l);
+        ts = LINK2TIMER(link.l);
 
-      ci_assert_equal(ts->time, *stime);
+        ci_assert_equal(ts->time, *stime);
 
-      /* callback safe to set/clear this or other timers */
-      ci_ip_timer_docallback(netif, ts);
+        /* callback safe to set/clear this or other timers */
+        ci_ip_timer_docallback(netif, ts);
+      }
     }
-    OO_P_DLLINK_ASSERT_EMPTY(netif, fire_list);
+
+    changed |= ci_ip_timer_drain(netif, *stime);
 
     DETAILED_CHECK_TIMERS(netif);
   }
 
-  OO_P_DLLINK_ASSERT_EMPTY(netif, fire_list);
-
   /* What is our next timer?
    * Let's update if our previous "closest" timer have already been
-   * handled, or we have cascaded some more timers into wheel0. */
+   * handled, or we have moved some more timers into wheel0. */
   if( TIME_GE(ipts->sched_ticks, ipts->closest_timer) || changed  ) {
-    /* we peek into the first wheel only */
-    ci_iptime_t base = ipts->sched_ticks & IPTIMER_WHEEL0_MASK;
-    ci_iptime_t b = ipts->sched_ticks - base;
-    int i = b/64;
-
-    /* All the lower bits have been already unset in the bitmask: */
-    ci_assert_nflags(ipts->busy_mask[i], (1ULL << (b%64)) - 1);
-
-    /* We peek into the wheel0 */
-    for( ; i < 4; i++ ) {
-      if( ipts->busy_mask[i] != 0 ) {
-        ipts->closest_timer = base + i*64 + ci_ffs64(ipts->busy_mask[i]) - 1;
-        return;
-      }
-    }
-
-    /* Next timer is not closer that the start of wheel1.  We'll cascade it
-     * and determine the closest_timer correctly after cascading.  */
-    ipts->closest_timer = base + CI_IPTIME_BUCKETS;
-
-    /* But if the first bucket in wheel1 is empty, we can push the
-     * closest_timer even further.  We are guaranteed to cascade at least
-     * once during this time frame, so we'll get better estimation when
-     * this value becomes limiting (we call linux_tcp_timer_do() every
-     * 90ms, which is smaller than CI_IPTIME_BUCKETS=250 ticks. */
-    if( oo_p_dllink_is_empty(netif,
+    /* We peek into wheel0: the rest of this revolution, and the next one
+     * too if it has been filled completely from wheel1.  (If the next
+     * revolution starts a new one of wheel1, some of its timers may still
+     * be in wheel2.) */
+    n = CI_IPTIME_BUCKETS - IPTIMER_BUCKETNO(0, ipts->sched_ticks);
+    if( IPTIMER_BUCKETNO(1, ipts->sched_ticks + n) != 0 &&
+        oo_p_dllink_is_empty(netif,
                              IPTIMER_BUCKET(netif, 1,
-                                            base + CI_IPTIME_BUCKETS) ) ) {
-      ipts->closest_timer += CI_IPTIME_BUCKETS;
-    }
+                                            ipts->sched_ticks + n)) )
+      n += CI_IPTIME_BUCKETS;
+
+    /* All the earlier slots have been already unset in the bitmask, so
+     * there is nothing before the current one. */
+    d = ci_ip_timer_busy_find(ipts, ipts->sched_ticks, n);
+
+    /* Otherwise the next timer is not closer than the end of the range we
+     * looked at.  We are guaranteed to cascade or drain again before then,
+     * so we'll get a better estimate when this value becomes limiting (we
+     * call linux_tcp_timer_do() every 90ms, which is smaller than
+     * CI_IPTIME_BUCKETS=256 ticks). */
+    ipts->closest_timer = ipts->sched_ticks + (d >= 0 ? d : n);
   }
 }
 
@@ -475,7 +521,7 @@ void ci_ip_timer_state_assert_valid(ci_netif* ni, const char* file, int line)
   struct oo_p_dllink_state bucket;
   struct oo_p_dllink_state l;
   ci_iptime_t stime, wheel_base, max_time, min_time;
-  int a1, a2, a3, w, b, bit_shift;
+  int a1, a2, a3, w, b, bit_shift, n_slots;
 
   /* shifting a 32 bit integer left or right 32 bits has undefined results 
    * (i.e. not 0 which is required). Therefore I now use an array of mask 
@@ -493,15 +539,18 @@ void ci_ip_timer_state_assert_valid(ci_netif* ni, const char* file, int line)
 
     /* base time of wheel */
     wheel_base = stime & wheel_mask[w];
-    /* for each bucket in wheel */
-    for (b=0; b < CI_IPTIME_BUCKETS; b++) {
-
-      /* max and min relative times for this bucket */
-      bit_shift = CI_IPTIME_BUCKETBITS*w;
-      min_time = wheel_base + (b << bit_shift);
+    bit_shift = CI_IPTIME_BUCKETBITS*w;
+    n_slots = w < CI_IPTIME_WHEELS - 1 ? CI_IPTIME_SLOTS : CI_IPTIME_BUCKETS;
+    /* for each slot in wheel */
+    for (b=0; b < n_slots; b++) {
+
+      /* max and min relative times for this slot, which is in this
+       * revolution of the wheel or the next */
+      min_time = wheel_base +
+        (((b - (wheel_base >> bit_shift)) & CI_IPTIME_SLOTMASK) << bit_shift);
       max_time = min_time   + (1 << bit_shift);
 
-      bucket = oo_p_dllink_ptr(ni, &ipts->warray[w*CI_IPTIME_BUCKETS + b]);
+      bucket = oo_p_dllink_ptr(ni, &ipts->warray[w*CI_IPTIME_SLOTS + b]);
 
       /* check list looks valid */
       if( w == 0 ) {
@@ -556,6 +605,8 @@ static const char* ci_ip_timer_dump(const ci_ip_timer* ts)
     MAKECASE(CI_IP_TIMER_TCP_KALIVE,   "kalive")
     MAKECASE(CI_IP_TIMER_TCP_LISTEN,   "listen")
     MAKECASE(CI_IP_TIMER_TCP_CORK,     "cork")
+    MAKECASE(CI_IP_TIMER_TCP_PACING,   "pacing")
+    MAKECASE(CI_IP_TIMER_UDP_TXTIME,   "udp-txtime")
     MAKECASE(CI_IP_TIMER_NETIF_TIMEOUT, "netif")
     MAKECASE(CI_IP_TIMER_PMTU_DISCOVER, "pmtu")
 #if CI_CFG_SUPPORT_STATS_COLLECTION
@@ -581,7 +632,7 @@ void ci_ip_timer_state_dump(ci_netif* ni)
   struct oo_p_dllink_state bucket;
   struct oo_p_dllink_state l;
   ci_iptime_t stime, wheel_base, max_time, min_time;
-  int w, b, bit_shift;
+  int w, b, bit_shift, n_slots;
 
   /* shifting a 32 bit integer left or right 32 bits has undefined results 
    * (i.e. not 0 which is required). Therefore I now use an array of mask 
@@ -600,15 +651,18 @@ void ci_ip_timer_state_dump(ci_netif* ni)
 
     /* base time of wheel */
     wheel_base = stime & wheel_mask[w];
-    /* for each bucket in wheel */
-    for (b=0; b < CI_IPTIME_BUCKETS; b++) {
-
-      /* max and min relative times for this bucket */
-      bit_shift = CI_IPTIME_BUCKETBITS*w;
-      min_time = wheel_base + (b << bit_shift);
+    bit_shift = CI_IPTIME_BUCKETBITS*w;
+    n_slots = w < CI_IPTIME_WHEELS - 1 ? CI_IPTIME_SLOTS : CI_IPTIME_BUCKETS;
+    /* for each slot in wheel */
+    for (b=0; b < n_slots; b++) {
+
+      /* max and min relative times for this slot, which is in this
+       * revolution of the wheel or the next */
+      min_time = wheel_base +
+        (((b - (wheel_base >> bit_shift)) & CI_IPTIME_SLOTMASK) << bit_shift);
       max_time = min_time   + (1 << bit_shift);
 
-      bucket = oo_p_dllink_ptr(ni, &ipts->warray[w*CI_IPTIME_BUCKETS + b]);
+      bucket = oo_p_dllink_ptr(ni, &ipts->warray[w*CI_IPTIME_SLOTS + b]);
 
       /* check buckets that should be empty are! */
       if ( TIME_LE(min_time, stime) && !oo_p_dllink_is_empty(ni, bucket) )
@@ -0,0 +1,191 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/**************************************************************************\
+*//*! \file
+** <L5_PRIVATE L5_SOURCE>
+**  \brief  Per-stack latency histograms (EF_LATENCY_HIST).
+** </L5_PRIVATE>
+*//*
+\**************************************************************************/
+
+/*! \cidoxg_lib_transport_ip */
+
+#include "ip_internal.h"
+#ifndef __KERNEL__
+#include <onload/ul/per_thread.h>
+#endif
+
+#if CI_CFG_STATS_NETIF
+
+#ifdef __KERNEL__
+  #define LOG_PRINT(...) logger(log_arg, __VA_ARGS__ )
+#else
+  #define LOG_PRINT(...) ci_log(__VA_ARGS__ )
+#endif /* __KERNEL__ */
+
+
+const char* const oo_lat_hist_names[OO_LAT_HIST_N] = {
+  [OO_LAT_HIST_RX_APP] = "rx_to_app",
+  [OO_LAT_HIST_APP_TX] = "app_to_tx",
+  [OO_LAT_HIST_POLL]   = "poll",
+  [OO_LAT_HIST_LOCK]   = "lock_hold",
+};
+
+
+#ifndef __KERNEL__
+/* Threads take shards in turn as they first receive.  Two threads that
+ * race here may get the same shard, which costs only some sharing. */
+static unsigned lat_hist_next_shard;
+
+static unsigned ci_netif_lat_hist_shard(void)
+{
+  struct oo_per_thread* pt = __oo_per_thread_get();
+  if(CI_UNLIKELY( pt->lat_hist_shard == 0 ))
+    pt->lat_hist_shard = 1 + lat_hist_next_shard++ % CI_CFG_LAT_HIST_SHARDS;
+  return pt->lat_hist_shard - 1;
+}
+#else
+# define ci_netif_lat_hist_shard()  0
+#endif
+
+
+void __ci_netif_lat_hist_rx(ci_netif* ni, ci_uint64 rx_frc)
+{
+  ci_uint64 now;
+  if( rx_frc == 0 )
+    return;
+  ci_frc64(&now);
+  oo_lat_hist_add(&ni->state->lat_hist.rx_app[ci_netif_lat_hist_shard()],
+                  rx_frc, now);
+}
+
+
+#ifndef __KERNEL__
+void __ci_netif_lat_hist_send_begin(void)
+{
+  ci_frc64(&__oo_per_thread_get()->lat_send_frc);
+}
+
+
+void __ci_netif_lat_hist_send_end(void)
+{
+  __oo_per_thread_get()->lat_send_frc = 0;
+}
+
+
+void __ci_netif_lat_hist_tx_doorbell(ci_netif* ni)
+{
+  struct oo_per_thread* pt = __oo_per_thread_get();
+  ci_uint64 now;
+
+  if( pt->lat_send_frc == 0 )
+    return;
+  ci_frc64(&now);
+  oo_lat_hist_add(&ni->state->lat_hist.app_tx, pt->lat_send_frc, now);
+  pt->lat_send_frc = 0;
+}
+#endif
+
+
+/* Fold the shards of histogram [which] into [out].  Returns the number of
+ * samples. */
+ci_uint64 ci_netif_lat_hist_sum(ci_netif* ni, int which,
+                                struct oo_lat_hist* out)
+{
+  struct oo_lat_hists* lh = &ni->state->lat_hist;
+  const struct oo_lat_hist* h;
+  int n_shards = 1;
+  ci_uint64 total = 0;
+  int i, b;
+
+  switch( which ) {
+  case OO_LAT_HIST_RX_APP:
+    h = lh->rx_app;
+    n_shards = CI_CFG_LAT_HIST_SHARDS;
+    break;
+  case OO_LAT_HIST_APP_TX:
+    h = &lh->app_tx;
+    break;
+  case OO_LAT_HIST_POLL:
+    h = &lh->poll;
+    break;
+  default:
+    ci_assert_equal(which, OO_LAT_HIST_LOCK);
+    h = &lh->lock;
+    break;
+  }
+
+  memset(out, 0, sizeof(*out));
+  for( i = 0; i < n_shards; ++i )
+    for( b = 0; b < OO_LAT_HIST_N_BUCKETS; ++b ) {
+      ci_uint32 n = OO_ACCESS_ONCE(h[i].bucket[b]);
+      out->bucket[b] += n;
+      total += n;
+    }
+  return total;
+}
+
+
+/* The bucket holding the [ppm]th part per million of [total] samples. */
+unsigned oo_lat_hist_quantile(const struct oo_lat_hist* h, ci_uint64 total,
+                              unsigned ppm)
+{
+  ci_uint64 want = (total * ppm + 999999) / 1000000;
+  ci_uint64 sum = 0;
+  unsigned b;
+
+  if( want == 0 )
+    want = 1;
+  for( b = 0; b < OO_LAT_HIST_N_BUCKETS - 1; ++b )
+    if( (sum += h->bucket[b]) >= want )
+      break;
+  return b;
+}
+
+
+ci_uint64 ci_netif_lat_hist_ns(ci_netif* ni, ci_uint64 cycles)
+{
+  unsigned khz = IPTIMER_STATE(ni)->khz;
+  return khz ? cycles * 1000000 / khz : 0;
+}
+
+
+void ci_netif_dump_lat_hists(ci_netif* ni, oo_dump_log_fn_t logger,
+                             void* log_arg)
+{
+  struct oo_lat_hist h;
+  ci_uint64 total;
+  int which, b;
+
+  if( ! NI_OPTS(ni).latency_hist ) {
+    LOG_PRINT("%s: stack %d: EF_LATENCY_HIST is not enabled",
+              __FUNCTION__, NI_ID(ni));
+    return;
+  }
+
+  LOG_PRINT("latency histograms in ns (lower bound of each bucket):");
+  for( which = 0; which < OO_LAT_HIST_N; ++which ) {
+    total = ci_netif_lat_hist_sum(ni, which, &h);
+    if( total == 0 ) {
+      LOG_PRINT("  %s: no samples", oo_lat_hist_names[which]);
+      continue;
+    }
+    for( b = OO_LAT_HIST_N_BUCKETS - 1; h.bucket[b] == 0; --b )
+      ;
+#define Q(ppm)                                                          \
+    ci_netif_lat_hist_ns(ni, oo_lat_hist_bucket_lo(                     \
+                           oo_lat_hist_quantile(&h, total, (ppm))))
+    LOG_PRINT("  %s: n=%"CI_PRIu64" p50=%"CI_PRIu64" p99=%"CI_PRIu64
+              " p99.9=%"CI_PRIu64" max=%"CI_PRIu64, oo_lat_hist_names[which],
+              total, Q(500000), Q(990000), Q(999000),
+              ci_netif_lat_hist_ns(ni, oo_lat_hist_bucket_lo(b)));
+#undef Q
+    for( b = 0; b < OO_LAT_HIST_N_BUCKETS; ++b )
+      if( h.bucket[b] )
+        LOG_PRINT("    %12"CI_PRIu64" %10u",
+                  ci_netif_lat_hist_ns(ni, oo_lat_hist_bucket_lo(b)),
+                  (unsigned) h.bucket[b]);
+  }
+}
+
+#endif /* CI_CFG_STATS_NETIF */
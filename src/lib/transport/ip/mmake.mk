@@ -18,6 +18,7 @@ LIB_SRCS	:=		\
 		tcp_tx.c	\
 		tcp_tx_reformat.c \
 		tcp_timer.c	\
+		tcp_cong.c	\
 		tcp_close.c	\
 		tcp_init_shared.c \
 		pmtu.c		\
@@ -53,6 +54,8 @@ LIB_SRCS	:=		\
 		active_wild.c	\
 		pkt_checksum.c	\
 		netif_dtor.c	\
+		lat_hist.c	\
+		tcpdump.c	\
 		ringbuffer.c
 
 ifneq ($(DRIVER),1)
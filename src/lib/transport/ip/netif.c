@@ -521,8 +521,7 @@ void ci_netif_rxq_low_on_recv(ci_netif* ni, ci_sock_cmn* s,
       CITP_STATS_NETIF_INC(ni, memory_pressure_exit_recv);
 
   OO_STACK_FOR_EACH_INTF_I(ni, intf_i)
-    if( ci_netif_rx_vi_space(ni, ci_netif_vi(ni, intf_i))
-        >= CI_CFG_RX_DESC_BATCH )
+    if( ci_netif_rx_want_post(ni, intf_i) )
       ci_netif_rx_post(ni, intf_i);
   CITP_STATS_NETIF_INC(ni, rx_refill_recv);
   ci_netif_unlock(ni);
@@ -576,8 +575,7 @@ static void ci_netif_mem_pressure_enter_critical(ci_netif* ni, int intf_i)
   ni->state->mem_pressure |= OO_MEM_PRESSURE_CRITICAL;
   ni->state->rxq_limit = 2*CI_CFG_RX_DESC_BATCH;
   ci_netif_mem_pressure_pkt_pool_use(ni);
-  if( ci_netif_rx_vi_space(ni, ci_netif_vi(ni, intf_i)) >=
-      CI_CFG_RX_DESC_BATCH )
+  if( ci_netif_rx_intf_space(ni, intf_i) >= CI_CFG_RX_DESC_BATCH )
     ci_netif_rx_post(ni, intf_i);
 }
 
@@ -705,7 +703,157 @@ static int __ci_netif_rx_post(ci_netif* ni, ef_vi* vi, int intf_i,
 }
 
 
-#define low_thresh(ni)       ((ni)->state->rxq_limit / 2)
+#define low_thresh(ni, intf_i)  (ci_netif_rx_intf_limit((ni), (intf_i)) / 2)
+
+
+/* Reset the EF_RXQ_ADAPT state of [intf_i]'s RX ring, so that it is filled
+ * to [rxq_limit] in batches of CI_CFG_RX_DESC_BATCH until the next review.
+ */
+void ci_netif_rx_adapt_init(ci_netif* ni, int intf_i)
+{
+  ci_netif_state_nic_t* nsn = &ni->state->nic[intf_i];
+  ef_vi* vi = ci_netif_vi(ni, intf_i);
+
+  nsn->rxq_target = ni->state->rxq_limit;
+  nsn->rxq_batch = CI_CFG_RX_DESC_BATCH;
+  nsn->rxq_adapt_removed = vi->ep_state->rxq.removed;
+  nsn->rxq_adapt_start = ci_ip_time_now(ni);
+  nsn->rxq_adapt_start_removed = vi->ep_state->rxq.removed;
+  nsn->rxq_adapt_rate = 0;
+  nsn->rxq_adapt_drain = 0;
+  nsn->rxq_adapt_low = ef_vi_receive_fill_level(vi);
+}
+
+
+/* Called before each refill of [intf_i]'s RX ring when EF_RXQ_ADAPT is set,
+ * to record how many buffers were used since the last refill and how low
+ * the ring got.
+ */
+static void ci_netif_rx_adapt_sample(ci_netif* ni, int intf_i)
+{
+  ci_netif_state_nic_t* nsn = &ni->state->nic[intf_i];
+  ef_vi* vi = ci_netif_vi(ni, intf_i);
+  ci_uint32 removed = vi->ep_state->rxq.removed;
+  ci_uint32 drained = removed - nsn->rxq_adapt_removed;
+  int level = ef_vi_receive_fill_level(vi);
+
+  nsn->rxq_adapt_removed = removed;
+  if( drained > nsn->rxq_adapt_drain )
+    nsn->rxq_adapt_drain = drained;
+  if( level < nsn->rxq_adapt_low )
+    nsn->rxq_adapt_low = level;
+  if( level == 0 && drained != 0 )
+    CITP_STATS_NETIF_INC(ni, rxq_adapt_empty);
+}
+
+
+/* Called from the poll path when EF_RXQ_ADAPT is set, so that a quiet ring
+ * that is not being refilled is still reviewed.
+ *
+ * Every CI_CFG_RXQ_ADAPT_INTERVAL_MS we choose a new target fill level:
+ * enough to absorb twice the largest drain between refills that we saw.
+ * If the ring ran empty we double the target, and if the target is more
+ * than we need we lower it by an eighth at a time, but only when traffic
+ * is not picking up.  The refill batch grows with the drain between
+ * refills, so that a busy ring is refilled less often.
+ *
+ * Buffers that are already posted cannot be taken back from the NIC
+ * without flushing the queue, so when the target falls below the fill
+ * level the excess is released as packets arrive into it.
+ */
+void ci_netif_rx_adapt(ci_netif* ni, int intf_i)
+{
+  ci_netif_state_nic_t* nsn = &ni->state->nic[intf_i];
+  ef_vi* vi = ci_netif_vi(ni, intf_i);
+  ci_uint32 removed, arrivals, drain;
+  int level, lo, hi, need, target, batch;
+  ci_uint32 rate;
+
+  if( ci_ip_time_before(ci_ip_time_now(ni),
+                        nsn->rxq_adapt_start +
+                        ci_ip_time_ms2ticks(ni, CI_CFG_RXQ_ADAPT_INTERVAL_MS)) )
+    return;
+  if( vi->nic_type.arch == EF_VI_ARCH_EFCT ||
+      vi->nic_type.arch == EF_VI_ARCH_EF10CT )
+    return;
+
+  /* Buffers used since the last refill count towards this interval too. */
+  removed = vi->ep_state->rxq.removed;
+  arrivals = removed - nsn->rxq_adapt_start_removed;
+  drain = CI_MAX(nsn->rxq_adapt_drain, removed - nsn->rxq_adapt_removed);
+  level = ef_vi_receive_fill_level(vi);
+  if( level < nsn->rxq_adapt_low )
+    nsn->rxq_adapt_low = level;
+
+  hi = ni->state->rxq_base_limit;
+  lo = CI_MIN(CI_MAX(NI_OPTS(ni).rxq_min, 2 * CI_CFG_RX_DESC_BATCH), hi);
+  need = 2 * drain + CI_CFG_RX_DESC_BATCH;
+  rate = nsn->rxq_adapt_rate;
+  target = nsn->rxq_target;
+
+  if( nsn->rxq_adapt_low == 0 && arrivals != 0 )
+    target = CI_MAX(2 * target, need);
+  else if( need > target )
+    target = need;
+  else if( arrivals <= rate )
+    target = CI_MAX(target - target / 8, need);
+  target = CI_MAX(CI_MIN(target, hi), lo);
+
+  batch = CI_ROUND_UP(drain / 2, CI_CFG_RX_DESC_BATCH);
+  batch = CI_MIN(batch, (int) NI_OPTS(ni).rxq_adapt_batch_max);
+  batch = CI_MIN(batch, target / 4);
+  batch = CI_MAX(batch, CI_CFG_RX_DESC_BATCH);
+
+  if( target > nsn->rxq_target )
+    CITP_STATS_NETIF_INC(ni, rxq_adapt_grow);
+  else if( target < nsn->rxq_target )
+    CITP_STATS_NETIF_INC(ni, rxq_adapt_shrink);
+  nsn->rxq_target = target;
+  nsn->rxq_batch = batch;
+
+  nsn->rxq_adapt_rate = (3 * rate + arrivals) / 4;
+  nsn->rxq_adapt_start = ci_ip_time_now(ni);
+  nsn->rxq_adapt_start_removed = removed;
+  nsn->rxq_adapt_drain = 0;
+  nsn->rxq_adapt_low = level;
+}
+
+
+/* Called when an RX ring is about to be refilled from packet set
+ * [bufset_id].  If the set is not on the NIC's NUMA node, ask for a set
+ * that is, so that we can move back to local memory once it arrives.
+ *
+ * Every refill from a remote set comes through here, so a request is made
+ * only when none is outstanding, no set on the node has free buffers, and
+ * the last request was at least CI_CFG_PKT_SET_NODE_REQ_MS ago.
+ */
+static void ci_netif_rx_post_check_node(ci_netif* netif, int bufset_id,
+                                        int node)
+{
+  oo_pktbuf_manager* pm = netif->packets;
+  ci_iptime_t now;
+  int i;
+
+  if(CI_LIKELY( node < 0 || pm->set[bufset_id].numa_node == node ))
+    return;
+  CITP_STATS_NETIF_INC(netif, refill_remote_node);
+
+  if( pm->sets_n >= pm->sets_max || pm->alloc_node >= 0 ||
+      (netif->state->lock.lock & CI_EPLOCK_NETIF_NEED_PKT_SET) )
+    return;
+  for( i = 0; i < pm->sets_n; ++i )
+    if( pm->set[i].numa_node == node && pm->set[i].n_free > 0 )
+      return;
+  now = ci_ip_time_now(netif);
+  if( (ci_iptime_t) (now - pm->alloc_node_time) <
+      ci_ip_time_ms2ticks(netif, CI_CFG_PKT_SET_NODE_REQ_MS) )
+    return;
+
+  pm->alloc_node = node;
+  pm->alloc_node_time = now;
+  ef_eplock_holder_set_single_flag(&netif->state->lock,
+                                   CI_EPLOCK_NETIF_NEED_PKT_SET);
+}
 
 
 void ci_netif_rx_post(ci_netif* netif, int intf_i)
@@ -722,6 +870,7 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
   ci_ip_pkt_fmt* pkt;
   int max_n_to_post, rx_allowed, n_to_post;
   int bufset_id = NI_PKT_SET(netif);
+  int node = netif->state->nic[intf_i].numa_node;
   int ask_for_more_packets = 0;
 
   if( vi->nic_type.arch == EF_VI_ARCH_EFCT ||
@@ -732,9 +881,15 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
     return;
 
   ci_assert(ci_netif_is_locked(netif));
-  ci_assert(ci_netif_rx_vi_space(netif, vi) >= CI_CFG_RX_DESC_BATCH);
+  if( NI_OPTS(netif).rxq_adapt ) {
+    ci_netif_rx_adapt_sample(netif, intf_i);
+    /* A new target may leave too little room to be worth a refill. */
+    if( ci_netif_rx_intf_space(netif, intf_i) < CI_CFG_RX_DESC_BATCH )
+      return;
+  }
+  ci_assert_ge(ci_netif_rx_intf_space(netif, intf_i), CI_CFG_RX_DESC_BATCH);
 
-  max_n_to_post = ci_netif_rx_vi_space(netif, vi);
+  max_n_to_post = ci_netif_rx_intf_space(netif, intf_i);
   rx_allowed = NI_OPTS(netif).max_rx_packets - netif->state->n_rx_pkts;
   if( max_n_to_post > rx_allowed )
     goto rx_limited;
@@ -742,11 +897,13 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
 
   ci_assert_ge(max_n_to_post, CI_CFG_RX_DESC_BATCH);
   /* We could have enough packets in all sets together, but we need them
-   * in one set. */
-  if( netif->packets->set[bufset_id].n_free < CI_CFG_RX_DESC_BATCH )
+   * in one set.  We'd also like it to be on the NIC's NUMA node. */
+  if( netif->packets->set[bufset_id].n_free < CI_CFG_RX_DESC_BATCH ||
+      (node >= 0 && netif->packets->set[bufset_id].numa_node != node) )
     goto find_new_bufset;
 
  good_bufset:
+  ci_netif_rx_post_check_node(netif, bufset_id, node);
   do {
     n_to_post = CI_MIN(max_n_to_post, netif->packets->set[bufset_id].n_free);
     max_n_to_post -= __ci_netif_rx_post(netif, vi, intf_i,
@@ -763,12 +920,13 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
     }
 
  find_new_bufset:
-    bufset_id = ci_netif_pktset_best(netif);
+    bufset_id = ci_netif_pktset_best_node(netif, node, CI_CFG_RX_DESC_BATCH);
     if( bufset_id == -1 ||
         netif->packets->set[bufset_id].n_free < CI_CFG_RX_DESC_BATCH )
       goto not_enough_pkts;
     ask_for_more_packets = ci_netif_pkt_set_is_underfilled(netif,
                                                            bufset_id);
+    ci_netif_rx_post_check_node(netif, bufset_id, node);
   } while( 1 );
   /* unreachable */
 
@@ -779,16 +937,18 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
     rx_allowed = 0;
 #if OO_DO_STACK_POLL
   /* Only reap if ring is getting pretty empty. */
-  if( ef_vi_receive_fill_level(vi) + rx_allowed < low_thresh(netif) ) {
+  if( ef_vi_receive_fill_level(vi) + rx_allowed < low_thresh(netif, intf_i) ) {
     CITP_STATS_NETIF_INC(netif, reap_rx_limited);
     ci_netif_try_to_reap(netif, max_n_to_post - rx_allowed);
     rx_allowed = NI_OPTS(netif).max_rx_packets - netif->state->n_rx_pkts;
     if( rx_allowed < 0 )
       rx_allowed = 0;
     max_n_to_post = CI_MIN(max_n_to_post, rx_allowed);
-    if( ef_vi_receive_fill_level(vi) + max_n_to_post < low_thresh(netif) )
+    if( ef_vi_receive_fill_level(vi) + max_n_to_post <
+        low_thresh(netif, intf_i) )
       /* Ask recv() path to refill when some buffers are freed. */
-      netif->state->rxq_low = ci_netif_rx_vi_space(netif, vi) - max_n_to_post;
+      netif->state->rxq_low = ci_netif_rx_intf_space(netif, intf_i) -
+                              max_n_to_post;
     if( max_n_to_post >= CI_CFG_RX_DESC_BATCH )
       goto not_rx_limited;
   }
@@ -802,7 +962,7 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
      * here.
      */
     rx_allowed = CI_CFG_RX_DESC_BATCH;
-    max_n_to_post = ci_netif_rx_vi_space(netif, vi);
+    max_n_to_post = ci_netif_rx_intf_space(netif, intf_i);
   }
 #endif
   max_n_to_post = CI_MIN(max_n_to_post, rx_allowed);
@@ -835,6 +995,7 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
   }
 
   /* Still not enough -- allocate more memory if possible. */
+  netif->packets->alloc_node = node;
   if( netif->packets->sets_n < netif->packets->sets_max &&
       ci_tcp_helper_more_bufs(netif) == 0 ) {
     bufset_id = netif->packets->sets_n - 1;
@@ -845,16 +1006,16 @@ void ci_netif_rx_post(ci_netif* netif, int intf_i)
   }
 
 #if OO_DO_STACK_POLL
-  if( ef_vi_receive_fill_level(vi) < low_thresh(netif) ) {
+  if( ef_vi_receive_fill_level(vi) < low_thresh(netif, intf_i) ) {
     CITP_STATS_NETIF_INC(netif, reap_buf_limited);
     ci_netif_try_to_reap(netif, max_n_to_post);
     max_n_to_post = CI_MIN(max_n_to_post, netif->packets->n_free);
-    bufset_id = ci_netif_pktset_best(netif);
+    bufset_id = ci_netif_pktset_best_node(netif, node, CI_CFG_RX_DESC_BATCH);
     if( bufset_id != -1 &&
         netif->packets->set[bufset_id].n_free >= CI_CFG_RX_DESC_BATCH )
       goto good_bufset;
     /* Ask recv() path to refill when some buffers are freed. */
-    netif->state->rxq_low = ci_netif_rx_vi_space(netif, vi);
+    netif->state->rxq_low = ci_netif_rx_intf_space(netif, intf_i);
   }
 
   CITP_STATS_NETIF_INC(netif, refill_buf_limited);
@@ -882,6 +1043,138 @@ static void citp_waitable_deferred_work(ci_netif* ni, citp_waitable* w)
 }
 
 
+/* Do the deferred work of socket [sock_id] - 1 and, if [follow_list],
+ * of the sockets linked from it through next_id. */
+static void ci_netif_perform_deferred_socket_work(ci_netif* ni,
+                                                  unsigned sock_id,
+                                                  int/*bool*/ follow_list)
+{
+  citp_waitable* w;
+  oo_sp sockp;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  do {
+    ci_assert(sock_id > 0);
+    --sock_id;
+    sockp = OO_SP_FROM_INT(ni, sock_id);
+    w = SP_TO_WAITABLE(ni, sockp);
+    sock_id = follow_list ? w->next_id : 0;
+    ci_bit_clear(&w->sb_aflags, CI_SB_AFLAG_DEFERRED_BIT);
+    CITP_STATS_NETIF(++ni->state->stats.deferred_work);
+
+    citp_waitable_deferred_work(ni, w);
+  }
+  while( sock_id > 0 );
+}
+
+
+/* Put [w] on its defer ring.  Returns false if the ring is full. */
+static int ci_netif_defer_ring_push(ci_netif* ni, citp_waitable* w)
+{
+  struct oo_defer_ring* r;
+  ci_uint32 h;
+
+  CI_BUILD_ASSERT(CI_IS_POW2(CI_CFG_DEFER_RING_SIZE));
+  r = &ni->state->defer_ring[W_ID(w) % CI_CFG_DEFER_RING_SHARDS];
+  do {
+    h = r->head;
+    if( h - r->tail >= CI_CFG_DEFER_RING_SIZE ) {
+      CITP_STATS_NETIF_INC(ni, defer_ring_full);
+      return 0;
+    }
+  } while( ci_cas32u_fail(&r->head, h, h + 1) );
+  r->slot[h & (CI_CFG_DEFER_RING_SIZE - 1)] = W_ID(w) + 1;
+  return 1;
+}
+
+
+/* Returns true if the drain of [r] has been stopped at the claimed but
+ * empty slot at [t] for longer than CI_CFG_DEFER_RING_STALL_MS.
+ *
+ * A producer that dies between claiming a slot and filling it in leaves a
+ * hole that is never filled.  We can't move [tail] past it, as a producer
+ * that was only descheduled may yet write to the slot, by which time it
+ * could belong to someone else.  So the hole stays, and the drain instead
+ * does the sockets beyond it as for [all].  Once those have filled the
+ * ring, further sockets for that shard go on the list in the lock word. */
+static int ci_netif_defer_ring_stalled(ci_netif* ni, struct oo_defer_ring* r,
+                                       ci_uint32 t)
+{
+  ci_iptime_t now = ci_ip_time_now(ni);
+
+  if( r->hole_state == OO_DEFER_RING_HOLE_NONE || r->hole != t ) {
+    r->hole = t;
+    r->hole_time = now;
+    r->hole_state = OO_DEFER_RING_HOLE_SEEN;
+    return 0;
+  }
+  if( r->hole_state == OO_DEFER_RING_HOLE_SEEN ) {
+    if( (ci_iptime_t) (now - r->hole_time) <
+        ci_ip_time_ms2ticks(ni, CI_CFG_DEFER_RING_STALL_MS) )
+      return 0;
+    r->hole_state = OO_DEFER_RING_HOLE_STALLED;
+    CITP_STATS_NETIF_INC(ni, defer_ring_stalled);
+    LOG_E(ci_log(FN_FMT "defer ring %d: slot %u still empty after %dms",
+                 FN_PRI_ARGS(ni), (int) (r - ni->state->defer_ring), t,
+                 CI_CFG_DEFER_RING_STALL_MS));
+  }
+  return 1;
+}
+
+
+/* Do the deferred work of every socket on the defer rings.  A slot that
+ * has been claimed but not yet filled in stops the drain of its ring; the
+ * thread filling it in will see that the flag is clear and set it again,
+ * so those sockets are picked up by this or a later lock holder.
+ *
+ * If [all], or the slot has been empty for too long (see
+ * ci_netif_defer_ring_stalled()), the sockets in filled slots beyond such a
+ * slot are done too, and their slots marked OO_DEFER_RING_DONE for a later
+ * drain to skip.  [all] is for callers that need no socket to be left on a
+ * ring. */
+static void ci_netif_drain_defer_rings(ci_netif* ni, int/*bool*/ all)
+{
+  struct oo_defer_ring* r;
+  ci_uint32 t, id;
+  int i, n;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  for( i = 0; i < CI_CFG_DEFER_RING_SHARDS; ++i ) {
+    r = &ni->state->defer_ring[i];
+    t = r->tail;
+    /* Bound the loop, as the ring is in shared memory. */
+    for( n = 0; t != r->head && n < CI_CFG_DEFER_RING_SIZE; ++n ) {
+      id = r->slot[t & (CI_CFG_DEFER_RING_SIZE - 1)];
+      if( id == 0 )
+        break;
+      ci_rmb();
+      r->slot[t & (CI_CFG_DEFER_RING_SIZE - 1)] = 0;
+      ci_wmb();
+      r->tail = ++t;
+      if( id != OO_DEFER_RING_DONE )
+        ci_netif_perform_deferred_socket_work(ni, id, 0);
+    }
+    if( t == r->head ) {
+      r->hole_state = OO_DEFER_RING_HOLE_NONE;
+      continue;
+    }
+    if( ! ci_netif_defer_ring_stalled(ni, r, t) && ! all )
+      continue;
+    for( ; t != r->head && n < CI_CFG_DEFER_RING_SIZE; ++n, ++t ) {
+      id = r->slot[t & (CI_CFG_DEFER_RING_SIZE - 1)];
+      if( id == 0 || id == OO_DEFER_RING_DONE )
+        continue;
+      ci_rmb();
+      r->slot[t & (CI_CFG_DEFER_RING_SIZE - 1)] = OO_DEFER_RING_DONE;
+      ci_netif_perform_deferred_socket_work(ni, id, 0);
+    }
+  }
+  ni->state->defer_work_count = 0;
+}
+
+
 int ci_netif_lock_or_defer_work(ci_netif* ni, citp_waitable* w)
 {
 #if CI_CFG_FD_CACHING && !defined(NDEBUG)
@@ -943,6 +1236,34 @@ int ci_netif_lock_or_defer_work(ci_netif* ni, citp_waitable* w)
     return 0;
   }
 
+  /* When the stack is locked, pass the socket to the lock holder through
+   * a defer ring if there is room.  The lock word then needs to change
+   * only to set CI_EPLOCK_NETIF_DEFER_RING, which is done once per holder
+   * rather than by every thread that defers work. */
+  if( (ni->state->lock.lock & CI_EPLOCK_LOCKED) &&
+      ci_netif_defer_ring_push(ni, w) ) {
+    CITP_STATS_NETIF_INC(ni, defer_ring_queued);
+    ++ni->state->defer_work_count;
+    /* The slot must be visible before we look at the lock: either the
+     * holder has yet to clear the flag and will drain the ring after it
+     * does, or we see it clear and take the lock or set it again. */
+    ci_mb();
+    while( 1 ) {
+      ci_uint64 v = ni->state->lock.lock;
+      if( ! (v & CI_EPLOCK_LOCKED) ) {
+        if( ci_netif_trylock(ni) ) {
+          ci_netif_drain_defer_rings(ni, 0);
+          return 1;
+        }
+      }
+      else if( v & CI_EPLOCK_NETIF_DEFER_RING ||
+               ci_cas64u_succeed(&ni->state->lock.lock, v,
+                                 v | CI_EPLOCK_NETIF_DEFER_RING) ) {
+        return 0;
+      }
+    }
+  }
+
   while( 1 ) {
     ci_uint64 new_v, v = ni->state->lock.lock;
     if( ! (v & CI_EPLOCK_LOCKED) ) {
@@ -964,29 +1285,6 @@ int ci_netif_lock_or_defer_work(ci_netif* ni, citp_waitable* w)
 }
 
 
-static void ci_netif_perform_deferred_socket_work(ci_netif* ni,
-                                                  unsigned sock_id)
-{
-  citp_waitable* w;
-  oo_sp sockp;
-
-  ci_assert(ci_netif_is_locked(ni));
-
-  do {
-    ci_assert(sock_id > 0);
-    --sock_id;
-    sockp = OO_SP_FROM_INT(ni, sock_id);
-    w = SP_TO_WAITABLE(ni, sockp);
-    sock_id = w->next_id;
-    ci_bit_clear(&w->sb_aflags, CI_SB_AFLAG_DEFERRED_BIT);
-    CITP_STATS_NETIF(++ni->state->stats.deferred_work);
-
-    citp_waitable_deferred_work(ni, w);
-  }
-  while( sock_id > 0 );
-}
-
-
 ci_uint64 ci_netif_purge_deferred_socket_list(ci_netif* ni)
 {
   ci_uint64 l;
@@ -997,7 +1295,8 @@ ci_uint64 ci_netif_purge_deferred_socket_list(ci_netif* ni)
     if( ci_cas64u_succeed(&ni->state->lock.lock, l,
                         l &~ CI_EPLOCK_NETIF_SOCKET_LIST) )
       ci_netif_perform_deferred_socket_work(ni,
-                                            l & CI_EPLOCK_NETIF_SOCKET_LIST);
+                                            l & CI_EPLOCK_NETIF_SOCKET_LIST,
+                                            1);
 
     /* It is not possible to clear defer_work_count atomically together
      * with NETIF_SOCKET_LIST.  We can do it before or after.
@@ -1007,6 +1306,12 @@ ci_uint64 ci_netif_purge_deferred_socket_list(ci_netif* ni)
     ni->state->defer_work_count = 0;
   }
 
+  /* Callers rely on no socket being left with deferred work, so empty the
+   * defer rings as well.  CI_EPLOCK_NETIF_DEFER_RING is left alone: if it
+   * is set, the next unlock finds the rings empty, or holding only sockets
+   * queued since. */
+  ci_netif_drain_defer_rings(ni, 1);
+
   return l;
 }
 
@@ -1107,6 +1412,13 @@ ci_uint64 ci_netif_unlock_slow_common(ci_netif* ni, ci_uint64 lock_val,
   /* Restrict work below to what has been requested */
   test_val = lock_val & flags_to_handle;
 
+  /* Deferred socket work goes before anything else, as for the list in the
+   * lock word above. */
+  if( test_val & CI_EPLOCK_NETIF_DEFER_RING ) {
+    CITP_STATS_NETIF_INC(ni, unlock_slow_socket_list);
+    ci_netif_drain_defer_rings(ni, 0);
+  }
+
   if( test_val & CI_EPLOCK_NETIF_IS_PKT_WAITER ) {
     if( ci_netif_pkt_tx_can_alloc_now(ni) ) {
       set_flags |= CI_EPLOCK_NETIF_PKT_WAKE;
@@ -1290,9 +1602,15 @@ void ci_netif_unlock(ci_netif* ni)
   ci_assert_nflags(ni->state->flags, CI_NETIF_FLAG_PKT_ACCOUNT_PENDING);
 
   ci_assert_equal(ni->state->in_poll, 0);
+#if CI_CFG_STATS_NETIF && ! defined(__KERNEL__)
+  if(CI_UNLIKELY( ni->lock_frc != 0 )) {
+    oo_lat_hist_add(&ni->state->lat_hist.lock, ni->lock_frc, ci_frc64_get());
+    ni->lock_frc = 0;
+  }
+#endif
   if(CI_LIKELY( ni->state->lock.lock == CI_EPLOCK_LOCKED &&
-                ci_cas64u_succeed(&ni->state->lock.lock,
-                                  CI_EPLOCK_LOCKED, 0) ))
+                ci_cas64u_succeed_release(&ni->state->lock.lock,
+                                          CI_EPLOCK_LOCKED, 0) ))
     return;
   ci_netif_unlock_slow(ni);
 
@@ -1653,16 +1971,16 @@ static int __ci_netif_active_wild_rss_ok(ci_netif* ni,
 #endif
 
 
-static int __ci_netif_active_wild_pool_select(ci_netif* ni, ci_addr_t laddr,
-                                              ci_addr_t raddr, ci_uint16 rport,
+/* [select_hash] is the NIC hash of the 3-tuple with a zero local port.  It
+ * is the same for every [offset], so callers compute it once.
+ */
+static int __ci_netif_active_wild_pool_select(ci_netif* ni,
+                                              ci_uint32 select_hash,
                                               int offset)
 {
   ci_uint32 pool_index = 0;
-  ci_uint32 select_hash;
 
   if( ni->state->active_wild_pools_n > 1 ) {
-    select_hash = ci_netif_active_wild_nic_hash(ni, laddr, 0, raddr, rport);
-
     ci_assert_equal(0, (offset & ~RSS_HASH_MASK));
 
     pool_index = select_hash ^ offset;
@@ -1829,15 +2147,18 @@ static oo_sp __ci_netif_active_wild_get(ci_netif* ni, ci_addr_t laddr,
 {
   int aw_pool;
   int offset;
+  ci_uint32 select_hash = 0;
   oo_sp aw = OO_SP_NULL;
 
   ci_assert(ci_netif_is_locked(ni));
 
+  if( ni->state->active_wild_pools_n > 1 )
+    select_hash = ci_netif_active_wild_nic_hash(ni, laddr, 0, raddr, rport);
+
   for( offset = ni->state->rss_instance;
        offset < ni->state->active_wild_pools_n;
        offset += ni->state->cluster_size ) {
-    aw_pool = __ci_netif_active_wild_pool_select(ni, laddr, raddr, rport,
-                                                 offset);
+    aw_pool = __ci_netif_active_wild_pool_select(ni, select_hash, offset);
     aw = __ci_netif_active_wild_pool_get(ni, aw_pool, laddr, raddr, rport,
                                          port_out, prev_seq_out);
     if( aw != OO_SP_NULL )
@@ -1932,29 +2253,6 @@ void ci_netif_active_wild_sharer_closed(ci_netif* ni, ci_sock_cmn* s)
 #endif /* CI_CFG_TCP_SHARED_LOCAL_PORTS */
 
 
-#if OO_DO_STACK_POLL
-void oo_tcpdump_free_pkts(ci_netif* ni, ci_uint16 i)
-{
-  ci_uint16 read_i = ni->state->dump_read_i;
-
-  ci_assert(ci_netif_is_locked(ni));
-
-  /* Ensure reader has finished reading before we free packets. */
-  ci_mb();
-
-  do {
-    oo_pkt_p id = ni->state->dump_queue[i % CI_CFG_DUMPQUEUE_LEN];
-    if( id != OO_PP_NULL ) {
-      ci_ip_pkt_fmt* pkt = PKT_CHK(ni, id);
-      ni->state->dump_queue[i % CI_CFG_DUMPQUEUE_LEN] = OO_PP_NULL;
-      ci_wmb();
-      ci_netif_pkt_release(ni, pkt);
-    }
-  } while( (++i - read_i) % CI_CFG_DUMPQUEUE_LEN );
-}
-#endif
-
-
 #if CI_CFG_UL_INTERRUPT_HELPER && ! defined(__KERNEL__)
 
 static void sw_update_cb(void* arg, void* data)
@@ -255,6 +255,42 @@ void ci_netif_print_sockets(ci_netif* ni)
 }
 
 
+/* Packet buffer usage for each NUMA node that has packet sets, and the
+ * interfaces on that node. */
+static void ci_netif_dump_pkt_nodes(ci_netif* ni, oo_dump_log_fn_t logger,
+                                    void* log_arg)
+{
+  int i, j, intf_i, node, n_sets, n_free;
+  char intfs[CI_CFG_MAX_INTERFACES * 4 + 1];
+  int intfs_len;
+
+  for( i = 0; i < ni->packets->sets_n; i++ ) {
+    node = ni->packets->set[i].numa_node;
+    for( j = 0; j < i; j++ )
+      if( ni->packets->set[j].numa_node == node )
+        break;
+    if( j < i )
+      continue;  /* already reported */
+
+    n_sets = n_free = 0;
+    for( j = i; j < ni->packets->sets_n; j++ )
+      if( ni->packets->set[j].numa_node == node ) {
+        ++n_sets;
+        n_free += ni->packets->set[j].n_free;
+      }
+    intfs[0] = '\0';
+    intfs_len = 0;
+    OO_STACK_FOR_EACH_INTF_I(ni, intf_i)
+      if( ni->state->nic[intf_i].numa_node == node )
+        intfs_len += snprintf(intfs + intfs_len, sizeof(intfs) - intfs_len,
+                              "%s%d", intfs_len ? "," : "", intf_i);
+    logger(log_arg, "  pkt_node[%d]: sets=%d alloc=%d free=%d used=%d "
+           "intfs=%s", node, n_sets, n_sets * PKTS_PER_SET, n_free,
+           n_sets * PKTS_PER_SET - n_free, intfs_len ? intfs : "-");
+  }
+}
+
+
 static void ci_netif_dump_pkt_summary(ci_netif* ni, oo_dump_log_fn_t logger,
                                       void* log_arg)
 {
@@ -266,9 +302,11 @@ static void ci_netif_dump_pkt_summary(ci_netif* ni, oo_dump_log_fn_t logger,
          ni->packets->sets_n);
 
   for( i = 0; i < ni->packets->sets_n; i++ ) {
-    logger(log_arg, "  pkt_set[%d]: free=%d%s", i, ni->packets->set[i].n_free,
+    logger(log_arg, "  pkt_set[%d]: free=%d node=%d%s", i,
+           ni->packets->set[i].n_free, ni->packets->set[i].numa_node,
            i == ni->packets->id ? " current" : "");
   }
+  ci_netif_dump_pkt_nodes(ni, logger, log_arg);
 
   rx_ring = 0;
   tx_ring = 0;
@@ -529,6 +567,7 @@ void ci_netif_dump_extra_to_logger(ci_netif* ni, oo_dump_log_fn_t logger,
   ci_netif_state* ns = ni->state;
   char hp2i[CI_CFG_MAX_HWPORTS * 10];
   char i2hp[CI_CFG_MAX_INTERFACES * 10];
+  char drq[CI_CFG_DEFER_RING_SHARDS * 12];
   int i, off;
 
   for( i = 0, off = 0; i < CI_CFG_MAX_HWPORTS; ++i )
@@ -552,6 +591,11 @@ void ci_netif_dump_extra_to_logger(ci_netif* ni, oo_dump_log_fn_t logger,
   logger(log_arg, "  hwport_to_intf_i=%s intf_i_to_hwport=%s", hp2i, i2hp);
   logger(log_arg, "  uk_intf_ver=%s", OO_UK_INTF_VER);
   logger(log_arg, "  deferred count %d/%d", ns->defer_work_count, NI_OPTS(ni).defer_work_limit);
+  for( i = 0, off = 0; i < CI_CFG_DEFER_RING_SHARDS; ++i )
+    off += ci_scnprintf(drq+off, sizeof(drq)-off, "%s%u", i?",":"",
+                        ns->defer_ring[i].head - ns->defer_ring[i].tail);
+  logger(log_arg, "  defer rings: queued=%s size=%d", drq,
+         CI_CFG_DEFER_RING_SIZE);
   logger(log_arg, "  numa nodes: creation=%d load=%d",
          ns->creation_numa_node, ns->load_numa_node);
   logger(log_arg, "  numa node masks: packet alloc=%x sock alloc=%x interrupt=%x",
@@ -685,9 +729,9 @@ static void ci_netif_dump_vi(ci_netif* ni, int intf_i, oo_dump_log_fn_t logger,
     return;
   }
 
-  logger(log_arg, "%s: stack=%d intf=%d dev=%s hw=%d%c%d", __FUNCTION__,
-         NI_ID(ni), intf_i, nic->dev_name, (int) nic->vi_arch,
-         nic->vi_variant, (int) nic->vi_revision);
+  logger(log_arg, "%s: stack=%d intf=%d dev=%s hw=%d%c%d numa=%d",
+         __FUNCTION__, NI_ID(ni), intf_i, nic->dev_name, (int) nic->vi_arch,
+         nic->vi_variant, (int) nic->vi_revision, (int) nic->numa_node);
   logger(log_arg, "  vi=%d pd_owner=%d %s=%d tcpdump=%s vi_flags=%x oo_vi_flags=%x",
          ef_vi_instance(vi), nic->pd_owner,
          nic->vi_nic_flags & EFHW_VI_NIC_IRQ ? irq : channel,
@@ -708,10 +752,16 @@ static void ci_netif_dump_vi(ci_netif* ni, int intf_i, oo_dump_log_fn_t logger,
   if( vi->efct_rxqs.ops )
     vi->efct_rxqs.ops->dump_stats(vi, logger, log_arg);
   else
+  {
     logger(log_arg, "  rxq: cap=%d lim=%d spc=%d level=%d total_desc=%d",
-           ef_vi_receive_capacity(vi), ni->state->rxq_limit,
-           ci_netif_rx_vi_space(ni, vi), ef_vi_receive_fill_level(vi),
+           ef_vi_receive_capacity(vi), ci_netif_rx_intf_limit(ni, intf_i),
+           ci_netif_rx_intf_space(ni, intf_i), ef_vi_receive_fill_level(vi),
            vi->ep_state->rxq.removed);
+    if( NI_OPTS(ni).rxq_adapt )
+      logger(log_arg, "  rxq: adapt target=%d batch=%d rate=%u drain=%u "
+             "low=%u", nic->rxq_target, nic->rxq_batch, nic->rxq_adapt_rate,
+             nic->rxq_adapt_drain, nic->rxq_adapt_low);
+  }
 
   logger(log_arg, "  txq: cap=%d lim=%d spc=%d level=%d pkts=%d oflow_pkts=%d",
          ef_vi_transmit_capacity(vi), ef_vi_transmit_capacity(vi),
@@ -926,12 +976,15 @@ void ci_netif_dump_to_logger(ci_netif* ni, oo_dump_log_fn_t logger,
   if( ns->error_flags )
     logger(log_arg, "  ERRORS: "CI_NETIF_ERRORS_FMT,
            CI_NETIF_ERRORS_PRI_ARG(ns->error_flags));
+#if CI_CFG_TCPDUMP
   {
-    ci_uint16 dwi = ni->state->dump_write_i, dri = ni->state->dump_read_i;
-    if( dwi != dri )
-      logger(log_arg, "  tcpdump: %d/%d packets in queue (wr=%u rd=%u)",
-             (int)(ci_uint16) (dwi - dri), CI_CFG_DUMPQUEUE_LEN, dwi, dri);
+    ci_uint32 dwi = ns->dump_write_i, dri = ns->dump_read_i;
+    if( dwi != dri || ns->dump_filter_len != 0 )
+      logger(log_arg, "  tcpdump: %u/%u packets in queue (wr=%u rd=%u "
+             "free=%u) filter=%u insns", dwi - dri, NI_OPTS(ni).tcpdump_ring,
+             dwi, dri, ns->dump_free_i, ns->dump_filter_len);
   }
+#endif
 
 #if CI_CFG_FD_CACHING
   logger(log_arg, "  active cache: hit=%d avail=%d cache=%s pending=%s",
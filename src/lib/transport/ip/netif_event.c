@@ -102,14 +102,21 @@ static int ci_tcp_csum_correct(ci_ip_pkt_fmt* pkt, int ip_paylen)
   ci_tcp_hdr* tcp = ipx_hdr_data(af, ipx);
   int tcp_hlen = CI_TCP_HDR_LEN(tcp);
   int tcp_paylen = ip_paylen - tcp_hlen;
+  ci_iovec payload;
+  ci_uint16 payload_sum;
 
   if( tcp_hlen < sizeof(ci_tcp_hdr) )
     return 0;
   if( ip_paylen < tcp_hlen )
     return 0;
 
+  /* As ci_udp_sendmsg_chksum(): the payload goes through the bulk checksum
+   * engine, and ef_vi checks the headers and the payload's sum. */
+  CI_IOVEC_BASE(&payload) = CI_TCP_PAYLOAD(tcp);
+  CI_IOVEC_LEN(&payload) = tcp_paylen;
+  payload_sum = ci_ip_csum_iov16(&payload, 1);
   return ef_tcp_checksum_ipx_is_correct(af, ipx_hdr, (struct tcphdr*)tcp,
-                                        CI_TCP_PAYLOAD(tcp), tcp_paylen);
+                                        &payload_sum, sizeof(payload_sum));
 }
 
 
@@ -1897,8 +1904,9 @@ ci_inline int ci_netif_poll_intf(ci_netif* ni, int intf_i, int max_evs)
   /* The following steps probably aren't needed if we haven't handled any
    * events, but that is a rare case and so not worth testing for.
    */
-  if( ci_netif_rx_vi_space(ni, ci_netif_vi(ni, intf_i))
-      >= CI_CFG_RX_DESC_BATCH )
+  if( NI_OPTS(ni).rxq_adapt )
+    ci_netif_rx_adapt(ni, intf_i);
+  if( ci_netif_rx_want_post(ni, intf_i) )
     ci_netif_rx_post(ni, intf_i);
 
   if( ci_netif_dmaq_not_empty(ni, intf_i) )
@@ -2133,6 +2141,9 @@ void ci_netif_loopback_pkts_send(ci_netif* ni)
 int ci_netif_poll_n(ci_netif* netif, int max_evs)
 {
   int offset, intf_i, intf_max, n_evs_handled = 0;
+#if CI_CFG_STATS_NETIF
+  ci_uint64 poll_start;
+#endif
 
 #if defined(__KERNEL__) || ! defined(NDEBUG)
   if( netif->error_flags )
@@ -2149,6 +2160,9 @@ int ci_netif_poll_n(ci_netif* netif, int max_evs)
 #endif
 
   ci_ip_time_resync(IPTIMER_STATE(netif));
+#if CI_CFG_STATS_NETIF
+  poll_start = IPTIMER_STATE(netif)->frc;
+#endif
 #if CI_CFG_UL_INTERRUPT_HELPER && ! defined(__KERNEL__)
   ci_netif_handle_actions(netif);
 #endif
@@ -2215,6 +2229,11 @@ int ci_netif_poll_n(ci_netif* netif, int max_evs)
   }
 #endif
 
+  /* SO_TXTIME datagrams are released here as soon as they are due; the
+   * timer wheel only backs this up at tick resolution. */
+  if(CI_UNLIKELY( netif->state->udp_txtime_next != 0 ))
+    ci_udp_txtime_release(netif);
+
   /* Timer code can't use in-poll wakeup, since endpoints are out of
    * post-poll list.  So, poll timers after --in_poll. */
   ci_ip_timer_poll(netif);
@@ -2242,6 +2261,13 @@ int ci_netif_poll_n(ci_netif* netif, int max_evs)
 
   netif->state->poll_work_outstanding = 0;
 
+#if CI_CFG_STATS_NETIF
+  /* Polls that find nothing would swamp the histogram, so leave them out. */
+  if(CI_UNLIKELY( NI_OPTS(netif).latency_hist ) && n_evs_handled > 0 )
+    oo_lat_hist_add(&netif->state->lat_hist.poll, poll_start,
+                    ci_frc64_get());
+#endif
+
   /* returns the number of events handled */
   return n_evs_handled;
 }
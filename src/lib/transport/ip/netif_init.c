@@ -101,6 +101,11 @@ void ci_netif_state_init(ci_netif* ni, int cpu_khz, const char* name)
     oo_p_dllink_init(ni, link);
     oo_p_dllink_add(ni, list, link);
   }
+  for( i = 0; i < CI_CFG_DEFER_RING_SHARDS; i++ ) {
+    assert_zero(nis->defer_ring[i].head);
+    assert_zero(nis->defer_ring[i].tail);
+    assert_zero(nis->defer_ring[i].hole_state);
+  }
 
   ci_netif_filter_init(ni, ci_log2_le(ci_netif_filter_table_size(ni)));
 #if CI_CFG_IPV6
@@ -130,6 +135,13 @@ void ci_netif_state_init(ci_netif* ni, int cpu_khz, const char* name)
 
   oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &nis->reap_list));
 
+  oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &nis->udp_txtime_list));
+  nis->udp_txtime_next = 0;
+  ci_ip_timer_init(ni, &nis->udp_txtime_tid,
+                   oo_ptr_to_statep(ni, &nis->udp_txtime_tid),
+                   "udtx");
+  nis->udp_txtime_tid.fn = CI_IP_TIMER_UDP_TXTIME;
+
   nis->free_eps_head = OO_SP_NULL;
   nis->free_eps_num = 0;
   nis->deferred_free_eps_head = CI_ILL_END;
@@ -172,7 +184,11 @@ void ci_netif_state_init(ci_netif* ni, int cpu_khz, const char* name)
 #if CI_CFG_TCPDUMP
   nis->dump_read_i = 0;
   nis->dump_write_i = 0;
+  nis->dump_free_i = 0;
+  nis->dump_filter_len = 0;
   memset(nis->dump_intf, 0, sizeof(nis->dump_intf));
+  for( i = 0; i < NI_OPTS(ni).tcpdump_ring; i++ )
+    ni->dump_queue[i] = OO_PP_NULL;
 #endif
 
   nis->uuid = ci_current_from_kuid_munged(ni->kuid);
@@ -614,6 +630,16 @@ void ci_netif_config_opts_rangecheck(ci_netif_config_opts* opts)
 
   /* EF_MAX_ENDPOINTS should must be divisible by 2048 */
   round_opts("EF_MAX_ENDPOINTS", &opts->max_ep_bufs, EP_BUF_PER_CHUNK);
+
+#if CI_CFG_TCPDUMP
+  /* The capture ring is indexed with a mask */
+  if( ! CI_IS_POW2(opts->tcpdump_ring) ) {
+    ci_uint32 ring = 1u << ci_log2_ge(opts->tcpdump_ring, 0);
+    ci_log("config: EF_TCPDUMP_RING is rounded up from %u to %u",
+           opts->tcpdump_ring, ring);
+    opts->tcpdump_ring = ring;
+  }
+#endif
 }
 
 
@@ -862,6 +888,10 @@ void ci_netif_config_opts_getenv(ci_netif_config_opts* opts)
     opts->defer_arp_pkts = atoi(s);
   if ( (s = getenv("EF_DEFER_ARP_TIMEOUT")) )
     opts->defer_arp_timeout = atoi(s);
+#if CI_CFG_TCPDUMP
+  if ( (s = getenv("EF_TCPDUMP_RING")) )
+    opts->tcpdump_ring = atoi(s);
+#endif
   if ( (s = getenv("EF_SHARE_WITH")) )
     opts->share_with = atoi(s);
 #if CI_CFG_PKTS_AS_HUGE_PAGES
@@ -879,6 +909,10 @@ void ci_netif_config_opts_getenv(ci_netif_config_opts* opts)
     opts->rxq_size = atoi(s);
   if ( (s = getenv("EF_RXQ_LIMIT")) )
     opts->rxq_limit = atoi(s);
+  if ( (s = getenv("EF_RXQ_ADAPT")) )
+    opts->rxq_adapt = atoi(s);
+  if ( (s = getenv("EF_RXQ_ADAPT_BATCH_MAX")) )
+    opts->rxq_adapt_batch_max = atoi(s);
   if ( (s = getenv("EF_SHARED_RXQ_NUM")) )
     opts->shared_rxq_num = atoi(s);
   if ( (s = getenv("EF_TXQ_SIZE")) )
@@ -1227,6 +1261,13 @@ void ci_netif_config_opts_getenv(ci_netif_config_opts* opts)
     }
     opts->periodic_timer_cpu = cpu;
   }
+  if( (s = getenv("EF_STACK_PLACEMENT")) )
+    opts->stack_placement = atoi(s);
+
+#if CI_CFG_STATS_NETIF
+  if( (s = getenv("EF_LATENCY_HIST")) )
+    opts->latency_hist = atoi(s);
+#endif
 
   if( (s = getenv("EF_TCP_SYNCOOKIES")) )
     opts->tcp_syncookies = atoi(s);
@@ -1724,6 +1765,10 @@ static void netif_tcp_helper_build2(ci_netif* ni)
   ni->deferred_pkts =
     (struct oo_deferred_pkt*) ((char*) ni->state +
                                ni->state->deferred_pkts_ofs);
+#if CI_CFG_TCPDUMP
+  ni->dump_queue =
+    (oo_pkt_p*) ((char*) ni->state + ni->state->dump_queue_ofs);
+#endif
   ni->filter_table =
     (ci_netif_filter_table*) ((char*) ni->state + ni->state->table_ofs);
   ni->filter_table_ext =
@@ -3164,6 +3209,8 @@ int ci_netif_set_rxq_limit(ci_netif* ni)
     rxq_limit = 2 * CI_CFG_RX_DESC_BATCH + 1;
   }
   ni->state->rxq_limit = ni->state->rxq_base_limit = rxq_limit;
+  OO_STACK_FOR_EACH_INTF_I(ni, intf_i)
+    ci_netif_rx_adapt_init(ni, intf_i);
   return rc;
 }
 
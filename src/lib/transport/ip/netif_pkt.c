@@ -127,6 +127,34 @@ int ci_netif_pktset_best(ci_netif* ni)
 }
 
 
+/* As ci_netif_pktset_best(), but prefer a set whose buffers are on NUMA
+ * node [node], so that a NIC DMAs into memory that is local to it.  If no
+ * set on [node] has at least [min_free] free packets then the best set on
+ * any node is returned.  A negative [node] means no preference.
+ */
+int ci_netif_pktset_best_node(ci_netif* ni, int node, int min_free)
+{
+  int i, ret = -1, n_free = 0;
+
+  if( node < 0 || ! ni->packets->n_free )
+    return ci_netif_pktset_best(ni);
+
+  for( i = 0; i < ni->packets->sets_n; i ++ ) {
+    if( ni->packets->set[i].numa_node != node )
+      continue;
+    if( ni->packets->set[i].n_free > n_free ) {
+      n_free = ni->packets->set[i].n_free;
+      ret = i;
+    }
+    if( n_free >= CI_CFG_PKT_SET_HIGH_WATER )
+      return ret;
+  }
+  if( n_free >= min_free && ret != -1 )
+    return ret;
+  return ci_netif_pktset_best(ni);
+}
+
+
 ci_ip_pkt_fmt* ci_netif_pkt_alloc_slow_ptrerr(ci_netif* ni, int flags)
 {
   /* This is the slow path of ci_netif_pkt_alloc() and
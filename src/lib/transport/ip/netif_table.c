@@ -29,18 +29,30 @@
  * sends us down the fast lookup path, to be handled with as little fuss as
  * possible.  To this end, the two bits representing the state are packed into
  * the most significant bits of the __id_and_state field, and the value for
- * state C. is chosen to be zero to make promotion of the remaining 30 bits to
- * a 32-bit socket index a no-op. */
-#define FILTER_TABLE_ID_BITS    30
+ * state C. is chosen to be zero.
+ *
+ * Between the state and the socket id is a tag: eight bits of a hash of the
+ * full tuple.  A probe whose tag differs from that of the query can't match,
+ * so lookups look at the socket only for entries whose tag matches, rather
+ * than taking a cache miss on the socket state for every entry on the probe
+ * sequence.  For the first probe, the test of state and tag is a single
+ * comparison. */
+#define FILTER_TABLE_ID_BITS    22
 #define FILTER_TABLE_ID_MASK    ((1u << FILTER_TABLE_ID_BITS) - 1)
-#define FILTER_TABLE_STATE_MASK (~FILTER_TABLE_ID_MASK)
+#define FILTER_TABLE_TAG_SHIFT  FILTER_TABLE_ID_BITS
+#define FILTER_TABLE_TAG_MASK   (0xffu << FILTER_TABLE_TAG_SHIFT)
+#define FILTER_TABLE_STATE_SHIFT 30
+#define FILTER_TABLE_STATE_MASK (3u << FILTER_TABLE_STATE_SHIFT)
 enum {
   OCCUPIED_PREFERRED = 0,
-  OCCUPIED_REHASHED  = (1u << FILTER_TABLE_ID_BITS),
-  EMPTY              = (2u << FILTER_TABLE_ID_BITS),
-  TOMBSTONE          = (3u << FILTER_TABLE_ID_BITS),
+  OCCUPIED_REHASHED  = (1u << FILTER_TABLE_STATE_SHIFT),
+  EMPTY              = (2u << FILTER_TABLE_STATE_SHIFT),
+  TOMBSTONE          = (3u << FILTER_TABLE_STATE_SHIFT),
 };
 
+CI_BUILD_ASSERT(CI_CFG_NETIF_MAX_ENDPOINTS_MAX <= FILTER_TABLE_ID_MASK + 1);
+CI_BUILD_ASSERT((FILTER_TABLE_TAG_MASK & FILTER_TABLE_STATE_MASK) == 0);
+
 ci_inline ci_uint32 STATE(ci_netif_filter_table_entry_fast* entry)
 {
   return entry->__id_and_state & FILTER_TABLE_STATE_MASK;
@@ -62,15 +74,35 @@ ci_inline ci_uint32 ID(ci_netif_filter_table_entry_fast* entry)
 ci_inline void
 set_entry_state(ci_netif_filter_table_entry_fast* entry, ci_uint32 state)
 {
-  entry->__id_and_state = __CI_TBL_ID(entry) | state;
+  entry->__id_and_state = (entry->__id_and_state & ~FILTER_TABLE_STATE_MASK) |
+                          state;
+}
+
+/* The tag of a tuple, given its __onload_hash3(), positioned as it is in
+ * __id_and_state.  hash1 is made from the low bits of the hash, so take the
+ * tag from a multiplicative hash of all of it, which depends mostly on the
+ * high bits. */
+ci_inline ci_uint32 filter_tag(ci_uint32 hash3)
+{
+  return ((hash3 * 0x9e3779b1u) >> 24) << FILTER_TABLE_TAG_SHIFT;
+}
+
+/* Returns true if [entry] is occupied and has tag [tag], as made by
+ * filter_tag(). */
+ci_inline int /*bool*/
+occupied_with_tag(ci_netif_filter_table_entry_fast* entry, ci_uint32 tag)
+{
+  return OCCUPIED(entry) &&
+         (entry->__id_and_state & FILTER_TABLE_TAG_MASK) == tag;
 }
 
 #if OO_DO_STACK_POLL
 ci_inline void
-set_entry_id(ci_netif_filter_table_entry_fast* entry, ci_uint32 id)
+set_entry_id(ci_netif_filter_table_entry_fast* entry, ci_uint32 id,
+             ci_uint32 tag)
 {
-  ci_assert_nflags(id, FILTER_TABLE_STATE_MASK);
-  entry->__id_and_state = STATE(entry) | id;
+  ci_assert_nflags(id, ~FILTER_TABLE_ID_MASK);
+  entry->__id_and_state = STATE(entry) | tag | id;
 }
 
 #define CI_NETIF_FILTER_ID_TO_SOCK_ID(ni, filter_id)            \
@@ -90,14 +122,16 @@ ci_ip4_netif_filter_lookup(ci_netif* netif, unsigned laddr, unsigned lport,
   unsigned hash1, hash2 = 0;
   ci_netif_filter_table* tbl;
   unsigned first;
+  ci_uint32 hash3, tag;
 
   ci_assert(netif);
   ci_assert(ci_netif_is_locked(netif));
   ci_assert(netif->filter_table);
 
   tbl = netif->filter_table;
-  hash1 = __onload_hash1(tbl->table_size_mask, laddr, lport,
-                       raddr, rport, protocol);
+  hash3 = __onload_hash3(laddr, lport, raddr, rport, protocol);
+  hash1 = hash3 & tbl->table_size_mask;
+  tag = filter_tag(hash3);
   first = hash1;
 
   LOG_NV(log("tbl_lookup: %s %s:%u->%s:%u hash=%u:%u at=%u",
@@ -115,7 +149,7 @@ ci_ip4_netif_filter_lookup(ci_netif* netif, unsigned laddr, unsigned lport,
     ci_netif_filter_table_entry_ext* entry_ext;
     entry_ext = &netif->filter_table_ext[hash1];
 
-    if( CI_LIKELY(OCCUPIED(entry)) ) {
+    if( occupied_with_tag(entry, tag) ) {
       ci_sock_cmn* s = ID_TO_SOCK(netif, ID(entry));
       if( ((laddr    - entry->laddr      ) |
 	   (lport    - entry_ext->lport  ) |
@@ -243,14 +277,16 @@ ci_netif_filter_for_each_match(ci_netif* ni,
   unsigned hash1, hash2 = 0;
   unsigned first, table_size_mask;
   ci_netif_filter_table_entry_fast* entry;
+  ci_uint32 hash3, tag;
 
   tbl = ni->filter_table;
   table_size_mask = tbl->table_size_mask;
 
+  hash3 = __onload_hash3(laddr, lport, raddr, rport, protocol);
   if( hash_out != NULL )
-    *hash_out = __onload_hash3(laddr, lport, raddr, rport, protocol);
-  hash1 = __onload_hash1(table_size_mask, laddr, lport, raddr, rport,
-                         protocol);
+    *hash_out = hash3;
+  hash1 = hash3 & table_size_mask;
+  tag = filter_tag(hash3);
   first = hash1;
 
   LOG_NV(log("%s: %s %s:%u->%s:%u hash=%u:%u at=%u",
@@ -279,7 +315,9 @@ ci_netif_filter_for_each_match(ci_netif* ni,
    * it. */
   ci_assert_ge(table_size_mask + 1, 1u << 16);
   entry = &tbl->table[hash1];
-  if( STATE(entry) == OCCUPIED_PREFERRED ) {
+  if( (entry->__id_and_state &
+       (FILTER_TABLE_STATE_MASK | FILTER_TABLE_TAG_MASK)) ==
+      (OCCUPIED_PREFERRED | tag) ) {
     /* We pass the entry in filter_table_ext here, but as check_lport is false
      * it won't be used, and moreover the inlining will drop it entirely. */
     if( handle_entry(ni, entry, &ni->filter_table_ext[hash1], laddr, lport,
@@ -308,7 +346,7 @@ ci_netif_filter_for_each_match(ci_netif* ni,
     }
     entry = &tbl->table[hash1];
     entry_ext = &ni->filter_table_ext[hash1];
-    if( OCCUPIED(entry) ) {
+    if( occupied_with_tag(entry, tag) ) {
       if( handle_entry(ni, entry, entry_ext, laddr, lport, raddr, rport,
                        protocol, intf_i, vlan, callback, callback_arg,
                        1 /*check_lport*/) )
@@ -334,9 +372,10 @@ ci_ip4_netif_filter_insert(ci_netif_filter_table* tbl,
   unsigned hops = 1;
 #endif
   unsigned first;
+  ci_uint32 hash3;
 
-  hash1 = __onload_hash1(tbl->table_size_mask, laddr, lport,
-                         raddr, rport, protocol);
+  hash3 = __onload_hash3(laddr, lport, raddr, rport, protocol);
+  hash1 = hash3 & tbl->table_size_mask;
   hash2 = __onload_hash2(laddr, lport, raddr, rport, protocol);
   first = hash1;
 
@@ -400,7 +439,7 @@ ci_ip4_netif_filter_insert(ci_netif_filter_table* tbl,
 
   set_entry_state(entry,
                   hash1 == first ? OCCUPIED_PREFERRED : OCCUPIED_REHASHED);
-  set_entry_id(entry, OO_SP_TO_INT(tcp_id));
+  set_entry_id(entry, OO_SP_TO_INT(tcp_id), filter_tag(hash3));
   entry->laddr = laddr;
   entry_ext->lport = lport;
   return 0;
@@ -709,7 +748,7 @@ void ci_netif_filter_dump(ci_netif* ni)
       unsigned hash2 = __onload_hash2(laddr, lport, raddr, rport, protocol);
       log("%010d state=%u id=%-10d rt_ct=%d %s "CI_IP_PRINTF_FORMAT":%d "
           CI_IP_PRINTF_FORMAT":%d %010d:%010d",
-          i, STATE(entry) >> FILTER_TABLE_ID_BITS, ID(entry),
+          i, STATE(entry) >> FILTER_TABLE_STATE_SHIFT, ID(entry),
           entry_ext->route_count, CI_IP_PROTOCOL_STR(protocol),
           CI_IP_PRINTF_ARGS(&laddr), CI_BSWAP_BE16(lport),
 	  CI_IP_PRINTF_ARGS(&raddr), CI_BSWAP_BE16(rport), hash1, hash2);
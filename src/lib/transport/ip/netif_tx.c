@@ -144,8 +144,10 @@ static void __ci_netif_dmaq_shove(ci_netif* ni, int intf_i, int is_fresh)
   /* If everything went out by CTPIO, there will be no outstanding DMA
    * descriptors to pushed, and we're finished.  Otherwise, we still need to
    * hit the doorbell for those DMA sends. */
-  if( ! posted_dma )
+  if( ! posted_dma ) {
+    ci_netif_lat_hist_tx_doorbell(ni);
     return;
+  }
 
   /* We're doing a DMA send, so there's no point attempting CTPIO now until
    * the TXQ has drained. */
@@ -154,6 +156,7 @@ static void __ci_netif_dmaq_shove(ci_netif* ni, int intf_i, int is_fresh)
 
   ef_vi_transmit_push(vi);
   CITP_STATS_NETIF_INC(ni, tx_dma_doorbells);
+  ci_netif_lat_hist_tx_doorbell(ni);
 }
 
 
@@ -233,6 +236,7 @@ void __ci_netif_send(ci_netif* netif, ci_ip_pkt_fmt* pkt)
             ci_assert(pkt->pio_addr == -1);
             pkt->pio_addr = offset;
             pkt->pio_order = order;
+            ci_netif_lat_hist_tx_doorbell(netif);
             return;
           }
           else {
@@ -280,6 +284,7 @@ void __ci_netif_send(ci_netif* netif, ci_ip_pkt_fmt* pkt)
     if( rc == 0 ) {
       LOG_AT(ci_analyse_pkt(oo_ether_hdr(pkt), pkt->buf_len));
       LOG_DT(ci_hex_dump(ci_log_fn, oo_ether_hdr(pkt), pkt->buf_len, 0));
+      ci_netif_lat_hist_tx_doorbell(netif);
       return;
     }
   }
@@ -291,5 +296,37 @@ void __ci_netif_send(ci_netif* netif, ci_ip_pkt_fmt* pkt)
   __ci_netif_dmaq_put(netif, dmaq, pkt);
 }
 
+
+void ci_netif_send_list(ci_netif* ni, ci_ip_pkt_fmt* head)
+{
+  ci_ip_pkt_fmt* pkt;
+  oo_pktq* dmaq;
+  ef_vi* vi;
+  int n, is_fresh;
+
+  /* A single packet may still go by PIO or CTPIO. */
+  if( OO_PP_IS_NULL(head->next) ) {
+    ci_netif_send(ni, head);
+    return;
+  }
+
+  pkt = head;
+  n = 0;
+  while( 1 ) {
+    ci_assert_equal(pkt->intf_i, head->intf_i);
+    __ci_netif_dmaq_insert_prep_pkt(ni, pkt);
+    pkt->netif.tx.dmaq_next = pkt->next;
+    ++n;
+    if( OO_PP_IS_NULL(pkt->next) )
+      break;
+    pkt = PKT_CHK(ni, pkt->next);
+  }
+
+  ci_netif_dmaq_and_vi_for_pkt(ni, head, &dmaq, &vi);
+  is_fresh = oo_pktq_is_empty(dmaq);
+  __oo_pktq_put_list(ni, dmaq, OO_PKT_P(head), pkt, n, netif.tx.dmaq_next);
+  ci_netif_dmaq_shove2(ni, head->intf_i, is_fresh);
+}
+
 #endif
 /*! \cidoxg_end */
@@ -19,6 +19,7 @@
 #include <aio.h>
 #include <resolv.h>
 #include <netdb.h>
+#include <sys/sendfile.h>
 
 #include <ci/tools.h>
 #include <ci/internal/transport_config_opt.h>
@@ -0,0 +1,297 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/**************************************************************************\
+*//*! \file
+** <L5_PRIVATE L5_SOURCE>
+**  \brief  TCP congestion control algorithms.
+** </L5_PRIVATE>
+*//*
+\**************************************************************************/
+
+/*! \cidoxg_lib_transport_ip */
+
+#include "ip_internal.h"
+
+#define LPF "TCP CONG "
+
+
+/**********************************************************************
+ * NewReno: RFC5681 congestion avoidance with appropriate byte counting
+ * (RFC3465).
+ */
+
+static void ci_tcp_reno_cong_avoid(ci_netif* ni, ci_tcp_state* ts,
+                                   unsigned acked)
+{
+  /* Hack - Increase less aggresively on small round trip times */
+#if CI_CFG_CONG_AVOID_SCALE_BACK
+  unsigned tmp = 0, cwnd_scaled;
+  /* tcp_srtt(ts) would relatively easy exceed 32 for a round trip time
+   * on longer links */
+  if( tcp_srtt(ts) < 32 )
+    tmp = NI_OPTS(ni).cong_avoid_scale_back >> tcp_srtt(ts);
+  cwnd_scaled = CI_MAX(1U, tmp) * ts->cwnd;
+#else
+  unsigned cwnd_scaled = ts->cwnd;
+#endif
+  /* Congestion avoidance.  RFC3465 says: increase the congestion window
+  ** by one segment each RTT.  i.e. wait for bytes_acked to be > cwnd
+  ** (which takes one RTT), then reset bytes_acked by subtracting the
+  ** cwnd from it, and add one segment to cwnd.
+  */
+  LOG_TV(log(LPF "%d OPENCWND: CA eff_mss=%u bytes_acked=%u cwnd=%u",
+             S_FMT(ts), tcp_eff_mss(ts), ts->bytes_acked, ts->cwnd));
+  if( ts->bytes_acked >= cwnd_scaled ) {
+    ts->bytes_acked -= cwnd_scaled;
+    ts->cwnd += tcp_eff_mss(ts);
+  }
+}
+
+
+static ci_uint32 ci_tcp_reno_ssthresh(ci_netif* ni, ci_tcp_state* ts)
+{
+  return ci_tcp_losswnd(ts);
+}
+
+
+static const struct ci_tcp_cong_ops ci_tcp_reno_ops = {
+  .name       = "reno",
+  .cong_avoid = ci_tcp_reno_cong_avoid,
+  .ssthresh   = ci_tcp_reno_ssthresh,
+};
+
+
+/**********************************************************************
+ * CUBIC (RFC9438).  The arithmetic follows the Linux implementation so
+ * that Onload and kernel sockets compete fairly with one another: time is
+ * in units of 2^-10 seconds and C = 410/1024 ~= 0.4.  HyStart is not
+ * implemented; slow start is shared with NewReno.
+ */
+
+#define CUBIC_BETA            717   /* multiplicative decrease, 0.7 * 1024 */
+#define CUBIC_BETA_SCALE      1024
+#define CUBIC_HZ              10
+#define CUBIC_C_SCALED        410
+#define CUBIC_CUBE_FACTOR \
+  ((1ull << (10 + 3 * CUBIC_HZ)) / CUBIC_C_SCALED)
+/* 8 * (1 + beta) / 3 / (1 - beta): Reno-friendly growth per RTT, << 3 */
+#define CUBIC_FRIENDLY_SCALE \
+  (8 * (CUBIC_BETA_SCALE + CUBIC_BETA) / 3 / (CUBIC_BETA_SCALE - CUBIC_BETA))
+/* Bound on |t - K| so that C * offs^3 fits in 64 bits (~128s). */
+#define CUBIC_MAX_OFFS        (1u << 17)
+
+
+/* Integer cube root, rounded down. */
+ci_uint32 ci_tcp_cubic_root(ci_uint64 a)
+{
+  ci_uint64 r = 0, b;
+  int s;
+
+  for( s = 63; s >= 0; s -= 3 ) {
+    r <<= 1;
+    b = 3 * r * (r + 1) + 1;
+    if( (a >> s) >= b ) {
+      a -= b << s;
+      ++r;
+    }
+  }
+  return (ci_uint32) r;
+}
+
+
+static void ci_tcp_cubic_init(ci_netif* ni, ci_tcp_state* ts)
+{
+  memset(&ts->cong.cubic, 0, sizeof(ts->cong.cubic));
+}
+
+
+static void ci_tcp_cubic_cong_avoid(ci_netif* ni, ci_tcp_state* ts,
+                                    unsigned acked)
+{
+  ci_tcp_cubic_state* ca = &ts->cong.cubic;
+  unsigned mss = tcp_eff_mss(ts);
+  ci_uint32 cwnd = ts->cwnd / mss;
+  ci_iptime_t now = ci_tcp_time_now(ni);
+  ci_uint64 t, offs, delta;
+  ci_uint32 target, cnt, friendly;
+
+  ca->ack_cnt += acked;
+  if( ca->epoch_start == 0 ) {
+    ca->epoch_start = now ? now : 1;
+    ca->ack_cnt = acked;
+    ca->tcp_cwnd = cwnd;
+    if( ca->last_max_cwnd <= cwnd ) {
+      ca->k = 0;
+      ca->origin_point = cwnd;
+    }
+    else {
+      ca->k = ci_tcp_cubic_root(CUBIC_CUBE_FACTOR *
+                                (ca->last_max_cwnd - cwnd));
+      ca->origin_point = ca->last_max_cwnd;
+    }
+  }
+
+  /* The window we choose now takes effect one RTT from now. */
+  t = ci_ip_time_ticks2ms(ni, now - ca->epoch_start + tcp_srtt(ts));
+  t = (t << CUBIC_HZ) / 1000;
+  offs = t < ca->k ? ca->k - t : t - ca->k;
+  offs = CI_MIN(offs, (ci_uint64) CUBIC_MAX_OFFS);
+  delta = (CUBIC_C_SCALED * offs * offs * offs) >> (10 + 3 * CUBIC_HZ);
+  if( t >= ca->k )
+    target = ca->origin_point + delta;
+  else if( delta < ca->origin_point )
+    target = ca->origin_point - delta;
+  else
+    target = 0;
+
+  /* [cnt] is the number of segments to be acked per segment of growth. */
+  if( target > cwnd )
+    cnt = cwnd / (target - cwnd);
+  else
+    cnt = 100 * cwnd;
+  if( ca->last_max_cwnd == 0 && cnt > 20 )
+    cnt = 20;
+
+  /* Don't grow more slowly than NewReno would with the same beta. */
+  friendly = ((cwnd * CUBIC_FRIENDLY_SCALE) >> 3) * mss;
+  while( friendly != 0 && ca->ack_cnt > friendly ) {
+    ca->ack_cnt -= friendly;
+    ++ca->tcp_cwnd;
+  }
+  if( ca->tcp_cwnd > cwnd )
+    cnt = CI_MIN(cnt, cwnd / (ca->tcp_cwnd - cwnd));
+  cnt = CI_MAX(cnt, 2u);
+
+  LOG_TV(log(LPF "%d OPENCWND: CUBIC cwnd=%u target=%u cnt=%u k=%u t=%u",
+             S_FMT(ts), cwnd, target, cnt, ca->k, (unsigned) t));
+  /* As Linux, credit that built up while [cnt] was larger earns just one
+   * segment, so that a drop in [cnt] does not release a burst of growth. */
+  if( ts->bytes_acked - acked >= cnt * mss ) {
+    ts->bytes_acked = acked;
+    ts->cwnd += mss;
+  }
+  if( ts->bytes_acked >= cnt * mss ) {
+    unsigned inc = ts->bytes_acked / (cnt * mss);
+    ts->bytes_acked -= inc * cnt * mss;
+    ts->cwnd += inc * mss;
+  }
+}
+
+
+static ci_uint32 ci_tcp_cubic_ssthresh(ci_netif* ni, ci_tcp_state* ts)
+{
+  ci_tcp_cubic_state* ca = &ts->cong.cubic;
+  unsigned mss = tcp_eff_mss(ts);
+  ci_uint32 cwnd = ts->cwnd / mss;
+
+  ca->epoch_start = 0;
+  /* Fast convergence: release bandwidth to newer flows. */
+  if( cwnd < ca->last_max_cwnd )
+    ca->last_max_cwnd = cwnd * (CUBIC_BETA_SCALE + CUBIC_BETA) /
+                        (2 * CUBIC_BETA_SCALE);
+  else
+    ca->last_max_cwnd = cwnd;
+
+  return CI_MAX(cwnd * CUBIC_BETA / CUBIC_BETA_SCALE, 2u) * mss;
+}
+
+
+static void ci_tcp_cubic_event(ci_netif* ni, ci_tcp_state* ts, int ev)
+{
+  /* As Linux, forget the previous W_max after a timeout. */
+  if( ev == CI_TCP_CONG_EV_RTO )
+    ci_tcp_cubic_init(ni, ts);
+}
+
+
+static const struct ci_tcp_cong_ops ci_tcp_cubic_ops = {
+  .name       = "cubic",
+  .init       = ci_tcp_cubic_init,
+  .cong_avoid = ci_tcp_cubic_cong_avoid,
+  .ssthresh   = ci_tcp_cubic_ssthresh,
+  .event      = ci_tcp_cubic_event,
+};
+
+
+/**********************************************************************
+ * Algorithm selection and logging.
+ */
+
+const struct ci_tcp_cong_ops* const
+ci_tcp_cong_ops_tbl[CI_TCP_CONG_ALG_N] = {
+  [CI_TCP_CONG_ALG_RENO]  = &ci_tcp_reno_ops,
+  [CI_TCP_CONG_ALG_CUBIC] = &ci_tcp_cubic_ops,
+};
+
+
+int ci_tcp_cong_alg_lookup(const char* name, int len)
+{
+  int alg;
+
+  for( alg = 0; alg < CI_TCP_CONG_ALG_N; ++alg ) {
+    const char* alg_name = ci_tcp_cong_ops_tbl[alg]->name;
+    int n = strlen(alg_name);
+    /* The name from TCP_CONGESTION need not be nul-terminated. */
+    if( len >= n && ! memcmp(name, alg_name, n) &&
+        (len == n || name[n] == '\0') )
+      return alg;
+  }
+  return -ENOENT;
+}
+
+
+void ci_tcp_cong_set_alg(ci_netif* ni, ci_tcp_state* ts, int alg)
+{
+  /* The listener's copy in [c->cong_alg] is shared state; don't trust it. */
+  if(CI_UNLIKELY( (unsigned) alg >= CI_TCP_CONG_ALG_N ))
+    alg = CI_TCP_CONG_ALG_RENO;
+  ts->c.cong_alg = alg;
+  if( ci_tcp_cong_ops(ts)->init != NULL )
+    ci_tcp_cong_ops(ts)->init(ni, ts);
+}
+
+
+void ci_tcp_cong_event(ci_netif* ni, ci_tcp_state* ts, int ev)
+{
+  struct oo_tcp_cong_log* cl = &ni->state->tcp_cong_log;
+  struct oo_tcp_cong_log_entry* e;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  e = &cl->ent[cl->n++ % CI_TCP_CONG_LOG_LEN];
+  e->sock = S_SP(ts);
+  e->time = ci_tcp_time_now(ni);
+  e->cwnd = ts->cwnd;
+  e->ssthresh = ts->ssthresh;
+  e->event = ev;
+  e->alg = ts->c.cong_alg;
+  ts->cong_sample_t = e->time;
+
+  if( ev != CI_TCP_CONG_EV_SAMPLE && ci_tcp_cong_ops(ts)->event != NULL )
+    ci_tcp_cong_ops(ts)->event(ni, ts, ev);
+}
+
+
+void ci_tcp_cong_log_dump(ci_netif* ni, oo_sp sock,
+                          oo_dump_log_fn_t logger, void* log_arg)
+{
+  static const char* const ev_str[] = { "sample", "loss", "rto" };
+  const struct oo_tcp_cong_log* cl = &ni->state->tcp_cong_log;
+  ci_uint32 n = cl->n;
+  ci_uint32 i = n > CI_TCP_CONG_LOG_LEN ? n - CI_TCP_CONG_LOG_LEN : 0;
+
+  for( ; i != n; ++i ) {
+    const struct oo_tcp_cong_log_entry* e = &cl->ent[i % CI_TCP_CONG_LOG_LEN];
+    if( OO_SP_NOT_NULL(sock) && ! OO_SP_EQ(e->sock, sock) )
+      continue;
+    logger(log_arg, "  cong: %08x %d:%d %-5s %-6s cwnd=%u ssthresh=%u",
+           e->time, NI_ID(ni), OO_SP_FMT(e->sock),
+           e->alg < CI_TCP_CONG_ALG_N ?
+             ci_tcp_cong_ops_tbl[e->alg]->name : "?",
+           e->event < sizeof(ev_str) / sizeof(ev_str[0]) ?
+             ev_str[e->event] : "?",
+           e->cwnd, e->ssthresh);
+  }
+}
+
+/*! \cidoxg_end */
@@ -795,6 +795,20 @@ void ci_tcp_state_dump(ci_netif* ni, ci_tcp_state* ts,
   logger(log_arg, "%s  snd: limited rwnd=%d cwnd=%d nagle=%d more=%d app=%d",
          pf, stats.tx_stop_rwnd, stats.tx_stop_cwnd, stats.tx_stop_nagle,
          stats.tx_stop_more, stats.tx_stop_app);
+  if( NI_OPTS(ni).tcp_pacing ||
+      ts->c.max_pacing_rate != OO_TCP_PACING_RATE_UNLIMITED )
+    logger(log_arg, "%s  snd: pacing rate=%"CI_PRIu64" max=%"CI_PRIu64
+           " limited=%d held_us=%u%s", pf, ci_tcp_pacing_rate(ni, ts),
+           ts->c.max_pacing_rate, stats.tx_stop_pacing,
+           stats.tx_pacing_held_us, ts->pacing_hold_frc ? " HOLD":"");
+  logger(log_arg, "%s  cong: alg=%s", pf, ci_tcp_cong_ops(ts)->name);
+  if( ts->c.cong_alg == CI_TCP_CONG_ALG_CUBIC )
+    logger(log_arg, "%s  cong: w_max=%u origin=%u k=%u epoch=%08x "
+           "tcp_cwnd=%u ack_cnt=%u", pf, ts->cong.cubic.last_max_cwnd,
+           ts->cong.cubic.origin_point, ts->cong.cubic.k,
+           ts->cong.cubic.epoch_start, ts->cong.cubic.tcp_cwnd,
+           ts->cong.cubic.ack_cnt);
+  ci_tcp_cong_log_dump(ni, S_SP(ts), logger, log_arg);
 #if CI_CFG_TAIL_DROP_PROBE
   if( ts->tcpflags & CI_TCPT_FLAG_TAIL_DROP_MARKED )
     logger(log_arg, "%s  snd: tail loss probe at %x", pf, ts->taildrop_mark);
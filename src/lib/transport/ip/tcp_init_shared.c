@@ -44,6 +44,7 @@ static void ci_tcp_state_setup_timers(ci_netif* ni, ci_tcp_state* ts)
   ci_tcp_setup_timer(stats,    CI_IP_TIMER_TCP_STATS,  "stat");
 #endif
   ci_tcp_setup_timer(cork,     CI_IP_TIMER_TCP_CORK,   "cork");
+  ci_tcp_setup_timer(pacing,   CI_IP_TIMER_TCP_PACING, "pace");
 
 #undef ci_tcp_setup_timer
 }
@@ -212,6 +213,10 @@ static void ci_tcp_state_tcb_reinit(ci_netif* netif, ci_tcp_state* ts,
   ts->burst_window = 0;
 #endif
 
+  /* Pacing */
+  ts->pacing_edt = 0;
+  ts->pacing_hold_frc = 0;
+
   /* congestion window validation RFC2861 */
 #if CI_CFG_CONGESTION_WINDOW_VALIDATION
   ts->t_last_sent = ci_tcp_time_now(netif);
@@ -225,6 +230,11 @@ static void ci_tcp_state_tcb_reinit(ci_netif* netif, ci_tcp_state* ts,
 
   /* TCP_MAXSEG */
   ts->c.user_mss = 0;
+  /* SO_MAX_PACING_RATE */
+  ts->c.max_pacing_rate = OO_TCP_PACING_RATE_UNLIMITED;
+  /* TCP_CONGESTION */
+  ci_tcp_cong_set_alg(netif, ts, NI_OPTS(netif).tcp_congestion);
+  ts->cong_sample_t = ci_tcp_time_now(netif);
   ts->amss = 0;
   ts->eff_mss = 0;
 
@@ -188,6 +188,7 @@ void ci_tcp_state_verify_no_timers(ci_netif *ni, ci_tcp_state *ts)
   chk(zwin_tid);
   chk(kalive_tid);
   chk(cork_tid);
+  chk(pacing_tid);
 #if CI_CFG_TCP_SOCK_STATS
   chk(stats_tid);
 #endif
@@ -574,6 +575,7 @@ void ci_tcp_stop_timers(ci_netif* netif, ci_tcp_state* ts)
   ci_ip_timer_clear_ool(netif, &ts->zwin_tid);
   ci_ip_timer_clear_ool(netif, &ts->kalive_tid);
   ci_ip_timer_clear_ool(netif, &ts->cork_tid);
+  ci_ip_timer_clear_ool(netif, &ts->pacing_tid);
   if( OO_PP_NOT_NULL(ts->pmtus) ) {
     ci_pmtu_state_t* pmtus = ci_ni_aux_p2pmtus(netif, ts->pmtus);
     ci_ip_timer_clear_ool(netif, &pmtus->tid);
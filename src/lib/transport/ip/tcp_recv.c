@@ -13,6 +13,8 @@
 
 /*! \cidoxg_lib_transport_ip */
 
+#define _GNU_SOURCE  /* for recvmmsg */
+
 #include "ip_internal.h"
 #include "ip_tx_cmsg.h"
 #include <ci/internal/ip_timestamp.h>
@@ -377,6 +379,10 @@ ci_tcp_recvmsg_get_impl(struct tcp_recv_info *rinf)
      */
     ci_assert_nflags(rinf->a->flags, ONLOAD_MSG_ONEPKT);
   }
+  else if( ! (rinf->a->flags & MSG_PEEK) ) {
+    /* One sample per call, for the oldest packet it returns. */
+    ci_netif_lat_hist_rx(netif, pkt->tstamp_frc);
+  }
 
   while( 1 ) {
     PKT_TCP_RX_BUF_ASSERT_VALID(netif, pkt);
@@ -584,6 +590,21 @@ static inline void ci_tcp_recvmsg_init_piov(struct tcp_recv_info* rinf)
   }
 }
 
+/* Drop the socket lock at the end of a receive. */
+ci_inline void ci_tcp_recvmsg_unlock(ci_netif* ni, ci_tcp_state* ts)
+{
+  /* If we've received FIN and RXQ is empty, let's reap it.
+   * See the counterpart in ci_tcp_rx_process_fin(), if FIN arrives with
+   * the empty receive queue. */
+  if( ( ( (ts->s.b.state & CI_TCP_STATE_RECVD_FIN) && tcp_rcv_usr(ts) == 0 )
+        || ni->state->mem_pressure ) && ci_netif_trylock(ni) ) {
+    ci_tcp_rx_reap_rxq_bufs_socklocked(ni, ts);
+    ci_netif_unlock(ni);
+  }
+
+  ci_sock_unlock(ni, &ts->s.b);
+}
+
 __attribute__((always_inline))
 static inline int ci_tcp_recvmsg_impl(const ci_tcp_recvmsg_args* a,
                                       pkt_copy_t copier,
@@ -924,17 +945,7 @@ static inline int ci_tcp_recvmsg_impl(const ci_tcp_recvmsg_args* a,
                            &a->msg->msg_namelen);  /*!\TODO fixme remove cast*/
 #endif
  unlock_out:
-
-  /* If we've received FIN and RXQ is empty, let's reap it.
-   * See the counterpart in ci_tcp_rx_process_fin(), if FIN arrives with
-   * the empty receive queue. */
-  if( ( ( (ts->s.b.state & CI_TCP_STATE_RECVD_FIN) && tcp_rcv_usr(ts) == 0 )
-        || ni->state->mem_pressure ) && ci_netif_trylock(ni) ) {
-    ci_tcp_rx_reap_rxq_bufs_socklocked(ni, ts);
-    ci_netif_unlock(ni);
-  }
-
-  ci_sock_unlock(ni, &ts->s.b);
+  ci_tcp_recvmsg_unlock(ni, ts);
  out:
   if(CI_UNLIKELY( ni->state->rxq_low ))
     ci_netif_rxq_low_on_recv(ni, &ts->s, rinf.rc);
@@ -958,6 +969,72 @@ int ci_tcp_recvmsg(const ci_tcp_recvmsg_args* a
 }
 
 
+#ifndef __KERNEL__
+/* recvmmsg() returns one segment per message.  The first message is an
+** ordinary ONLOAD_MSG_ONEPKT receive, so may block or spin as recv() would.
+** Any further segments that are already queued then go into the following
+** messages under a single grab of the socket lock.  We don't wait for
+** more, so this behaves as if MSG_WAITFORONE were given.
+*/
+int ci_tcp_recvmmsg(ci_netif* ni, ci_tcp_state* ts, struct mmsghdr* mmsg,
+                    unsigned int vlen, int flags)
+{
+  ci_tcp_recvmsg_args a;
+  struct tcp_recv_info rinf;
+  struct msghdr* msg;
+  unsigned i;
+  int rc, bytes = 0;
+
+  ci_assert_nflags(flags, MSG_PEEK | MSG_OOB | MSG_ERRQUEUE | MSG_WAITALL);
+
+  flags |= ONLOAD_MSG_ONEPKT;
+  ci_tcp_recvmsg_args_init(&a, ni, ts, &mmsg[0].msg_hdr, flags);
+  rc = ci_tcp_recvmsg(&a);
+  if( rc < 0 )
+    return rc;
+  mmsg[0].msg_len = rc;
+  if( rc == 0 || vlen == 1 || tcp_rcv_usr(ts) == 0 )
+    return 1;
+
+  if( ci_sock_lock(ni, &ts->s.b) != 0 )
+    return 1;
+
+  rinf.stack_locked = 0;
+  rinf.a = &a;
+  rinf.copier = copy_one_pkt;
+  rinf.zc_args = NULL;
+  for( i = 1; i < vlen; ++i ) {
+    msg = &mmsg[i].msg_hdr;
+    /* Urgent data is left for a full recvmsg() to deal with. */
+    if( msg->msg_iov == NULL || msg->msg_iovlen == 0 ||
+        OO_PP_NOT_NULL(ts->recv2.head) )
+      break;
+
+    ci_tcp_recvmsg_args_init(&a, ni, ts, msg, flags);
+    rinf.rc = 0;
+    rinf.msg_flags = 0;
+    rinf.controllen = msg->msg_controllen;
+    msg->msg_controllen = 0;
+    ci_tcp_recvmsg_init_piov(&rinf);
+    rinf.rc = ci_tcp_recvmsg_get_outofline(&rinf);
+    if( rinf.rc == 0 ) {
+      msg->msg_controllen = rinf.controllen;
+      break;
+    }
+    ci_tcp_recv_fill_msgname(ts, (struct sockaddr*) msg->msg_name,
+                             &msg->msg_namelen);
+    msg->msg_flags = rinf.msg_flags;
+    mmsg[i].msg_len = rinf.rc;
+    bytes += rinf.rc;
+  }
+  ci_tcp_recvmsg_unlock(ni, ts);
+  if(CI_UNLIKELY( ni->state->rxq_low ))
+    ci_netif_rxq_low_on_recv(ni, &ts->s, bytes);
+  return i;
+}
+#endif
+
+
 static void move_from_recv2_to_recv1(ci_netif* ni, ci_tcp_state* ts,
                                      ci_ip_pkt_fmt* head,
                                      ci_ip_pkt_fmt* tail, int n)
@@ -780,9 +780,10 @@ ci_inline unsigned ci_tcp_paws_check(ci_netif* netif, ci_uint32 tsval,
 
 
 /* function to open the congestion window following the
-** reception of an ack for new data. Implements RFC3465 (ABC)
+** reception of an ack for new data.  Slow start implements RFC3465 (ABC);
+** congestion avoidance is delegated to the socket's algorithm.
 */
-ci_inline void ci_tcp_opencwnd(ci_netif *ni, ci_tcp_state* ts)
+ci_inline void ci_tcp_opencwnd(ci_netif *ni, ci_tcp_state* ts, unsigned acked)
 {
 #if CI_CFG_CONG_AVOID_NOTIFIED
   /* If congestion has been notified (but no loss detected yet)
@@ -794,28 +795,7 @@ ci_inline void ci_tcp_opencwnd(ci_netif *ni, ci_tcp_state* ts)
   else
 #endif
   if( ts->cwnd >= ts->ssthresh ) {
-    /* Hack - Increase less aggresively on small round trip times */
-#if CI_CFG_CONG_AVOID_SCALE_BACK
-    unsigned tmp = 0, cwnd_scaled;
-    /* tcp_srtt(ts) would relatively easy exceed 32 for a round trip time
-     * on longer links */
-    if( tcp_srtt(ts) < 32 )
-      tmp = NI_OPTS(ni).cong_avoid_scale_back >> tcp_srtt(ts);
-    cwnd_scaled = CI_MAX(1U, tmp) * ts->cwnd;
-#else
-    unsigned cwnd_scaled = ts->cwnd;
-#endif
-    /* Congestion avoidance.  RFC3465 says: increase the congestion window
-    ** by one segment each RTT.  i.e. wait for bytes_acked to be > cwnd
-    ** (which takes one RTT), then reset bytes_acked by subtracting the
-    ** cwnd from it, and add one segment to cwnd.
-    */
-    LOG_TV(log(LPF "%d OPENCWND: CA eff_mss=%u bytes_acked=%u cwnd=%u",
-               S_FMT(ts), tcp_eff_mss(ts), ts->bytes_acked, ts->cwnd));
-    if( ts->bytes_acked >= cwnd_scaled ) {
-      ts->bytes_acked -= cwnd_scaled;
-      ts->cwnd += tcp_eff_mss(ts);
-    }
+    ci_tcp_cong_ops(ts)->cong_avoid(ni, ts, acked);
   }
   else {
     /* Slow-start. */
@@ -842,6 +822,10 @@ ci_inline void ci_tcp_opencwnd(ci_netif *ni, ci_tcp_state* ts)
 
   LOG_TV(log(LPF "%d OPENCWND: end cwnd=%u", S_FMT(ts), ts->cwnd));
 
+  /* Record the cwnd/ssthresh trajectory about once per RTT. */
+  if( ci_tcp_time_now(ni) - ts->cong_sample_t > tcp_srtt(ts) )
+    ci_tcp_cong_event(ni, ts, CI_TCP_CONG_EV_SAMPLE);
+
   ci_assert_le(tcp_eff_mss(ts), CI_MAX_ETH_FRAME_LEN);
   ci_assert_ge(ts->cwnd, tcp_eff_mss(ts));
   ci_assert_ge(ts->ssthresh, (ci_uint32)(tcp_eff_mss(ts) << 1));
@@ -850,7 +834,7 @@ ci_inline void ci_tcp_opencwnd(ci_netif *ni, ci_tcp_state* ts)
 
 static void ci_tcp_reset_cwnd_on_loss(ci_netif* ni, ci_tcp_state* ts)
 {
-  ts->ssthresh = ci_tcp_losswnd(ts);
+  ts->ssthresh = ci_tcp_cong_ops(ts)->ssthresh(ni, ts);
   ts->cwnd = ts->ssthresh + ci_tcp_base_dupack_thresh(ts) * tcp_eff_mss(ts);
   ts->cwnd = CI_MAX(ts->cwnd, NI_OPTS(ni).loss_min_cwnd);
   ts->cwnd = CI_MAX(ts->cwnd, NI_OPTS(ni).min_cwnd);
@@ -932,6 +916,7 @@ int /*bool*/ ci_tcp_maybe_enter_fast_recovery(ci_netif* ni, ci_tcp_state* ts)
              LNT_PRI_ARGS(ni, ts), TCP_CONG_PRI_ARG(ts)));
 
   ts->congstate = CI_TCP_CONG_FAST_RECOV;
+  ci_tcp_cong_event(ni, ts, CI_TCP_CONG_EV_LOSS);
 
   if( ts->tcpflags & CI_TCPT_FLAG_SACK )
     ci_tcp_retrans_recover(ni, ts, 1);
@@ -1641,7 +1626,7 @@ static void ci_tcp_rx_handle_ack(ci_tcp_state* ts, ci_netif* netif,
 
     /* Open the congestion window. */
     ts->bytes_acked += acked;
-    ci_tcp_opencwnd(netif, ts);
+    ci_tcp_opencwnd(netif, ts, acked);
 
     /* New acknowledgement clears any dup_acks. */
     ts->dup_acks = 0;
@@ -1868,12 +1868,10 @@ static int ci_tcp_send_via_prequeue(ci_netif* ni, ci_tcp_state* ts,
   return 1;
 }
 
-/* It is not safe to call this function while holding the netif lock */
-/*! \todo Confirm */
-int ci_tcp_sendmsg(ci_netif* ni, ci_tcp_state* ts,
-                   const ci_iovec* iov, unsigned long iovlen,
-                   int flags 
-                   CI_KERNEL_ARG(ci_addr_spc_t addr_spc))
+static int __ci_tcp_sendmsg(ci_netif* ni, ci_tcp_state* ts,
+                            const ci_iovec* iov, unsigned long iovlen,
+                            int flags
+                            CI_KERNEL_ARG(ci_addr_spc_t addr_spc))
 {
   ci_ip_pkt_queue* sendq = &ts->send;
   ci_ip_pkt_fmt* pkt;
@@ -2246,6 +2244,21 @@ int ci_tcp_sendmsg(ci_netif* ni, ci_tcp_state* ts,
 }
 
 
+/* It is not safe to call this function while holding the netif lock */
+/*! \todo Confirm */
+int ci_tcp_sendmsg(ci_netif* ni, ci_tcp_state* ts,
+                   const ci_iovec* iov, unsigned long iovlen,
+                   int flags 
+                   CI_KERNEL_ARG(ci_addr_spc_t addr_spc))
+{
+  int rc;
+  ci_netif_lat_hist_send_begin(ni);
+  rc = __ci_tcp_sendmsg(ni, ts, iov, iovlen, flags CI_KERNEL_ARG(addr_spc));
+  ci_netif_lat_hist_send_end(ni);
+  return rc;
+}
+
+
 #ifndef __KERNEL__
 /* 
  * TODO:
@@ -137,11 +137,15 @@ ci_tcp_info_get(ci_netif* netif, ci_sock_cmn* s, struct ci_tcp_info* uinfo,
     }
     info.tcpi_total_retrans = ts->stats.total_retrans;
 
-    /* Starting from linux-3.15, there are tcpi_pacing_rate and
-     * tcpi_max_pacing_rate fields.  However, as Onload does not support
-     * pacing, we might as well pretend that we simulate older kernel
-     * with smaller tcp_info size. */
+
+    info.tcpi_pacing_rate = ci_tcp_pacing_rate(netif, ts);
+    if( info.tcpi_pacing_rate == 0 )
+      info.tcpi_pacing_rate = OO_TCP_PACING_RATE_UNLIMITED;
+  }
+  else {
+    info.tcpi_pacing_rate = OO_TCP_PACING_RATE_UNLIMITED;
   }
+  info.tcpi_max_pacing_rate = SOCK_TO_WAITABLE_OBJ(s)->tcp.c.max_pacing_rate;
 
   if( *optlen > sizeof(info) )
     *optlen = sizeof(info);
@@ -224,6 +228,18 @@ int ci_get_sol_tcp(ci_netif* netif, ci_sock_cmn* s, int optname, void *optval,
         u = ci_tcp_is_in_faststart(SOCK_TO_TCP(s));
       goto u_out;
     }
+  case TCP_CONGESTION:
+    {
+      /* As Linux: the name is returned in a nul-padded buffer of
+       * TCP_CA_NAME_MAX bytes, truncated to the caller's length. */
+      char name[TCP_CA_NAME_MAX];
+      memset(name, 0, sizeof(name));
+      strncpy(name, ci_tcp_cong_alg_ops(c->cong_alg)->name,
+              sizeof(name) - 1);
+      *optlen = CI_MIN(*optlen, (socklen_t) sizeof(name));
+      memcpy(optval, name, *optlen);
+      return 0;
+    }
   default:
 #ifndef __KERNEL__
     LOG_TC( log(LPF "getsockopt: unimplemented or bad option: %i", 
@@ -271,6 +287,17 @@ int ci_tcp_getsockopt(citp_socket* ep, ci_fd_t fd, int level,
       ci_tcp_set_sndbuf_from_sndbuf_pkts(netif, ts);
     }
 
+    if( optname == SO_MAX_PACING_RATE ) {
+      ci_tcp_socket_cmn* c = &(SOCK_TO_WAITABLE_OBJ(s)->tcp.c);
+      unsigned u;
+      /* As Linux: 64-bit value if there is room for it, else saturate. */
+      if( *optlen >= sizeof(ci_uint64) )
+        return ci_getsockopt_final(optval, optlen, SOL_SOCKET,
+                                   &c->max_pacing_rate, sizeof(ci_uint64));
+      u = CI_MIN(c->max_pacing_rate, (ci_uint64) 0xffffffffu);
+      return ci_getsockopt_final(optval, optlen, SOL_SOCKET, &u, sizeof(u));
+    }
+
     /* Common SOL_SOCKET handler */
     return ci_get_sol_socket(netif, s, optname, optval, optlen);
 
@@ -346,6 +373,23 @@ static int ci_tcp_setsockopt_lk(citp_socket* ep, ci_fd_t fd, int level,
       }
       break;
 
+    case SO_MAX_PACING_RATE:
+      /* Rate in bytes per second.  As Linux, a 64-bit value is accepted,
+       * and ~0U as a 32-bit value means unlimited.  The pacer itself is
+       * in ci_tcp_tx_advance_to(). */
+      if( optlen >= sizeof(ci_uint64) ) {
+        c->max_pacing_rate = *(ci_uint64*) optval;
+      }
+      else {
+        if( (rc = opt_not_ok(optval, optlen, unsigned)) )
+          goto fail_inval;
+        if( *(unsigned*) optval == ~0u )
+          c->max_pacing_rate = OO_TCP_PACING_RATE_UNLIMITED;
+        else
+          c->max_pacing_rate = *(unsigned*) optval;
+      }
+      break;
+
     default:
       {
         /* Common socket level options */
@@ -362,6 +406,28 @@ static int ci_tcp_setsockopt_lk(citp_socket* ep, ci_fd_t fd, int level,
     return ci_set_sol_ip6(netif, s, optname, optval, optlen);
   }
   else if( level == IPPROTO_TCP ) {
+    if( optname == TCP_CONGESTION ) {
+      /* The only option here that is not an int: the algorithm name. */
+      int alg;
+      if( optval == NULL ) {
+        rc = -EFAULT;
+        goto fail_inval;
+      }
+      if( (alg = ci_tcp_cong_alg_lookup(optval, optlen)) < 0 ) {
+        rc = alg;
+        goto fail_inval;
+      }
+      if( (unsigned) alg >= CI_TCP_CONG_ALG_N ) {
+        rc = -EINVAL;
+        goto fail_inval;
+      }
+      if( s->b.state == CI_TCP_LISTEN )
+        c->cong_alg = alg;
+      else
+        ci_tcp_cong_set_alg(netif, SOCK_TO_TCP(s), alg);
+      return 0;
+    }
+
     /* These are ints values */
     if( (rc = opt_not_ok(optval, optlen, int)) )
       goto fail_inval;
@@ -852,6 +918,11 @@ static int ci_tcp_sync_tcp_sockopts(ci_netif* ni, ci_tcp_state* ts,
     ci_tcp_sock_ops_setsockopt(sock, &err, SOL_TCP, TCP_DEFER_ACCEPT,
                                &optval, sizeof(optval));
   }
+  if( ts->c.cong_alg != NI_OPTS(ni).tcp_congestion ) {
+    const char* name = ci_tcp_cong_ops(ts)->name;
+    ci_tcp_sock_ops_setsockopt(sock, &err, SOL_TCP, TCP_CONGESTION,
+                               (void*) name, strlen(name));
+  }
 
   optval = 1;
   if( ts->s.s_aflags & CI_SOCK_AFLAG_CORK_BIT )
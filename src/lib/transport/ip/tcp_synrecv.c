@@ -648,6 +648,10 @@ static void ci_tcp_inherit_options(ci_netif* ni, ci_sock_cmn* s,
   ts->c.t_ka_intvl         = c->t_ka_intvl;
   ts->c.t_ka_intvl_in_secs = c->t_ka_intvl_in_secs;
   ts->c.ka_probe_th        = c->ka_probe_th;
+  /* SO_MAX_PACING_RATE */
+  ts->c.max_pacing_rate    = c->max_pacing_rate;
+  /* TCP_CONGESTION */
+  ci_tcp_cong_set_alg(ni, ts, c->cong_alg);
   {
     int af = ipcache_af(&ts->s.pkt);
     ci_ipx_hdr_init_fixed(&ts->s.pkt.ipx, af, IPPROTO_TCP,
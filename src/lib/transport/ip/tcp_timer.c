@@ -444,6 +444,13 @@ void ci_tcp_timeout_cork(ci_netif* netif, ci_tcp_state* ts)
   ci_tcp_send_corked_packets(netif, ts);
 }
 
+/* Called when segments held back by the pacer are due for release */
+void ci_tcp_timeout_pacing(ci_netif* netif, ci_tcp_state* ts)
+{
+  if( ci_ip_queue_not_empty(&ts->send) )
+    ci_tcp_tx_advance(ts, netif);
+}
+
 
 /* Called as action on a retransmission timer timeout (RTO) */
 void ci_tcp_timeout_rto(ci_netif* netif, ci_tcp_state* ts)
@@ -564,7 +571,7 @@ void ci_tcp_timeout_rto(ci_netif* netif, ci_tcp_state* ts)
       ts->ssthresh = CI_MAX(x, y);
     }
     else
-      ts->ssthresh = ci_tcp_losswnd(ts);
+      ts->ssthresh = ci_tcp_cong_ops(ts)->ssthresh(netif, ts);
 
     ts->congstate = CI_TCP_CONG_RTO;
     ts->cwnd_extra = 0;
@@ -577,6 +584,7 @@ void ci_tcp_timeout_rto(ci_netif* netif, ci_tcp_state* ts)
   ts->cwnd = CI_MAX((ci_uint32)tcp_eff_mss(ts), NI_OPTS(netif).loss_min_cwnd);
   ts->cwnd = CI_MAX(ts->cwnd, NI_OPTS(netif).min_cwnd);
   ts->bytes_acked = 0;
+  ci_tcp_cong_event(netif, ts, CI_TCP_CONG_EV_RTO);
 
   /* Backoff RTO timer and restart. */
   ts->rto <<= 1u;
@@ -1272,6 +1272,72 @@ static void ci_tcp_tx_advance_too_long(ci_netif* ni, ci_tcp_state* ts,
 }
 
 
+/* Returns the rate, in bytes per second, at which [ts] should be paced, or
+ * zero if it is not paced.
+ *
+ * With EF_TCP_PACING the rate follows cwnd/srtt in the same way as Linux:
+ * twice that in slow start and 1.2 times in congestion avoidance, so that
+ * the pacer does not itself hold back cwnd growth.  The smoothed RTT is
+ * measured in timer ticks, so connections with an RTT below one tick are
+ * only paced by SO_MAX_PACING_RATE.
+ */
+ci_uint64 ci_tcp_pacing_rate(ci_netif* ni, ci_tcp_state* ts)
+{
+  ci_uint64 rate = ts->c.max_pacing_rate;
+
+  if( NI_OPTS(ni).tcp_pacing ) {
+    ci_uint32 srtt_us = ci_ip_time_ticks2ms(ni, ts->sa) * 1000 / 8;
+    if( srtt_us != 0 ) {
+      ci_uint64 cwnd_rate = (ci_uint64) ts->cwnd * 1000000u / srtt_us;
+      cwnd_rate = cwnd_rate * (ts->cwnd < ts->ssthresh ? 200 : 120) / 100;
+      rate = CI_MIN(rate, cwnd_rate);
+    }
+  }
+
+  return rate == OO_TCP_PACING_RATE_UNLIMITED ? 0 : rate;
+}
+
+
+/* Earliest-departure-time pacer.  Returns true if [pkt] must be held back,
+ * in which case the pacing timer is armed to release it.  Releases are
+ * driven by the periodic timer, so the pacer allows up to one tick worth of
+ * departures to go back-to-back when catching up.
+ */
+static int ci_tcp_tx_pacing_hold(ci_netif* ni, ci_tcp_state* ts,
+                                 ci_ip_pkt_fmt* pkt, ci_uint64 rate)
+{
+  ci_ip_timer_state* its = IPTIMER_STATE(ni);
+  ci_uint64 tick = 1ull << its->ci_ip_time_frc2tick;
+  ci_uint64 now;
+
+  ci_frc64(&now);
+
+  if( now < ts->pacing_edt ) {
+    if( ts->pacing_hold_frc == 0 ) {
+      ts->pacing_hold_frc = now;
+      CITP_STATS_NETIF_INC(ni, tcp_pacing_holds);
+    }
+    if( ! ci_ip_timer_pending(ni, &ts->pacing_tid) ) {
+      ci_iptime_t delay = ((ts->pacing_edt - now) >> its->ci_ip_time_frc2tick);
+      ci_ip_timer_set(ni, &ts->pacing_tid, ci_tcp_time_now(ni) + delay + 1);
+    }
+    return 1;
+  }
+
+  if( ts->pacing_hold_frc != 0 ) {
+    ci_uint32 held_us = (now - ts->pacing_hold_frc) * 1000 / its->khz;
+    ts->stats.tx_pacing_held_us += held_us;
+    CITP_STATS_NETIF_ADD(ni, tcp_pacing_held_us, held_us);
+    ts->pacing_hold_frc = 0;
+  }
+
+  if( ts->pacing_edt + tick < now )
+    ts->pacing_edt = now - tick;
+  ts->pacing_edt += (ci_uint64) TX_PKT_LEN(pkt) * its->khz * 1000u / rate;
+  return 0;
+}
+
+
 void ci_tcp_tx_advance(ci_tcp_state* ts, ci_netif* ni)
 {
   unsigned cwnd_right_edge, right_edge;
@@ -1340,6 +1406,13 @@ void ci_tcp_tx_advance_to(ci_netif* ni, ci_tcp_state* ts,
   oo_pkt_p id = sendq->head;
   int sent_num = 0;
   int af = ipcache_af(&ts->s.pkt);
+  ci_uint64 pacing_rate = 0;
+
+  if(CI_UNLIKELY( (NI_OPTS(ni).tcp_pacing ||
+                   ts->c.max_pacing_rate != OO_TCP_PACING_RATE_UNLIMITED) &&
+                  ! (ts->s.pkt.flags & CI_IP_CACHE_IS_LOCALROUTE) &&
+                  ! (ts->tcpflags & CI_TCPT_FLAG_MSG_WARM) ))
+    pacing_rate = ci_tcp_pacing_rate(ni, ts);
 
   while( 1 ) {
     ci_ip_pkt_fmt* pkt = PKT_CHK(ni, id);
@@ -1374,6 +1447,10 @@ void ci_tcp_tx_advance_to(ci_netif* ni, ci_tcp_state* ts,
         ++ts->stats.tx_stop_more;
         break;
       }
+    if( pacing_rate != 0 && ci_tcp_tx_pacing_hold(ni, ts, pkt, pacing_rate) ) {
+      ++ts->stats.tx_stop_pacing;
+      break;
+    }
 
 #if CI_CFG_CONG_AVOID_NOTIFIED
     /* Is there local congestion, suggesting we should back off a bit? */
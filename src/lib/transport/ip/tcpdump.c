@@ -0,0 +1,316 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/**************************************************************************\
+*//*! \file
+** <L5_PRIVATE L5_SOURCE>
+**  \brief  Capture ring and pre-filter for onload_tcpdump.
+** </L5_PRIVATE>
+*//*
+\**************************************************************************/
+
+/*! \cidoxg_lib_transport_ip */
+
+#include "ip_internal.h"
+#include <linux/filter.h>
+
+#if CI_CFG_TCPDUMP && OO_DO_STACK_POLL
+
+/* The stack releases the packets that onload_tcpdump has written out once
+ * per this many captures, so that it looks at dump_read_i rarely. */
+#define OO_TCPDUMP_FREE_BATCH  32
+
+
+void oo_tcpdump_free_pkts(ci_netif* ni)
+{
+  ci_netif_state* ns = ni->state;
+  ci_uint32 mask = NI_OPTS(ni).tcpdump_ring - 1;
+  ci_uint32 free_i = ns->dump_free_i;
+  ci_uint32 n = ns->dump_read_i - free_i;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  /* dump_read_i is written by onload_tcpdump, so do not trust it to be
+   * behind dump_write_i, and bound the work done here in any case. */
+  n = CI_MIN(n, ns->dump_write_i - free_i);
+  n = CI_MIN(n, mask + 1);
+  if( n == 0 )
+    return;
+
+  /* Ensure reader has finished reading before we free packets. */
+  ci_mb();
+
+  for( ; n > 0; --n, ++free_i ) {
+    oo_pkt_p id = ni->dump_queue[free_i & mask];
+    if( OO_PP_NOT_NULL(id) ) {
+      ni->dump_queue[free_i & mask] = OO_PP_NULL;
+      ci_netif_pkt_release(ni, PKT_CHK(ni, id));
+    }
+  }
+  ns->dump_free_i = free_i;
+}
+
+
+/* Load [size] bytes at [off] in the packet, as big-endian.  Returns 0 on
+ * success, -1 if the bytes are in the packet but not in its first buffer
+ * (which we do not look at), or 1 if they are past the end of the packet.
+ */
+static int oo_bpf_load(const ci_uint8* data, ci_uint32 buf_len,
+                       ci_uint32 wire_len, ci_uint64 off, unsigned size,
+                       ci_uint32* val_out)
+{
+  ci_uint32 val = 0;
+  unsigned i;
+
+  if( off + size > wire_len )
+    return 1;
+  if( off + size > buf_len )
+    return -1;
+  for( i = 0; i < size; ++i )
+    val = (val << 8) | data[off + i];
+  *val_out = val;
+  return 0;
+}
+
+
+/* Run onload_tcpdump's pre-filter, a classic BPF program as compiled by
+ * libpcap, over [pkt].  Returns true if the packet should be captured.
+ *
+ * The program is in shared memory, so each instruction is checked as it
+ * runs, and we accept the packet if the program turns out to be invalid.
+ * Jumps may only go forwards, so the cost is bounded by the length of the
+ * program.  We also accept packets that the program cannot decide on from
+ * the first buffer alone: onload_tcpdump filters again in any case.
+ */
+int oo_tcpdump_filter(ci_netif* ni, ci_ip_pkt_fmt* pkt)
+{
+  const struct oo_bpf_insn* prog = ni->state->dump_filter;
+  unsigned len = OO_ACCESS_ONCE(ni->state->dump_filter_len);
+  const ci_uint8* data = (const ci_uint8*) oo_ether_hdr(pkt);
+  ci_uint32 mem[BPF_MEMWORDS] = { 0 };
+  ci_uint32 A = 0, X = 0, wire_len, buf_len;
+  unsigned pc, n_insns = 0;
+  int rc = 1;
+
+  if( pkt->pay_len <= 0 || len > CI_CFG_TCPDUMP_FILTER_LEN )
+    return 1;
+  wire_len = pkt->pay_len;
+  buf_len = wire_len;
+  if( pkt->n_buffers > 1 )
+    buf_len = CI_MIN(buf_len, (ci_uint32) CI_MAX(pkt->buf_len, 0));
+  /* Never look outside the packet buffer, whatever the metadata says. */
+  if( (const char*) data < (const char*) pkt ||
+      (const char*) data >= (const char*) pkt + CI_CFG_PKT_BUF_SIZE )
+    return 1;
+  buf_len = CI_MIN(buf_len, (ci_uint32) ((const char*) pkt +
+                                         CI_CFG_PKT_BUF_SIZE -
+                                         (const char*) data));
+
+  for( pc = 0; pc < len; ++pc ) {
+    ci_uint16 code = OO_ACCESS_ONCE(prog[pc].code);
+    ci_uint32 k = OO_ACCESS_ONCE(prog[pc].k);
+    ci_uint32 src = (BPF_SRC(code) == BPF_X) ? X : k;
+    ci_uint64 jump = 0;
+    int load = 0;
+
+    ++n_insns;
+    switch( code ) {
+    case BPF_RET | BPF_K:
+      rc = k != 0;
+      goto out;
+    case BPF_RET | BPF_A:
+      rc = A != 0;
+      goto out;
+
+    case BPF_LD | BPF_W | BPF_ABS:
+      load = oo_bpf_load(data, buf_len, wire_len, k, 4, &A);
+      break;
+    case BPF_LD | BPF_H | BPF_ABS:
+      load = oo_bpf_load(data, buf_len, wire_len, k, 2, &A);
+      break;
+    case BPF_LD | BPF_B | BPF_ABS:
+      load = oo_bpf_load(data, buf_len, wire_len, k, 1, &A);
+      break;
+    case BPF_LD | BPF_W | BPF_IND:
+      load = oo_bpf_load(data, buf_len, wire_len, (ci_uint64) X + k, 4, &A);
+      break;
+    case BPF_LD | BPF_H | BPF_IND:
+      load = oo_bpf_load(data, buf_len, wire_len, (ci_uint64) X + k, 2, &A);
+      break;
+    case BPF_LD | BPF_B | BPF_IND:
+      load = oo_bpf_load(data, buf_len, wire_len, (ci_uint64) X + k, 1, &A);
+      break;
+    case BPF_LDX | BPF_B | BPF_MSH:
+      load = oo_bpf_load(data, buf_len, wire_len, k, 1, &X);
+      X = (X & 0xf) << 2;
+      break;
+    case BPF_LD | BPF_W | BPF_LEN:
+      A = wire_len;
+      break;
+    case BPF_LDX | BPF_W | BPF_LEN:
+      X = wire_len;
+      break;
+    case BPF_LD | BPF_IMM:
+      A = k;
+      break;
+    case BPF_LDX | BPF_IMM:
+      X = k;
+      break;
+    case BPF_LD | BPF_MEM:
+      if( k >= BPF_MEMWORDS )
+        goto out;
+      A = mem[k];
+      break;
+    case BPF_LDX | BPF_MEM:
+      if( k >= BPF_MEMWORDS )
+        goto out;
+      X = mem[k];
+      break;
+    case BPF_ST:
+      if( k >= BPF_MEMWORDS )
+        goto out;
+      mem[k] = A;
+      break;
+    case BPF_STX:
+      if( k >= BPF_MEMWORDS )
+        goto out;
+      mem[k] = X;
+      break;
+
+    case BPF_ALU | BPF_ADD | BPF_K:
+    case BPF_ALU | BPF_ADD | BPF_X:
+      A += src;
+      break;
+    case BPF_ALU | BPF_SUB | BPF_K:
+    case BPF_ALU | BPF_SUB | BPF_X:
+      A -= src;
+      break;
+    case BPF_ALU | BPF_MUL | BPF_K:
+    case BPF_ALU | BPF_MUL | BPF_X:
+      A *= src;
+      break;
+    case BPF_ALU | BPF_DIV | BPF_K:
+    case BPF_ALU | BPF_DIV | BPF_X:
+      if( src == 0 ) {
+        rc = 0;
+        goto out;
+      }
+      A /= src;
+      break;
+    case BPF_ALU | BPF_MOD | BPF_K:
+    case BPF_ALU | BPF_MOD | BPF_X:
+      if( src == 0 ) {
+        rc = 0;
+        goto out;
+      }
+      A %= src;
+      break;
+    case BPF_ALU | BPF_AND | BPF_K:
+    case BPF_ALU | BPF_AND | BPF_X:
+      A &= src;
+      break;
+    case BPF_ALU | BPF_OR | BPF_K:
+    case BPF_ALU | BPF_OR | BPF_X:
+      A |= src;
+      break;
+    case BPF_ALU | BPF_XOR | BPF_K:
+    case BPF_ALU | BPF_XOR | BPF_X:
+      A ^= src;
+      break;
+    case BPF_ALU | BPF_LSH | BPF_K:
+    case BPF_ALU | BPF_LSH | BPF_X:
+      A = src < 32 ? A << src : 0;
+      break;
+    case BPF_ALU | BPF_RSH | BPF_K:
+    case BPF_ALU | BPF_RSH | BPF_X:
+      A = src < 32 ? A >> src : 0;
+      break;
+    case BPF_ALU | BPF_NEG:
+      A = -A;
+      break;
+
+    case BPF_JMP | BPF_JA:
+      jump = k;
+      break;
+    case BPF_JMP | BPF_JEQ | BPF_K:
+    case BPF_JMP | BPF_JEQ | BPF_X:
+      jump = A == src ? prog[pc].jt : prog[pc].jf;
+      break;
+    case BPF_JMP | BPF_JGT | BPF_K:
+    case BPF_JMP | BPF_JGT | BPF_X:
+      jump = A > src ? prog[pc].jt : prog[pc].jf;
+      break;
+    case BPF_JMP | BPF_JGE | BPF_K:
+    case BPF_JMP | BPF_JGE | BPF_X:
+      jump = A >= src ? prog[pc].jt : prog[pc].jf;
+      break;
+    case BPF_JMP | BPF_JSET | BPF_K:
+    case BPF_JMP | BPF_JSET | BPF_X:
+      jump = (A & src) ? prog[pc].jt : prog[pc].jf;
+      break;
+
+    case BPF_MISC | BPF_TAX:
+      X = A;
+      break;
+    case BPF_MISC | BPF_TXA:
+      A = X;
+      break;
+
+    default:
+      goto out;
+    }
+
+    if( load != 0 ) {
+      rc = load < 0;
+      goto out;
+    }
+    if( jump >= len - pc - 1 && jump != 0 )
+      goto out;
+    pc += jump;
+  }
+
+ out:
+  CITP_STATS_NETIF_ADD(ni, tcpdump_filter_insns, n_insns);
+  return rc;
+}
+
+
+void oo_tcpdump_dump_pkt(ci_netif* ni, ci_ip_pkt_fmt* pkt)
+{
+  ci_netif_state* ns = ni->state;
+  ci_uint32 mask = NI_OPTS(ni).tcpdump_ring - 1;
+  ci_uint32 write_i = ns->dump_write_i;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  if(CI_UNLIKELY( pkt->flags & CI_PKT_FLAG_MSG_WARM ))
+    return;
+
+  if( ns->dump_filter_len != 0 && ! oo_tcpdump_filter(ni, pkt) ) {
+    CITP_STATS_NETIF_INC(ni, tcpdump_filtered);
+    return;
+  }
+
+  if( (write_i & (OO_TCPDUMP_FREE_BATCH - 1)) == 0 ||
+      write_i - ns->dump_free_i > mask || ns->mem_pressure )
+    oo_tcpdump_free_pkts(ni);
+
+  /* Do not hold on to packet buffers that the stack needs. */
+  if( ns->mem_pressure ) {
+    CITP_STATS_NETIF_INC(ni, tcpdump_holdoff);
+    return;
+  }
+  /* Never overwrite entries that onload_tcpdump has not read. */
+  if( write_i - ns->dump_free_i > mask ) {
+    CITP_STATS_NETIF_INC(ni, tcpdump_missed);
+    return;
+  }
+
+  ci_assert(OO_PP_IS_NULL(ni->dump_queue[write_i & mask]));
+  ci_netif_pkt_hold(ni, pkt);
+  ni->dump_queue[write_i & mask] = OO_PKT_P(pkt);
+  ci_wmb();
+  ns->dump_write_i = write_i + 1;
+  CITP_STATS_NETIF_INC(ni, tcpdump_captured);
+}
+
+#endif /* CI_CFG_TCPDUMP && OO_DO_STACK_POLL */
@@ -91,6 +91,13 @@ static void ci_udp_state_init(ci_netif* netif, ci_udp_state* us)
   us->tx_async_q = CI_ILL_END;
   oo_atomic_set(&us->tx_async_q_level, 0);
   us->tx_count = 0;
+  us->gso_size = 0;
+  us->txtime_clockid = 0;
+  us->txtime_flags = 0;
+  us->txtime_q = OO_PP_NULL;
+  oo_p_dllink_init(netif, oo_p_dllink_sb(netif, &us->s.b, &us->txtime_link));
+  us->txtime_err_put = 0;
+  us->txtime_err_get = 0;
   us->udpflags = CI_UDPF_MCAST_LOOP;
   us->future_intf_i = 0;
   us->ip_pktinfo_cache.intf_i = -1;
@@ -271,6 +278,9 @@ void ci_udp_state_dump(ci_netif* ni, ci_udp_state* us, const char* pf,
          uss.max_recvq_pkts);
   logger(log_arg, "%s  rcv: os=%u(%u%%) os_slow=%u os_error=%u", pf,
          rx_os, percent(rx_os, rx_total), uss.n_rx_os_slow, uss.n_rx_os_error);
+  if( (us->s.cmsg_flags & CI_UDP_CMSG_GRO) || uss.n_rx_gro != 0 )
+    logger(log_arg, "%s  rcv: gro=%u gro_segs=%u", pf,
+           uss.n_rx_gro, uss.n_rx_gro_segs);
 
   /* Send path. */
   logger(log_arg, "%s  snd: q=%u+%u ul=%u os=%u(%u%%)", pf,
@@ -323,6 +333,17 @@ void ci_udp_state_dump(ci_netif* ni, ci_udp_state* us, const char* pf,
          "%s  snd: os_slow=%d os_late=%d unconnect_late=%d nomac=%u(%u%%)", pf,
          uss.n_tx_os_slow, uss.n_tx_os_late, uss.n_tx_unconnect_late,
          uss.n_tx_cp_no_mac, percent(uss.n_tx_cp_no_mac, tx_total));
+  if( us->gso_size != 0 || uss.n_tx_gso != 0 )
+    logger(log_arg, "%s  snd: gso_size=%u gso=%u gso_segs=%u", pf,
+           us->gso_size, uss.n_tx_gso, uss.n_tx_gso_segs);
+  if( uss.n_tx_mmsg != 0 )
+    logger(log_arg, "%s  snd: mmsg=%u mmsg_dgrams=%u", pf,
+           uss.n_tx_mmsg, uss.n_tx_mmsg_dgrams);
+  if( (us->udpflags & CI_UDPF_TXTIME) || uss.n_tx_txtime != 0 )
+    logger(log_arg, "%s  snd: txtime clock=%d flags=%x held=%u drop=%u "
+           "errq=%u", pf, us->txtime_clockid, us->txtime_flags,
+           uss.n_tx_txtime, uss.n_tx_txtime_drop,
+           us->txtime_err_put - us->txtime_err_get);
 }
 
 #endif
@@ -147,6 +147,142 @@ oo_copy_pkt_to_iovec_no_adv(ci_netif* ni, const ci_ip_pkt_fmt* pkt,
 
 
 #ifndef __KERNEL__
+/* As oo_copy_pkt_to_iovec_no_adv(), but always leaves [piov] just past the
+ * data copied so that further datagrams can follow.
+ */
+static int
+oo_copy_pkt_to_iovec_adv(ci_netif* ni, const ci_ip_pkt_fmt* pkt,
+                         ci_iovec_ptr* piov, int bytes_to_copy)
+{
+  int rc, copied;
+  struct oo_copy_state ocs;
+  ocs.bytes_copied = 0;
+  ocs.bytes_to_copy = bytes_to_copy;
+  ocs.pkt_off = 0;
+  ocs.pkt = pkt;
+
+  while( 1 ) {
+    ocs.pkt_left = oo_offbuf_left(&(ocs.pkt->buf)) - ocs.pkt_off;
+    ocs.from = oo_offbuf_ptr(&(ocs.pkt->buf));
+    copied = ocs.bytes_copied;
+    rc = __oo_copy_frag_to_iovec_no_adv(ni, piov, &ocs);
+    if( rc == 0 ) {
+      ci_iovec_ptr_advance(piov, ocs.bytes_copied - copied);
+      return ocs.bytes_copied;
+    }
+    else if( rc == 1 )
+      continue;
+    else if( rc < 0 )
+      return rc;
+    else
+      ci_assert(0);
+  }
+}
+
+
+/* UDP_GRO only coalesces datagrams held in a single buffer. */
+ci_inline int ci_udp_gro_pkt_ok(const ci_ip_pkt_fmt* pkt)
+{
+  return pkt->n_buffers == 1 && ! (pkt->flags & CI_PKT_FLAG_INDIRECT) &&
+         pkt->pf.udp.pay_len != 0;
+}
+
+
+ci_inline int ci_udp_gro_same_flow(ci_ip_pkt_fmt* pkt1, ci_ip_pkt_fmt* pkt2)
+{
+  int af = oo_pkt_af(pkt1);
+  const ci_udp_hdr* udp1;
+  const ci_udp_hdr* udp2;
+
+  if( oo_pkt_af(pkt2) != af )
+    return 0;
+  udp1 = oo_ipx_data(af, pkt1);
+  udp2 = oo_ipx_data(af, pkt2);
+  return udp1->udp_source_be16 == udp2->udp_source_be16 &&
+         udp1->udp_dest_be16 == udp2->udp_dest_be16 &&
+         CI_IPX_ADDR_EQ(RX_PKT_SADDR(pkt1), RX_PKT_SADDR(pkt2)) &&
+         CI_IPX_ADDR_EQ(RX_PKT_DADDR(pkt1), RX_PKT_DADDR(pkt2));
+}
+
+
+/* UDP_GRO: count the datagrams at the head of the receive queue, starting
+ * with [pkt], that can be handed back together in at most [space] bytes.
+ * They must come from one flow and all carry as much payload as the first,
+ * except that the last may carry less.
+ */
+static int ci_udp_recv_q_gro_run(ci_netif* ni, ci_udp_state* us,
+                                 ci_ip_pkt_fmt* pkt, int space)
+{
+  ci_ip_pkt_fmt* first = pkt;
+  ci_ip_pkt_fmt* next;
+  int seg_len = pkt->pf.udp.pay_len;
+  int avail = ci_udp_recv_q_pkts(&us->recv_q) - pkt->n_buffers;
+  int bytes = seg_len, n = 1;
+
+  if( ! ci_udp_gro_pkt_ok(pkt) )
+    return 1;
+
+  /* Only packets already counted in [pkts_added] are safe to look at. */
+  ci_rmb();
+  while( avail > 0 && n < CI_UDP_MAX_SEGMENTS ) {
+    next = ci_udp_recv_q_next(ni, pkt);
+    if( next == NULL || ! ci_udp_gro_pkt_ok(next) ||
+        next->pf.udp.pay_len > seg_len ||
+        bytes + next->pf.udp.pay_len > space ||
+        ! ci_udp_gro_same_flow(first, next) )
+      break;
+    bytes += next->pf.udp.pay_len;
+    --avail;
+    ++n;
+    if( next->pf.udp.pay_len < seg_len )
+      break;
+    pkt = next;
+  }
+  return n;
+}
+
+
+/* Copy a run of [n_segs] datagrams found by ci_udp_recv_q_gro_run() to
+ * [piov] back to back, and consume them unless peeking.
+ */
+static int ci_udp_recvmsg_get_gro(ci_udp_recv_info* rinf, ci_ip_pkt_fmt* pkt,
+                                  ci_iovec_ptr* piov, int n_segs)
+{
+  ci_netif* ni = rinf->a->ni;
+  ci_udp_state* us = rinf->a->us;
+  int i, rc, bytes = 0;
+
+  us->stamp = pkt->tstamp_frc;
+  us->future_intf_i = pkt->intf_i;
+  ci_udp_recvmsg_fill_msghdr(ni, rinf->msg, pkt, &us->s);
+
+  for( i = 0; ; ) {
+    rc = oo_copy_pkt_to_iovec_adv(ni, pkt, piov, pkt->pf.udp.pay_len);
+    if(CI_UNLIKELY( rc < 0 ))
+      return rc;
+    bytes += rc;
+    if( ++i == n_segs )
+      break;
+    if( rinf->flags & MSG_PEEK ) {
+      pkt = ci_udp_recv_q_next(ni, pkt);
+    }
+    else {
+      ci_udp_recv_q_deliver(ni, &us->recv_q, pkt);
+      pkt = ci_udp_recv_q_get(ni, &us->recv_q);
+    }
+  }
+
+  if( ! (rinf->flags & MSG_PEEK) ) {
+    ci_netif_lat_hist_rx(ni, us->stamp);
+    ci_udp_recv_q_deliver(ni, &us->recv_q, pkt);
+    ++us->stats.n_rx_gro;
+    us->stats.n_rx_gro_segs += n_segs;
+  }
+  us->udpflags |= CI_UDPF_LAST_RECV_ON;
+  return bytes;
+}
+
+
 /* Max number of iovecs needed:
  * = max_datagram / (min_mtu - udp_header)
  * = 65536 / (576 - 28) 
@@ -190,6 +326,25 @@ static void ci_udp_pkt_to_zc_msg(ci_netif* ni, ci_ip_pkt_fmt* pkt,
   zc_msg->msghdr.msg_iovlen = i;
 }
 
+/* Present a UDP_GRO run as one message with an iovec per datagram. */
+static void ci_udp_gro_pkts_to_zc_msg(ci_netif* ni, ci_ip_pkt_fmt* pkt,
+                                      int n_segs, struct onload_zc_msg* zc_msg)
+{
+  int i;
+
+  ci_assert_le(n_segs, CI_UDP_ZC_IOVEC_MAX);
+  for( i = 0; ; ) {
+    zc_msg->iov[i].iov_len = pkt->pf.udp.pay_len;
+    zc_msg->iov[i].iov_base = oo_offbuf_ptr(&pkt->buf);
+    zc_msg->iov[i].buf = zc_pktbuf_to_handle(pkt);
+    zc_msg->iov[i].iov_flags = 0;
+    if( ++i == n_segs )
+      break;
+    pkt = ci_udp_recv_q_next(ni, pkt);
+  }
+  zc_msg->msghdr.msg_iovlen = n_segs;
+}
+
 # if CI_CFG_ZC_RECV_FILTER
 static void ci_udp_filter_kernel_pkt(ci_netif* ni, ci_udp_state* us,
                                      struct msghdr* msg, int *bytes)
@@ -249,8 +404,23 @@ static int ci_udp_recvmsg_get(ci_udp_recv_info* rinf, ci_iovec_ptr* piov
 
 #ifndef __KERNEL__
   if( msg != NULL ) {
-    if( CI_UNLIKELY(us->s.cmsg_flags != 0 ) )
-      ci_ip_cmsg_recv(ni, us, pkt, msg, 0, &rinf->msg_flags);
+    if( CI_UNLIKELY(us->s.cmsg_flags != 0 ) ) {
+      int n_segs = 1;
+      if( (us->s.cmsg_flags & CI_UDP_CMSG_GRO)
+# if CI_CFG_ZC_RECV_FILTER
+          && ! us->recv_q_filter
+# endif
+          ) {
+        /* As Linux, a coalesced receive is at most 64KB. */
+        n_segs = ci_udp_recv_q_gro_run(ni, us, pkt,
+                                       CI_MIN(ci_iovec_ptr_bytes_count(piov),
+                                              0xffff));
+      }
+      ci_ip_cmsg_recv(ni, us, pkt, msg, 0, &rinf->msg_flags,
+                      n_segs > 1 ? pkt->pf.udp.pay_len : 0);
+      if( n_segs > 1 )
+        return ci_udp_recvmsg_get_gro(rinf, pkt, piov, n_segs);
+    }
     else
       msg->msg_controllen = 0;
   }
@@ -299,6 +469,7 @@ static int ci_udp_recvmsg_get(ci_udp_recv_info* rinf, ci_iovec_ptr* piov
 # endif
 #endif
 
+      ci_netif_lat_hist_rx(ni, pkt->tstamp_frc);
       ci_udp_recv_q_deliver(ni, &us->recv_q, pkt);
     }
     us->udpflags |= CI_UDPF_LAST_RECV_ON;
@@ -478,6 +649,18 @@ static int ci_udp_recvmsg_socklocked_slowpath(ci_udp_recv_info* rinf,
       return rc;
     }
 #endif
+    if( ci_udp_txtime_err_pending(us) ) {
+      struct cmsg_state cmsg_state;
+
+      cmsg_state.msg = rinf->msg;
+      cmsg_state.cm = rinf->msg->msg_control;
+      cmsg_state.cmsg_bytes_used = 0;
+      cmsg_state.p_msg_flags = &rinf->msg_flags;
+      ci_ip_txtime_err_to_cmsg(us, &cmsg_state);
+      ci_ip_cmsg_finish(&cmsg_state);
+      rinf->msg_flags |= MSG_ERRQUEUE_CHK;
+      return SLOWPATH_RET_ZERO;
+    }
     /* ICMP is handled via OS, so get OS error */
     rc = oo_os_sock_recvmsg(ni, SC_SP(&us->s), rinf->msg, rinf->flags);
     if( rc < 0 ) {
@@ -1116,6 +1299,7 @@ int ci_udp_zc_recv(ci_udp_iomsg_args* a, struct onload_zc_recv_args* args)
   void* supplied_name = args->msg.msghdr.msg_name;
   struct onload_zc_iovec iovec[CI_UDP_ZC_IOVEC_MAX];
   unsigned cb_flags;
+  int i, n_segs;
 
   spin_state.do_spin = -1;
   spin_state.si = citp_signal_get_specific_inited();
@@ -1149,12 +1333,16 @@ int ci_udp_zc_recv(ci_udp_iomsg_args* a, struct onload_zc_recv_args* args)
       args->msg.msghdr.msg_name = supplied_name;
       args->msg.msghdr.msg_namelen = supplied_namelen;
       args->msg.msghdr.msg_flags = 0;
+      n_segs = 1;
 
       if( CI_UNLIKELY(us->s.cmsg_flags != 0 ) ) {
+        if( us->s.cmsg_flags & CI_UDP_CMSG_GRO )
+          n_segs = ci_udp_recv_q_gro_run(ni, us, pkt, 0xffff);
         args->msg.msghdr.msg_controllen = supplied_controllen;
         args->msg.msghdr.msg_control = supplied_control;
         ci_ip_cmsg_recv(ni, us, pkt, &args->msg.msghdr, 0,
-                        &args->msg.msghdr.msg_flags);
+                        &args->msg.msghdr.msg_flags,
+                        n_segs > 1 ? pkt->pf.udp.pay_len : 0);
       }
       else
         args->msg.msghdr.msg_controllen = 0;
@@ -1162,14 +1350,17 @@ int ci_udp_zc_recv(ci_udp_iomsg_args* a, struct onload_zc_recv_args* args)
       ci_udp_recvmsg_fill_msghdr(ni, &args->msg.msghdr, pkt, 
                                  &us->s);
 
-      ci_udp_pkt_to_zc_msg(ni, pkt, &args->msg);
+      if( n_segs > 1 )
+        ci_udp_gro_pkts_to_zc_msg(ni, pkt, n_segs, &args->msg);
+      else
+        ci_udp_pkt_to_zc_msg(ni, pkt, &args->msg);
 
       us->stamp = pkt->tstamp_frc;
       us->udpflags |= CI_UDPF_LAST_RECV_ON;
     
       cb_flags = CI_IP_IS_MULTICAST(oo_ip_hdr(pkt)->ip_daddr_be32) ? 
         ONLOAD_ZC_MSG_SHARED : 0;
-      if( (ci_udp_recv_q_pkts(&us->recv_q) == 1) &&
+      if( (ci_udp_recv_q_pkts(&us->recv_q) == n_segs) &&
           ((us->s.os_sock_status & OO_OS_STATUS_RX) == 0) )
         cb_flags |= ONLOAD_ZC_END_OF_BURST;
 
@@ -1177,17 +1368,33 @@ int ci_udp_zc_recv(ci_udp_iomsg_args* a, struct onload_zc_recv_args* args)
        * if not needed.  This prevents races where the app releases
        * the pkt before we've added the flag.
        */
-      pkt->rx_flags |= CI_PKT_RX_FLAG_KEEP;
+      {
+        ci_ip_pkt_fmt* p = pkt;
+        for( i = 0; ; ) {
+          p->rx_flags |= CI_PKT_RX_FLAG_KEEP;
+          if( ++i == n_segs )
+            break;
+          p = ci_udp_recv_q_next(ni, p);
+        }
+      }
 
       cb_rc = (*args->cb)(args, cb_flags);
 
-      if( ! (cb_rc & ONLOAD_ZC_KEEP) ) {
-        /* Remove the ref we added earlier iff the user didn't retain it */
-        pkt->rx_flags &=~ CI_PKT_RX_FLAG_KEEP;
-        pkt->pio_addr = -1;
+      for( i = 0; ; ) {
+        if( ! (cb_rc & ONLOAD_ZC_KEEP) ) {
+          /* Remove the ref we added earlier iff the user didn't retain it */
+          pkt->rx_flags &=~ CI_PKT_RX_FLAG_KEEP;
+          pkt->pio_addr = -1;
+        }
+        ci_udp_recv_q_deliver(ni, &us->recv_q, pkt);
+        if( ++i == n_segs )
+          break;
+        pkt = ci_udp_recv_q_get(ni, &us->recv_q);
+      }
+      if( n_segs > 1 ) {
+        ++us->stats.n_rx_gro;
+        us->stats.n_rx_gro_segs += n_segs;
       }
-
-      ci_udp_recv_q_deliver(ni, &us->recv_q, pkt);
 
       done_callback = 1;
 
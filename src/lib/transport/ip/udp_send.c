@@ -12,7 +12,9 @@
 \**************************************************************************/
   
 /*! \cidoxg_lib_transport_ip */
-  
+
+#define _GNU_SOURCE  /* for sendmmsg */
+
 #include "ip_internal.h"
 #include "udp_internal.h"
 #include "ip_tx.h"
@@ -77,11 +79,24 @@ struct udp_send_info {
   int                   stack_locked;
   ci_uint32             timeout;
   int                   old_ipcache_updated;
+  int                   gso_size;
+  ci_uint64             txtime;     /* SO_TXTIME launch time as frc */
+  ci_uint64             txtime_ns;  /* ...and as given by the caller */
 #ifdef __KERNEL__
   ci_addr_spc_t addr_spc;
 #endif
 };
 
+/* Value of [udp_send_info::txtime] for a launch time that could not be
+ * converted.  The datagram is dropped and reported as an invalid parameter.
+ */
+#define CI_UDP_TXTIME_INVALID  ((ci_uint64) -1)
+
+/* Launch times further than this into the future are rejected, as is done
+ * by the kernel's fq qdisc by default.
+ */
+#define CI_UDP_TXTIME_HORIZON_NS  10000000000ll
+
 static bool ci_ipx_is_first_frag(int af, ci_ipx_hdr_t* ipx)
 {
 #if CI_CFG_IPV6
@@ -123,6 +138,15 @@ static bool ci_ipx_is_mf_set(int af, ci_ipx_hdr_t* ipx)
   return false;
 }
 
+/* Datagrams produced by UDP_SEGMENT are chained exactly as IP fragments
+ * are, but each carries its own UDP header.
+ */
+static bool ci_udp_pkt_is_gso(int af, ci_ip_pkt_fmt* pkt)
+{
+  return OO_PP_NOT_NULL(pkt->next) &&
+         ! ci_ipx_is_frag(af, TX_PKT_IPX_HDR(af, pkt));
+}
+
 ci_noinline void ci_udp_sendmsg_chksum(ci_netif* ni, ci_ip_pkt_fmt* pkt,
                                        int af, ci_ipx_hdr_t* first_hdr)
 {
@@ -133,6 +157,7 @@ ci_noinline void ci_udp_sendmsg_chksum(ci_netif* ni, ci_ip_pkt_fmt* pkt,
   ci_udp_hdr* udp = TX_PKT_IPX_UDP(af, pkt, true);
   ci_ip_pkt_fmt* p = pkt;
   int first_frag = 1;
+  ci_uint16 payload_sum;
 
   /* iterate all IP fragments */
   while( OO_PP_NOT_NULL(p->next) ) {
@@ -196,8 +221,13 @@ ci_noinline void ci_udp_sendmsg_chksum(ci_netif* ni, ci_ip_pkt_fmt* pkt,
     }
   }
   
+  /* Sum the payload with the bulk checksum engine, and leave the headers
+   * to ef_vi by passing it the payload's sum in place of the payload. */
+  payload_sum = ci_ip_csum_iov16(iov, n + 1);
+  iov[0].iov_base = &payload_sum;
+  iov[0].iov_len = sizeof(payload_sum);
   udp->udp_check_be16 = ef_udp_checksum_ipx(af, ipx_hdr_ptr(af, first_hdr),
-                                            (struct udphdr*)udp, iov, n+1);
+                                            (struct udphdr*)udp, iov, 1);
 }
 
 
@@ -332,7 +362,8 @@ static void ci_udp_sendmsg_mcast(ci_netif* ni, ci_udp_state* us,
 
 /* Pass prepared packet to ip_send(), release our ref & and update stats */
 ci_inline void prep_send_pkt(ci_netif* ni, ci_udp_state* us,
-                             ci_ip_pkt_fmt* pkt, ci_ip_cached_hdrs* ipcache)
+                             ci_ip_pkt_fmt* pkt, ci_ip_cached_hdrs* ipcache,
+                             bool first_dgram)
 {
   int af = ipcache_af(&us->s.pkt);
   ci_ipx_hdr_t* ipx = oo_tx_ipx_hdr(af, pkt);
@@ -361,8 +392,10 @@ ci_inline void prep_send_pkt(ci_netif* ni, ci_udp_state* us,
 
   if( ci_ipx_is_first_frag(af, ipx) ) {
 #if CI_CFG_TIMESTAMPING
-    /* Request TX timestamp for the first segment */
-    if( onload_timestamping_want_tx_nic(us->s.timestamping_flags) )
+    /* Request TX timestamp for the first segment.  A UDP_SEGMENT send
+     * reports a single timestamp, as Linux does. */
+    if( first_dgram &&
+        onload_timestamping_want_tx_nic(us->s.timestamping_flags) )
       pkt->flags |= CI_PKT_FLAG_TX_TIMESTAMPED;
 #endif
     if( ci_ipx_is_mf_set(af, ipx) ) {
@@ -595,14 +628,19 @@ static int ci_udp_sendmsg_send_pkt_via_os(ci_netif* ni, ci_udp_state* us,
   int seg_i, buf_len, iov_i;
   ci_ip_pkt_fmt* frag_head;
   ci_ip_pkt_fmt* buf_pkt;
-  struct iovec iov[30];
   ci_udp_hdr* udp;
   void* buf_start;
   ci_msghdr m;
+  int af = ipcache_af(&us->s.pkt);
+  bool gso = ci_udp_pkt_is_gso(af, pkt);
 #ifndef __KERNEL__
   struct sockaddr_storage ss;
+  /* Room for a full UDP_SEGMENT batch, one buffer per datagram. */
+  struct iovec iov[CI_MAX(30, CI_UDP_MAX_SEGMENTS)];
+  char control[CMSG_SPACE(sizeof(ci_uint16))];
+#else
+  struct iovec iov[30];
 #endif
-  int af = ipcache_af(&us->s.pkt);
 
   m.msg_iov = iov;
   m.msg_iovlen = 0;
@@ -625,6 +663,20 @@ static int ci_udp_sendmsg_send_pkt_via_os(ci_netif* ni, ci_udp_state* us,
     }
     m.msg_controllen = 0;
   }
+
+  /* Have the kernel split the payload again.  In the kernel case the OS
+   * socket splits it only if UDP_SEGMENT was set on the socket itself. */
+  if( gso ) {
+    struct cmsghdr* cmsg;
+    m.msg_control = control;
+    m.msg_controllen = sizeof(control);
+    cmsg = CMSG_FIRSTHDR(&m);
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(ci_uint16));
+    *(ci_uint16*) CMSG_DATA(cmsg) =
+      CI_BSWAP_BE16(TX_PKT_UDP(pkt)->udp_len_be16) - sizeof(ci_udp_hdr);
+  }
 #endif /* __KERNEL__ */
 
   frag_head = pkt;
@@ -636,6 +688,9 @@ static int ci_udp_sendmsg_send_pkt_via_os(ci_netif* ni, ci_udp_state* us,
     if( buf_pkt == pkt )
       /* First IP fragment, move past IP+UDP header */
       buf_start = udp + 1;
+    else if( seg_i == 0 && gso )
+      /* Subsequent UDP_SEGMENT datagram, move past IP+UDP header */
+      buf_start = TX_PKT_IPX_UDP(af, buf_pkt, false) + 1;
     else if( seg_i == 0 )
       /* Subsequent IP fragment, move past IP header */
       buf_start = oo_tx_ipx_data(af, buf_pkt);
@@ -676,6 +731,19 @@ static int ci_udp_sendmsg_send_pkt_via_os(ci_netif* ni, ci_udp_state* us,
 }
 
 
+static int ci_udp_tx_datagram_level(ci_netif* ni, ci_ip_pkt_fmt* pkt,
+                                    ci_boolean_t ni_locked)
+{
+  /* Sum the contributions from each IP fragment. */
+  int level = 0;
+  for( ; ; pkt = PKT_CHK_NML(ni, pkt->next, ni_locked) ) {
+    level += pkt->pf.udp.tx_length;
+    if( OO_PP_IS_NULL(pkt->next) )
+      return level;
+  }
+}
+
+
 static void fixup_pkt_not_transmitted(ci_netif *ni, ci_ip_pkt_fmt* pkt)
 {
   ci_assert(ci_netif_is_locked(ni));
@@ -696,6 +764,107 @@ static void fixup_pkt_not_transmitted(ci_netif *ni, ci_ip_pkt_fmt* pkt)
 }
 
 
+/* Drop a datagram that was scheduled with SO_TXTIME, reporting it on the
+ * error queue if SOF_TXTIME_REPORT_ERRORS is set.  The caller still holds
+ * its own reference to [pkt].
+ */
+static void ci_udp_txtime_drop(ci_netif* ni, ci_udp_state* us,
+                               ci_ip_pkt_fmt* pkt, int code)
+{
+  unsigned i;
+
+  fixup_pkt_not_transmitted(ni, pkt);
+  ++us->stats.n_tx_txtime_drop;
+
+  if( ! (us->txtime_flags & OO_SOF_TXTIME_REPORT_ERRORS) ||
+      us->txtime_err_put - OO_ACCESS_ONCE(us->txtime_err_get) >=
+      CI_UDP_TXTIME_ERR_Q_LEN )
+    return;
+  i = us->txtime_err_put % CI_UDP_TXTIME_ERR_Q_LEN;
+  us->txtime_err[i].txtime = pkt->pf.udp.txtime_ns;
+  us->txtime_err[i].code = code;
+  ci_wmb();
+  us->txtime_err_put++;
+  ci_udp_wake_possibly_not_in_poll(ni, us, CI_SB_FLAG_WAKE_RX);
+}
+
+
+/* Arm the stack's txtime timer for [udp_txtime_next].  The timer fires at
+ * the start of a tick, so aim for the tick after the launch time.
+ */
+static void ci_udp_txtime_arm(ci_netif* ni)
+{
+  ci_ip_timer* tid = &ni->state->udp_txtime_tid;
+  ci_iptime_t t = (ci_iptime_t)
+    (ni->state->udp_txtime_next >> IPTIMER_STATE(ni)->ci_ip_time_frc2tick) + 1;
+
+  if( ci_ip_timer_pending(ni, tid) )
+    ci_ip_timer_modify(ni, tid, t);
+  else
+    ci_ip_timer_set(ni, tid, t);
+}
+
+
+/* Decide what to do with a datagram that carries an SO_TXTIME launch time.
+ * Returns true if the datagram has been dealt with (queued on [txtime_q]
+ * or dropped), or false if it should be sent now.
+ */
+static bool ci_udp_txtime_hold(ci_netif* ni, ci_udp_state* us,
+                               ci_ip_pkt_fmt* pkt, int flags)
+{
+  ci_uint64 now, txtime = pkt->pf.udp.txtime;
+  oo_pkt_p* p_pp;
+  ci_ip_pkt_fmt* next;
+
+  if( txtime == CI_UDP_TXTIME_INVALID ) {
+    ci_udp_txtime_drop(ni, us, pkt, SO_EE_CODE_TXTIME_INVALID_PARAM);
+    return true;
+  }
+  ci_frc64(&now);
+  if( (ci_int64) (txtime - now) <= 0 ) {
+    ci_udp_txtime_drop(ni, us, pkt, SO_EE_CODE_TXTIME_MISSED);
+    return true;
+  }
+  if( us->txtime_flags & OO_SOF_TXTIME_DEADLINE_MODE ) {
+    /* Launch time is a deadline, and we've not missed it. */
+    pkt->pf.udp.txtime = 0;
+    return false;
+  }
+
+  if( flags & MSG_CONFIRM )
+    pkt->flags |= CI_PKT_FLAG_MSG_CONFIRM;
+  ci_netif_pkt_hold(ni, pkt);
+  us->tx_count += ci_udp_tx_datagram_level(ni, pkt, CI_TRUE);
+  ++us->stats.n_tx_txtime;
+
+  /* Keep [txtime_q] in launch time order, FIFO for equal times. */
+  p_pp = &us->txtime_q;
+  while( OO_PP_NOT_NULL(*p_pp) ) {
+    next = PKT_CHK(ni, *p_pp);
+    if( (ci_int64) (txtime - next->pf.udp.txtime) < 0 )
+      break;
+    p_pp = &next->netif.tx.dmaq_next;
+  }
+  pkt->netif.tx.dmaq_next = *p_pp;
+  *p_pp = OO_PKT_P(pkt);
+
+  if( p_pp == &us->txtime_q ) {
+    struct oo_p_dllink_state link =
+      oo_p_dllink_sb(ni, &us->s.b, &us->txtime_link);
+    if( oo_p_dllink_is_empty(ni, link) )
+      oo_p_dllink_add_tail(ni,
+                           oo_p_dllink_ptr(ni, &ni->state->udp_txtime_list),
+                           link);
+    if( ni->state->udp_txtime_next == 0 ||
+        (ci_int64) (txtime - ni->state->udp_txtime_next) < 0 ) {
+      ni->state->udp_txtime_next = txtime;
+      ci_udp_txtime_arm(ni);
+    }
+  }
+  return true;
+}
+
+
 static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
                                 ci_ip_pkt_fmt* pkt, int flags,
                                 bool may_poll,
@@ -714,6 +883,10 @@ static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
 
   ci_assert(ci_netif_is_locked(ni));
 
+  if(CI_UNLIKELY( pkt->pf.udp.txtime != 0 ) &&
+     ci_udp_txtime_hold(ni, us, pkt, flags) )
+    return;
+
   is_connected_send = CI_IPX_ADDR_IS_ANY(pkt_daddr) ? 1 : 0;
 
   if( ! is_connected_send ) {
@@ -775,6 +948,16 @@ static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
   }
 
  done_hdr_update:
+  if( ci_udp_pkt_is_gso(af, pkt) ) {
+    /* Only the first datagram has been given its destination port. */
+    ci_uint16 dport_be16 = TX_PKT_IPX_DPORT(af, pkt);
+    ci_ip_pkt_fmt* p = pkt;
+    do {
+      p = PKT_CHK(ni, p->next);
+      TX_PKT_IPX_UDP(af, p, false)->udp_dest_be16 = dport_be16;
+    } while( OO_PP_NOT_NULL(p->next) );
+  }
+
   switch( ipcache->status ) {
   case retrrc_success:
     ipcache_onloadable = 1;
@@ -820,15 +1003,11 @@ static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
   /* Linux allows sending IPv6 packets with zero Hop Limit field */
   if( ipcache_ttl(ipcache) || ipcache_is_ipv6(ipcache) ) {
     if(CI_LIKELY( ipcache_onloadable )) {
-      /* TODO: Hit the doorbell just once. */
       while( 1 ) {
-        oo_pkt_p next = pkt->next;
-        prep_send_pkt(ni, us, pkt, ipcache);
-        /* We've called ci_netif_pkt_hold() in ci_udp_sendmsg_fill(). */
-        ci_netif_send(ni, pkt);
-        if( OO_PP_IS_NULL(next) )
+        prep_send_pkt(ni, us, pkt, ipcache, pkt == first_pkt);
+        if( OO_PP_IS_NULL(pkt->next) )
           break;
-        pkt = PKT_CHK(ni, next);
+        pkt = PKT_CHK(ni, pkt->next);
 #ifdef __KERNEL__
         if(CI_UNLIKELY( i++ > ni->pkt_sets_n << CI_CFG_PKTS_PER_SET_S )) {
           ci_netif_error_detected(ni, CI_NETIF_ERROR_UDP_SEND_PKTS_LIST,
@@ -836,6 +1015,9 @@ static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
         }
 #endif
       }
+      /* All fragments or UDP_SEGMENT datagrams go with one doorbell.  We've
+       * called ci_netif_pkt_hold() on each in ci_udp_sendmsg_fill(). */
+      ci_netif_send_list(ni, first_pkt);
       if( flags & MSG_CONFIRM )
         oo_cp_arp_confirm(ni->cplane, &ipcache->fwd_ver,
                           ci_ni_fwd_table_id(ni));
@@ -860,7 +1042,7 @@ static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
       us->udpflags |= CI_UDPF_LAST_SEND_NOMAC;
       while( 1 ) {
         oo_pkt_p next = pkt->next;
-        prep_send_pkt(ni, us, pkt, ipcache);
+        prep_send_pkt(ni, us, pkt, ipcache, pkt == first_pkt);
         ci_ip_send_udp_slow(ni, &us->s.cp, pkt, ipcache);
         if( OO_PP_IS_NULL(next) )
           break;
@@ -935,19 +1117,6 @@ static void ci_udp_sendmsg_send(ci_netif* ni, ci_udp_state* us,
 }
 
 
-static int ci_udp_tx_datagram_level(ci_netif* ni, ci_ip_pkt_fmt* pkt,
-                                    ci_boolean_t ni_locked)
-{
-  /* Sum the contributions from each IP fragment. */
-  int level = 0;
-  for( ; ; pkt = PKT_CHK_NML(ni, pkt->next, ni_locked) ) {
-    level += pkt->pf.udp.tx_length;
-    if( OO_PP_IS_NULL(pkt->next) )
-      return level;
-  }
-}
-
-
 void ci_udp_sendmsg_send_async_q(ci_netif* ni, ci_udp_state* us)
 {
   oo_pkt_p pp, send_list;
@@ -988,6 +1157,103 @@ void ci_udp_sendmsg_send_async_q(ci_netif* ni, ci_udp_state* us)
   }
 }
 
+
+/* Send, or drop if we're too late, those datagrams on [us->txtime_q] whose
+ * launch time has come.  Returns the launch time of the next datagram, or
+ * zero if the queue is now empty.
+ */
+static ci_uint64 ci_udp_txtime_release_sock(ci_netif* ni, ci_udp_state* us,
+                                            ci_uint64 now)
+{
+  /* We're only woken by the timer wheel in the worst case, so allow for
+   * the timer firing up to a tick late before declaring a miss.
+   */
+  ci_uint64 late = 2ull << IPTIMER_STATE(ni)->ci_ip_time_frc2tick;
+  ci_ip_pkt_fmt* pkt;
+  int flags;
+
+  while( OO_PP_NOT_NULL(us->txtime_q) ) {
+    pkt = PKT_CHK(ni, us->txtime_q);
+    if( (ci_int64) (pkt->pf.udp.txtime - now) > 0 )
+      return pkt->pf.udp.txtime;
+    us->txtime_q = pkt->netif.tx.dmaq_next;
+    us->tx_count -= ci_udp_tx_datagram_level(ni, pkt, CI_TRUE);
+
+    if( now - pkt->pf.udp.txtime > late ) {
+      ci_udp_txtime_drop(ni, us, pkt, SO_EE_CODE_TXTIME_MISSED);
+      if( ci_udp_tx_advertise_space(us) )
+        ci_udp_wake_possibly_not_in_poll(ni, us, CI_SB_FLAG_WAKE_TX);
+    }
+    else {
+      if( pkt->flags & CI_PKT_FLAG_MSG_CONFIRM )
+        flags = MSG_CONFIRM;
+      else
+        flags = 0;
+      pkt->pf.udp.txtime = 0;
+      ci_udp_sendmsg_send(ni, us, pkt, flags, false/*don't poll*/, NULL);
+    }
+    ci_netif_pkt_release(ni, pkt);
+  }
+  return 0;
+}
+
+
+void ci_udp_txtime_release(ci_netif* ni)
+{
+  ci_netif_state* nis = ni->state;
+  struct oo_p_dllink_state list = oo_p_dllink_ptr(ni, &nis->udp_txtime_list);
+  struct oo_p_dllink_state lnk, tmp;
+  ci_uint64 now, t, next = 0;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  ci_frc64(&now);
+  if( ! ci_udp_txtime_due(ni, now) ) {
+    /* The timer fired early, or we've been called from the poll loop. */
+    if( nis->udp_txtime_next != 0 &&
+        ! ci_ip_timer_pending(ni, &nis->udp_txtime_tid) )
+      ci_udp_txtime_arm(ni);
+    return;
+  }
+
+  oo_p_dllink_for_each_safe(ni, lnk, tmp, list) {
+    ci_udp_state* us = CI_CONTAINER(ci_udp_state, txtime_link, lnk.l);
+    t = ci_udp_txtime_release_sock(ni, us, now);
+    if( t == 0 )
+      oo_p_dllink_del_init(ni, lnk);
+    else if( next == 0 || (ci_int64) (t - next) < 0 )
+      next = t;
+  }
+
+  nis->udp_txtime_next = next;
+  if( next != 0 )
+    ci_udp_txtime_arm(ni);
+  else if( ci_ip_timer_pending(ni, &nis->udp_txtime_tid) )
+    ci_ip_timer_clear(ni, &nis->udp_txtime_tid);
+}
+
+
+/* Called when the last reference to the socket goes: there is no-one left
+ * to report to, so just free anything still waiting for its launch time.
+ * [udp_txtime_next] may now be stale, which costs at most one spurious
+ * call to ci_udp_txtime_release().
+ */
+void ci_udp_txtime_purge(ci_netif* ni, ci_udp_state* us)
+{
+  ci_ip_pkt_fmt* pkt;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  while( OO_PP_NOT_NULL(us->txtime_q) ) {
+    pkt = PKT_CHK(ni, us->txtime_q);
+    us->txtime_q = pkt->netif.tx.dmaq_next;
+    us->tx_count -= ci_udp_tx_datagram_level(ni, pkt, CI_TRUE);
+    fixup_pkt_not_transmitted(ni, pkt);
+    ci_netif_pkt_release(ni, pkt);
+  }
+  oo_p_dllink_del_init(ni, oo_p_dllink_sb(ni, &us->s.b, &us->txtime_link));
+}
+
 static void ci_udp_sendmsg_async_q_enqueue(ci_netif* ni, ci_udp_state* us,
                                            ci_ip_pkt_fmt* pkt, int flags)
 {
@@ -1228,6 +1494,53 @@ ci_inline ci_ip6_hdr* eth_ip6_init(ci_netif* ni, ci_udp_state* us,
 #endif
 
 
+/* Drop the refs taken for ci_netif_send() on a chain built by
+ * ci_udp_sendmsg_fill() and free the chain.
+ */
+static void ci_udp_sendmsg_fill_undo(ci_netif* ni, ci_ip_pkt_fmt* first_pkt,
+                                     struct udp_send_info* sinf)
+{
+  if( ! sinf->stack_locked && ci_netif_lock(ni) == 0 )
+    sinf->stack_locked = 1;
+
+  /* Release the refs we've taken for ci_netif_send().
+   * Unlike fixup_pkt_not_transmitted(), we can't rely that ->next links to
+   * the next IP fragment, because oo_pkt_fill() can leave it in other way.
+   * So, we should go through all fragments and decrement refcounts for IP
+   * fragments only. */
+  {
+    ci_ip_pkt_fmt* pkt = first_pkt;
+    int n_buffers;
+
+    while( 1 ) {
+      n_buffers = pkt->n_buffers;
+      ci_assert_gt(pkt->refcount, 1);
+      pkt->refcount--;
+      /* Skip scatter-gather fragments, we need to release
+       * IP fragments only. */
+      while( n_buffers-- > 0 ) {
+        CI_NETIF_STATE_MOD(ni, sinf->stack_locked, n_async_pkts, -);
+        if( OO_PP_IS_NULL(pkt->frag_next) )
+          goto pkt_chain_released;
+        pkt = PKT_CHK(ni, pkt->frag_next);
+      }
+    }
+  }
+ pkt_chain_released:
+
+  /* Free the packet chain by freeing the first fragment. */
+ #ifdef __KERNEL__
+   if( ! sinf->stack_locked )
+     ci_netif_set_merge_atomic_flag(ni);
+   ci_netif_pkt_release_mnl(ni, first_pkt, &sinf->stack_locked);
+ #else
+   /* ci_netif_lock() can't fail in UL */
+   ci_assert(sinf->stack_locked);
+   ci_netif_pkt_release(ni, first_pkt);
+ #endif
+}
+
+
 /* Allocate packet buffers and fill them with the payload.
  *
  * Returns [bytes_to_send] on success, -errno on failure.
@@ -1374,46 +1687,85 @@ int ci_udp_sendmsg_fill(ci_netif* ni, ci_udp_state* us,
   return bytes_to_send;
 
  fill_failed:
-  if( ! sinf->stack_locked && ci_netif_lock(ni) == 0 )
-    sinf->stack_locked = 1;
+  ci_udp_sendmsg_fill_undo(ni, first_pkt, sinf);
+  return rc;
+}
 
-  /* Release the refs we've taken for ci_netif_send().
-   * Unlike fixup_pkt_not_transmitted(), we can't rely that ->next links to
-   * the next IP fragment, because oo_pkt_fill() can leave it in other way.
-   * So, we should go through all fragments and decrement refcounts for IP
-   * fragments only. */
-  {
-    ci_ip_pkt_fmt* pkt = first_pkt;
-    int n_buffers;
 
-    while( 1 ) {
-      n_buffers = pkt->n_buffers;
-      ci_assert_gt(pkt->refcount, 1);
-      pkt->refcount--;
-      /* Skip scatter-gather fragments, we need to release
-       * IP fragments only. */
-      while( n_buffers-- > 0 ) {
-        CI_NETIF_STATE_MOD(ni, sinf->stack_locked, n_async_pkts, -);
-        if( OO_PP_IS_NULL(pkt->frag_next) )
-          goto pkt_chain_released;
-        pkt = PKT_CHK(ni, pkt->frag_next);
-      }
+/* Split [bytes_to_send] into datagrams of [sinf->gso_size] bytes of
+ * payload each, chained as ci_udp_sendmsg_fill() chains IP fragments.
+ *
+ * Returns the number of datagrams on success, -errno on failure.
+ */
+static
+int ci_udp_sendmsg_fill_gso(ci_netif* ni, ci_udp_state* us,
+                            ci_iovec_ptr* piov, int bytes_to_send,
+                            int flags,
+                            struct oo_pkt_filler* pf,
+                            struct udp_send_info* sinf)
+{
+  ci_ip_pkt_fmt* first_pkt = NULL;
+  ci_ip_pkt_fmt* last_pkt = NULL;
+  ci_ip_pkt_fmt* buf_pkt;
+  int rc, n, seg_bytes, n_segs = 0;
+
+  while( bytes_to_send > 0 ) {
+    seg_bytes = CI_MIN(bytes_to_send, sinf->gso_size);
+    rc = ci_udp_sendmsg_fill(ni, us, piov, seg_bytes, flags, pf, sinf,
+                             false);
+    if(CI_UNLIKELY( rc < 0 )) {
+      if( first_pkt != NULL )
+        ci_udp_sendmsg_fill_undo(ni, first_pkt, sinf);
+      return rc;
     }
+
+    if( first_pkt == NULL ) {
+      first_pkt = pf->pkt;
+    }
+    else {
+      /* Link from the last buffer of the previous datagram. */
+      buf_pkt = last_pkt;
+      for( n = last_pkt->n_buffers; n > 1; --n )
+        buf_pkt = PKT_CHK_NML(ni, buf_pkt->frag_next, sinf->stack_locked);
+      buf_pkt->frag_next = OO_PKT_P(pf->pkt);
+      last_pkt->next = OO_PKT_P(pf->pkt);
+    }
+    last_pkt = pf->pkt;
+    bytes_to_send -= seg_bytes;
+    ++n_segs;
   }
- pkt_chain_released:
 
-  /* Free the packet chain by freeing the first fragment. */
- #ifdef __KERNEL__
-   if( ! sinf->stack_locked )
-     ci_netif_set_merge_atomic_flag(ni);
-   ci_netif_pkt_release_mnl(ni, first_pkt, &sinf->stack_locked);
- #else
-   /* ci_netif_lock() can't fail in UL */
-   ci_assert(sinf->stack_locked);
-   ci_netif_pkt_release(ni, first_pkt);
- #endif
+  pf->pkt = first_pkt;
+  pf->last_pkt = last_pkt;
+  return n_segs;
+}
 
-  return rc;
+
+/* Validate a UDP_SEGMENT send as Linux does.
+ *
+ * Returns 0 to split the send in the stack, 1 to pass it to the OS socket,
+ * or -errno.
+ */
+static int ci_udp_sendmsg_gso_check(ci_netif* ni, ci_udp_state* us,
+                                    unsigned long bytes_to_send,
+                                    struct udp_send_info* sinf)
+{
+  int hdrs = CI_IPX_HDR_SIZE(ipcache_af(&us->s.pkt)) + sizeof(ci_udp_hdr);
+  ci_addr_t daddr = ipcache_raddr(&sinf->ipcache);
+
+  if( sinf->gso_size + hdrs > sinf->ipcache.mtu ||
+      bytes_to_send > (unsigned long) sinf->gso_size * CI_UDP_MAX_SEGMENTS )
+    return -EINVAL;
+
+  /* Looped-back multicast would be delivered as a single datagram, so
+   * leave the split to the kernel. */
+  if( CI_IPX_ADDR_IS_ANY(daddr) )
+    daddr = udp_ipx_raddr(us);
+  if( CI_IPX_IS_MULTICAST(daddr) && (us->udpflags & CI_UDPF_MCAST_LOOP) &&
+      (NI_OPTS(ni).mcast_send & CITP_MCAST_SEND_FLAG_LOCAL) )
+    return 1;
+
+  return 0;
 }
 
 
@@ -1429,6 +1781,7 @@ void ci_udp_sendmsg_onload(ci_netif* ni, ci_udp_state* us,
   int was_locked;
   int af = ipcache_af(&us->s.pkt);
   bool need_frag = false;
+  bool gso = false;
 
   /* Caller should guarantee the following: */
   ci_assert(ni);
@@ -1451,9 +1804,20 @@ void ci_udp_sendmsg_onload(ci_netif* ni, ci_udp_state* us,
     ci_iovec_ptr_init(&piov, NULL, 0);
   }
 
-  if( bytes_to_send > sinf->ipcache.mtu - CI_IPX_HDR_SIZE(af) -
-      sizeof(ci_udp_hdr) )
+  if( sinf->gso_size != 0 && bytes_to_send > sinf->gso_size ) {
+    rc = ci_udp_sendmsg_gso_check(ni, us, bytes_to_send, sinf);
+    if( rc < 0 ) {
+      sinf->rc = rc;
+      return;
+    }
+    if( rc > 0 )
+      goto send_via_os;
+    gso = true;
+  }
+  else if( bytes_to_send > sinf->ipcache.mtu - CI_IPX_HDR_SIZE(af) -
+           sizeof(ci_udp_hdr) ) {
     need_frag = true;
+  }
 
   /* For now we don't allocate packets in advance, so init to NULL */
   pf.alloc_pkt = NULL;
@@ -1498,8 +1862,12 @@ void ci_udp_sendmsg_onload(ci_netif* ni, ci_udp_state* us,
     }
     /* IP_PMTUDISC_PROBE does not do anything in non-connected case */
   }
-  rc = ci_udp_sendmsg_fill(ni, us, &piov, bytes_to_send, flags, &pf, sinf,
-                           need_frag);
+  if( gso )
+    rc = ci_udp_sendmsg_fill_gso(ni, us, &piov, bytes_to_send, flags, &pf,
+                                 sinf);
+  else
+    rc = ci_udp_sendmsg_fill(ni, us, &piov, bytes_to_send, flags, &pf, sinf,
+                             need_frag);
 #if CI_CFG_TIMESTAMPING
   if( us->s.timestamping_flags & ONLOAD_SOF_TIMESTAMPING_OPT_ID ) {
     pf.pkt->ts_key = us->s.ts_key;
@@ -1510,9 +1878,15 @@ void ci_udp_sendmsg_onload(ci_netif* ni, ci_udp_state* us,
     ++us->stats.n_tx_lock_pkt;
   if(CI_LIKELY( rc >= 0 )) {
     sinf->rc = bytes_to_send;
+    if( gso ) {
+      ++us->stats.n_tx_gso;
+      us->stats.n_tx_gso_segs += rc;
+    }
     TX_PKT_SET_DADDR(af, pf.pkt, ipcache_raddr(&sinf->ipcache));
     TX_PKT_IPX_UDP(af, pf.pkt, need_frag)->udp_dest_be16 =
         sinf->ipcache.dport_be16;
+    pf.pkt->pf.udp.txtime = sinf->txtime;
+    pf.pkt->pf.udp.txtime_ns = sinf->txtime_ns;
 
     if( si_trylock_and_inc(ni, sinf, us->stats.n_tx_lock_snd) ) {
       ci_udp_sendmsg_send(ni, us, pf.pkt, flags,
@@ -1581,9 +1955,40 @@ static int ci_udp_sendmsg_control_os(ci_fd_t fd, ci_udp_state *us,
 }
 #endif
 
-int ci_udp_sendmsg(ci_udp_iomsg_args *a,
-                   const ci_msghdr* msg, int flags
-                   CI_KERNEL_ARG(ci_addr_spc_t addr_spc))
+#if ! defined(__KERNEL__) && ! defined(__i386__)
+/* Convert an SCM_TXTIME launch time on the socket's clock to the frc, which
+ * the stack can check cheaply from the poll loop and from the kernel.
+ */
+static ci_uint64 ci_udp_txtime_to_frc(ci_netif* ni, ci_udp_state* us,
+                                      ci_uint64 txtime_ns)
+{
+  struct timespec ts;
+  ci_uint64 frc;
+  ci_int64 delta;
+
+  if( clock_gettime(us->txtime_clockid, &ts) != 0 )
+    return CI_UDP_TXTIME_INVALID;
+  ci_frc64(&frc);
+
+  delta = (ci_int64) (txtime_ns - (ts.tv_sec * 1000000000ull + ts.tv_nsec));
+  if( delta > CI_UDP_TXTIME_HORIZON_NS )
+    return CI_UDP_TXTIME_INVALID;
+  /* Anything further in the past is just as late, and this keeps the
+   * conversion below from overflowing.
+   */
+  if( delta < -CI_UDP_TXTIME_HORIZON_NS )
+    delta = -CI_UDP_TXTIME_HORIZON_NS;
+
+  delta = delta * (ci_int64) IPTIMER_STATE(ni)->khz / 1000000;
+  if( delta < 0 && (ci_uint64) -delta >= frc )
+    return 1;
+  return frc + delta;
+}
+#endif
+
+static int __ci_udp_sendmsg(ci_udp_iomsg_args *a,
+                            const ci_msghdr* msg, int flags
+                            CI_KERNEL_ARG(ci_addr_spc_t addr_spc))
 {
   ci_netif *ni = a->ni;
   ci_udp_state *us = a->us;
@@ -1600,6 +2005,9 @@ int ci_udp_sendmsg(ci_udp_iomsg_args *a,
   sinf.used_ipcache = 0;
   sinf.old_ipcache_updated = 0;
   sinf.timeout = us->s.so.sndtimeo_msec;
+  sinf.gso_size = us->gso_size;
+  sinf.txtime = 0;
+  sinf.txtime_ns = 0;
 #ifdef __KERNEL__
   sinf.addr_spc = addr_spc;
 #endif
@@ -1615,9 +2023,18 @@ int ci_udp_sendmsg(ci_udp_iomsg_args *a,
   if(CI_UNLIKELY( CMSG_FIRSTHDR(msg) != NULL )) {
     void* info = NULL;
     struct ci_scm_ts_pktinfo *ts_pktinfo = NULL;
-    if( ci_ip_cmsg_send(msg, &info, (void**)&ts_pktinfo) != 0 || info != NULL )
+    if( ci_ip_cmsg_send(msg, &info, (void**)&ts_pktinfo,
+                        &sinf.gso_size, &sinf.txtime_ns) != 0 ||
+        info != NULL )
       goto send_via_os;
 
+    if( sinf.txtime_ns != 0 ) {
+      /* Without SO_TXTIME the kernel rejects SCM_TXTIME, so let it. */
+      if( ! (us->udpflags & CI_UDPF_TXTIME) )
+        goto send_via_os;
+      sinf.txtime = ci_udp_txtime_to_frc(ni, us, sinf.txtime_ns);
+    }
+
     if( ts_pktinfo != NULL ) {
       cicp_hwport_mask_t hwports = 0;
       ci_hwport_id_t hwport;
@@ -1871,5 +2288,181 @@ int ci_udp_sendmsg(ci_udp_iomsg_args *a,
     RET_WITH_ERRNO(-rc);
 }
 
+
+int ci_udp_sendmsg(ci_udp_iomsg_args *a,
+                   const ci_msghdr* msg, int flags
+                   CI_KERNEL_ARG(ci_addr_spc_t addr_spc))
+{
+  int rc;
+  ci_netif_lat_hist_send_begin(a->ni);
+  rc = __ci_udp_sendmsg(a, msg, flags CI_KERNEL_ARG(addr_spc));
+  ci_netif_lat_hist_send_end(a->ni);
+  return rc;
+}
+
+
+#ifndef __KERNEL__
+/* Fill a datagram for each of [mmsg] that the connected fast path can take,
+ * and send them as one chain, as for UDP_SEGMENT.  So the whole batch takes
+ * the stack lock once and rings one doorbell.
+ *
+ * Returns the number of messages sent, or -errno if the chain could not be
+ * sent.  Returns 0 if the first message has to go by ci_udp_sendmsg(); any
+ * later message that does ends the batch.
+ */
+static int ci_udp_sendmmsg_batch(ci_netif* ni, ci_udp_state* us,
+                                 struct mmsghdr* mmsg, unsigned vlen,
+                                 int flags)
+{
+  ci_ip_cached_hdrs* ipcache = &us->s.pkt;
+  int af = ipcache_af(ipcache);
+  struct udp_send_info sinf;
+  struct oo_pkt_filler pf;
+  ci_iovec_ptr piov;
+  ci_ip_pkt_fmt* first_pkt = NULL;
+  ci_ip_pkt_fmt* last_pkt = NULL;
+  ci_ip_pkt_fmt* buf_pkt;
+  const struct msghdr* msg;
+  unsigned long bytes, total = 0;
+  unsigned i, max_payload;
+  int j, rc, relocked = 0;
+
+  if( (flags & (MSG_MORE | MSG_OOB | MSG_CONFIRM)) ||
+      ! (us->s.s_flags & CI_SOCK_FLAG_CONNECTED) ||
+      (us->s.so_error | us->s.tx_errno) || us->gso_size != 0 ||
+      (ipcache->flags & CI_IP_CACHE_REQUEST_HWPORT) )
+    return 0;
+#if CI_CFG_TIMESTAMPING
+  /* Each datagram would need its own TX timestamp. */
+  if( us->s.timestamping_flags != 0 )
+    return 0;
+#endif
+  /* A first message that the loop below would refuse goes by
+   * ci_udp_sendmsg() anyway, so don't take the lock just to find that out.
+   */
+  msg = &mmsg[0].msg_hdr;
+  if( msg->msg_namelen != 0 || msg->msg_controllen != 0 ||
+      (msg->msg_iov == NULL && msg->msg_iovlen != 0) )
+    return 0;
+
+  ci_netif_lat_hist_send_begin(ni);
+  ci_netif_lock(ni);
+  if( ipcache->status != retrrc_success ||
+      ! oo_cp_ipcache_is_valid(ni, ipcache) ||
+      CI_IPX_IS_MULTICAST(udp_ipx_raddr(us)) ) {
+    ci_netif_unlock(ni);
+    ci_netif_lat_hist_send_end(ni);
+    return 0;
+  }
+
+  sinf.rc = 0;
+  sinf.stack_locked = 1;
+  sinf.used_ipcache = 0;
+  sinf.old_ipcache_updated = 0;
+  sinf.timeout = us->s.so.sndtimeo_msec;
+  sinf.gso_size = 0;
+  sinf.txtime = 0;
+  sinf.txtime_ns = 0;
+#if CI_CFG_IPV6
+  sinf.ipcache.ether_type = ipcache->ether_type;
+#endif
+  ci_ipcache_set_daddr(&sinf.ipcache, addr_any);
+  sinf.ipcache.mtu = ipcache->mtu;
+  max_payload = ipcache->mtu - CI_IPX_HDR_SIZE(af) - sizeof(ci_udp_hdr);
+
+  for( i = 0; i < vlen && ! relocked; ++i ) {
+    msg = &mmsg[i].msg_hdr;
+    if( msg->msg_namelen != 0 || msg->msg_controllen != 0 ||
+        (msg->msg_iov == NULL && msg->msg_iovlen != 0) )
+      break;
+    bytes = 0;
+    for( j = 0; j < msg->msg_iovlen; ++j ) {
+      if( CI_IOVEC_BASE(&msg->msg_iov[j]) == NULL &&
+          CI_IOVEC_LEN(&msg->msg_iov[j]) > 0 )
+        break;
+      bytes += CI_IOVEC_LEN(&msg->msg_iov[j]);
+    }
+    if( j < msg->msg_iovlen || bytes > max_payload ||
+        ! UDP_HAS_SENDQ_SPACE(us, total + bytes) ||
+        ! ci_netif_pkt_tx_can_alloc_now(ni) )
+      break;
+
+    if( msg->msg_iovlen > 0 )
+      ci_iovec_ptr_init_nz(&piov, msg->msg_iov, msg->msg_iovlen);
+    else
+      ci_iovec_ptr_init(&piov, NULL, 0);
+    pf.alloc_pkt = NULL;
+    rc = ci_udp_sendmsg_fill(ni, us, &piov, bytes, flags, &pf, &sinf,
+                             false);
+    if(CI_UNLIKELY( ! sinf.stack_locked )) {
+      /* We waited for buffers.  Send what we have, and leave the rest. */
+      ci_netif_lock(ni);
+      sinf.stack_locked = 1;
+      relocked = 1;
+    }
+    if( rc < 0 )
+      break;
+
+    pf.pkt->pf.udp.txtime = 0;
+    pf.pkt->pf.udp.txtime_ns = 0;
+    if( first_pkt == NULL ) {
+      first_pkt = pf.pkt;
+    }
+    else {
+      /* Link from the last buffer of the previous datagram. */
+      buf_pkt = last_pkt;
+      for( j = last_pkt->n_buffers; j > 1; --j )
+        buf_pkt = PKT_CHK(ni, buf_pkt->frag_next);
+      buf_pkt->frag_next = OO_PKT_P(pf.pkt);
+      last_pkt->next = OO_PKT_P(pf.pkt);
+    }
+    last_pkt = pf.pkt;
+    total += bytes;
+    mmsg[i].msg_len = bytes;
+  }
+
+  if( first_pkt != NULL ) {
+    TX_PKT_SET_DADDR(af, first_pkt, addr_any);
+    ci_udp_sendmsg_send(ni, us, first_pkt, flags, ci_netif_may_poll(ni),
+                        &sinf);
+    ci_netif_pkt_release(ni, first_pkt);
+    ++us->stats.n_tx_mmsg;
+    us->stats.n_tx_mmsg_dgrams += i;
+  }
+  ci_netif_unlock(ni);
+  ci_netif_lat_hist_send_end(ni);
+  return sinf.rc < 0 ? sinf.rc : (int) i;
+}
+
+
+int ci_udp_sendmmsg(ci_udp_iomsg_args *a, struct mmsghdr* mmsg,
+                    unsigned int vlen, int flags)
+{
+  unsigned n = 0;
+  int rc;
+
+  while( n < vlen ) {
+    if( vlen - n > 1 &&
+        (rc = ci_udp_sendmmsg_batch(a->ni, a->us, mmsg + n, vlen - n,
+                                    flags)) != 0 ) {
+      if( rc < 0 ) {
+        if( n > 0 )
+          break;
+        RET_WITH_ERRNO(-rc);
+      }
+      n += rc;
+      continue;
+    }
+
+    rc = ci_udp_sendmsg(a, &mmsg[n].msg_hdr, flags);
+    if( rc < 0 )
+      return n > 0 ? (int) n : rc;
+    mmsg[n].msg_len = rc;
+    ++n;
+  }
+  return n;
+}
+#endif
+
 #endif
 /*! \cidoxg_end */
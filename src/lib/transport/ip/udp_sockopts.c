@@ -258,6 +258,14 @@ int ci_udp_getsockopt(citp_socket* ep, ci_fd_t fd, int level,
       }
       goto u_out;
     }
+    else if( optname == SO_TXTIME ) {
+      struct oo_sock_txtime txt = {
+        .clockid = us->txtime_clockid,
+        .flags = us->txtime_flags,
+      };
+      return ci_getsockopt_final(optval, optlen, SOL_SOCKET,
+                                 &txt, sizeof(txt));
+    }
     else {
       /* Common SOL_SOCKET option handler */
       return ci_get_sol_socket(netif, &us->s, optname, optval, optlen);
@@ -305,8 +313,18 @@ int ci_udp_getsockopt(citp_socket* ep, ci_fd_t fd, int level,
 #endif
 
   } else if (level == IPPROTO_UDP) {
-    /* We definitely don't support this */
-    RET_WITH_ERRNO(ENOPROTOOPT);
+    switch (optname) {
+    case UDP_SEGMENT:
+      u = us->gso_size;
+      goto u_out;
+
+    case UDP_GRO:
+      u = !!(us->s.cmsg_flags & CI_UDP_CMSG_GRO);
+      goto u_out;
+
+    default:
+      RET_WITH_ERRNO(ENOPROTOOPT);
+    }
   } else {
     SOCKOPT_RET_INVALID_LEVEL(&us->s);
   }
@@ -455,6 +473,18 @@ static int ci_udp_setsockopt_lk(citp_socket* ep, ci_fd_t fd, ci_fd_t os_sock,
       return ci_set_sol_socket(netif, &us->s, optname, optval, optlen);
       break;
 
+    case SO_TXTIME:
+    {
+      const struct oo_sock_txtime* txt = optval;
+      /* The OS socket has already vetted the clock and the flags. */
+      if( (rc = opt_not_ok(optval, optlen, struct oo_sock_txtime)) )
+        goto fail_inval;
+      us->txtime_clockid = txt->clockid;
+      us->txtime_flags = txt->flags & OO_SOF_TXTIME_FLAGS_MASK;
+      UDP_SET_FLAG(us, CI_UDPF_TXTIME);
+      break;
+    }
+
     default:
       /* Common socket level options */
       return ci_set_sol_socket(netif, &us->s, optname, optval, optlen);
@@ -642,7 +672,32 @@ static int ci_udp_setsockopt_lk(citp_socket* ep, ci_fd_t fd, ci_fd_t os_sock,
 #endif
 
   } else if (level == IPPROTO_UDP) {
-    RET_WITH_ERRNO(ENOPROTOOPT);
+    switch (optname) {
+    case UDP_SEGMENT:
+      if( (rc = opt_not_ok(optval, optlen, int)) )
+        goto fail_inval;
+      /* As Linux: any 16-bit value is accepted here, and checked against
+       * the path MTU at send time. */
+      v = *(int*) optval;
+      if( v < 0 || v > 0xffff ) {
+        rc = -EINVAL;
+        goto fail_inval;
+      }
+      us->gso_size = v;
+      break;
+
+    case UDP_GRO:
+      if( (rc = opt_not_ok(optval, optlen, int)) )
+        goto fail_inval;
+      if( ci_get_optval(optval, optlen) )
+        us->s.cmsg_flags |= CI_UDP_CMSG_GRO;
+      else
+        us->s.cmsg_flags &= ~CI_UDP_CMSG_GRO;
+      break;
+
+    default:
+      RET_WITH_ERRNO(ENOPROTOOPT);
+    }
   }
   else {
     LOG_U(log(FNS_FMT "unknown level=%d optname=%d accepted by O/S",
@@ -180,31 +180,57 @@ citp_ul_epoll_member_to_fdi(struct citp_epoll_member* eitem)
 
 
 #if CI_CFG_EPOLL3
-static void
-citp_epoll_set_home_stack(struct citp_epoll_fd* ep, ci_netif* ni)
+/* Returns the index of [ni] in ep->homes, or -1 if it is not a home. */
+ci_inline int citp_epoll_find_home(struct citp_epoll_fd* ep, ci_netif* ni)
 {
-  struct oo_epoll1_set_home_arg op;
-  int rc;
+  int i;
 
-  ep->ready_list = ci_netif_get_ready_list(ni);
-  if( ep->ready_list < 0 )
-    return;
+  ci_assert(ni);
+  for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ )
+    if( ep->homes[i].ni == ni )
+      return i;
+  return -1;
+}
+
+
+/* Make [ni] a home stack if we have room for another one and it has a
+ * free ready list.  Returns the index of the new home, or -1. */
+static int
+citp_epoll_add_home(struct citp_epoll_fd* ep, ci_netif* ni)
+{
+  struct oo_epoll1_set_home_slot_arg op;
+  struct citp_epoll_home* home;
+  int i, rc;
+
+  if( ep->n_homes >= CI_MIN(CITP_OPTS.ul_epoll_max_homes,
+                            CI_CFG_EPOLL3_MAX_HOMES) )
+    return -1;
+  for( i = 0; ep->homes[i].ni != NULL; i++ )
+    ci_assert_lt(i, CI_CFG_EPOLL3_MAX_HOMES - 1);
+  home = &ep->homes[i];
+
+  home->ready_list = ci_netif_get_ready_list(ni);
+  if( home->ready_list < 0 )
+    return -1;
 
-  Log_POLL(ci_log("%s: Set home stack using ready list %d "
+  Log_POLL(ci_log("%s: Set home stack %d using ready list %d "
                   "stack %s",
-                  __FUNCTION__, ep->ready_list, ni->state->pretty_name));
+                  __FUNCTION__, i, home->ready_list, ni->state->pretty_name));
 
   op.sockfd = ci_netif_get_driver_handle(ni);
-  op.ready_list = ep->ready_list;
-  rc = ci_sys_ioctl(ep->epfd_os, OO_EPOLL1_IOC_SET_HOME_STACK, &op);
-  if( rc == 0 ) {
-    citp_netif_add_ref(ni);
-    ep->home_stack = ni;
-  }
-  else {
-    ci_netif_put_ready_list(ni, ep->ready_list);
-    ep->ready_list = -1;
+  op.ready_list = home->ready_list;
+  op.home = i;
+  rc = ci_sys_ioctl(ep->epfd_os, OO_EPOLL1_IOC_SET_HOME_SLOT, &op);
+  if( rc != 0 ) {
+    ci_netif_put_ready_list(ni, home->ready_list);
+    home->ready_list = -1;
+    return -1;
   }
+  citp_netif_add_ref(ni);
+  home->ni = ni;
+  home->sockets_n = 0;
+  ep->n_homes++;
+  return i;
 }
 
 static int citp_epoll_sb_state_alloc(citp_socket* sock)
@@ -245,44 +271,48 @@ static void citp_epoll_sb_state_set(struct citp_epoll_member* eitem,
 {
   ci_sb_epoll_state* epoll;
   struct oo_p_dllink_state link;
+  ci_netif* ni = sock->netif;
+  int id = eitem->ready_list_id;
 
   ci_assert(OO_PP_NOT_NULL(sock->s->b.epoll));
+  ci_assert(ep->homes[eitem->home].ni == ni);
+  ci_assert_equal(ep->homes[eitem->home].ready_list, id);
 
-  epoll = ci_ni_aux_p2epoll(sock->netif, sock->s->b.epoll);
-  link = ci_sb_epoll_ready_link(ep->home_stack, epoll, ep->ready_list);
+  epoll = ci_ni_aux_p2epoll(ni, sock->s->b.epoll);
+  link = ci_sb_epoll_ready_link(ni, epoll, id);
 
   /* This epoll set owns the ready list id, so it must be free in the
    * socket */
-  ci_assert_nflags(sock->s->b.ready_lists_in_use, 1 << ep->ready_list);
-  OO_P_DLLINK_ASSERT_EMPTY(ep->home_stack, link);
+  ci_assert_nflags(sock->s->b.ready_lists_in_use, 1 << id);
+  OO_P_DLLINK_ASSERT_EMPTY(ni, link);
 
-  CI_USER_PTR_SET(epoll->e[ep->ready_list].eitem, eitem);
+  CI_USER_PTR_SET(epoll->e[id].eitem, eitem);
 
   /* Tell others that we are in the list */
-  ci_netif_lock(ep->home_stack);
-  sock->s->b.ready_lists_in_use |= 1 << ep->ready_list;
-  oo_p_dllink_add_tail(ep->home_stack,
-                       oo_p_dllink_ptr(ep->home_stack,
-                                       &ep->home_stack->state->
-                                            unready_lists[ep->ready_list]),
+  ci_netif_lock(ni);
+  sock->s->b.ready_lists_in_use |= 1 << id;
+  oo_p_dllink_add_tail(ni, oo_p_dllink_ptr(ni, &ni->state->unready_lists[id]),
                        link);
-  ci_netif_unlock(ep->home_stack);
+  ci_netif_unlock(ni);
 }
 
 
 static void
 citp_epoll_promote_to_home(struct citp_epoll_member* eitem, citp_fdinfo* fd_fdi,
-                           citp_socket* sock, struct citp_epoll_fd* ep)
+                           citp_socket* sock, struct citp_epoll_fd* ep,
+                           int home)
 {
-  Log_POLL(ci_log("%s:  fd %d", __FUNCTION__, eitem->fd));
+  Log_POLL(ci_log("%s:  fd %d home %d", __FUNCTION__, eitem->fd, home));
   /* Sockets from the oo_sockets list are added to the OS epoll set.
    * We'll handle it when deleting them, see citp_epoll_ctl_onload_del().
    */
   ci_dllist_remove_safe(&eitem->dllink);
   ep->oo_sockets_n--;
   eitem->item_list = &ep->oo_stack_sockets;
-  eitem->ready_list_id = ep->ready_list;
+  eitem->ready_list_id = ep->homes[home].ready_list;
+  eitem->home = home;
   eitem->flags &=~ CITP_EITEM_FLAG_POLL_END;
+  ep->homes[home].sockets_n++;
   ep->oo_stack_sockets_n++;
 
   ci_dllist_push(&ep->oo_stack_sockets, &eitem->dllink);
@@ -295,6 +325,7 @@ citp_epoll_try_promote_to_home(struct citp_epoll_member* eitem,
                                struct citp_epoll_fd* ep, citp_fdinfo* fdi)
 {
   citp_socket* sock;
+  int home;
 
   ci_assert_equal(CITP_OPTS.ul_epoll, 3);
   if( ! citp_fdinfo_is_socket(fdi) )
@@ -303,30 +334,42 @@ citp_epoll_try_promote_to_home(struct citp_epoll_member* eitem,
   sock = fdi_to_socket(fdi);
   if( citp_epoll_sb_state_alloc(sock) != 0 )
     return;
-  if( ep->home_stack == NULL )
-    citp_epoll_set_home_stack(ep, sock->netif);
-  if( sock->netif == ep->home_stack )
-    citp_epoll_promote_to_home(eitem, fdi, sock, ep);
+  home = citp_epoll_find_home(ep, sock->netif);
+  if( home < 0 )
+    home = citp_epoll_add_home(ep, sock->netif);
+  if( home >= 0 )
+    citp_epoll_promote_to_home(eitem, fdi, sock, ep, home);
 }
 
 
-static void citp_epoll_last_stack_socket_gone(struct citp_epoll_fd* epoll_fd,
-                                              int fdt_locked)
+/* Called when the last member using the ready list of ep->homes[home] has
+ * gone.  Frees up the slot, and then tries to find a home for the members
+ * that didn't have one.
+ */
+static void citp_epoll_last_home_socket_gone(struct citp_epoll_fd* epoll_fd,
+                                             int home, int fdt_locked)
 {
+  struct citp_epoll_home* h = &epoll_fd->homes[home];
   struct citp_epoll_member* e;
   struct citp_epoll_member* enext;
+  ci_int32 home_arg = home;
+
+  ci_assert(h->ni);
+  ci_assert_equal(h->sockets_n, 0);
 
   /* Release the ready list.  We don't bother to sync this to the kernel. */
-  ci_assert(ci_dllist_is_empty(&epoll_fd->oo_stack_sockets));
-  ci_assert(ci_dllist_is_empty(&epoll_fd->oo_stack_not_ready_sockets));
-  ci_assert(ci_dllist_is_empty(&epoll_fd->dead_stack_sockets));
-  ci_sys_ioctl(epoll_fd->epfd_os, OO_EPOLL1_IOC_REMOVE_HOME_STACK);
-  ci_netif_put_ready_list(epoll_fd->home_stack, epoll_fd->ready_list);
+  ci_sys_ioctl(epoll_fd->epfd_os, OO_EPOLL1_IOC_REMOVE_HOME_SLOT, &home_arg);
+  ci_netif_put_ready_list(h->ni, h->ready_list);
 
-  citp_netif_release_ref(epoll_fd->home_stack, fdt_locked);
+  citp_netif_release_ref(h->ni, fdt_locked);
 
-  epoll_fd->home_stack = NULL;
-  epoll_fd->ready_list = -1;
+  h->ni = NULL;
+  h->ready_list = -1;
+  if( --epoll_fd->n_homes == 0 ) {
+    ci_assert(ci_dllist_is_empty(&epoll_fd->oo_stack_sockets));
+    ci_assert(ci_dllist_is_empty(&epoll_fd->oo_stack_not_ready_sockets));
+    ci_assert(ci_dllist_is_empty(&epoll_fd->dead_stack_sockets));
+  }
   if( epoll_fd->closing )
     return;
 
@@ -353,10 +396,11 @@ static void citp_remove_home_member(struct citp_epoll_fd* epoll_fd,
 {
   ci_netif* ni;
   citp_socket* sock;
+  int home = eitem->home;
 
   ci_assert(eitem);
   ci_assert_ge(eitem->ready_list_id, 0);
-  ci_assert(epoll_fd->home_stack);
+  ci_assert(epoll_fd->homes[home].ni);
 
   ci_dllist_remove_safe(&eitem->dllink);
   epoll_fd->oo_stack_sockets_n--;
@@ -381,8 +425,8 @@ static void citp_remove_home_member(struct citp_epoll_fd* epoll_fd,
     ci_netif_unlock(ni);
   }
 
-  if( epoll_fd->oo_stack_sockets_n == 0 )
-    citp_epoll_last_stack_socket_gone(epoll_fd, fdt_locked);
+  if( --epoll_fd->homes[home].sockets_n == 0 )
+    citp_epoll_last_home_socket_gone(epoll_fd, home, fdt_locked);
 }
 
 
@@ -393,6 +437,7 @@ static void citp_epoll_cleanup_dead_home_socks(struct citp_epoll_fd* ep,
                                                int fdt_locked)
 {
   struct citp_epoll_member* eitem;
+  int home;
 
   oo_wqlock_lock(&ep->dead_stack_lock);
   while( ci_dllist_not_empty(&ep->dead_stack_sockets) ) {
@@ -405,12 +450,15 @@ static void citp_epoll_cleanup_dead_home_socks(struct citp_epoll_fd* ep,
      * We just need to remove this eitem from any other queue it's on, and
      * free it.
      */
+    home = eitem->home;
     ci_dllist_remove(&eitem->dllink);
     ci_dllist_remove(&eitem->dead_stack_link);
     CI_FREE_OBJ(eitem);
     ci_assert_gt(ep->oo_stack_sockets_n, 0);
-    if( --ep->oo_stack_sockets_n == 0 )
-      citp_epoll_last_stack_socket_gone(ep, fdt_locked);
+    ep->oo_stack_sockets_n--;
+    ci_assert_gt(ep->homes[home].sockets_n, 0);
+    if( --ep->homes[home].sockets_n == 0 )
+      citp_epoll_last_home_socket_gone(ep, home, fdt_locked);
   }
   oo_wqlock_unlock(&ep->dead_stack_lock, NULL);
 }
@@ -506,7 +554,7 @@ static void citp_epoll_dtor(citp_fdinfo* fdi, int fdt_locked)
   ep->closing = 1;
 
 #if CI_CFG_EPOLL3
-  if( ep->home_stack ) {
+  if( ep->n_homes ) {
     /* Cleaning up the dead sockets must be done first, to ensure that they're
      * removed from the other lists before we process them.
      */
@@ -670,8 +718,16 @@ int citp_epoll_create(int size, int flags)
   ep->oo_stack_sockets_n = 0;
   ci_dllist_init(&ep->oo_stack_not_ready_sockets);
   ci_dllist_init(&ep->dead_stack_sockets);
-  ep->home_stack = NULL;
-  ep->ready_list = -1;
+  {
+    int i;
+    for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ ) {
+      ep->homes[i].ni = NULL;
+      ep->homes[i].ready_list = -1;
+      ep->homes[i].sockets_n = 0;
+    }
+  }
+  ep->n_homes = 0;
+  ep->home_rr = 0;
   ci_dllist_init(&ep->epi_list);
   ci_dllist_push(&ep->epi_list, &epi->dllink);
 #endif
@@ -752,6 +808,7 @@ citp_epoll_find(struct citp_epoll_fd* ep, const citp_fdinfo* fd_fdi,
 #if CI_CFG_EPOLL3
   citp_socket* sock;
   ci_sb_epoll_state* epoll;
+  int home, id;
 
   /* We don't know how long ago the fdi was aquired - although we know it's
    * still valid because we hold a reference.  All sorts of things could have
@@ -773,16 +830,17 @@ citp_epoll_find(struct citp_epoll_fd* ep, const citp_fdinfo* fd_fdi,
    *
    * We also need to be certain that we actually own this eitem.
    */
-  if( ep->home_stack != sock->netif )
+  if( (home = citp_epoll_find_home(ep, sock->netif)) < 0 )
     goto out;
   if( OO_PP_IS_NULL(sock->s->b.epoll) )
     goto out;
   epoll = ci_ni_aux_p2epoll(sock->netif, sock->s->b.epoll);
-  if( (sock->s->b.ready_lists_in_use & (1 << ep->ready_list)) == 0 )
+  id = ep->homes[home].ready_list;
+  if( (sock->s->b.ready_lists_in_use & (1 << id)) == 0 )
     goto out;
 
   oo_wqlock_lock(&ep->dead_stack_lock);
-  *eitem_out = CI_USER_PTR_GET(epoll->e[ep->ready_list].eitem);
+  *eitem_out = CI_USER_PTR_GET(epoll->e[id].eitem);
   oo_wqlock_unlock(&ep->dead_stack_lock, NULL);
   ci_assert(eitem_out);
 
@@ -825,6 +883,7 @@ static void citp_eitem_init(struct citp_epoll_member* eitem,
   eitem->fdi_seq = fd_fdi->seq;
 #if CI_CFG_EPOLL3
   eitem->ready_list_id = -1;
+  eitem->home = -1;
   ci_dllink_self_link(&eitem->dead_stack_link);
 #endif
   eitem->flags = 0;
@@ -832,14 +891,16 @@ static void citp_eitem_init(struct citp_epoll_member* eitem,
 
 #if CI_CFG_EPOLL3
 static void citp_epoll_ctl_onload_add_home(struct citp_epoll_member* eitem,
-                                           struct citp_epoll_fd* ep,
+                                           struct citp_epoll_fd* ep, int home,
                                            citp_socket* sock,
                                            citp_fdinfo* fd_fdi, int epoll_fd,
                                            ci_uint64 epoll_fd_seq)
 {
   eitem->item_list = &ep->oo_stack_sockets;
-  eitem->ready_list_id = ep->ready_list;
+  eitem->ready_list_id = ep->homes[home].ready_list;
+  eitem->home = home;
   eitem->flags &=~ (CITP_EITEM_FLAG_POLL_END | CITP_EITEM_FLAG_OS_SYNC);
+  ep->homes[home].sockets_n++;
   ep->oo_stack_sockets_n++;
 
   /* We start it out on the ready list - if it's already ready it won't be
@@ -915,6 +976,9 @@ static int citp_epoll_ctl_onload_add_new(struct citp_epoll_member** eitem_out,
 {
   citp_socket* sock = NULL;
   ci_netif* ni;
+#if CI_CFG_EPOLL3
+  int home = -1;
+#endif
 
   *eitem_out = CI_ALLOC_OBJ(struct citp_epoll_member);
   if( *eitem_out == NULL ) {
@@ -934,7 +998,7 @@ static int citp_epoll_ctl_onload_add_new(struct citp_epoll_member** eitem_out,
   ni = sock->netif;
 
 #if CI_CFG_EPOLL3
-  if( (CITP_OPTS.ul_epoll == 3) && CI_UNLIKELY(!ep->home_stack) && sock &&
+  if( (CITP_OPTS.ul_epoll == 3) && CI_UNLIKELY(ep->n_homes == 0) && sock &&
        citp_epoll_can_rehome_on_scalable(ni) ) {
     char* name;
     int empty;
@@ -957,29 +1021,31 @@ static int citp_epoll_ctl_onload_add_new(struct citp_epoll_member** eitem_out,
     }
   }
 
-  /* If we don't already have a home stack, then see if we can get a ready
-   * list for this socket's stack, and if so use that.
+  /* If this socket's stack is not already one of our home stacks, then
+   * see if we have room for another home and can get a ready list for this
+   * socket's stack, and if so use that.
    *
-   * There's a gap here between deciding to use this socket's stack for our
+   * There's a gap here between deciding to use this socket's stack for a
    * home stack, and actually claiming this socket as ours, but I'm deeming
    * the chance of this socket being added to another socket in parallel
    * sufficiently low that the cost of locking more widely to avoid it isn't
    * worth it.  Things will work fine, we just potentially won't end up with
-   * any sockets in our home stack, but currently home stack selection is not
-   * guaranteed to be in any way optimal anyway.
+   * any sockets in that home stack, but currently home stack selection is
+   * not guaranteed to be in any way optimal anyway.
    */
-  if( (CITP_OPTS.ul_epoll == 3) && CI_UNLIKELY(!ep->home_stack) && sock &&
-       citp_epoll_sb_state_alloc(sock) == 0 ) {
-    citp_epoll_set_home_stack(ep, ni);
+  if( (CITP_OPTS.ul_epoll == 3) && sock &&
+      citp_epoll_sb_state_alloc(sock) == 0 ) {
+    home = citp_epoll_find_home(ep, ni);
+    if( home < 0 )
+      home = citp_epoll_add_home(ep, ni);
   }
 
-  /* If we have a home stack then need to check if this fd lives there.
-   * If so we can add it to our cool sockets list, if not we'll do it the old
-   * school way.
+  /* If this fd lives in a home stack we can add it to our cool sockets
+   * list, if not we'll do it the old school way.
    */
-  if( ep->home_stack == ni && citp_epoll_sb_state_alloc(sock) == 0 ) {
-    citp_epoll_ctl_onload_add_home(*eitem_out, ep, sock, fd_fdi, epoll_fd,
-                                   epoll_fd_seq);
+  if( home >= 0 ) {
+    citp_epoll_ctl_onload_add_home(*eitem_out, ep, home, sock, fd_fdi,
+                                   epoll_fd, epoll_fd_seq);
     *sync_kernel = 0;
   }
   else
@@ -1570,14 +1636,19 @@ static int citp_ul_epoll_one(struct oo_ul_epoll_state*__restrict__ eps,
 
 
 #if CI_CFG_EPOLL3
-static void citp_epoll_get_ready_list(struct oo_ul_epoll_state*
-                                      __restrict__ eps)
+/* Move the sockets on the ready list of [home] to our list of potentially
+ * ready home sockets.  Returns the last one moved, or NULL.
+ */
+static struct citp_epoll_member*
+citp_epoll_get_home_ready_list(struct oo_ul_epoll_state* __restrict__ eps,
+                               struct citp_epoll_home* home)
 {
-  ci_netif* ni = eps->ep->home_stack;
+  ci_netif* ni = home->ni;
+  int id = home->ready_list;
   struct oo_p_dllink_state ready_list =
-      oo_p_dllink_ptr(ni, &ni->state->ready_lists[eps->ep->ready_list]);
+      oo_p_dllink_ptr(ni, &ni->state->ready_lists[id]);
   struct oo_p_dllink_state unready_list =
-      oo_p_dllink_ptr(ni, &ni->state->unready_lists[eps->ep->ready_list]);
+      oo_p_dllink_ptr(ni, &ni->state->unready_lists[id]);
   struct oo_p_dllink_state lnk, tmp;
   struct citp_epoll_member* eitem = NULL;
   int stack_locked = 0;
@@ -1589,14 +1660,20 @@ static void citp_epoll_get_ready_list(struct oo_ul_epoll_state*
     stack_locked = __citp_poll_if_needed(ni, eps->this_poll_frc,
                                          eps->ul_epoll_spin);
 
-  if( ! stack_locked )
+  if( ! stack_locked ) {
+    /* Don't take the lock of a stack with nothing for us.  Anything that
+     * is added to the ready list after this check is seen next time, and
+     * the kernel checks the ready list before we block.
+     */
+    if( oo_p_dllink_is_empty(ni, ready_list) )
+      return NULL;
     ci_netif_lock(ni);
+  }
   oo_p_dllink_for_each_safe(ni, lnk, tmp, ready_list) {
     ci_sb_epoll_state* epoll;
-    epoll = CI_CONTAINER(ci_sb_epoll_state,
-                         e[eps->ep->ready_list].ready_link, lnk.l);
+    epoll = CI_CONTAINER(ci_sb_epoll_state, e[id].ready_link, lnk.l);
 
-    eitem = CI_USER_PTR_GET(epoll->e[eps->ep->ready_list].eitem);
+    eitem = CI_USER_PTR_GET(epoll->e[id].eitem);
     oo_p_dllink_del(ni, lnk);
     oo_p_dllink_add_tail(ni, unready_list, lnk);
     ci_assert(eitem);
@@ -1610,12 +1687,37 @@ static void citp_epoll_get_ready_list(struct oo_ul_epoll_state*
     ci_dllist_push_tail(&eps->ep->oo_stack_sockets,
                         &((struct citp_epoll_member*)eitem)->dllink);
   }
-  if( eitem ) {
+  ci_netif_unlock(ni);
+  return eitem;
+}
+
+
+static void citp_epoll_get_ready_list(struct oo_ul_epoll_state*
+                                      __restrict__ eps)
+{
+  struct citp_epoll_fd* ep = eps->ep;
+  struct citp_epoll_member* eitem;
+  struct citp_epoll_member* last = NULL;
+  int i, h;
+
+  /* Start from a different home each time, so that a busy stack doesn't
+   * always get to the front of the queue.
+   */
+  for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ ) {
+    h = (ep->home_rr + i) % CI_CFG_EPOLL3_MAX_HOMES;
+    if( ep->homes[h].ni == NULL )
+      continue;
+    eitem = citp_epoll_get_home_ready_list(eps, &ep->homes[h]);
+    if( eitem != NULL )
+      last = eitem;
+  }
+  ep->home_rr = (ep->home_rr + 1) % CI_CFG_EPOLL3_MAX_HOMES;
+
+  if( last ) {
     /* mark that when we remove this item from ready list we shall poll
      * other as well as os fds */
-    eitem->flags |= CITP_EITEM_FLAG_POLL_END;
+    last->flags |= CITP_EITEM_FLAG_POLL_END;
   }
-  ci_netif_unlock(ni);
 }
 
 
@@ -1715,15 +1817,15 @@ static void citp_epoll_poll_ul_other(struct oo_ul_epoll_state* __restrict__ eps)
 static void citp_epoll_poll_ul(struct oo_ul_epoll_state*__restrict__ eps)
 {
 #if CI_CFG_EPOLL3
-  /* First check any sockets in our home stack */
-  if( eps->ep->home_stack )
+  /* First check any sockets in our home stacks */
+  if( eps->ep->n_homes )
     citp_epoll_poll_ul_home_stack(eps);
 #endif
 
   /* Then check any other accelerated sockets if we still have space */
   if( eps->events < eps->events_top ) {
 #if CI_CFG_EPOLL3
-    if( eps->ep->home_stack )
+    if( eps->ep->n_homes )
       ci_assert_flags(eps->phase, EPOLL_PHASE_DONE_ACCELERATED);
 #endif
     citp_epoll_poll_ul_other(eps);
@@ -1904,7 +2006,7 @@ int citp_epoll_wait(citp_fdinfo* fdi, struct epoll_event*__restrict__ events,
     int need_to_process_other = 0;
     /* get ready list anyway and tag its end */
 #if CI_CFG_EPOLL3
-    if( eps.ep->home_stack )
+    if( eps.ep->n_homes )
       citp_epoll_get_ready_list(&eps);
 #endif
     if( ~eps.phase & EPOLL_PHASE_DONE_OTHER ) {
@@ -2083,9 +2185,12 @@ no_events:
      * that the stack continues to be polled, so if we've looked at everything
      * and nothing's ready yet then poll now.
      */
-    if( ordering && ordering->ordering_stack)
-      citp_poll_if_needed(ordering->ordering_stack, eps.this_poll_frc,
-                          eps.ul_epoll_spin);
+    if( ordering ) {
+      int i;
+      for( i = 0; i < ordering->n_ordering_stacks; i++ )
+        citp_poll_if_needed(ordering->ordering_stacks[i], eps.this_poll_frc,
+                            eps.ul_epoll_spin);
+    }
     if( CITP_OPTS.sleep_spin_usec ) {
       struct oo_epoll1_spin_on_arg op = {};
       op.epoll_fd = fdi->fd;
@@ -2188,9 +2293,9 @@ no_events:
         citp_reenter_lib(lib_context);
 
         CITP_EPOLL_EP_LOCK(ep);
-        /* We MUST check that home stack has not disappeared while we were
+        /* We MUST check that home stacks have not disappeared while we were
          * waiting. */
-        if( eps.ep->home_stack )
+        if( eps.ep->n_homes )
           citp_epoll_poll_ul_home_stack(&eps);
         CITP_EPOLL_EP_UNLOCK(ep, 0);
 
@@ -2298,11 +2403,14 @@ void citp_epoll_on_move_do(citp_fdinfo* epoll_fdi, citp_fdinfo* fd_fdi,
     /* This was in our home stack, but now isn't.  Need to update the eitem
      * state to be appropriate for a non-home sock.
      */
+    int home = eitem->home;
+
     ci_dllist_remove(&eitem->dllink);
     ep->oo_stack_sockets_n--;
     eitem->ready_list_id = -1;
-    if( ep->oo_stack_sockets_n == 0 )
-      citp_epoll_last_stack_socket_gone(ep, fdt_locked);
+    eitem->home = -1;
+    if( --ep->homes[home].sockets_n == 0 )
+      citp_epoll_last_home_socket_gone(ep, home, fdt_locked);
 
     eitem->item_list = &ep->oo_sockets;
     ci_dllist_push(&ep->oo_sockets, &eitem->dllink);
@@ -2446,6 +2554,7 @@ void citp_epoll_on_close(citp_fdinfo* epoll_fdi, citp_fdinfo* fd_fdi,
   citp_socket* sock;
   ci_sb_epoll_state* epoll;
   ci_netif* ni;
+  int home, id;
 
   if( ! citp_fdinfo_is_socket(fd_fdi) )
     return;
@@ -2457,22 +2566,22 @@ void citp_epoll_on_close(citp_fdinfo* epoll_fdi, citp_fdinfo* fd_fdi,
     return;
 
   oo_wqlock_lock(&ep->dead_stack_lock);
-  if( ni != ep->home_stack )
+  if( (home = citp_epoll_find_home(ep, ni)) < 0 )
     goto unlock;
-  if( (sock->s->b.ready_lists_in_use & (1 << ep->ready_list)) == 0 )
+  id = ep->homes[home].ready_list;
+  if( (sock->s->b.ready_lists_in_use & (1 << id)) == 0 )
     goto unlock;
 
   epoll = ci_ni_aux_p2epoll(ni, sock->s->b.epoll);
-  eitem = CI_USER_PTR_GET(epoll->e[ep->ready_list].eitem);
+  eitem = CI_USER_PTR_GET(epoll->e[id].eitem);
 
 
   /* Only remove home members from the set here, because this hook is only
    * guaranteed to be called for home sockets as we only remember one epoll
    * set we've been added to.
    */
-  if( eitem && (eitem->ready_list_id == ep->ready_list) ) {
-    struct oo_p_dllink_state link = ci_sb_epoll_ready_link(ni, epoll,
-                                                           ep->ready_list);
+  if( eitem && (eitem->ready_list_id == id) ) {
+    struct oo_p_dllink_state link = ci_sb_epoll_ready_link(ni, epoll, id);
     Log_POLL(ci_log("%s: epoll_fd=%d fd=%d",
                     __FUNCTION__, fd_fdi->epoll_fd, fd_fdi->fd));
     /* At this point any of the eitem, sock buf, or fdinfo may still be in
@@ -2484,7 +2593,7 @@ void citp_epoll_on_close(citp_fdinfo* epoll_fdi, citp_fdinfo* fd_fdi,
     fd_fdi->epoll_fd = -1;
 
     ci_netif_lock(ni);
-    sock->s->b.ready_lists_in_use &=~ (1 << ep->ready_list);
+    sock->s->b.ready_lists_in_use &=~ (1 << id);
     oo_p_dllink_del(ni, link);
     oo_p_dllink_init(ni, link);
     ci_netif_unlock(ni);
@@ -2668,6 +2777,41 @@ static void citp_epoll_get_ordering_limit(ci_netif* ni,
 }
 
 
+/* The limit for a set spanning several stacks is the earliest of the
+ * per-stack limits.  A stack that has never received anything has no limit
+ * to contribute, so is ignored.
+ */
+static void citp_epoll_get_ordering_limits(struct citp_ordered_wait* wait,
+                                           struct timespec* limit_out)
+{
+  struct timespec ts;
+  int i, have_limit = 0;
+
+  limit_out->tv_sec = 0;
+  limit_out->tv_nsec = 0;
+
+  for( i = 0; i < wait->n_ordering_stacks; i++ ) {
+    ts.tv_sec = 0;
+    ts.tv_nsec = 0;
+    citp_epoll_get_ordering_limit(wait->ordering_stacks[i], &ts);
+    if( ts.tv_sec == 0 && ts.tv_nsec == 0 )
+      continue;
+    if( ! have_limit || citp_timespec_compare(&ts, limit_out) < 0 )
+      *limit_out = ts;
+    have_limit = 1;
+  }
+}
+
+
+static void citp_epoll_release_ordering_stacks(struct citp_ordered_wait* wait)
+{
+  int i;
+  for( i = 0; i < wait->n_ordering_stacks; i++ )
+    citp_netif_release_ref(wait->ordering_stacks[i], 0);
+  wait->n_ordering_stacks = 0;
+}
+
+
 static int citp_epoll_ordering_compare(const void* a, const void* b)
 {
   return citp_timespec_compare(
@@ -2765,7 +2909,6 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
   struct citp_epoll_member* eitem;
   citp_fdinfo* sock_fdi = NULL;
   citp_sock_fdi* sock_epi;
-  ci_netif* ni;
   struct timespec limit_ts = {0, 0};
   struct citp_ordered_wait wait;
   int n_socks;
@@ -2778,7 +2921,7 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
                    ep->epfd_syncs_needed));
 
  new_stack:
-  ni = NULL;
+  wait.n_ordering_stacks = 0;
 
   CITP_EPOLL_EP_LOCK(ep);
 
@@ -2801,7 +2944,7 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
    */
   n_socks = CI_MAX(maxevents,
 #if CI_CFG_EPOLL3
-                   ep->home_stack ? ep->oo_stack_sockets_n :
+                   ep->n_homes ? ep->oo_stack_sockets_n :
 #endif
                    ep->oo_sockets_n);
 
@@ -2828,9 +2971,15 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
   }
 
 #if CI_CFG_EPOLL3
-  if( ep->home_stack ) {
-    ni = ep->home_stack;
-    citp_netif_add_ref(ni);
+  if( ep->n_homes ) {
+    /* Events may come from any of the home stacks, so all of them bound
+     * the ordering limit. */
+    int i;
+    for( i = 0; i < CI_CFG_EPOLL3_MAX_HOMES; i++ )
+      if( ep->homes[i].ni != NULL ) {
+        citp_netif_add_ref(ep->homes[i].ni);
+        wait.ordering_stacks[wait.n_ordering_stacks++] = ep->homes[i].ni;
+      }
   }
   else
 #endif
@@ -2852,8 +3001,9 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
       if(CI_LIKELY( (sock_fdi = citp_ul_epoll_member_to_fdi(eitem)) != NULL )) {
         if( citp_fdinfo_is_socket(sock_fdi) ) {
           sock_epi = fdi_to_sock_fdi(sock_fdi);
-          ni = sock_epi->sock.netif;
-          citp_netif_add_ref(ni);
+          wait.ordering_stacks[0] = sock_epi->sock.netif;
+          wait.n_ordering_stacks = 1;
+          citp_netif_add_ref(wait.ordering_stacks[0]);
           break;
         }
       }
@@ -2867,11 +3017,10 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
   CITP_EPOLL_EP_UNLOCK(ep, 0);
 
  again:
-  citp_epoll_get_ordering_limit(ni, &limit_ts);
+  citp_epoll_get_ordering_limits(&wait, &limit_ts);
 
   wait.ordering_info = ep->ordering_info;
   wait.poll_again = 0;
-  wait.ordering_stack = ni;
   /* citp_epoll_wait will do citp_exit_lib */
   rc = citp_epoll_wait(fdi, ep->wait_events, &wait,
                        n_socks, timeout_hr, sigmask, NULL, lib_context);
@@ -2886,9 +3035,9 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
     ci_assert_gt(rc, 0);
     Log_VPOLL(ci_log("%s: need repoll at user level", __FUNCTION__));
     citp_reenter_lib(lib_context);
-    if( ni == NULL )
+    if( wait.n_ordering_stacks == 0 )
       goto new_stack;
-    citp_epoll_get_ordering_limit(ni, &limit_ts);
+    citp_epoll_get_ordering_limits(&wait, &limit_ts);
 
     rc = citp_epoll_wait(fdi, ep->wait_events, &wait, n_socks,
                          0, sigmask, NULL, lib_context);
@@ -2913,15 +3062,13 @@ int citp_epoll_ordered_wait(citp_fdinfo* fdi,
       citp_reenter_lib(lib_context);
       timeout_hr = wait.next_timeout_hr;
       Log_VPOLL(ci_log("%s: all events vanished.  Stack change?", __FUNCTION__));
-      if( ni )
-        citp_netif_release_ref(ni, 0);
+      citp_epoll_release_ordering_stacks(&wait);
       goto new_stack;
     }
   }
 
 out:
-  if( ni )
-    citp_netif_release_ref(ni, 0);
+  citp_epoll_release_ordering_stacks(&wait);
   return rc;
 }
 #endif /* CI_CFG_TIMESTAMPING */
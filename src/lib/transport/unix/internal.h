@@ -543,6 +543,17 @@ extern int citp_syscall_init(void) CI_HF;
 #undef socklen_t
 
 extern citp_fdinfo* citp_tcp_dup(citp_fdinfo* orig_fdi);
+extern int citp_tcp_sendfile(citp_fdinfo* fdi, int in_fd, off_t* offset,
+                             size_t count, ssize_t* p_rc);
+
+#if CI_CFG_USERSPACE_SYSCALL && CI_HAVE_IO_URING
+extern void citp_io_uring_init(void) CI_HF;
+extern long citp_io_uring_setup(unsigned entries, void* params) CI_HF;
+extern long citp_io_uring_enter(int fd, unsigned to_submit,
+                                unsigned min_complete, unsigned flags,
+                                const void* arg, size_t argsz) CI_HF;
+extern void citp_io_uring_close(int fd) CI_HF;
+#endif
 
 /* Locking order:
  * - citp_pkt_map_lock is the innermost lock;
@@ -24,6 +24,7 @@ LIB_SRCS	:=			\
 		sockcall_intercept.c	\
 		onload_ext_intercept.c	\
 		zc_intercept.c          \
+		uring_intercept.c	\
 		tmpl_intercept.c	\
 		stackname.c		\
 		stackopt.c		\
@@ -1830,6 +1830,68 @@ OO_INTERCEPT(ci_splice_return_type, splice, (int in_fd, loff_t* in_off,
 }
 
 
+static ssize_t citp_sendfile(int out_fd, int in_fd, off_t* offset,
+                             size_t count)
+{
+  citp_fdinfo* fdi;
+  citp_lib_context_t lib_context;
+  ssize_t rc;
+
+  Log_CALL(ci_log("%s(%d, %d, %p, %zu)", __FUNCTION__,
+                  out_fd, in_fd, offset, count));
+
+  if( CITP_OPTS.tcp_sendfile &&
+      (fdi = citp_fdtable_lookup_fast(&lib_context, out_fd)) ) {
+    int via_os = 1;
+    if( citp_fdinfo_get_type(fdi) == CITP_TCP_SOCKET )
+      via_os = citp_tcp_sendfile(fdi, in_fd, offset, count, &rc);
+    citp_fdinfo_release_ref_fast(fdi);
+    citp_exit_lib(&lib_context, via_os || rc >= 0);
+    if( ! via_os ) {
+      Log_CALL_RESULT((int) rc);
+      return rc;
+    }
+  }
+  else {
+    citp_exit_lib_if(&lib_context, TRUE);
+  }
+
+  /* Without EF_TCP_SENDFILE the kernel feeds the file to an accelerated
+   * socket a page at a time via our sendpage() handler. */
+  Log_PT(log("PT: sys_sendfile(%d, %d, %p, %zu)",
+             out_fd, in_fd, offset, count));
+  rc = ci_sys_sendfile(out_fd, in_fd, offset, count);
+  Log_CALL_RESULT((int) rc);
+  return rc;
+}
+
+
+OO_INTERCEPT(ssize_t, sendfile,
+             (int out_fd, int in_fd, off_t* offset, size_t count))
+{
+  if( CI_UNLIKELY(citp.init_level < CITP_INIT_ALL) ) {
+    citp_do_init(CITP_INIT_SYSCALLS);
+    return ci_sys_sendfile(out_fd, in_fd, offset, count);
+  }
+  return citp_sendfile(out_fd, in_fd, offset, count);
+}
+
+
+#ifdef __USE_LARGEFILE64
+OO_INTERCEPT(ssize_t, sendfile64,
+             (int out_fd, int in_fd, off64_t* offset, size_t count))
+{
+  /* We only support 64-bit platforms, where these are the same call. */
+  CI_BUILD_ASSERT(sizeof(off_t) == sizeof(off64_t));
+  if( CI_UNLIKELY(citp.init_level < CITP_INIT_ALL) ) {
+    citp_do_init(CITP_INIT_SYSCALLS);
+    return ci_sys_sendfile64(out_fd, in_fd, offset, count);
+  }
+  return citp_sendfile(out_fd, in_fd, (off_t*) offset, count);
+}
+#endif
+
+
 OO_INTERCEPT(int, close,
              (int fd))
 {
@@ -1844,6 +1906,9 @@ OO_INTERCEPT(int, close,
   citp_enter_lib(&lib_context);
   Log_CALL(ci_log("%s(%d)", __FUNCTION__, fd));
 
+#if CI_CFG_USERSPACE_SYSCALL && CI_HAVE_IO_URING
+  citp_io_uring_close(fd);
+#endif
   rc = citp_ep_close(fd);
 
   citp_exit_lib(&lib_context, rc == 0);
@@ -2768,6 +2833,7 @@ OO_INTERCEPT(long, syscall,
     NR(poll)
     NR(ppoll)
     NR(splice)
+    NR(sendfile)
     NR(read)
     NR(write)
     NR(readv)
@@ -2795,6 +2861,13 @@ OO_INTERCEPT(long, syscall,
 #if CI_LIBC_HAS_epoll_pwait2
     NR(epoll_pwait2)
 #endif /* CI_LIBC_HAS_epoll_pwait2 */
+#if CI_HAVE_IO_URING
+    /* There are no libc wrappers for these. */
+    case __NR_io_uring_setup:
+      return citp_io_uring_setup(a, (void*) b);
+    case __NR_io_uring_enter:
+      return citp_io_uring_enter(a, b, c, d, (const void*) e, f);
+#endif
     /* When adding new syscalls here, make sure to check that the libc API
     matches the kernel API. It does for almost everything (on x86-64) but
     there are a few exceptions.  */
@@ -157,6 +157,8 @@ static void citp_dump_opts(citp_opts_t *o)
   DUMP_OPT_INT("EF_UDP_SEND_SPIN",      udp_send_spin);
   DUMP_OPT_INT("EF_TCP_RECV_SPIN",      tcp_recv_spin);
   DUMP_OPT_INT("EF_TCP_SEND_SPIN",      tcp_send_spin);
+  DUMP_OPT_INT("EF_TCP_SENDFILE",       tcp_sendfile);
+  DUMP_OPT_INT("EF_IO_URING",           io_uring);
   DUMP_OPT_INT("EF_TCP_ACCEPT_SPIN",    tcp_accept_spin);
   DUMP_OPT_INT("EF_TCP_CONNECT_SPIN",   tcp_connect_spin);
   DUMP_OPT_INT("EF_PKT_WAIT_SPIN",      pkt_wait_spin);
@@ -171,6 +173,7 @@ static void citp_dump_opts(citp_opts_t *o)
   DUMP_OPT_INT("EF_EPOLL_CTL_FAST",     ul_epoll_ctl_fast);
   DUMP_OPT_INT("EF_EPOLL_CTL_HANDOFF",  ul_epoll_ctl_handoff);
   DUMP_OPT_INT("EF_EPOLL_MT_SAFE",      ul_epoll_mt_safe);
+  DUMP_OPT_INT("EF_EPOLL_MAX_HOMES",    ul_epoll_max_homes);
   DUMP_OPT_INT("EF_FDTABLE_SIZE",	fdtable_size);
   DUMP_OPT_INT("EF_SPIN_USEC",		ul_spin_usec);
   DUMP_OPT_INT("EF_SLEEP_SPIN_USEC",	sleep_spin_usec);
@@ -419,6 +422,8 @@ static void citp_opts_getenv(citp_opts_t* opts)
   GET_ENV_OPT_INT("EF_UDP_SEND_SPIN",   udp_send_spin);
   GET_ENV_OPT_INT("EF_TCP_RECV_SPIN",   tcp_recv_spin);
   GET_ENV_OPT_INT("EF_TCP_SEND_SPIN",   tcp_send_spin);
+  GET_ENV_OPT_INT("EF_TCP_SENDFILE",    tcp_sendfile);
+  GET_ENV_OPT_INT("EF_IO_URING",        io_uring);
   GET_ENV_OPT_INT("EF_TCP_ACCEPT_SPIN", tcp_accept_spin);
   GET_ENV_OPT_INT("EF_TCP_CONNECT_SPIN",tcp_connect_spin);
   GET_ENV_OPT_INT("EF_PKT_WAIT_SPIN",   pkt_wait_spin);
@@ -433,6 +438,7 @@ static void citp_opts_getenv(citp_opts_t* opts)
   GET_ENV_OPT_INT("EF_EPOLL_CTL_FAST",  ul_epoll_ctl_fast);
   GET_ENV_OPT_INT("EF_EPOLL_CTL_HANDOFF",ul_epoll_ctl_handoff);
   GET_ENV_OPT_INT("EF_EPOLL_MT_SAFE",   ul_epoll_mt_safe);
+  GET_ENV_OPT_INT("EF_EPOLL_MAX_HOMES", ul_epoll_max_homes);
   GET_ENV_OPT_INT("EF_WODA_SINGLE_INTERFACE", woda_single_if);
   GET_ENV_OPT_INT("EF_FDTABLE_SIZE",	fdtable_size);
   GET_ENV_OPT_INT("EF_SPIN_USEC",	ul_spin_usec);
@@ -607,6 +613,9 @@ citp_transport_init(void)
   ci_tp_init(__oo_per_thread_init_thread, oo_signal_terminate);
 
   citp_update_and_crosscheck(&ci_cfg_opts.netif_opts, &CITP_OPTS);
+#if CI_CFG_USERSPACE_SYSCALL && CI_HAVE_IO_URING
+  citp_io_uring_init();
+#endif
   return 0;
 }
 
@@ -19,6 +19,7 @@
 #include "ul_poll.h"
 #include "ul_select.h"
 #include <netinet/in.h>
+#include <sys/mman.h>
 #include <ci/internal/transport_config_opt.h>
 #include <ci/internal/transport_common.h>
 #include <ci/internal/ip.h>
@@ -1734,19 +1735,37 @@ static int citp_tcp_recvmmsg(citp_fdinfo* fdinfo, struct mmsghdr* msg,
                              unsigned vlen, int flags,
                              ci_recvmmsg_timespec* timeout)
 {
-  Log_E(ci_log("%s: TCP fd recvmmsg not supported by OpenOnload",
-               __FUNCTION__));
-  errno = ENOSYS;
-  return -1;
-}
+  citp_sock_fdi* epi = fdi_to_sock_fdi(fdinfo);
+  int rc;
 
-static int citp_tcp_sendmmsg(citp_fdinfo* fdinfo, struct mmsghdr* msg, 
-                             unsigned vlen, int flags)
-{
-  Log_E(ci_log("%s: TCP fd sendmmsg not supported by OpenOnload",
-               __FUNCTION__));
-  errno = ENOSYS;
-  return -1;
+  Log_V(ci_log(LPF "recvmmsg("EF_FMT", vlen=%u, "CI_SOCKCALL_FLAGS_FMT")",
+               EF_PRI_ARGS(epi, fdinfo->fd), vlen,
+               CI_SOCKCALL_FLAGS_PRI_ARG(flags)));
+
+  if( vlen == 0 )
+    return 0;
+
+  /* [timeout] is only checked between messages, and we never wait for any
+   * message but the first, so it makes no difference here. */
+  if( (flags & (MSG_PEEK | MSG_OOB | MSG_ERRQUEUE | MSG_WAITALL)) ||
+      epi->sock.s->b.state == CI_TCP_LISTEN ||
+      msg[0].msg_hdr.msg_iov == NULL || msg[0].msg_hdr.msg_iovlen == 0 ) {
+    /* These don't split into segments, so are done as one message. */
+    rc = citp_tcp_recv(fdinfo, &msg[0].msg_hdr, flags);
+    if( rc < 0 )
+      return rc;
+    msg[0].msg_len = rc;
+    return 1;
+  }
+
+  if( epi->sock.s->b.sb_aflags & (CI_SB_AFLAG_O_NONBLOCK |
+                                  CI_SB_AFLAG_O_NDELAY) )
+    flags |= MSG_DONTWAIT;
+  rc = ci_tcp_recvmmsg(epi->sock.netif, SOCK_TO_TCP(epi->sock.s), msg, vlen,
+                       flags & ~MSG_WAITFORONE);
+  Log_V(ci_log(LPF "recvmmsg("EF_FMT") = %d", EF_PRI_ARGS(epi, fdinfo->fd),
+               rc));
+  return rc;
 }
 
 static int citp_tcp_send(citp_fdinfo* fdinfo, const struct msghdr* msg,
@@ -1811,6 +1830,127 @@ static int citp_tcp_send(citp_fdinfo* fdinfo, const struct msghdr* msg,
 }
 
 
+/* Small messages are coalesced into as few segments as possible: all but
+ * the last go with MSG_MORE, so the stack holds back a part-filled segment
+ * until the batch is complete and then pushes it.
+ */
+static int citp_tcp_sendmmsg(citp_fdinfo* fdinfo, struct mmsghdr* msg, 
+                             unsigned vlen, int flags)
+{
+  citp_sock_fdi* epi = fdi_to_sock_fdi(fdinfo);
+  ci_netif* ni = epi->sock.netif;
+  unsigned i;
+  int rc = 0, more, held = 0;
+
+  Log_V(ci_log(LPF "sendmmsg("EF_FMT", vlen=%u, "CI_SOCKCALL_FLAGS_FMT")",
+               EF_PRI_ARGS(epi, fdinfo->fd), vlen,
+               CI_SOCKCALL_FLAGS_PRI_ARG(flags)));
+
+  for( i = 0; i < vlen; ++i ) {
+    more = (i + 1 < vlen && ! (flags & ONLOAD_MSG_WARM)) ? MSG_MORE : 0;
+    rc = citp_tcp_send(fdinfo, &msg[i].msg_hdr, flags | more);
+    if( rc < 0 )
+      break;
+    held = more;
+    msg[i].msg_len = rc;
+    if( rc < ci_iovec_bytes(msg[i].msg_hdr.msg_iov,
+                            msg[i].msg_hdr.msg_iovlen) ) {
+      ++i;
+      break;
+    }
+  }
+
+  if( held && ! (flags & MSG_MORE) ) {
+    /* We stopped early, so push out whatever the last send held back. */
+    ci_netif_lock(ni);
+    if( (epi->sock.s->b.state & CI_TCP_STATE_SYNCHRONISED) &&
+        ! (epi->sock.s->s_aflags & CI_SOCK_AFLAG_CORK) )
+      ci_tcp_send_corked_packets(ni, SOCK_TO_TCP(epi->sock.s));
+    ci_netif_unlock(ni);
+  }
+
+  return i > 0 ? (int) i : rc;
+}
+
+
+/* The file is mapped and sent in windows of this size. */
+#define CITP_TCP_SENDFILE_MAP_LEN  (4u << 20)
+/* As Linux, a single sendfile() moves at most this much. */
+#define CITP_TCP_SENDFILE_MAX      0x7ffff000
+
+/* sendfile() from a regular file: map a window of the file and hand its
+ * page cache pages to the ordinary send path, which copies them straight
+ * into packet buffers.  That is the same single copy the kernel does via
+ * sendpage(), without a kernel entry and a stack lock per page.
+ *
+ * Returns 1 if [in_fd] is not something we can map, in which case the
+ * caller should pass the call through to the kernel.  Otherwise returns 0
+ * with the sendfile() result in [*p_rc].
+ */
+int citp_tcp_sendfile(citp_fdinfo* fdi, int in_fd, off_t* offset,
+                      size_t count, ssize_t* p_rc)
+{
+  struct stat st;
+  struct msghdr m;
+  struct iovec iov;
+  off_t pos;
+  off_t page_mask = sysconf(_SC_PAGESIZE) - 1;
+  ssize_t sent = 0;
+  int rc = 0;
+
+  if( ci_sys_fstat(in_fd, &st) != 0 || ! S_ISREG(st.st_mode) )
+    return 1;
+  pos = offset != NULL ? *offset : lseek(in_fd, 0, SEEK_CUR);
+  if( pos < 0 )
+    return 1;
+
+  /* Stop at end-of-file, as Linux does. */
+  count = CI_MIN(count, CITP_TCP_SENDFILE_MAX);
+  count = pos < st.st_size ? CI_MIN(count, (size_t) (st.st_size - pos)) : 0;
+
+  memset(&m, 0, sizeof(m));
+  m.msg_iov = &iov;
+  m.msg_iovlen = 1;
+
+  while( count > 0 ) {
+    off_t map_off = pos & ~page_mask;
+    size_t skip = pos - map_off;
+    size_t len = CI_MIN(count, CITP_TCP_SENDFILE_MAP_LEN - skip);
+    void* p;
+
+    p = mmap(NULL, skip + len, PROT_READ, MAP_SHARED | MAP_POPULATE,
+             in_fd, map_off);
+    if( p == MAP_FAILED ) {
+      /* Not mappable (e.g. opened write-only): let the kernel sort it. */
+      if( sent == 0 )
+        return 1;
+      break;
+    }
+    iov.iov_base = (char*) p + skip;
+    iov.iov_len = len;
+    rc = citp_tcp_send(fdi, &m, count > len ? MSG_MORE : 0);
+    munmap(p, skip + len);
+    if( rc <= 0 )
+      break;
+    sent += rc;
+    pos += rc;
+    count -= rc;
+    if( (size_t) rc < len )
+      /* Non-blocking socket is full, or interrupted by a signal. */
+      break;
+  }
+
+  if( offset != NULL )
+    *offset = pos;
+  else
+    lseek(in_fd, pos, SEEK_SET);
+
+  /* A failure after some data has gone is reported as a short count. */
+  *p_rc = sent > 0 || rc >= 0 ? sent : rc;
+  return 0;
+}
+
+
 static int citp_tcp_fcntl(citp_fdinfo* fdinfo, int cmd, long arg)
 {
   return citp_sock_fcntl(fdi_to_sock_fdi(fdinfo), fdinfo->fd, cmd, arg);
@@ -110,6 +110,7 @@ struct citp_epoll_member {
 #if CI_CFG_EPOLL3
   ci_dllink             dead_stack_link; /*!< Link for dead stack list */
   int                   ready_list_id;
+  int                   home;       /*!< citp_epoll_fd::homes[] index */
 #endif
   struct epoll_event    epoll_data;
   struct epoll_event    epfd_event; /*!< event synchronised to kernel */
@@ -134,6 +135,16 @@ enum {
 
 #define EPOLL_STACK_EITEM 1
 #define EPOLL_NON_STACK_EITEM 2
+
+#if CI_CFG_EPOLL3
+/*! A stack whose ready list feeds an epoll set. */
+struct citp_epoll_home {
+  ci_netif* ni;         /*!< NULL if this slot is not in use */
+  int       ready_list;
+  int       sockets_n;  /*!< members using this ready list */
+};
+#endif
+
 /*! Data associated with each epoll epfd.  */
 struct citp_epoll_fd {
   /* epoll_create() parameter */
@@ -191,8 +202,12 @@ struct citp_epoll_fd {
   int closing;
 
 #if CI_CFG_EPOLL3
-  ci_netif* home_stack;
-  int ready_list;
+  /* Home stacks, up to EF_EPOLL_MAX_HOMES of them. */
+  struct citp_epoll_home homes[CI_CFG_EPOLL3_MAX_HOMES];
+  int n_homes;
+  /* Home whose ready list is collected first, rotated on each collection
+   * so that no stack's sockets are always reported first. */
+  int home_rr;
 #endif
 
   /*!< phase of the poll to ensure fairness between groups of sockets
@@ -234,7 +249,8 @@ struct citp_ordered_wait {
   struct citp_ordering_info* ordering_info;
   int poll_again;
   ci_int64 next_timeout_hr;
-  ci_netif* ordering_stack;
+  ci_netif* ordering_stacks[CI_CFG_EPOLL3_MAX_HOMES];
+  int n_ordering_stacks;
 };
 
 /* Epoll state in user-land poll.  Copied from oo_ul_poll_state */
@@ -0,0 +1,888 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/**************************************************************************\
+*//*! \file
+** <L5_PRIVATE L5_SOURCE>
+**  \brief  Intercept of io_uring requests on accelerated sockets.
+** </L5_PRIVATE>
+*//*
+\**************************************************************************/
+
+/*! \cidoxg_lib_transport_unix */
+
+/* There is no libc wrapper for io_uring, so applications (and liburing)
+ * reach the kernel through syscall(), which we already intercept.  When a
+ * ring we know about is entered, we walk the new SQEs and pick out send,
+ * recv, accept and poll-add requests on accelerated sockets:
+ *
+ * - If the request can complete now, we do it against the stack and turn
+ *   the SQE into an IORING_OP_MSG_RING to the ring itself, carrying the
+ *   result and the original user_data.  The kernel posts that as the CQE
+ *   in the same io_uring_enter() call, and IOSQE_CQE_SKIP_SUCCESS hides
+ *   the MSG_RING's own completion.
+ *
+ * - Otherwise the SQE becomes a NOP (again with IOSQE_CQE_SKIP_SUCCESS)
+ *   and we keep the request.  It is retried each time the ring is entered,
+ *   and when the application waits for completions we wait in Onload's
+ *   ppoll() on the sockets and the ring together.  Its CQE is posted with
+ *   MSG_RING from a private ring.
+ *
+ * The kernel owns the CQ tail, so MSG_RING is the only way to post a CQE
+ * that the kernel will not overwrite.  Everything else goes to the kernel
+ * untouched.
+ *
+ * If more requests would block than we can keep, we stop at the first one
+ * we can't take and submit only the SQEs before it.  The rest stay in the
+ * SQ, as they do when the kernel submits fewer than asked, and are
+ * submitted on a later io_uring_enter() once some pending requests have
+ * completed.  Handing them to the kernel instead would let them overtake
+ * earlier requests on the same socket.
+ *
+ * We only see rings whose io_uring_setup() and io_uring_enter() go through
+ * libc's syscall().  liburing 2.2 and later make these system calls inline
+ * unless configured with --use-libc, so their rings are invisible to us and
+ * requests on them go to the kernel.  We can't intercept that, but we warn
+ * at startup if such a liburing is loaded, and when a ring we never saw
+ * created is entered through syscall().  liburing linked statically or
+ * loaded with dlopen() after startup is not detected.
+ */
+
+#include "internal.h"
+
+#if CI_CFG_USERSPACE_SYSCALL && CI_HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <link.h>
+
+
+/* IORING_SETUP_SUBMIT_ALL arrived in the same release as MSG_RING, and
+ * after IOSQE_CQE_SKIP_SUCCESS.
+ */
+#ifdef IORING_SETUP_SUBMIT_ALL
+
+#define CITP_URING_MAX_RINGS     16
+#define CITP_URING_MAX_PENDING   64
+#define CITP_URING_PRIV_ENTRIES  64
+
+/* Ring setups where we can't see or rewrite the SQEs ourselves, or where
+ * MSG_RING completions would not show up in the CQ before the owner next
+ * enters the kernel.
+ */
+#define CITP_URING_SETUP_UNSUPPORTED                                   \
+  (IORING_SETUP_SQPOLL | IORING_SETUP_IOPOLL | IORING_SETUP_SQE128 |    \
+   IORING_SETUP_CQE32 | CITP_URING_SETUP_DEFER_TASKRUN |                \
+   CITP_URING_SETUP_NO_MMAP | CITP_URING_SETUP_NO_SQARRAY)
+#ifdef IORING_SETUP_DEFER_TASKRUN
+# define CITP_URING_SETUP_DEFER_TASKRUN  IORING_SETUP_DEFER_TASKRUN
+#else
+# define CITP_URING_SETUP_DEFER_TASKRUN  0
+#endif
+#ifdef IORING_SETUP_NO_MMAP
+# define CITP_URING_SETUP_NO_MMAP  IORING_SETUP_NO_MMAP
+#else
+# define CITP_URING_SETUP_NO_MMAP  0
+#endif
+#ifdef IORING_SETUP_NO_SQARRAY
+# define CITP_URING_SETUP_NO_SQARRAY  IORING_SETUP_NO_SQARRAY
+#else
+# define CITP_URING_SETUP_NO_SQARRAY  0
+#endif
+
+
+/* A request taken over from the ring. */
+struct citp_uring_req {
+  __u64 user_data;
+  __u64 addr;
+  __u64 addr2;
+  __u32 len;
+  __u32 flags;     /* msg_flags, accept_flags or poll events */
+  int   fd;
+  __u8  opcode;
+};
+
+/* [in_use] and [refs] are protected by the table lock.  A ring is in use
+ * from when it is tracked until its fd is closed, and only rings in use are
+ * found by fd.  Each io_uring_enter() holds a reference for as long as it
+ * looks at the ring, and the mappings are only released, and the slot
+ * reused, once the ring is no longer in use and the last reference has
+ * gone.
+ */
+struct citp_uring {
+  int                   in_use;
+  int                   refs;
+  int                   fd;
+  pthread_mutex_t       lock;
+
+  void*                 sq_ring;
+  size_t                sq_ring_len;
+  void*                 cq_ring;
+  size_t                cq_ring_len;
+  struct io_uring_sqe*  sqes;
+  size_t                sqes_len;
+
+  unsigned*             sq_head;
+  unsigned*             sq_tail;
+  unsigned*             sq_array;
+  unsigned              sq_mask;
+  unsigned              sq_entries;
+  unsigned*             cq_head;
+  unsigned*             cq_tail;
+
+  /* Requests that could not complete at submission, in submission order.
+   * Protected by [lock].
+   */
+  unsigned              n_pending;
+  struct citp_uring_req pending[CITP_URING_MAX_PENDING];
+};
+
+
+static struct citp_uring citp_urings[CITP_URING_MAX_RINGS];
+static int citp_uring_n;
+/* Number of io_uring_setup() calls we have seen. */
+static int citp_uring_n_setup;
+static pthread_mutex_t citp_uring_table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Private ring for posting completions of pending requests.  Created when
+ * the first ring is tracked; [citp_uring_priv_state] is -1 if the kernel
+ * can't do what we need.
+ */
+static struct citp_uring citp_uring_priv;
+static int citp_uring_priv_state;
+
+
+static long citp_uring_sys_enter(int fd, unsigned to_submit,
+                                 unsigned min_complete, unsigned flags,
+                                 const void* arg, size_t argsz)
+{
+  return ci_sys_syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, arg, argsz);
+}
+
+
+static int citp_uring_map(struct citp_uring* r, int fd,
+                          const struct io_uring_params* p)
+{
+  size_t sq_len = p->sq_off.array + p->sq_entries * sizeof(__u32);
+  size_t cq_len = p->cq_off.cqes +
+                  p->cq_entries * sizeof(struct io_uring_cqe);
+  size_t sqes_len = p->sq_entries * sizeof(struct io_uring_sqe);
+  int single = p->features & IORING_FEAT_SINGLE_MMAP;
+  void *sq, *cq, *sqes;
+
+  if( single )
+    sq_len = cq_len = CI_MAX(sq_len, cq_len);
+
+  sq = mmap(NULL, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            fd, IORING_OFF_SQ_RING);
+  if( sq == MAP_FAILED )
+    return -errno;
+  if( single ) {
+    cq = sq;
+  }
+  else {
+    cq = mmap(NULL, cq_len, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if( cq == MAP_FAILED ) {
+      munmap(sq, sq_len);
+      return -errno;
+    }
+  }
+  sqes = mmap(NULL, sqes_len, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if( sqes == MAP_FAILED ) {
+    if( ! single )
+      munmap(cq, cq_len);
+    munmap(sq, sq_len);
+    return -errno;
+  }
+
+  r->sq_ring = sq;
+  r->sq_ring_len = sq_len;
+  r->cq_ring = single ? NULL : cq;
+  r->cq_ring_len = cq_len;
+  r->sqes = sqes;
+  r->sqes_len = sqes_len;
+  r->sq_head = (unsigned*) ((char*) sq + p->sq_off.head);
+  r->sq_tail = (unsigned*) ((char*) sq + p->sq_off.tail);
+  r->sq_array = (unsigned*) ((char*) sq + p->sq_off.array);
+  r->sq_mask = *(unsigned*) ((char*) sq + p->sq_off.ring_mask);
+  r->sq_entries = p->sq_entries;
+  r->cq_head = (unsigned*) ((char*) cq + p->cq_off.head);
+  r->cq_tail = (unsigned*) ((char*) cq + p->cq_off.tail);
+  r->fd = fd;
+  r->n_pending = 0;
+  pthread_mutex_init(&r->lock, NULL);
+  return 0;
+}
+
+
+static void citp_uring_unmap(struct citp_uring* r)
+{
+  munmap(r->sqes, r->sqes_len);
+  if( r->cq_ring != NULL )
+    munmap(r->cq_ring, r->cq_ring_len);
+  munmap(r->sq_ring, r->sq_ring_len);
+  pthread_mutex_destroy(&r->lock);
+}
+
+
+/* Create the private ring and check that the kernel supports MSG_RING.
+ * Called with the table lock held.
+ */
+static int citp_uring_priv_init(void)
+{
+  citp_lib_context_t lib_context;
+  struct io_uring_params p;
+  struct io_uring_probe* probe;
+  size_t probe_len;
+  long fd;
+  int ok;
+
+  if( citp_uring_priv_state != 0 )
+    return citp_uring_priv_state;
+  citp_uring_priv_state = -1;
+
+  memset(&p, 0, sizeof(p));
+  fd = ci_sys_syscall(__NR_io_uring_setup, CITP_URING_PRIV_ENTRIES, &p);
+  if( fd < 0 ) {
+    Log_V(log("%s: io_uring_setup failed (errno=%d)", __FUNCTION__, errno));
+    return -1;
+  }
+
+  probe_len = sizeof(*probe) + 256 * sizeof(struct io_uring_probe_op);
+  probe = calloc(1, probe_len);
+  ok = probe != NULL &&
+       ci_sys_syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+                      probe, 256) == 0 &&
+       probe->last_op >= IORING_OP_MSG_RING &&
+       (probe->ops[IORING_OP_MSG_RING].flags & IO_URING_OP_SUPPORTED);
+  free(probe);
+  if( ! ok || citp_uring_map(&citp_uring_priv, fd, &p) < 0 ) {
+    Log_V(log("%s: kernel does not support IORING_OP_MSG_RING; io_uring "
+              "requests will not be accelerated", __FUNCTION__));
+    ci_sys_close(fd);
+    return -1;
+  }
+
+  /* Keep the application's hands off our ring.  We get here from
+   * syscall(), which does not enter the library for us.
+   */
+  citp_enter_lib(&lib_context);
+  CITP_FDTABLE_LOCK();
+  __citp_fdtable_reserve(fd, 1);
+  CITP_FDTABLE_UNLOCK();
+  citp_exit_lib(&lib_context, 1);
+
+  citp_uring_priv.in_use = 1;
+  citp_uring_priv_state = 1;
+  return 1;
+}
+
+
+/* Called with the table lock held. */
+static void citp_uring_untrack(struct citp_uring* r)
+{
+  pthread_mutex_lock(&r->lock);
+  r->in_use = 0;
+  if( r->n_pending != 0 )
+    Log_V(log("%s: ring %d closed with %u requests pending", __FUNCTION__,
+              r->fd, r->n_pending));
+  pthread_mutex_unlock(&r->lock);
+  if( r->refs == 0 )
+    citp_uring_unmap(r);
+  --citp_uring_n;
+}
+
+
+static void citp_uring_track(int fd, const struct io_uring_params* p)
+{
+  struct citp_uring* r = NULL;
+  int i, rc;
+
+  pthread_mutex_lock(&citp_uring_table_lock);
+  if( citp_uring_priv_init() < 0 )
+    goto out;
+
+  for( i = 0; i < CITP_URING_MAX_RINGS; ++i )
+    if( citp_urings[i].in_use && citp_urings[i].fd == fd )
+      /* The previous owner of this fd was closed behind our back. */
+      citp_uring_untrack(&citp_urings[i]);
+  for( i = 0; i < CITP_URING_MAX_RINGS; ++i )
+    if( ! citp_urings[i].in_use && citp_urings[i].refs == 0 ) {
+      r = &citp_urings[i];
+      break;
+    }
+  if( r == NULL ) {
+    Log_V(log("%s: too many rings; ring %d is not accelerated",
+              __FUNCTION__, fd));
+    goto out;
+  }
+
+  rc = citp_uring_map(r, fd, p);
+  if( rc < 0 ) {
+    Log_E(log("%s: failed to map ring %d (rc=%d)", __FUNCTION__, fd, rc));
+    goto out;
+  }
+  ci_wmb();
+  r->in_use = 1;
+  ++citp_uring_n;
+  Log_V(log("%s: accelerating ring %d", __FUNCTION__, fd));
+ out:
+  pthread_mutex_unlock(&citp_uring_table_lock);
+}
+
+
+/* Called with the table lock held. */
+static struct citp_uring* __citp_uring_find(int fd)
+{
+  int i;
+
+  for( i = 0; i < CITP_URING_MAX_RINGS; ++i )
+    if( citp_urings[i].in_use && citp_urings[i].fd == fd )
+      return &citp_urings[i];
+  return NULL;
+}
+
+
+/* Returns the ring for [fd] with a reference held, or NULL.  Drop the
+ * reference with citp_uring_put().
+ */
+static struct citp_uring* citp_uring_get(int fd)
+{
+  struct citp_uring* r;
+
+  if( citp_uring_n == 0 )
+    return NULL;
+  pthread_mutex_lock(&citp_uring_table_lock);
+  if( (r = __citp_uring_find(fd)) != NULL )
+    ++r->refs;
+  pthread_mutex_unlock(&citp_uring_table_lock);
+  return r;
+}
+
+
+static void citp_uring_put(struct citp_uring* r)
+{
+  pthread_mutex_lock(&citp_uring_table_lock);
+  ci_assert_gt(r->refs, 0);
+  if( --r->refs == 0 && ! r->in_use )
+    /* Closed while we were using it. */
+    citp_uring_unmap(r);
+  pthread_mutex_unlock(&citp_uring_table_lock);
+}
+
+
+static int citp_uring_fd_is_accel(int fd)
+{
+  citp_lib_context_t lib_context;
+  citp_fdinfo* fdi;
+  int rc = 0;
+
+  citp_enter_lib(&lib_context);
+  if( (fdi = citp_fdtable_lookup(fd)) != NULL ) {
+    rc = citp_fdinfo_get_type(fdi) == CITP_TCP_SOCKET ||
+         citp_fdinfo_get_type(fdi) == CITP_UDP_SOCKET;
+    citp_fdinfo_release_ref(fdi, 0);
+  }
+  citp_exit_lib(&lib_context, 1);
+  return rc;
+}
+
+
+/* Try a request without blocking.  Returns the CQE result, or -EAGAIN if
+ * the request can't complete yet.
+ */
+static long citp_uring_do(const struct citp_uring_req* req)
+{
+  void* buf = (void*) (uintptr_t) req->addr;
+  struct pollfd pfd;
+  long rc = -1;
+
+  switch( req->opcode ) {
+  case IORING_OP_SEND:
+    rc = send(req->fd, buf, req->len, req->flags | MSG_DONTWAIT);
+    break;
+  case IORING_OP_RECV:
+    rc = recv(req->fd, buf, req->len, req->flags | MSG_DONTWAIT);
+    break;
+  case IORING_OP_ACCEPT:
+    pfd.fd = req->fd;
+    pfd.events = POLLIN;
+    if( poll(&pfd, 1, 0) == 0 )
+      return -EAGAIN;
+    rc = accept4(req->fd, buf, (socklen_t*) (uintptr_t) req->addr2,
+                 req->flags);
+    break;
+  case IORING_OP_POLL_ADD:
+    pfd.fd = req->fd;
+    pfd.events = req->flags;
+    pfd.revents = 0;
+    rc = poll(&pfd, 1, 0);
+    if( rc == 0 )
+      return -EAGAIN;
+    if( rc > 0 )
+      return pfd.revents;
+    break;
+  default:
+    ci_assert(0);
+    return -EINVAL;
+  }
+
+  if( rc < 0 )
+    return errno == EWOULDBLOCK ? -EAGAIN : -errno;
+  return rc;
+}
+
+
+static void citp_uring_sqe_msg_ring(struct io_uring_sqe* sqe, int ring_fd,
+                                    __u64 user_data, long res)
+{
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_MSG_RING;
+  sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  sqe->fd = ring_fd;
+  sqe->addr = IORING_MSG_DATA;
+  sqe->len = (__u32) res;
+  sqe->off = user_data;
+  /* If the MSG_RING itself fails, its CQE tells the application that the
+   * request failed.
+   */
+  sqe->user_data = user_data;
+}
+
+
+/* Post the completion of a pending request via the private ring.  The
+ * caller must call citp_uring_priv_flush() afterwards.
+ */
+static void citp_uring_priv_post(int ring_fd, __u64 user_data, long res)
+{
+  struct citp_uring* p = &citp_uring_priv;
+  unsigned tail = *p->sq_tail;
+  unsigned idx;
+
+  if( tail - OO_ACCESS_ONCE(*p->sq_head) == p->sq_entries ) {
+    citp_uring_sys_enter(p->fd, p->sq_entries, 0, 0, NULL, 0);
+    ci_assert_equal(tail, OO_ACCESS_ONCE(*p->sq_head));
+  }
+  idx = tail & p->sq_mask;
+  citp_uring_sqe_msg_ring(&p->sqes[idx], ring_fd, user_data, res);
+  p->sq_array[idx] = idx;
+  ci_wmb();
+  *p->sq_tail = tail + 1;
+}
+
+
+static void citp_uring_priv_flush(void)
+{
+  struct citp_uring* p = &citp_uring_priv;
+  unsigned n = *p->sq_tail - OO_ACCESS_ONCE(*p->sq_head);
+  unsigned head, tail;
+
+  if( n != 0 )
+    citp_uring_sys_enter(p->fd, n, 0, 0, NULL, 0);
+
+  /* Only failures post CQEs here.  The application will see those failures
+   * as missing completions, so there's nothing better to do than log them.
+   */
+  head = *p->cq_head;
+  tail = OO_ACCESS_ONCE(*p->cq_tail);
+  if( head != tail ) {
+    Log_E(log("%s: failed to post %u io_uring completions", __FUNCTION__,
+              tail - head));
+    ci_mb();
+    *p->cq_head = tail;
+  }
+}
+
+
+/* Retry the pending requests of [r], posting the completions of any that
+ * finish.  Called with [r->lock] held.
+ */
+static void citp_uring_retry(struct citp_uring* r)
+{
+  unsigned i = 0, n_done = 0;
+  long res;
+
+  while( i < r->n_pending ) {
+    res = citp_uring_do(&r->pending[i]);
+    if( res == -EAGAIN ) {
+      ++i;
+      continue;
+    }
+    if( n_done++ == 0 )
+      pthread_mutex_lock(&citp_uring_priv.lock);
+    citp_uring_priv_post(r->fd, r->pending[i].user_data, res);
+    --r->n_pending;
+    memmove(&r->pending[i], &r->pending[i + 1],
+            (r->n_pending - i) * sizeof(r->pending[0]));
+  }
+  if( n_done != 0 ) {
+    citp_uring_priv_flush();
+    pthread_mutex_unlock(&citp_uring_priv.lock);
+  }
+}
+
+
+/* Requests on the same socket must complete in order, so a new request
+ * waits behind any pending request of the same type.
+ */
+static int citp_uring_queued_behind(const struct citp_uring* r,
+                                    const struct citp_uring_req* req)
+{
+  unsigned i;
+  for( i = 0; i < r->n_pending; ++i )
+    if( r->pending[i].fd == req->fd && r->pending[i].opcode == req->opcode )
+      return 1;
+  return 0;
+}
+
+
+/* Handle one SQE.  Returns 0 if the SQE can be submitted, or -ENOBUFS if
+ * the request would block and there is no room to keep it, in which case
+ * the SQE is left untouched and must not be submitted yet.
+ */
+static int citp_uring_sqe(struct citp_uring* r, struct io_uring_sqe* sqe)
+{
+  struct citp_uring_req req;
+  long res;
+
+  /* Links, drains, fixed files and provided buffers need the kernel. */
+  if( sqe->flags & ~IOSQE_ASYNC )
+    return 0;
+
+  switch( sqe->opcode ) {
+  case IORING_OP_SEND:
+  case IORING_OP_RECV:
+    /* [ioprio] holds the multishot, poll-first and fixed buffer flags. */
+    if( sqe->ioprio != 0 || sqe->buf_index != 0 )
+      return 0;
+    req.flags = sqe->msg_flags;
+    req.addr2 = 0;
+    break;
+  case IORING_OP_ACCEPT:
+    if( sqe->ioprio != 0 || sqe->file_index != 0 )
+      return 0;
+    req.flags = sqe->accept_flags;
+    req.addr2 = sqe->addr2;
+    break;
+  case IORING_OP_POLL_ADD:
+    /* Multishot and updates have flags in [len]. */
+    if( sqe->len != 0 )
+      return 0;
+    req.flags = sqe->poll32_events & 0xffff;
+    req.addr2 = 0;
+    break;
+  default:
+    return 0;
+  }
+  if( ! citp_uring_fd_is_accel(sqe->fd) )
+    return 0;
+
+  req.user_data = sqe->user_data;
+  req.addr = sqe->addr;
+  req.len = sqe->len;
+  req.fd = sqe->fd;
+  req.opcode = sqe->opcode;
+
+  if( citp_uring_queued_behind(r, &req) )
+    res = -EAGAIN;
+  else
+    res = citp_uring_do(&req);
+
+  if( res != -EAGAIN ) {
+    citp_uring_sqe_msg_ring(sqe, r->fd, req.user_data, res);
+    return 0;
+  }
+  if( r->n_pending == CITP_URING_MAX_PENDING )
+    return -ENOBUFS;
+  r->pending[r->n_pending++] = req;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_NOP;
+  sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  sqe->user_data = req.user_data;
+  return 0;
+}
+
+
+/* Look at the SQEs that this io_uring_enter() will submit.  Returns the
+ * number of them that may be submitted now.  Called with [r->lock] held.
+ */
+static unsigned citp_uring_scan_sq(struct citp_uring* r, unsigned to_submit)
+{
+  unsigned head = OO_ACCESS_ONCE(*r->sq_head);
+  unsigned tail = OO_ACCESS_ONCE(*r->sq_tail);
+  unsigned i, n, idx;
+
+  ci_rmb();
+  n = CI_MIN(tail - head, to_submit);
+  for( i = 0; i < n; ++i ) {
+    idx = r->sq_array[(head + i) & r->sq_mask];
+    if( idx < r->sq_entries &&
+        citp_uring_sqe(r, &r->sqes[idx]) == -ENOBUFS ) {
+      Log_V(log("%s: ring %d has %u requests pending; submitting %u of %u",
+                __FUNCTION__, r->fd, r->n_pending, i, to_submit));
+      return i;
+    }
+  }
+  return to_submit;
+}
+
+
+static unsigned citp_uring_cq_ready(const struct citp_uring* r)
+{
+  unsigned tail = OO_ACCESS_ONCE(*r->cq_tail);
+  ci_rmb();
+  return tail - OO_ACCESS_ONCE(*r->cq_head);
+}
+
+
+static short citp_uring_req_events(const struct citp_uring_req* req)
+{
+  switch( req->opcode ) {
+  case IORING_OP_SEND:
+    return POLLOUT;
+  case IORING_OP_POLL_ADD:
+    return req->flags;
+  default:
+    return POLLIN;
+  }
+}
+
+
+/* Wait for [min_complete] CQEs while some requests are pending with us.
+ * The kernel can't wake us for those, so wait in ppoll() on the pending
+ * sockets and the ring fd, which is readable when the CQ is not empty.
+ */
+static int citp_uring_wait(struct citp_uring* r, unsigned min_complete,
+                           unsigned flags, const void* arg, size_t argsz)
+{
+  struct pollfd pfds[CITP_URING_MAX_PENDING + 1];
+  const sigset_t* sigmask = arg;
+  struct timespec ts, deadline, now;
+  int have_timeout = 0;
+  unsigned i, n;
+
+  if( flags & IORING_ENTER_EXT_ARG ) {
+    const struct io_uring_getevents_arg* ga = arg;
+    if( argsz != sizeof(*ga) ) {
+      errno = EINVAL;
+      return -1;
+    }
+    sigmask = (const sigset_t*) (uintptr_t) ga->sigmask;
+    if( ga->ts != 0 ) {
+      const struct __kernel_timespec* kts =
+        (const struct __kernel_timespec*) (uintptr_t) ga->ts;
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      deadline.tv_sec += kts->tv_sec;
+      deadline.tv_nsec += kts->tv_nsec;
+      while( deadline.tv_nsec >= 1000000000 ) {
+        deadline.tv_nsec -= 1000000000;
+        ++deadline.tv_sec;
+      }
+      have_timeout = 1;
+    }
+  }
+
+  while( 1 ) {
+    pthread_mutex_lock(&r->lock);
+    if( r->n_pending != 0 )
+      citp_uring_retry(r);
+    for( i = 0; i < r->n_pending; ++i ) {
+      pfds[i].fd = r->pending[i].fd;
+      pfds[i].events = citp_uring_req_events(&r->pending[i]);
+    }
+    n = r->n_pending;
+    pthread_mutex_unlock(&r->lock);
+
+    if( citp_uring_cq_ready(r) >= min_complete )
+      return 0;
+    if( n == 0 )
+      /* Everything is with the kernel again. */
+      return citp_uring_sys_enter(r->fd, 0, min_complete, flags,
+                                  arg, argsz) < 0 ? -1 : 0;
+
+    pfds[n].fd = r->fd;
+    pfds[n].events = POLLIN;
+    if( have_timeout ) {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      ts.tv_sec = deadline.tv_sec - now.tv_sec;
+      ts.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+      if( ts.tv_nsec < 0 ) {
+        ts.tv_nsec += 1000000000;
+        --ts.tv_sec;
+      }
+      if( ts.tv_sec < 0 ) {
+        errno = ETIME;
+        return -1;
+      }
+    }
+    if( ppoll(pfds, n + 1, have_timeout ? &ts : NULL, sigmask) < 0 )
+      return -1;
+  }
+}
+
+
+/* A liburing that makes its system calls inline does not import syscall(),
+ * so look for that name in the dynamic string table of each liburing.
+ */
+static int citp_uring_check_lib(struct dl_phdr_info* info, size_t size,
+                                void* arg)
+{
+  const ElfW(Dyn)* dyn = NULL;
+  const char* strtab = NULL;
+  size_t strsz = 0, off;
+  int i;
+
+  if( info->dlpi_name == NULL || strstr(info->dlpi_name, "/liburing") == NULL )
+    return 0;
+  for( i = 0; i < info->dlpi_phnum; ++i )
+    if( info->dlpi_phdr[i].p_type == PT_DYNAMIC )
+      dyn = (const ElfW(Dyn)*) (info->dlpi_addr +
+                                info->dlpi_phdr[i].p_vaddr);
+  if( dyn == NULL )
+    return 0;
+  for( ; dyn->d_tag != DT_NULL; ++dyn ) {
+    if( dyn->d_tag == DT_STRTAB ) {
+      ElfW(Addr) a = dyn->d_un.d_ptr;
+      /* Not every architecture relocates the dynamic section. */
+      if( a < info->dlpi_addr )
+        a += info->dlpi_addr;
+      strtab = (const char*) a;
+    }
+    else if( dyn->d_tag == DT_STRSZ ) {
+      strsz = dyn->d_un.d_val;
+    }
+  }
+  if( strtab == NULL )
+    return 0;
+  for( off = 0; off < strsz; off += strlen(strtab + off) + 1 )
+    if( strcmp(strtab + off, "syscall") == 0 )
+      return 0;
+
+  Log_U(log("%s: %s makes io_uring system calls directly, so requests on "
+            "its rings are not accelerated; build liburing with --use-libc "
+            "to use EF_IO_URING", __FUNCTION__, info->dlpi_name));
+  return 0;
+}
+
+
+void citp_io_uring_init(void)
+{
+  if( CITP_OPTS.io_uring )
+    dl_iterate_phdr(citp_uring_check_lib, NULL);
+}
+
+
+long citp_io_uring_setup(unsigned entries, void* params)
+{
+  struct io_uring_params* p = params;
+  long fd = ci_sys_syscall(__NR_io_uring_setup, entries, p);
+  int saved_errno;
+
+  if( fd >= 0 )
+    ++citp_uring_n_setup;
+  if( fd < 0 || ! CITP_OPTS.io_uring ||
+      (p->flags & CITP_URING_SETUP_UNSUPPORTED) )
+    return fd;
+
+  saved_errno = errno;
+  citp_uring_track(fd, p);
+  errno = saved_errno;
+  return fd;
+}
+
+
+long citp_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                         unsigned flags, const void* arg, size_t argsz)
+{
+  struct citp_uring* r;
+  int saved_errno = errno;
+  unsigned n_pending;
+  long rc;
+
+  if( (flags & IORING_ENTER_REGISTERED_RING) ||
+      (r = citp_uring_get(fd)) == NULL ) {
+    static int warned;
+    if( citp_uring_n_setup == 0 && CITP_OPTS.io_uring && ! warned ) {
+      warned = 1;
+      Log_U(log("%s: ring %d was not created through syscall(), so "
+                "requests on it are not accelerated", __FUNCTION__, fd));
+    }
+    return citp_uring_sys_enter(fd, to_submit, min_complete, flags,
+                                arg, argsz);
+  }
+
+  pthread_mutex_lock(&r->lock);
+  if( to_submit != 0 )
+    to_submit = citp_uring_scan_sq(r, to_submit);
+  if( r->n_pending != 0 )
+    citp_uring_retry(r);
+  n_pending = r->n_pending;
+  pthread_mutex_unlock(&r->lock);
+  errno = saved_errno;
+
+  if( n_pending == 0 || ! (flags & IORING_ENTER_GETEVENTS) ) {
+    citp_uring_put(r);
+    return citp_uring_sys_enter(fd, to_submit, min_complete, flags,
+                                arg, argsz);
+  }
+
+  /* Submit now, and do the waiting ourselves. */
+  rc = citp_uring_sys_enter(fd, to_submit, 0,
+                            flags & ~IORING_ENTER_GETEVENTS, arg, argsz);
+  if( rc >= 0 ) {
+    /* As in the kernel, a wait failure is only reported if nothing was
+     * submitted.
+     */
+    if( citp_uring_wait(r, min_complete, flags, arg, argsz) < 0 && rc == 0 )
+      rc = -1;
+    else
+      errno = saved_errno;
+  }
+  citp_uring_put(r);
+  return rc;
+}
+
+
+void citp_io_uring_close(int fd)
+{
+  struct citp_uring* r;
+
+  if( citp_uring_n == 0 )
+    return;
+  pthread_mutex_lock(&citp_uring_table_lock);
+  if( (r = __citp_uring_find(fd)) != NULL )
+    citp_uring_untrack(r);
+  pthread_mutex_unlock(&citp_uring_table_lock);
+}
+
+
+#else  /* ! IORING_SETUP_SUBMIT_ALL */
+
+void citp_io_uring_init(void)
+{
+}
+
+
+long citp_io_uring_setup(unsigned entries, void* params)
+{
+  return ci_sys_syscall(__NR_io_uring_setup, entries, params);
+}
+
+
+long citp_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                         unsigned flags, const void* arg, size_t argsz)
+{
+  return ci_sys_syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, arg, argsz);
+}
+
+
+void citp_io_uring_close(int fd)
+{
+}
+
+#endif
+#endif
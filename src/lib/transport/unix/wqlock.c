@@ -49,7 +49,7 @@ void oo_wqlock_lock_slow(struct oo_wqlock* wql)
   while( 1 ) {
     uintptr_t v = wql->lock;
     if( v == 0 ) {
-      if( ci_cas_uintptr_succeed(&wql->lock, 0, OO_WQLOCK_LOCKED) )
+      if( ci_cas_uintptr_succeed_acquire(&wql->lock, 0, OO_WQLOCK_LOCKED) )
         break;
     }
     else {
@@ -71,7 +71,7 @@ void oo_wqlock_unlock_slow(struct oo_wqlock* wql,
     v = wql->lock;
     ci_assert(v & OO_WQLOCK_LOCKED);
     if( (v & OO_WQLOCK_WORK_BITS) == 0 )
-      if( ci_cas_uintptr_succeed(&wql->lock, v, 0) )
+      if( ci_cas_uintptr_succeed_release(&wql->lock, v, 0) )
         break;
     oo_wqlock_try_drain_work(wql, unlock_param);
   }
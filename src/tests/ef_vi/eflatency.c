@@ -4,6 +4,11 @@
  *
  * Copyright 2016 Solarflare Communications Inc.
  * Date: 2016/05/06
+ *
+ * With -f, runs several ping-pong flows at once, each on its own thread
+ * with its own VIs and UDP port.  Both ends must be given the same number
+ * of flows.  State that belongs to a flow is thread-local, so that the
+ * datapath code is the same whatever the number of flows.
  */
 
 #include "utils.h"
@@ -25,9 +30,23 @@
 #include <netdb.h>
 #include <limits.h>
 #include <time.h>
+#include <pthread.h>
 
 #include <stdint.h>
 
+/* Clock sources for timing round trips.  "cycles" counts cpu cycles and
+ * "timer" is a fixed-rate system counter.  On x86 both are the TSC.  On
+ * aarch64 "timer" is the generic timer (cntvct_el0) whose rate is read from
+ * cntfrq_el0, and "cycles" is the PMU cycle counter, which is only readable
+ * if the kernel grants user-level access (kernel.perf_user_access=1).  The
+ * cycle counter is per-cpu, so pin eflatency to a core when using it.
+ */
+enum clock_src {
+  CLOCK_AUTO,
+  CLOCK_CYCLES,
+  CLOCK_TIMER,
+};
+
 #if defined(__x86_64__)
 
 static inline uint64_t frc64_get(void) {
@@ -37,15 +56,110 @@ static inline uint64_t frc64_get(void) {
   return val;
 }
 
+static enum clock_src clock_select(enum clock_src want)
+{
+  return want == CLOCK_AUTO ? CLOCK_CYCLES : want;
+}
+
+static unsigned clock_fixed_khz(void)
+{
+  return 0;
+}
+
 #elif defined(__aarch64__)
 
+#include <signal.h>
+#include <setjmp.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static bool frc_use_pmccntr;
+
 static inline uint64_t frc64_get(void) {
   uint64_t val;
-  // Read the virtual counter (CNTVCT_EL0)
-  asm volatile("mrs %0, cntvct_el0" : "=r" (val));
+  if( frc_use_pmccntr )
+    asm volatile("isb; mrs %0, pmccntr_el0" : "=r" (val));
+  else
+    // Read the virtual counter (CNTVCT_EL0)
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r" (val));
   return val;
 }
 
+static sigjmp_buf pmccntr_probe_env;
+
+static void pmccntr_probe_sigill(int sig)
+{
+  siglongjmp(pmccntr_probe_env, 1);
+}
+
+/* The kernel only enables EL0 access to the PMU for tasks which have a
+ * user-readable counting event mapped, so ask for a 64-bit cycles event
+ * (which is always allocated to the cycle counter) and then check that
+ * reading pmccntr_el0 neither traps nor stands still.
+ */
+static bool pmccntr_probe(void)
+{
+  struct perf_event_attr attr = {
+    .type = PERF_TYPE_HARDWARE,
+    .size = sizeof(attr),
+    .config = PERF_COUNT_HW_CPU_CYCLES,
+    .config1 = 0x3,  /* 64-bit counter, user access */
+    .exclude_kernel = 1,
+  };
+  struct sigaction sa = { .sa_handler = pmccntr_probe_sigill }, old_sa;
+  volatile bool ok = false;
+  uint64_t c0, c1;
+  void* page;
+  int fd;
+
+  fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  if( fd < 0 )
+    return false;
+  /* The mapping must stay for as long as we read the counter. */
+  page = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+  if( page == MAP_FAILED ) {
+    close(fd);
+    return false;
+  }
+
+  sigaction(SIGILL, &sa, &old_sa);
+  if( sigsetjmp(pmccntr_probe_env, 1) == 0 ) {
+    asm volatile("isb; mrs %0, pmccntr_el0" : "=r" (c0));
+    usleep(1000);
+    asm volatile("isb; mrs %0, pmccntr_el0" : "=r" (c1));
+    ok = c1 != c0;
+  }
+  sigaction(SIGILL, &old_sa, NULL);
+  /* On success the event stays open (and EL0 access enabled) for the rest
+   * of the run; otherwise nothing is left behind. */
+  if( ! ok ) {
+    munmap(page, sysconf(_SC_PAGESIZE));
+    close(fd);
+  }
+  return ok;
+}
+
+static enum clock_src clock_select(enum clock_src want)
+{
+  if( want != CLOCK_TIMER && pmccntr_probe() ) {
+    frc_use_pmccntr = true;
+    return CLOCK_CYCLES;
+  }
+  if( want == CLOCK_CYCLES )
+    fprintf(stderr, "WARNING: PMU cycle counter not readable, using the "
+            "system timer\n");
+  return CLOCK_TIMER;
+}
+
+static unsigned clock_fixed_khz(void)
+{
+  uint64_t hz;
+  if( frc_use_pmccntr )
+    return 0;
+  asm volatile("mrs %0, cntfrq_el0" : "=r" (hz));
+  return hz / 1000;
+}
+
 #else
 #error "Unsupported architecture"
 #endif
@@ -91,6 +205,21 @@ static int measure_cpu_khz(unsigned* cpu_khz)
   return 1;
 }
 
+static unsigned frc_khz;
+
+/* Choose the clock source and find its rate once, up front, so that the
+ * rate is the same for every result. */
+static void clock_init(enum clock_src want)
+{
+  enum clock_src src = clock_select(want);
+
+  frc_khz = clock_fixed_khz();
+  if( frc_khz == 0 )
+    TRY(measure_cpu_khz(&frc_khz));
+  printf("# clock: %s %ukHz\n", src == CLOCK_CYCLES ? "cycles" : "timer",
+         frc_khz);
+}
+
 /* Forward declarations. */
 struct eflatency_vi;
 static inline void rx_wait_poll_evq(struct eflatency_vi*,
@@ -111,8 +240,11 @@ static int              cfg_ctpio_no_poison;
 static unsigned         cfg_ctpio_thresh = 64;
 static const char*      cfg_save_file = NULL;
 static const char*      cfg_yaml_file = NULL;
+static const char*      cfg_json_file = NULL;
+static int              cfg_flows = 1;
 static bool             cfg_data_read = false;
 static bool             cfg_data_peek = false;
+static enum clock_src   cfg_clock = CLOCK_AUTO;
 enum mode {
   MODE_DMA = 1,
   MODE_PIO = 2,
@@ -154,15 +286,68 @@ struct eflatency_vi {
   int       rx_prefix_len;
 };
 
-static ef_driver_handle  driver_handle;
-static struct eflatency_vi rx_vi, tx_vi;
+/* Round-trip times are counted in a log-linear histogram, as HDR Histogram
+ * does, so that memory does not grow with the number of iterations.  Each
+ * power of two is split into HIST_SUB buckets, so a value is known to
+ * within 1/HIST_SUB of itself.
+ */
+#define HIST_SUB_BITS   8
+#define HIST_SUB        (1u << HIST_SUB_BITS)
+#define HIST_N_BUCKETS  ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+struct lat_hist {
+  uint64_t n, sum, min, max;
+  uint64_t bucket[HIST_N_BUCKETS];
+};
 
-struct pkt_buf*          pkt_bufs[N_BUFS];
-static ef_pio            pio;
-static int               tx_frame_len;
-static uint64_t*         timings;
+/* Percentiles that we report, by the fraction of samples above each in
+ * parts per billion. */
+static const struct {
+  const char* name;
+  uint64_t    tail_ppb;
+} percentiles[] = {
+  { "50",      500000000 },
+  { "95",       50000000 },
+  { "99",       10000000 },
+  { "99.9",      1000000 },
+  { "99.99",      100000 },
+  { "99.999",      10000 },
+  { "99.9999",      1000 },
+};
+#define N_PERCENTILES  (sizeof(percentiles) / sizeof(percentiles[0]))
+
+struct flow {
+  pthread_t       thread;
+  const char*     tx_mode;
+  struct lat_hist hist;
+  /* Wall-clock time of the timed iterations. */
+  int             run_usec;
+};
+
+static ef_driver_handle  driver_handle;
+static int               rx_ifindex = -1, tx_ifindex = -1;
+static bool              ping;
+static struct flow*      flows;
+static int               flows_done;
+static pthread_barrier_t flows_barrier;
+static int*              payload_lens = NULL;
+static int               n_payload_lens = 0;
+static struct lat_hist   all_hist;
 static double            last_mean_latency_usec;
 static FILE*             yaml_fp;
+static FILE*             json_fp;
+static int               json_n_results;
+
+static __thread struct flow*         this_flow;
+static __thread int                  flow_i;
+static __thread struct eflatency_vi  rx_vi, tx_vi;
+static __thread struct eflatency_vi* tx_vi_ptr;
+static __thread void (*rx_wait)(struct eflatency_vi*, struct eflatency_vi*);
+static __thread unsigned long        use_rx_ref;
+static __thread struct pkt_buf*      pkt_bufs[N_BUFS];
+static __thread ef_pio               pio;
+static __thread int                  tx_frame_len;
+static __thread uint64_t*            timings;
 
 /* The IP addresses can be chosen arbitrarily. */
 const uint32_t laddr_he = 0xac108564;  /* 172.16.133.100 */
@@ -170,7 +355,7 @@ const uint32_t raddr_he = 0xac010203;  /* 172.1.2.3 */
 const uint16_t port_he = 8080;
 
 /* Used for simulating copy to app buffer */
-static char app_buf[BUF_SIZE];
+static __thread char app_buf[BUF_SIZE];
 
 static void init_udp_pkt(void* pkt_buf, int paylen)
 {
@@ -193,7 +378,8 @@ static void init_udp_pkt(void* pkt_buf, int paylen)
   eth->h_proto = htons(0x0800);
   iphdr_init(ip4, ip_len, 0, IPPROTO_UDP, htonl(laddr_he),
              htonl(raddr_he));
-  udphdr_init(udp, ip4, htons(port_he), htons(port_he), paylen);
+  udphdr_init(udp, ip4, htons(port_he + flow_i), htons(port_he + flow_i),
+              paylen);
 
   iov.iov_base = udp + 1;
   iov.iov_len = paylen;
@@ -204,33 +390,105 @@ static void init_udp_pkt(void* pkt_buf, int paylen)
 
 static inline void rx_post(ef_vi* vi)
 {
-  static int rx_posted = 0;
+  static __thread int rx_posted = 0;
   struct pkt_buf* pb = pkt_bufs[rx_posted++ & RX_BUFS_MASK];
   TRY(ef_vi_receive_post(vi, pb->dma_buf_addr, pb->id));
 }
 
 
-static int cmp_u64(const void* ap, const void* bp)
+static void hist_reset(struct lat_hist* h)
+{
+  memset(h, 0, sizeof(*h));
+  h->min = UINT64_MAX;
+}
+
+
+static inline unsigned hist_index(uint64_t v)
+{
+  unsigned shift;
+  if( v < HIST_SUB )
+    return v;
+  shift = 63 - __builtin_clzll(v) - HIST_SUB_BITS;
+  return (shift + 1) * HIST_SUB + (unsigned) ((v >> shift) - HIST_SUB);
+}
+
+
+static inline void hist_add(struct lat_hist* h, uint64_t v)
+{
+  ++h->bucket[hist_index(v)];
+  ++h->n;
+  h->sum += v;
+  if( v < h->min )
+    h->min = v;
+  if( v > h->max )
+    h->max = v;
+}
+
+
+static void hist_merge(struct lat_hist* to, const struct lat_hist* from)
+{
+  unsigned i;
+  for( i = 0; i < HIST_N_BUCKETS; ++i )
+    to->bucket[i] += from->bucket[i];
+  to->n += from->n;
+  to->sum += from->sum;
+  to->min = MIN(to->min, from->min);
+  to->max = MAX(to->max, from->max);
+}
+
+
+/* Returns the value below which all but [tail_ppb] parts per billion of the
+ * samples lie, taking the middle of the bucket that it falls in.  The
+ * extremes are exact.
+ */
+static uint64_t hist_percentile(const struct lat_hist* h, uint64_t tail_ppb)
+{
+  uint64_t rank, seen = 0, lo, width;
+  unsigned i;
+
+  if( h->n == 0 )
+    return 0;
+  rank = MIN(h->n - h->n * tail_ppb / 1000000000 + 1, h->n);
+  for( i = 0; i < HIST_N_BUCKETS; ++i )
+    if( (seen += h->bucket[i]) >= rank )
+      break;
+  if( i < HIST_SUB ) {
+    lo = i;
+    width = 1;
+  }
+  else {
+    lo = (uint64_t) (i % HIST_SUB + HIST_SUB) << (i / HIST_SUB - 1);
+    width = (uint64_t) 1 << (i / HIST_SUB - 1);
+  }
+  return MAX(h->min, MIN(h->max, lo + width / 2));
+}
+
+
+static void json_hist(FILE* fp, const struct lat_hist* h, double div)
 {
-  uint64_t a = *(const uint64_t*)ap;
-  uint64_t b = *(const uint64_t*)bp;
-  if (a < b)
-    return -1;
-  return a > b;
+  unsigned i;
+
+  fprintf(fp, "\"samples\": %llu, \"mean_ns\": %.0lf, \"min_ns\": %.0lf, "
+          "\"max_ns\": %.0lf, \"percentiles_ns\": { ",
+          (unsigned long long) h->n, h->sum * 1e3 / div / h->n,
+          h->min * 1e3 / div, h->max * 1e3 / div);
+  for( i = 0; i < N_PERCENTILES; ++i )
+    fprintf(fp, "%s\"%s\": %.0lf", i ? ", " : "", percentiles[i].name,
+            hist_percentile(h, percentiles[i].tail_ppb) * 1e3 / div);
+  fprintf(fp, " }");
 }
 
 
-static void output_results(struct timeval start, struct timeval end)
+/* Report on the flows' latest payload length, from the first flow's thread
+ * once all flows have finished it. */
+static void output_results(void)
 {
-  unsigned freq = 0;
-  double div, min, p50, p95, p99, max, run_mean;
-  int usec = (end.tv_sec - start.tv_sec) * 1000000;
-  usec += end.tv_usec - start.tv_usec;
+  double div, min, max, mean, run_mean = 0;
+  double pct[N_PERCENTILES];
+  int f, i;
 
-  TRY(measure_cpu_khz(&freq));
-  div = freq / 1e3;
+  div = frc_khz / 1e3;
   if( cfg_save_file ) {
-    int i;
     char* subst = strstr(cfg_save_file, "$s");
     FILE* fp;
 
@@ -253,33 +511,55 @@ static void output_results(struct timeval start, struct timeval end)
     fclose(fp);
   }
 
-  qsort(timings, cfg_iter, sizeof(timings[0]), cmp_u64);
-  min = timings[0] / div;
-  p50 = timings[cfg_iter / 2] / div;
-  p95 = timings[cfg_iter - cfg_iter / 20] / div;
-  p99 = timings[cfg_iter - cfg_iter / 100] / div;
-  max = timings[cfg_iter - 1] / div;
-  run_mean = (double) usec / cfg_iter;
-  printf("%d\t%0.3lf\t%0.3lf\t%0.3lf\t%0.3lf\t%0.3lf\t%0.3lf\n",
+  hist_reset(&all_hist);
+  for( f = 0; f < cfg_flows; ++f ) {
+    hist_merge(&all_hist, &flows[f].hist);
+    run_mean += (double) flows[f].run_usec / cfg_iter;
+  }
+  run_mean /= cfg_flows;
+  for( i = 0; i < N_PERCENTILES; ++i )
+    pct[i] = hist_percentile(&all_hist, percentiles[i].tail_ppb) / div;
+  min = all_hist.min / div;
+  max = all_hist.max / div;
+  mean = all_hist.sum / div / all_hist.n;
+
+  /* The tail percentiles go after max, so that scripts that read the
+   * original columns need not change. */
+  printf("%d\t%0.3lf\t%0.3lf\t%0.3lf\t%0.3lf\t%0.3lf\t%0.3lf",
          cfg_payload_len,
-         run_mean, min, p50, p95, p99, max);
+         run_mean, min, pct[0], pct[1], pct[2], max);
+  for( i = 3; i < N_PERCENTILES; ++i )
+    printf("\t%0.3lf", pct[i]);
+  printf("\n");
   last_mean_latency_usec = run_mean;
 
   if( yaml_fp ) {
-    int i;
-    uint64_t sum = 0;
-    double mean;
-    for( i = 0; i < cfg_iter; ++i )
-      sum += timings[i];
-    mean = sum / div / cfg_iter;
     fprintf(yaml_fp,
             "  - { payload_len: %d, frame_len: %d, "
             "mean: %.0lf, min: %.0lf, median: %.0lf, "
-            "95%%: %.0lf, 99%%: %.0lf, max: %.0lf, "
-            "runtime_mean: %.0lf }\n",
+            "95%%: %.0lf, 99%%: %.0lf, max: %.0lf, ",
             cfg_payload_len, tx_frame_len,
-            mean * 1e3, min * 1e3, p50 * 1e3, p95 * 1e3, p99 * 1e3, max * 1e3,
-            run_mean * 1e3);
+            mean * 1e3, min * 1e3, pct[0] * 1e3, pct[1] * 1e3, pct[2] * 1e3,
+            max * 1e3);
+    for( i = 3; i < N_PERCENTILES; ++i )
+      fprintf(yaml_fp, "%s%%: %.0lf, ", percentiles[i].name, pct[i] * 1e3);
+    fprintf(yaml_fp, "runtime_mean: %.0lf }\n", run_mean * 1e3);
+  }
+
+  if( json_fp ) {
+    fprintf(json_fp, "%s\n    { \"payload_len\": %d, \"frame_len\": %d, "
+            "\"runtime_mean_ns\": %.0lf, ", json_n_results++ ? "," : "",
+            cfg_payload_len, tx_frame_len, run_mean * 1e3);
+    json_hist(json_fp, &all_hist, div);
+    fprintf(json_fp, ",\n      \"flows\": [");
+    for( f = 0; f < cfg_flows; ++f ) {
+      fprintf(json_fp, "%s\n        { \"flow\": %d, \"tx_mode\": \"%s\", "
+              "\"runtime_mean_ns\": %.0lf, ", f ? "," : "", f,
+              flows[f].tx_mode, flows[f].run_usec * 1e3 / cfg_iter);
+      json_hist(json_fp, &flows[f].hist, div);
+      fprintf(json_fp, " }");
+    }
+    fprintf(json_fp, " ] }");
   }
 }
 
@@ -293,6 +573,8 @@ typedef struct {
   void (*cleanup)(ef_vi* rx_vi, ef_vi* tx_vi);
 } test_t;
 
+static __thread const test_t* flow_test;
+
 static int
 generic_desc_check(struct eflatency_vi* vi, struct eflatency_vi* tx_vi,
                    int wait);
@@ -318,9 +600,11 @@ generic_ping(struct eflatency_vi* rx_vi, struct eflatency_vi* tx_vi,
              void (*rx_wait)(struct eflatency_vi*, struct eflatency_vi*),
              void (*tx_send)(struct eflatency_vi*))
 {
+  struct lat_hist* hist = &this_flow->hist;
   struct timeval start, end;
   int i;
 
+  hist_reset(hist);
   for( i = 0; i < cfg_warmups; ++i ) {
     tx_send(tx_vi);
     poll_tx_and_wait_for_pkt(rx_vi, tx_vi, rx_wait);
@@ -333,11 +617,14 @@ generic_ping(struct eflatency_vi* rx_vi, struct eflatency_vi* tx_vi,
     tx_send(tx_vi);
     poll_tx_and_wait_for_pkt(rx_vi, tx_vi, rx_wait);
     uint64_t stop = frc64_get();
-    timings[i] = stop - start;
+    hist_add(hist, stop - start);
+    if( timings )
+      timings[i] = stop - start;
   }
 
   gettimeofday(&end, NULL);
-  output_results(start, end);
+  this_flow->run_usec = (end.tv_sec - start.tv_sec) * 1000000;
+  this_flow->run_usec += end.tv_usec - start.tv_usec;
 }
 
 
@@ -442,7 +729,7 @@ static const test_t pio_test = {
 #define N_TX_ALT       2
 #define TX_ALT_MASK    (N_TX_ALT - 1)
 
-struct {
+static __thread struct {
   /* Track the alternatives that are awaiting completion and those that are
    * available for use. */
   uint32_t complete_id;
@@ -548,7 +835,7 @@ generic_desc_check(struct eflatency_vi* vi, struct eflatency_vi *tx_vi,
 {
   /* Track which buffer will be written next to be able to
    * peek at data. */
-  static int rx_bufs_idx = 0;
+  static __thread int rx_bufs_idx = 0;
   /* We might exit with events read but unprocessed. */
   int i = vi->i;
   int n_ev = vi->n_ev;
@@ -736,7 +1023,7 @@ static const test_t* do_init(int mode, struct eflatency_vi* latency_vi,
   if( latency_vi == &rx_vi ) {
     ef_filter_spec_init(&filter_spec, EF_FILTER_FLAG_EXCLUSIVE_RXQ);
     TRY(ef_filter_spec_set_ip4_local(&filter_spec, IPPROTO_UDP, htonl(raddr_he),
-                                    htons(port_he)));
+                                    htons(port_he + flow_i)));
     TRY(ef_vi_filter_add(vi, driver_handle, &filter_spec, NULL));
   }
 
@@ -826,6 +1113,159 @@ static void print_payload_len_array(FILE *out_stream, const char *prefix,
 }
 
 
+/* Set up the VIs and buffers of flow [id].  This runs in the flow's own
+ * thread, as the state that it sets up is thread-local. */
+static void flow_init(int id)
+{
+  const test_t* t;
+  unsigned long rx_min_page_size;
+  unsigned long min_page_size;
+  unsigned long can_rx_poll;
+  void* pkt_mem;
+  int pkt_mem_bytes;
+  int i;
+
+  this_flow = &flows[id];
+  flow_i = id;
+
+  TRY(ef_pd_alloc(&rx_vi.pd, driver_handle, rx_ifindex, cfg_rx_pd_flags));
+  if( tx_ifindex >= 0 )
+    TRY(ef_pd_alloc(&tx_vi.pd, driver_handle, tx_ifindex, cfg_tx_pd_flags));
+
+  TRY(ef_pd_capabilities_get(driver_handle, &rx_vi.pd, driver_handle,
+                             EF_VI_CAP_MIN_BUFFER_MODE_SIZE,
+                             &rx_min_page_size));
+  if( tx_ifindex < 0 ) {
+    min_page_size = rx_min_page_size;
+  }
+  else {
+    TRY(ef_pd_capabilities_get(driver_handle, &tx_vi.pd, driver_handle,
+                               EF_VI_CAP_MIN_BUFFER_MODE_SIZE,
+                               &min_page_size));
+    min_page_size = MAX(rx_min_page_size, min_page_size);
+  }
+
+  pkt_mem_bytes = N_BUFS * BUF_SIZE;
+  pkt_mem_bytes = MAX(min_page_size, pkt_mem_bytes);
+  if (min_page_size >= 2 * 1024 * 1024) {
+    /* Assume this means huge pages are mandatory */
+    pkt_mem = mmap(NULL, pkt_mem_bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    TEST(pkt_mem != MAP_FAILED);
+  }
+  else {
+    TEST(posix_memalign(&pkt_mem, min_page_size, pkt_mem_bytes) == 0);
+  }
+  for( i = 0; i < N_BUFS; ++i ) {
+    struct pkt_buf* pb = (void*) ((char*) pkt_mem + i * BUF_SIZE);
+    pkt_bufs[i] = pb;
+    pb->id = i;
+  }
+
+  /* Initialize a VI and configure it to operate with the lowest latency
+   * possible.  The return value specifies the test that the application must
+   * run to use the VI in its configured mode. */
+  t = do_init(cfg_mode, &rx_vi, pkt_mem, pkt_mem_bytes);
+
+  if( tx_ifindex < 0 ) {
+    tx_vi_ptr = &rx_vi;
+  } else {
+    /* mode really selects tx method */
+    t = do_init(cfg_mode, &tx_vi, pkt_mem, pkt_mem_bytes);
+    tx_vi_ptr = &tx_vi;
+  }
+
+  /* Test gives TX send method. Determine RX polling method */
+  if( ef_pd_capabilities_get(driver_handle, &rx_vi.pd, driver_handle,
+                             EF_VI_CAP_RX_POLL,
+                             &can_rx_poll) == 0 && can_rx_poll )
+    rx_wait = rx_wait_poll_rx;
+  else
+    rx_wait = rx_wait_poll_evq;
+
+  for( i = 0; i < N_BUFS; ++i ) {
+    struct pkt_buf* pb = (void*) ((char*) pkt_mem + i * BUF_SIZE);
+    ef_memreg* memreg = i < N_RX_BUFS ? &rx_vi.memreg : &tx_vi_ptr->memreg;
+    pb->dma_buf_addr = ef_memreg_dma_addr(memreg, i * BUF_SIZE);
+    pb->dma_buf_addr += offsetof(struct pkt_buf, dma_buf);
+  }
+
+
+  /* Default to descriptor style RX unless we can confirm support for RX_REF */
+  rx_vi.needs_rx_post = 1;
+  if( ef_pd_capabilities_get(driver_handle, &rx_vi.pd, driver_handle,
+                             EF_VI_CAP_RX_REF, &use_rx_ref) == 0 &&
+                             use_rx_ref )
+    rx_vi.needs_rx_post = 0;
+
+  prepare(&rx_vi);
+
+  flow_test = t;
+  this_flow->tx_mode = t->name;
+  if( ping && cfg_save_file ) {
+    timings = mmap(NULL, cfg_iter * sizeof(timings[0]), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    TEST(timings != MAP_FAILED);
+  }
+}
+
+
+/* Move on to the next payload length.  Returns false if there is none. */
+static bool next_payload_len(int iters_run)
+{
+  if( payload_lens ) {
+    if( iters_run >= n_payload_lens )
+      return false;
+    cfg_payload_len = payload_lens[iters_run];
+    return true;
+  }
+  cfg_payload_len += cfg_payload_step;
+  if( cfg_payload_step < 0 )
+    return cfg_payload_len > cfg_payload_end;
+  return cfg_payload_len < cfg_payload_end;
+}
+
+
+/* Run the test at each payload length.  The flows move from one payload
+ * length to the next together, and the first flow reports on each.
+ * Returns the number of payload lengths run. */
+static int flow_run(void)
+{
+  const test_t* t = flow_test;
+  int iters_run = 0;
+
+  pthread_barrier_wait(&flows_barrier);
+  for( ; ; ) {
+    ++iters_run;
+    if( t->init )
+      t->init(&rx_vi, tx_vi_ptr);
+    (ping ? generic_ping : generic_pong)(&rx_vi, tx_vi_ptr, rx_wait, t->send);
+    if( t->cleanup != NULL )
+      t->cleanup(&rx_vi.vi, &tx_vi_ptr->vi);
+    pthread_barrier_wait(&flows_barrier);
+    if( flow_i == 0 ) {
+      if( ping )
+        output_results();
+      flows_done = ! next_payload_len(iters_run);
+    }
+    pthread_barrier_wait(&flows_barrier);
+    if( flows_done )
+      break;
+    init_udp_pkt(pkt_bufs[FIRST_TX_BUF]->dma_buf, cfg_payload_len);
+    tx_frame_len = cfg_payload_len + HEADER_SIZE;
+  }
+  return iters_run;
+}
+
+
+static void* flow_thread(void* arg)
+{
+  flow_init((uintptr_t) arg);
+  flow_run();
+  return NULL;
+}
+
+
 static __attribute__((noreturn)) void usage(const char* fmt, ...)
 {
   if( fmt ) {
@@ -858,6 +1298,13 @@ static __attribute__((noreturn)) void usage(const char* fmt, ...)
   fprintf(stderr, "                      - [p]eek at buffer ahead of arrival\n");
   fprintf(stderr, "  -o <filename>       - save raw timings to file\n");
   fprintf(stderr, "  -y <filename>       - save result data to file (YAML)\n");
+  fprintf(stderr, "  -j <filename>       - save result data to file (JSON)\n");
+  fprintf(stderr, "  -f <flows>          - run this many ping-pong flows at once,\n");
+  fprintf(stderr, "                        each with its own thread, VIs and\n");
+  fprintf(stderr, "                        UDP port; give pong the same number\n");
+  fprintf(stderr, "  -C <clock>          - clock source for timings: auto,\n");
+  fprintf(stderr, "                        cycles (PMU cycle counter on arm64)\n");
+  fprintf(stderr, "                        or timer (system counter)\n");
   fprintf(stderr, "\n");
   exit(1);
 }
@@ -865,22 +1312,10 @@ static __attribute__((noreturn)) void usage(const char* fmt, ...)
 
 int main(int argc, char* argv[])
 {
-  int rx_ifindex = -1 , tx_ifindex = -1;
   int c;
-  bool ping = false;
   const test_t* t;
-  int iters_run = 0;
-  struct eflatency_vi* tx_vi_ptr;
-  void (*rx_wait)(struct eflatency_vi*, struct eflatency_vi*);
-  unsigned long rx_min_page_size;
-  unsigned long min_page_size;
-  unsigned long can_rx_poll;
-  unsigned long use_rx_ref;
-  void* pkt_mem;
-  int pkt_mem_bytes;
+  int iters_run;
   int i;
-  int *payload_lens = NULL;
-  int n_payload_lens = 0;
 
   printf("# ef_vi_version_str: %s\n", ef_vi_version_str());
 
@@ -900,7 +1335,7 @@ int main(int argc, char* argv[])
     p = (unsigned int)__v;                                   \
   } while( 0 );
 
-  while( (c = getopt (argc, argv, "n:s:w:c:pm:t:d:o:y:")) != -1 )
+  while( (c = getopt (argc, argv, "n:s:w:c:pm:t:d:o:y:j:f:C:")) != -1 )
     switch( c ) {
     case 'n':
       OPT_INT(optarg, cfg_iter);
@@ -955,6 +1390,24 @@ int main(int argc, char* argv[])
     case 'y':
       cfg_yaml_file = optarg;
       break;
+    case 'j':
+      cfg_json_file = optarg;
+      break;
+    case 'f':
+      OPT_INT(optarg, cfg_flows);
+      if( cfg_flows < 1 )
+        usage("Number of flows must be at least 1");
+      break;
+    case 'C':
+      if( ! strcmp(optarg, "auto") )
+        cfg_clock = CLOCK_AUTO;
+      else if( ! strcmp(optarg, "cycles") )
+        cfg_clock = CLOCK_CYCLES;
+      else if( ! strcmp(optarg, "timer") )
+        cfg_clock = CLOCK_TIMER;
+      else
+        usage("Unknown clock '%s'", optarg);
+      break;
     case 'm':
       cfg_mode = 0;
       for( i = 0; i < strlen(optarg); ++i ) {
@@ -1029,83 +1482,17 @@ int main(int argc, char* argv[])
     ping = true;
   else if( strcmp(argv[0], "pong") != 0 )
     usage("Unknown command '%s'", argv[0]);
-
-  TRY(ef_pd_alloc(&rx_vi.pd, driver_handle, rx_ifindex, cfg_rx_pd_flags));
-  if( tx_ifindex >= 0 )
-    TRY(ef_pd_alloc(&tx_vi.pd, driver_handle, tx_ifindex, cfg_tx_pd_flags));
-
-  TRY(ef_pd_capabilities_get(driver_handle, &rx_vi.pd, driver_handle,
-                             EF_VI_CAP_MIN_BUFFER_MODE_SIZE,
-                             &rx_min_page_size));
-  if( tx_ifindex < 0 ) {
-    min_page_size = rx_min_page_size;
-  }
-  else {
-    TRY(ef_pd_capabilities_get(driver_handle, &tx_vi.pd, driver_handle,
-                               EF_VI_CAP_MIN_BUFFER_MODE_SIZE,
-                               &min_page_size));
-    min_page_size = MAX(rx_min_page_size, min_page_size);
-  }
-
-  pkt_mem_bytes = N_BUFS * BUF_SIZE;
-  pkt_mem_bytes = MAX(min_page_size, pkt_mem_bytes);
-  if (min_page_size >= 2 * 1024 * 1024) {
-    /* Assume this means huge pages are mandatory */
-    pkt_mem = mmap(NULL, pkt_mem_bytes, PROT_READ | PROT_WRITE,
-                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
-    TEST(pkt_mem != MAP_FAILED);
-  }
-  else {
-    TEST(posix_memalign(&pkt_mem, min_page_size, pkt_mem_bytes) == 0);
-  }
-  for( i = 0; i < N_BUFS; ++i ) {
-    struct pkt_buf* pb = (void*) ((char*) pkt_mem + i * BUF_SIZE);
-    pkt_bufs[i] = pb;
-    pb->id = i;
-  }
-
-  /* Initialize a VI and configure it to operate with the lowest latency
-   * possible.  The return value specifies the test that the application must
-   * run to use the VI in its configured mode. */
-  t = do_init(cfg_mode, &rx_vi, pkt_mem, pkt_mem_bytes);
-
-  if( tx_ifindex < 0 ) {
-    tx_vi_ptr = &rx_vi;
-  } else {
-    /* mode really selects tx method */
-    t = do_init(cfg_mode, &tx_vi, pkt_mem, pkt_mem_bytes);
-    tx_vi_ptr = &tx_vi;
-  }
-
-  /* Test gives TX send method. Determine RX polling method */
-  if( ef_pd_capabilities_get(driver_handle, &rx_vi.pd, driver_handle,
-                             EF_VI_CAP_RX_POLL,
-                             &can_rx_poll) == 0 && can_rx_poll )
-    rx_wait = rx_wait_poll_rx;
-  else
-    rx_wait = rx_wait_poll_evq;
-
-  for( i = 0; i < N_BUFS; ++i ) {
-    struct pkt_buf* pb = (void*) ((char*) pkt_mem + i * BUF_SIZE);
-    ef_memreg* memreg = i < N_RX_BUFS ? &rx_vi.memreg : &tx_vi_ptr->memreg;
-    pb->dma_buf_addr = ef_memreg_dma_addr(memreg, i * BUF_SIZE);
-    pb->dma_buf_addr += offsetof(struct pkt_buf, dma_buf);
-  }
-
-
-  /* Default to descriptor style RX unless we can confirm support for RX_REF */
-  rx_vi.needs_rx_post = 1;
-  if( ef_pd_capabilities_get(driver_handle, &rx_vi.pd, driver_handle,
-                             EF_VI_CAP_RX_REF, &use_rx_ref) == 0 &&
-                             use_rx_ref )
-    rx_vi.needs_rx_post = 0;
-
-  prepare(&rx_vi);
-
-  if( ping ) {
-    timings = mmap(NULL, cfg_iter * sizeof(timings[0]), PROT_READ | PROT_WRITE,
-                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
-  }
+  if( cfg_save_file && cfg_flows > 1 )
+    usage("Raw timings can only be saved with a single flow");
+
+  flows = calloc(cfg_flows, sizeof(*flows));
+  TEST(flows != NULL);
+  TEST(pthread_barrier_init(&flows_barrier, NULL, cfg_flows) == 0);
+  flow_init(0);
+  for( i = 1; i < cfg_flows; ++i )
+    TEST(pthread_create(&flows[i].thread, NULL, flow_thread,
+                        (void*) (uintptr_t) i) == 0);
+  t = flow_test;
 
   if( cfg_yaml_file ) {
       yaml_fp = fopen(cfg_yaml_file, "wt");
@@ -1133,6 +1520,7 @@ int main(int argc, char* argv[])
         }
         fprintf(yaml_fp, "iterations: %d\n", cfg_iter);
         fprintf(yaml_fp, "warmups: %d\n", cfg_warmups);
+        fprintf(yaml_fp, "flows: %d\n", cfg_flows);
         fprintf(yaml_fp, "tx_mode: %s\n", t->name);
         fprintf(yaml_fp, "rx_event_type: %s\n",
                 use_rx_ref ? "EF_EVENT_TYPE_RX_REF" : "EF_EVENT_TYPE_RX");
@@ -1155,6 +1543,7 @@ int main(int argc, char* argv[])
            cfg_payload_step);
   printf("# iterations: %d\n", cfg_iter);
   printf("# warmups: %d\n", cfg_warmups);
+  printf("# flows: %d\n", cfg_flows);
   if( payload_lens )
     print_payload_len_array(stdout, "# frame len: ", "\n", ", ",
                             payload_lens, n_payload_lens,
@@ -1164,38 +1553,46 @@ int main(int argc, char* argv[])
   printf("# TX mode: %s\n", t->name);
   printf("# RX event type: %s\n",
          use_rx_ref ? "EF_EVENT_TYPE_RX_REF" : "EF_EVENT_TYPE_RX");
-  if( ping )
-    printf("paylen\tmean\tmin\t50%%\t95%%\t99%%\tmax\n");
+  if( ping ) {
+    clock_init(cfg_clock);
+    printf("paylen\tmean\tmin\t50%%\t95%%\t99%%\tmax");
+    for( i = 3; i < N_PERCENTILES; ++i )
+      printf("\t%s%%", percentiles[i].name);
+    printf("\n");
+  }
 
-  for( ; ; ) {
-    ++iters_run;
-    if( t->init )
-      t->init(&rx_vi, tx_vi_ptr);
-    (ping ? generic_ping : generic_pong)(&rx_vi, tx_vi_ptr, rx_wait, t->send);
-    if( t->cleanup != NULL )
-      t->cleanup(&rx_vi.vi, &tx_vi_ptr->vi);
-    if( payload_lens ) {
-      if (iters_run >= n_payload_lens)
-        break;
-      cfg_payload_len = payload_lens[iters_run];
-    } else {
-      cfg_payload_len += cfg_payload_step;
-      if( cfg_payload_step < 0 ) {
-        if( cfg_payload_len <= cfg_payload_end )
-          break;
-      }
-      else if( cfg_payload_len >= cfg_payload_end )
-        break;
-    }
-    init_udp_pkt(pkt_bufs[FIRST_TX_BUF]->dma_buf, cfg_payload_len);
-    tx_frame_len = cfg_payload_len + HEADER_SIZE;
+  if( cfg_json_file ) {
+    json_fp = fopen(cfg_json_file, "wt");
+    TEST(json_fp != NULL);
+    fprintf(json_fp, "{ \"ef_vi_version_str\": \"%s\",\n",
+            ef_vi_version_str());
+    fprintf(json_fp, "  \"nics\": [ %d, %d ],\n", rx_ifindex, tx_ifindex);
+    fprintf(json_fp, "  \"iterations\": %d,\n", cfg_iter);
+    fprintf(json_fp, "  \"warmups\": %d,\n", cfg_warmups);
+    fprintf(json_fp, "  \"flows\": %d,\n", cfg_flows);
+    fprintf(json_fp, "  \"tx_mode\": \"%s\",\n", t->name);
+    fprintf(json_fp, "  \"rx_event_type\": \"%s\",\n",
+            use_rx_ref ? "EF_EVENT_TYPE_RX_REF" : "EF_EVENT_TYPE_RX");
+    fprintf(json_fp, "  \"vi_flags\": %u,\n", (unsigned)cfg_vi_flags);
+    fprintf(json_fp, "  \"ping_or_pong\": \"%s\",\n", ping ? "ping" : "pong");
+    fprintf(json_fp, "  \"clock_khz\": %u,\n", frc_khz);
+    fprintf(json_fp, "  \"results\": [");
   }
+
+  iters_run = flow_run();
+  for( i = 1; i < cfg_flows; ++i )
+    pthread_join(flows[i].thread, NULL);
   if( ping && iters_run == 1 )
     printf("mean round-trip time: %.3lf usec\n", last_mean_latency_usec);
 
   free(payload_lens);
+  free(flows);
   if( yaml_fp )
     fclose(yaml_fp);
+  if( json_fp ) {
+    fprintf(json_fp, "\n  ]\n}\n");
+    fclose(json_fp);
+  }
   return 0;
 }
 
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* X-SPDX-Copyright-Text: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/* efresolve_bench
+ *
+ * Rate of cached route resolutions with the cplane API, one packet at a time
+ * with ef_cp_resolve() and a burst at a time with ef_cp_resolve_batch().
+ *
+ *   efresolve_bench [-b burst] [-f flows] [-d secs] dest_ip...
+ *
+ * A burst of [burst] UDP packets (default 32) is spread over [flows] flows
+ * (default 4), each to one of the given destinations with its own source
+ * port, so that bonds hash them differently.  Packets for the same flow are
+ * adjacent in the burst, as they would be in a router that sorts its input.
+ * Each packet keeps its route verinfo from one burst to the next, as an
+ * application that caches routes per flow would.
+ *
+ * Interfaces need not be registered, and destinations need not answer ARP,
+ * so this can be run on any host with a cplane server.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <cplane/api.h>
+
+#define PREFIX_SPACE  64
+#define BUF_SIZE      (PREFIX_SPACE + sizeof(struct iphdr) + \
+                       sizeof(struct udphdr))
+#define MAX_BURST     1024
+#define RESOLVE_FLAGS (EF_CP_RESOLVE_F_UNREGISTERED | EF_CP_RESOLVE_F_NO_ARP)
+
+static char bufs[MAX_BURST][BUF_SIZE];
+static void* ip_hdrs[MAX_BURST];
+static size_t prefix_space[MAX_BURST];
+static struct ef_cp_fwd_meta meta[MAX_BURST];
+static struct ef_cp_route_verinfo ver[MAX_BURST];
+static int64_t rc[MAX_BURST];
+
+
+static double now_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void build_pkt(int i, in_addr_t daddr, unsigned flow)
+{
+  struct iphdr* ip = (void*) (bufs[i] + PREFIX_SPACE);
+  struct udphdr* udp = (void*) (ip + 1);
+
+  ip->version = 4;
+  ip->ihl = sizeof(*ip) / 4;
+  ip->protocol = IPPROTO_UDP;
+  ip->daddr = daddr;
+  udp->source = htons(20000 + flow);
+  udp->dest = htons(12345);
+  ip_hdrs[i] = ip;
+  meta[i] = (struct ef_cp_fwd_meta){ .ifindex = -1, .iif_ifindex = -1 };
+  ver[i] = EF_CP_ROUTE_VERINFO_INIT;
+}
+
+
+static void reset_inputs(int burst)
+{
+  int i;
+  for( i = 0; i < burst; ++i ) {
+    prefix_space[i] = PREFIX_SPACE;
+    meta[i].ifindex = -1;
+  }
+}
+
+
+static void check(int i, int64_t r)
+{
+  if( r < 0 ) {
+    fprintf(stderr, "ERROR: packet %d: ef_cp_resolve failed (%s)\n", i,
+            strerror(-r));
+    exit(1);
+  }
+}
+
+
+static void report(const char* what, uint64_t n, double t)
+{
+  printf("%-8s %14.0f %10.1f\n", what, n / t, t * 1e9 / n);
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: efresolve_bench [-b burst] [-f flows] [-d secs] "
+          "dest_ip...\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  struct ef_cp_handle* cp;
+  int burst = 32, n_flows = 4, n_dests, i, c;
+  double duration = 2, t0, t;
+  in_addr_t* dests;
+  uint64_t n;
+
+  while( (c = getopt(argc, argv, "b:f:d:")) != -1 )
+    switch( c ) {
+    case 'b':  burst = atoi(optarg);     break;
+    case 'f':  n_flows = atoi(optarg);   break;
+    case 'd':  duration = atof(optarg);  break;
+    default:   usage();
+    }
+  if( optind == argc || burst < 1 || burst > MAX_BURST || n_flows < 1 ||
+      n_flows > burst || duration <= 0 )
+    usage();
+
+  n_dests = argc - optind;
+  dests = calloc(n_dests, sizeof(*dests));
+  for( i = 0; i < n_dests; ++i )
+    if( inet_pton(AF_INET, argv[optind + i], &dests[i]) != 1 ) {
+      fprintf(stderr, "ERROR: bad address '%s'\n", argv[optind + i]);
+      return 1;
+    }
+
+  if( (c = ef_cp_init(&cp, 0)) < 0 ) {
+    fprintf(stderr, "ERROR: ef_cp_init failed (%s)\n", strerror(-c));
+    return 1;
+  }
+  for( i = 0; i < burst; ++i ) {
+    unsigned flow = (uint64_t) i * n_flows / burst;
+    build_pkt(i, dests[flow % n_dests], flow);
+  }
+
+  /* Fill the verinfo of every packet, so that both loops below measure only
+   * the cached path. */
+  reset_inputs(burst);
+  for( i = 0; i < burst; ++i )
+    check(i, ef_cp_resolve(cp, ip_hdrs[i], &prefix_space[i], &meta[i],
+                           &ver[i], RESOLVE_FLAGS));
+
+  printf("# burst=%d flows=%d dests=%d secs=%.1f\n", burst, n_flows, n_dests,
+         duration);
+  printf("#%-7s %14s %10s\n", "api", "resolves/s", "ns/resolve");
+
+  n = 0;
+  t0 = now_sec();
+  do {
+    int j;
+    for( j = 0; j < 64; ++j ) {
+      reset_inputs(burst);
+      for( i = 0; i < burst; ++i )
+        rc[i] = ef_cp_resolve(cp, ip_hdrs[i], &prefix_space[i], &meta[i],
+                              &ver[i], RESOLVE_FLAGS);
+    }
+    n += 64 * burst;
+  } while( (t = now_sec() - t0) < duration );
+  for( i = 0; i < burst; ++i )
+    check(i, rc[i]);
+  report("single", n, t);
+
+  n = 0;
+  t0 = now_sec();
+  do {
+    int j;
+    for( j = 0; j < 64; ++j ) {
+      reset_inputs(burst);
+      ef_cp_resolve_batch(cp, ip_hdrs, prefix_space, meta, ver, rc, burst,
+                          RESOLVE_FLAGS);
+    }
+    n += 64 * burst;
+  } while( (t = now_sec() - t0) < duration );
+  for( i = 0; i < burst; ++i )
+    check(i, rc[i]);
+  report("batch", n, t);
+
+  ef_cp_fini(cp);
+  free(dests);
+  return 0;
+}
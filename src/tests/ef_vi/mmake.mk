@@ -3,7 +3,7 @@
 
 EFSEND_APPS := efsend efsend_timestamping efsend_warming efsend_cplane
 TEST_APPS	:= efforward efrss efsink \
-		   efsink_packed eflatency stats \
+		   efsink_packed eflatency stats efresolve_bench \
 		   $(EFSEND_APPS)
 
 TARGETS		:= $(TEST_APPS:%=$(AppPattern))
@@ -82,6 +82,7 @@
 #endif
 
 #define MAX(x,y)             (((x) > (y)) ? (x) : (y))
+#define MIN(x,y)             (((x) < (y)) ? (x) : (y))
 #define ROUND_UP(p, align)   (((p)+(align)-1u) & ~((typeof(p))(align)-1u))
 #define IS_POW2(n)           (((n) & (n - 1)) == 0)
 
@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Microbenchmark for the citools bulk checksum engine.
+ *
+ * For each available kernel and each buffer size, reports the throughput of
+ * plain checksum (ci_ip_csum64) and fused copy+checksum (ci_ip_csum64_copy)
+ * in GB/s.  Every kernel's result is cross-checked against the scalar one
+ * before it is timed.
+ *
+ *   csum_bench [-e engine] [-b total_bytes]
+ */
+
+#include <ci/tools.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+static const size_t sizes[] = { 64, 128, 256, 512, 1024, 1500, 4096, 9000 };
+#define N_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static const char* const engines[] = { "scalar", "avx2", "neon" };
+#define N_ENGINES (sizeof(engines) / sizeof(engines[0]))
+
+/* Amount of data to checksum per measurement */
+static size_t total_bytes = 1ull << 30;
+
+/* Keep the results live so the compiler can't discard the work */
+static volatile unsigned sink;
+
+
+static double now_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static double bench_csum(const ci_uint8* buf, size_t size)
+{
+  size_t iters = total_bytes / size, i;
+  ci_uint64 sum = 0;
+  double t0, t1;
+
+  t0 = now_sec();
+  for( i = 0; i < iters; ++i )
+    /* Vary the offset so both alignments are exercised. */
+    sum += ci_ip_csum64(buf + (i & 1), size);
+  t1 = now_sec();
+  sink = ci_ip_csum64_fold(sum);
+  return iters * size / (t1 - t0) / 1e9;
+}
+
+
+static double bench_csum_copy(ci_uint8* dst, const ci_uint8* buf, size_t size)
+{
+  size_t iters = total_bytes / size, i;
+  ci_uint64 sum = 0;
+  double t0, t1;
+
+  t0 = now_sec();
+  for( i = 0; i < iters; ++i )
+    sum += ci_ip_csum64_copy(dst, buf + (i & 1), size);
+  t1 = now_sec();
+  sink = ci_ip_csum64_fold(sum);
+  return iters * size / (t1 - t0) / 1e9;
+}
+
+
+static int check_engine(const char* engine, ci_uint8* dst,
+                        const ci_uint8* buf, size_t max_size)
+{
+  size_t size, off;
+  unsigned ref, got, got_copy;
+
+  for( size = 0; size <= max_size; size += (size < 256 ? 1 : 61) )
+    for( off = 0; off < 4; ++off ) {
+      ci_ip_csum_engine_select("scalar");
+      ref = ci_ip_csum64_fold(ci_ip_csum64(buf + off, size));
+      ci_ip_csum_engine_select(engine);
+      got = ci_ip_csum64_fold(ci_ip_csum64(buf + off, size));
+      got_copy = ci_ip_csum64_fold(ci_ip_csum64_copy(dst, buf + off, size));
+      /* 0 and 0xffff are the same value in one's complement */
+      if( ref % 0xffff != got % 0xffff || ref % 0xffff != got_copy % 0xffff ||
+          memcmp(dst, buf + off, size) ) {
+        fprintf(stderr, "%s: mismatch size=%zu off=%zu ref=%#x got=%#x "
+                "copy=%#x\n", engine, size, off, ref, got, got_copy);
+        return -1;
+      }
+    }
+  return 0;
+}
+
+
+static void usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-e scalar|avx2|neon] [-b total_bytes]\n", prog);
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  const char* only = NULL;
+  size_t max_size = sizes[N_SIZES - 1];
+  ci_uint8 *buf, *dst;
+  unsigned e, s;
+  int c, rc = 0;
+
+  while( (c = getopt(argc, argv, "e:b:")) != -1 )
+    switch( c ) {
+    case 'e':
+      only = optarg;
+      break;
+    case 'b':
+      total_bytes = strtoull(optarg, NULL, 0);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  if( total_bytes < max_size )
+    usage(argv[0]);
+
+  buf = malloc(max_size + 8);
+  dst = malloc(max_size + 8);
+  if( buf == NULL || dst == NULL )
+    return 1;
+  srandom(42);
+  for( s = 0; s < max_size + 8; ++s )
+    buf[s] = random();
+
+  printf("# default engine: %s\n", ci_ip_csum_engine_name());
+  printf("# %-8s %6s %12s %12s\n", "engine", "bytes", "csum_GB/s",
+         "copy_GB/s");
+
+  for( e = 0; e < N_ENGINES; ++e ) {
+    if( only != NULL && strcmp(only, engines[e]) )
+      continue;
+    if( ci_ip_csum_engine_select(engines[e]) < 0 ) {
+      if( only != NULL ) {
+        fprintf(stderr, "%s: engine not available\n", engines[e]);
+        rc = 1;
+      }
+      continue;
+    }
+    if( check_engine(engines[e], dst, buf, max_size) < 0 ) {
+      rc = 1;
+      continue;
+    }
+    ci_ip_csum_engine_select(engines[e]);
+    for( s = 0; s < N_SIZES; ++s )
+      printf("  %-8s %6zu %12.2f %12.2f\n", engines[e], sizes[s],
+             bench_csum(buf, sizes[s]), bench_csum_copy(dst, buf, sizes[s]));
+  }
+
+  free(buf);
+  free(dst);
+  return rc;
+}
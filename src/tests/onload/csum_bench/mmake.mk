@@ -0,0 +1,18 @@
+# SPDX-License-Identifier: BSD-2-Clause
+# SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc.
+
+TARGETS := csum_bench
+
+MMAKE_LIBS += $(LINK_CITOOLS_LIB)
+MMAKE_LIB_DEPS += $(CITOOLS_LIB_DEPEND)
+
+all: $(TARGETS)
+
+csum_bench: csum_bench.o $(MMAKE_LIB_DEPS)
+	(libs="$(MMAKE_LIBS)"; $(MMakeLinkCApp))
+
+targets:
+	@echo $(TARGETS)
+
+clean:
+	@$(MakeClean)
@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Latency of software filter-table lookups on a large stack.
+ *
+ *   filter_bench [-s table_lg2] [-n lookups] [load%...]
+ *
+ * For each load (default 50, 70 and 90 percent of a 2^20-entry table, so
+ * from about 500k connections) the table is filled with TCP connections to
+ * one local address and port from random remote addresses and ports, in the
+ * way that a busy server's would be.  It then reports the mean time for
+ * ci_netif_filter_for_each_match(), as used by the RX path, to find a
+ * connected socket (hit) and to fail to find one (miss).
+ *
+ * Each connection has its own socket buffer, and lookups are in random
+ * order, so every socket that a probe has to look at is a cache miss.  This
+ * is what the fingerprint in the table entries is there to avoid.
+ */
+
+#define _GNU_SOURCE
+#include <ci/internal/ip.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+
+#define LADDR  CI_BSWAP_BE32(0x0a000001)  /* 10.0.0.1 */
+#define LPORT  CI_BSWAP_BE16(80)
+
+
+/* Referenced by logging in the table code, which is disabled here. */
+unsigned ci_tp_log;
+const char* ip_addr_str(unsigned addr_be32) { return ""; }
+
+
+struct tuple {
+  ci_uint32 raddr;
+  ci_uint16 rport;
+};
+
+
+static ci_uint64 now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+static int found(ci_sock_cmn* s, void* arg)
+{
+  *(ci_sock_cmn**) arg = s;
+  return 1;
+}
+
+
+/* Random remote endpoint in 10.128.0.0/9 for hits, or 10.0.0.0/9 for
+ * misses. */
+static void random_tuple(struct tuple* t, int miss)
+{
+  t->raddr = CI_BSWAP_BE32(0x0a000000 | (miss ? 0 : 0x800000) |
+                           (random() & 0x7fffff));
+  t->rport = CI_BSWAP_BE16(1024 + random() % 64512);
+}
+
+
+/* Empty the table, as ci_netif_filter_init() does in the driver. */
+static void table_init(ci_netif* ni, unsigned size)
+{
+  unsigned i;
+
+  *(unsigned*) &ni->filter_table->table_size_mask = size - 1;
+  for( i = 0; i < size; ++i ) {
+    ni->filter_table->table[i].__id_and_state = 2u << 30;  /* EMPTY */
+    ni->filter_table->table[i].laddr = 0;
+    ni->filter_table_ext[i].route_count = 0;
+    ni->filter_table_ext[i].lport = 0;
+  }
+}
+
+
+static double bench(ci_netif* ni, const struct tuple* q, unsigned n_q,
+                    int expect_hit)
+{
+  ci_sock_cmn* s;
+  ci_uint64 t0;
+  unsigned i, n_hit = 0;
+
+  t0 = now_ns();
+  for( i = 0; i < n_q; ++i ) {
+    s = NULL;
+    ci_netif_filter_for_each_match(ni, LADDR, LPORT, q[i].raddr, q[i].rport,
+                                   IPPROTO_TCP, 0, 0, found, &s, NULL);
+    n_hit += s != NULL;
+  }
+  t0 = now_ns() - t0;
+  if( n_hit != (expect_hit ? n_q : 0) ) {
+    fprintf(stderr, "ERROR: %u of %u lookups found a socket\n", n_hit, n_q);
+    exit(1);
+  }
+  return (double) t0 / n_q;
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: filter_bench [-s table_lg2] [-n lookups] "
+          "[load%%...]\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  static const unsigned default_loads[] = { 50, 70, 90 };
+  unsigned table_lg2 = 20, n_q = 1u << 21;
+  const unsigned* loads = default_loads;
+  unsigned n_loads = sizeof(default_loads) / sizeof(default_loads[0]);
+  unsigned* arg_loads = NULL;
+  unsigned size, max_socks, n_socks, i, l;
+  struct tuple *socks, *hits, *misses;
+  size_t state_size;
+  ci_netif ni;
+  int c;
+
+  while( (c = getopt(argc, argv, "s:n:")) != -1 )
+    switch( c ) {
+    case 's':  table_lg2 = atoi(optarg);              break;
+    case 'n':  n_q = strtoul(optarg, NULL, 0);        break;
+    default:   usage();
+    }
+  if( table_lg2 < 16 || table_lg2 > 22 || n_q == 0 )
+    usage();
+  if( optind < argc ) {
+    n_loads = argc - optind;
+    loads = arg_loads = calloc(n_loads, sizeof(*arg_loads));
+    for( i = 0; i < n_loads; ++i )
+      if( (arg_loads[i] = atoi(argv[optind + i])) < 1 ||
+          arg_loads[i] > 99 )
+        usage();
+  }
+
+  size = 1u << table_lg2;
+  max_socks = 0;
+  for( l = 0; l < n_loads; ++l )
+    if( (ci_uint64) size * loads[l] / 100 > max_socks )
+      max_socks = (ci_uint64) size * loads[l] / 100;
+
+  /* Socket buffers follow the stack state, as they do in a real stack. */
+  memset(&ni, 0, sizeof(ni));
+  state_size = CI_ROUND_UP(sizeof(*ni.state), EP_BUF_SIZE);
+  ni.state = calloc(1, state_size + (size_t) max_socks * EP_BUF_SIZE);
+  ni.filter_table = calloc(1, sizeof(*ni.filter_table) +
+                           size * sizeof(ni.filter_table->table[0]));
+  ni.filter_table_ext = calloc(size, sizeof(ni.filter_table_ext[0]));
+  socks = calloc(max_socks, sizeof(*socks));
+  hits = calloc(n_q, sizeof(*hits));
+  misses = calloc(n_q, sizeof(*misses));
+  if( ni.state == NULL || ni.filter_table == NULL ||
+      ni.filter_table_ext == NULL || socks == NULL || hits == NULL ||
+      misses == NULL ) {
+    fprintf(stderr, "ERROR: out of memory\n");
+    return 1;
+  }
+  *(ci_uint32*) &ni.state->ep_ofs = state_size;
+  *(ci_uint32*) &ni.state->n_ep_bufs = max_socks;
+  /* The table is only changed with the stack lock held. */
+  ni.state->lock.lock = CI_EPLOCK_LOCKED;
+
+  srandom(1);
+  for( i = 0; i < max_socks; ++i ) {
+    ci_sock_cmn* s = ID_TO_SOCK(&ni, i);
+    random_tuple(&socks[i], 0);
+    s->pkt.ether_type = CI_ETHERTYPE_IP;
+    sock_raddr_be32(s) = socks[i].raddr;
+    sock_rport_be16(s) = socks[i].rport;
+    sock_protocol(s) = IPPROTO_TCP;
+    s->rx_bind2dev_ifindex = CI_IFID_BAD;
+  }
+
+  printf("# table=2^%u lookups=%u\n", table_lg2, n_q);
+  printf("#load  conns    hit_ns  miss_ns  mean_hops  max_hops\n");
+  for( l = 0; l < n_loads; ++l ) {
+    double hit_ns, miss_ns;
+
+    n_socks = (ci_uint64) size * loads[l] / 100;
+    table_init(&ni, size);
+    memset(&ni.state->stats, 0, sizeof(ni.state->stats));
+    for( i = 0; i < n_socks; ++i )
+      if( ci_netif_filter_insert(&ni, OO_SP_FROM_INT(&ni, i),
+                                 AF_SPACE_FLAG_IP4, CI_ADDR_FROM_IP4(LADDR),
+                                 LPORT, CI_ADDR_FROM_IP4(socks[i].raddr),
+                                 socks[i].rport, IPPROTO_TCP) < 0 ) {
+        fprintf(stderr, "ERROR: insert failed at %u\n", i);
+        return 1;
+      }
+    for( i = 0; i < n_q; ++i ) {
+      hits[i] = socks[random() % n_socks];
+      random_tuple(&misses[i], 1);
+    }
+
+    /* Once untimed, to fault in the page tables. */
+    bench(&ni, hits, n_q, 1);
+    hit_ns = bench(&ni, hits, n_q, 1);
+    miss_ns = bench(&ni, misses, n_q, 0);
+    printf("%4u%%  %-7u  %7.1f  %7.1f  %9u  %8u\n", loads[l], n_socks,
+           hit_ns, miss_ns, (unsigned) ni.state->stats.table_mean_hops,
+           (unsigned) ni.state->stats.table_max_hops);
+  }
+  return 0;
+}
@@ -0,0 +1,22 @@
+# SPDX-License-Identifier: BSD-2-Clause
+# SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc.
+
+TARGETS := filter_bench
+
+# The filter table is linked in directly, as in the unit tests.
+TABLE_OBJ := $(BUILDPATH)/lib/transport/ip/ci_ip_netif_table.o
+
+MMAKE_LIBS += $(LINK_CITOOLS_LIB)
+MMAKE_LIB_DEPS += $(CITOOLS_LIB_DEPEND)
+MMAKE_DIR_LINKFLAGS += -Wl,--unresolved-symbols=ignore-all
+
+all: $(TARGETS)
+
+filter_bench: filter_bench.o $(TABLE_OBJ) $(MMAKE_LIB_DEPS)
+	(libs="$(MMAKE_LIBS)"; $(MMakeLinkCApp))
+
+targets:
+	@echo $(TARGETS)
+
+clean:
+	@$(MakeClean)
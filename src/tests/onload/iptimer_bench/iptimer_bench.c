@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Cost of ci_ip_timer_poll() with a very large number of pending timers.
+ *
+ *   iptimer_bench [-n timers] [-s span] [-t ticks] [-c churn]
+ *
+ * [timers] timers (default 1M) are set at random times up to [span] ticks
+ * ahead (default 2^20, so most start in wheel 2).  The clock is then
+ * advanced one tick at a time for [ticks] ticks (default 2^18), and each
+ * ci_ip_timer_poll() is timed on its own.  Between polls [churn] random
+ * timers are moved to a new time, or set again if they have already fired,
+ * which keeps the population steady in the way that RTO and delayed-ACK
+ * timers are constantly reset by a busy stack.
+ *
+ * The run starts shortly before wheel 2 wraps, so it takes in at least one
+ * wrap of each wheel.  The worst case is what matters here: the mean is
+ * dominated by the common case of an empty bucket.
+ */
+
+#define _GNU_SOURCE
+#include <ci/internal/ip.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+
+static unsigned n_fired;
+
+/* Referenced by logging in the timer code, which is disabled here. */
+unsigned ci_tp_log;
+
+
+/* The callbacks that ci_ip_timer_poll() can dispatch to.  Only the first
+ * is used. */
+void ci_netif_timeout_state(ci_netif* ni) { ++n_fired; }
+void ci_udp_txtime_release(ci_netif* ni) {}
+void ci_tcp_timeout_rto(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_delack(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_zwin(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_kalive(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_listen(ci_netif* ni, ci_tcp_socket_listen* tls) {}
+void ci_tcp_timeout_cork(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_pacing(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_pmtu_timeout_pmtu(ci_netif* ni, ci_pmtu_state_t* pmtu) {}
+void ci_netif_stats_action(ci_netif* ni, ci_ip_stats_action_type action,
+                           ci_ip_stats_output_fmt fmt, void* data,
+                           socklen_t* size) {}
+
+
+static ci_uint64 now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+
+static int cmp_u32(const void* a, const void* b)
+{
+  ci_uint32 x = *(const ci_uint32*) a, y = *(const ci_uint32*) b;
+  return (x > y) - (x < y);
+}
+
+
+/* The scheduler part of ci_ip_timer_state_init(), which is kernel-only. */
+static void timer_state_init(ci_netif* ni, ci_iptime_t start)
+{
+  ci_ip_timer_state* ipts = IPTIMER_STATE(ni);
+  int i;
+
+  ipts->sched_ticks = ipts->ci_ip_time_real_ticks = start;
+  ipts->closest_timer = start + 2 * CI_IPTIME_BUCKETS;
+  for( i = 0; i < CI_IP_TIMER_N_FN; i++ )
+    oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &ipts->fire_list[i]));
+  for( i = 0; i < CI_IPTIME_WHEELSIZE; i++ )
+    oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &ipts->warray[i]));
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: iptimer_bench [-n timers] [-s span] [-t ticks] "
+          "[-c churn]\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  unsigned n_timers = 1u << 20, span = 1u << 20, n_ticks = 1u << 18;
+  unsigned churn = 64;
+  ci_netif ni;
+  ci_ip_timer* timers;
+  ci_uint32* cost;
+  ci_iptime_t start;
+  ci_uint64 t0, total = 0;
+  unsigned i, j;
+  int c;
+
+  while( (c = getopt(argc, argv, "n:s:t:c:")) != -1 )
+    switch( c ) {
+    case 'n':  n_timers = strtoul(optarg, NULL, 0);  break;
+    case 's':  span = strtoul(optarg, NULL, 0);      break;
+    case 't':  n_ticks = strtoul(optarg, NULL, 0);   break;
+    case 'c':  churn = strtoul(optarg, NULL, 0);     break;
+    default:   usage();
+    }
+  if( optind != argc || n_timers == 0 || span == 0 || n_ticks == 0 )
+    usage();
+
+  /* Timers live after the stack state so that they can be addressed with
+   * oo_p, as they would be in socket buffers. */
+  memset(&ni, 0, sizeof(ni));
+  ni.state = calloc(1, sizeof(*ni.state) + n_timers * sizeof(ci_ip_timer));
+  cost = malloc(n_ticks * sizeof(*cost));
+  if( ni.state == NULL || cost == NULL ) {
+    fprintf(stderr, "ERROR: out of memory\n");
+    return 1;
+  }
+  timers = (ci_ip_timer*) (ni.state + 1);
+
+  start = (1u << 24) - n_ticks / 2;
+  timer_state_init(&ni, start);
+  srandom(1);
+  for( i = 0; i < n_timers; ++i ) {
+    ci_ip_timer_init(&ni, &timers[i],
+                     oo_state_ptr_to_statep(&ni, &timers[i]), "bench");
+    timers[i].fn = CI_IP_TIMER_NETIF_TIMEOUT;
+    ci_ip_timer_set(&ni, &timers[i], start + 1 + random() % span);
+  }
+
+  for( i = 0; i < n_ticks; ++i ) {
+    ci_iptime_t now = start + i + 1;
+    for( j = 0; j < churn; ++j ) {
+      ci_ip_timer* ts = &timers[random() % n_timers];
+      ci_ip_timer_modify(&ni, ts, now + 1 + random() % span);
+    }
+    IPTIMER_STATE(&ni)->ci_ip_time_real_ticks = now;
+    t0 = now_ns();
+    ci_ip_timer_poll(&ni);
+    cost[i] = now_ns() - t0;
+    total += cost[i];
+  }
+
+  qsort(cost, n_ticks, sizeof(*cost), cmp_u32);
+  printf("# timers=%u span=%u ticks=%u churn=%u\n",
+         n_timers, span, n_ticks, churn);
+  printf("# fired=%u drained=%u cascade_max=%u\n", n_fired,
+         (unsigned) ni.state->stats.timer_drained,
+         (unsigned) ni.state->stats.timer_cascade_max);
+  printf("poll ns: mean=%.0f p50=%u p99=%u p99.9=%u max=%u\n",
+         (double) total / n_ticks, cost[n_ticks / 2],
+         cost[(ci_uint64) n_ticks * 99 / 100],
+         cost[(ci_uint64) n_ticks * 999 / 1000], cost[n_ticks - 1]);
+  return 0;
+}
@@ -0,0 +1,23 @@
+# SPDX-License-Identifier: BSD-2-Clause
+# SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc.
+
+TARGETS := iptimer_bench
+
+# The timer wheel is linked in directly, with stubs for the callbacks it
+# would dispatch to, as in the unit tests.
+IPTIMER_OBJ := $(BUILDPATH)/lib/transport/ip/ci_ip_iptimer.o
+
+MMAKE_LIBS += $(LINK_CITOOLS_LIB)
+MMAKE_LIB_DEPS += $(CITOOLS_LIB_DEPEND)
+MMAKE_DIR_LINKFLAGS += -Wl,--unresolved-symbols=ignore-all
+
+all: $(TARGETS)
+
+iptimer_bench: iptimer_bench.o $(IPTIMER_OBJ) $(MMAKE_LIB_DEPS)
+	(libs="$(MMAKE_LIBS)"; $(MMakeLinkCApp))
+
+targets:
+	@echo $(TARGETS)
+
+clean:
+	@$(MakeClean)
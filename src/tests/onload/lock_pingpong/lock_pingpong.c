@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Cost of handing a lock back and forth between two CPUs.
+ *
+ * Two threads pinned to different CPUs take turns to acquire a shared
+ * 64-bit lock word in the same way as the stack lock fast path, bump a
+ * counter that says whose turn is next, and release it.  The time per
+ * handoff is reported for the fully-ordered CAS (ci_cas64u_succeed) and for
+ * the acquire/release variants used by the lock paths.
+ *
+ *   lock_pingpong [-a cpu] [-b cpu] [-n handoffs]
+ *
+ * On x86 both variants compile to the same instruction and should give the
+ * same result.  On aarch64 the difference shows the saving from dropping
+ * the extra barriers.  In the header, "lse" says whether the cpu has the
+ * ARMv8.1 atomics and "lse_build" whether this build uses them, which it
+ * does only when compiled for ARMv8.1 or later.
+ */
+
+#define _GNU_SOURCE
+#include <ci/tools.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#define LOCKED  1ull
+
+struct shared {
+  volatile ci_uint64 lock   CI_ALIGN(CI_CACHE_LINE_SIZE);
+  volatile ci_uint64 turn   CI_ALIGN(CI_CACHE_LINE_SIZE);
+};
+
+struct worker {
+  struct shared* sh;
+  int            cpu;
+  int            me;
+  int            ordered;
+};
+
+static struct shared sh;
+static ci_uint64 n_handoffs = 10000000;
+static volatile int go;
+
+
+static double now_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void pin(int cpu)
+{
+  cpu_set_t set;
+  int rc;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if( rc != 0 ) {
+    fprintf(stderr, "ERROR: cannot pin to cpu %d (%s)\n", cpu, strerror(rc));
+    exit(1);
+  }
+}
+
+
+/* Each handoff is one lock, one counter update and one unlock, so the
+ * loops differ only in the ordering of the two CAS operations. */
+static void run_full(struct shared* s, int me)
+{
+  ci_uint64 t;
+
+  while( (t = s->turn) < n_handoffs ) {
+    if( (t & 1) != (ci_uint64) me || s->lock != 0 )
+      continue;
+    if( ! ci_cas64u_succeed(&s->lock, 0, LOCKED) )
+      continue;
+    if( s->turn == t )
+      s->turn = t + 1;
+    ci_cas64u_succeed(&s->lock, LOCKED, 0);
+  }
+}
+
+
+static void run_acq_rel(struct shared* s, int me)
+{
+  ci_uint64 t;
+
+  while( (t = s->turn) < n_handoffs ) {
+    if( (t & 1) != (ci_uint64) me || s->lock != 0 )
+      continue;
+    if( ! ci_cas64u_succeed_acquire(&s->lock, 0, LOCKED) )
+      continue;
+    if( s->turn == t )
+      s->turn = t + 1;
+    ci_cas64u_succeed_release(&s->lock, LOCKED, 0);
+  }
+}
+
+
+static void* worker_fn(void* arg)
+{
+  struct worker* w = arg;
+
+  pin(w->cpu);
+  while( ! go )
+    ci_spinloop_pause();
+  if( w->ordered )
+    run_full(w->sh, w->me);
+  else
+    run_acq_rel(w->sh, w->me);
+  return NULL;
+}
+
+
+static double bench(int cpu_a, int cpu_b, int ordered)
+{
+  struct worker wa = { &sh, cpu_a, 0, ordered };
+  struct worker wb = { &sh, cpu_b, 1, ordered };
+  pthread_t ta, tb;
+  double t0, t1;
+
+  sh.lock = 0;
+  sh.turn = 0;
+  go = 0;
+  if( pthread_create(&ta, NULL, worker_fn, &wa) != 0 ||
+      pthread_create(&tb, NULL, worker_fn, &wb) != 0 ) {
+    fprintf(stderr, "ERROR: pthread_create failed\n");
+    exit(1);
+  }
+  /* Give both threads time to migrate before starting the clock. */
+  usleep(10000);
+  t0 = now_sec();
+  go = 1;
+  pthread_join(ta, NULL);
+  pthread_join(tb, NULL);
+  t1 = now_sec();
+  return (t1 - t0) * 1e9 / n_handoffs;
+}
+
+
+static void usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-a cpu] [-b cpu] [-n handoffs]\n", prog);
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  int cpu_a = 0, cpu_b = 1;
+  int lse_build = 0;
+  int c;
+
+  while( (c = getopt(argc, argv, "a:b:n:")) != -1 )
+    switch( c ) {
+    case 'a':
+      cpu_a = atoi(optarg);
+      break;
+    case 'b':
+      cpu_b = atoi(optarg);
+      break;
+    case 'n':
+      n_handoffs = strtoull(optarg, NULL, 0);
+      break;
+    default:
+      usage(argv[0]);
+    }
+  if( optind != argc || n_handoffs == 0 || cpu_a == cpu_b )
+    usage(argv[0]);
+
+#ifdef __ARM_FEATURE_ATOMICS
+  lse_build = 1;
+#endif
+  printf("# cpus=%d,%d handoffs=%llu lse=%d lse_build=%d\n", cpu_a, cpu_b,
+         (unsigned long long) n_handoffs, ci_cpu_has_feature("lse") ? 1 : 0,
+         lse_build);
+  printf("# %-10s %12s\n", "ordering", "ns/handoff");
+  printf("  %-10s %12.1f\n", "full", bench(cpu_a, cpu_b, 1));
+  printf("  %-10s %12.1f\n", "acq_rel", bench(cpu_a, cpu_b, 0));
+  return 0;
+}
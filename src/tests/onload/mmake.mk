@@ -1,7 +1,9 @@
 # SPDX-License-Identifier: BSD-2-Clause
 # X-SPDX-Copyright-Text: (c) Copyright 2002-2020 Xilinx, Inc.
 SUBDIRS	:= wire_order tproxy_preload hwtimestamping \
-           sync_preload l3xudp_preload
+           sync_preload l3xudp_preload csum_bench \
+           sendfile_bench lock_pingpong iptimer_bench \
+           filter_bench mt_send_bench mmsg_bench
 
 ifneq ($(ONLOAD_ONLY),1)
 # These tests have dependency on kernel_compat lib,
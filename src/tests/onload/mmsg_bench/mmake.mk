@@ -0,0 +1,15 @@
+# SPDX-License-Identifier: BSD-2-Clause
+# SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc.
+
+TARGETS := mmsg_bench
+
+all: $(TARGETS)
+
+mmsg_bench: mmsg_bench.o
+	(libs="$(MMAKE_LIBS)"; $(MMakeLinkCApp))
+
+targets:
+	@echo $(TARGETS)
+
+clean:
+	@$(MakeClean)
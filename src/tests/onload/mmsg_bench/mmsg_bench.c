@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Message rate of sendmmsg()/recvmmsg() against one call per message.
+ *
+ * Run a sink on one host and the sender on another:
+ *
+ *   mmsg_bench -s [-T] [-l] [-p port] [-b batch]
+ *   mmsg_bench [-T] [-p port] [-m msg_size] [-b batch] [-d secs] host
+ *
+ * The sender sends [msg_size]-byte messages (default 64) for [secs]
+ * seconds (default 2), first with one sendmsg() per message and then with
+ * sendmmsg() of [batch] messages (default 32).  It reports messages and
+ * calls per second for each.  -T uses TCP rather than UDP.
+ *
+ * The sink receives with recvmmsg() of [batch] messages, or with one
+ * recvmsg() per message if given -l.  Once a second it reports messages
+ * per second and the mean number of messages per call.  Over TCP, a message
+ * is whatever one segment carried.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define TRY(x)                                                          \
+  do {                                                                  \
+    if( (x) < 0 ) {                                                     \
+      fprintf(stderr, "ERROR: %s failed at %s:%d (errno=%d %s)\n",      \
+              #x, __FILE__, __LINE__, errno, strerror(errno));          \
+      exit(1);                                                          \
+    }                                                                   \
+  } while( 0 )
+
+#define MAX_BATCH 1024
+#define MAX_MSG   65000
+
+static const char* port = "8125";
+static unsigned msg_size = 64;
+static unsigned batch = 32;
+static double duration = 2;
+static int tcp;
+
+static struct mmsghdr msgs[MAX_BATCH];
+static struct iovec iovs[MAX_BATCH];
+
+
+static double now_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void init_msgs(unsigned len)
+{
+  unsigned i;
+
+  for( i = 0; i < batch; ++i ) {
+    iovs[i].iov_base = calloc(1, len);
+    iovs[i].iov_len = len;
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+}
+
+
+static void do_sink(int loop)
+{
+  struct addrinfo hints = { .ai_flags = AI_PASSIVE,
+                            .ai_socktype = tcp ? SOCK_STREAM : SOCK_DGRAM };
+  struct addrinfo* ai;
+  uint64_t n_msgs = 0, n_calls = 0;
+  double t0, t;
+  int one = 1;
+  int sock, rc;
+
+  if( getaddrinfo(NULL, port, &hints, &ai) != 0 ) {
+    fprintf(stderr, "ERROR: bad port '%s'\n", port);
+    exit(1);
+  }
+  TRY(sock = socket(ai->ai_family, ai->ai_socktype, 0));
+  TRY(setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)));
+  TRY(bind(sock, ai->ai_addr, ai->ai_addrlen));
+  freeaddrinfo(ai);
+  if( tcp ) {
+    int lsock = sock;
+    TRY(listen(lsock, 1));
+    TRY(sock = accept(lsock, NULL, NULL));
+    close(lsock);
+  }
+
+  init_msgs(MAX_MSG);
+  printf("# %s %s batch=%u\n", tcp ? "tcp" : "udp",
+         loop ? "recvmsg" : "recvmmsg", loop ? 1 : batch);
+  printf("# %12s %10s\n", "msgs/s", "msgs/call");
+  t0 = now_sec();
+  while( 1 ) {
+    if( loop ) {
+      TRY(rc = recvmsg(sock, &msgs[0].msg_hdr, 0));
+      rc = rc > 0;
+    }
+    else {
+      TRY(rc = recvmmsg(sock, msgs, batch, MSG_WAITFORONE, NULL));
+      if( tcp && rc == 1 && msgs[0].msg_len == 0 )
+        rc = 0;
+    }
+    if( rc == 0 && tcp )
+      break;
+    n_msgs += rc;
+    ++n_calls;
+    if( (t = now_sec() - t0) >= 1 ) {
+      printf("  %12.0f %10.2f\n", n_msgs / t, (double) n_msgs / n_calls);
+      fflush(stdout);
+      n_msgs = n_calls = 0;
+      t0 += t;
+    }
+  }
+  close(sock);
+}
+
+
+static void run(int sock, int use_mmsg)
+{
+  uint64_t n_msgs = 0, n_calls = 0;
+  double t0, t, end;
+  int rc;
+
+  t0 = now_sec();
+  end = t0 + duration;
+  do {
+    /* Check the clock every so often rather than on every call. */
+    int i;
+    for( i = 0; i < 64; ++i ) {
+      if( use_mmsg ) {
+        rc = sendmmsg(sock, msgs, batch, 0);
+      }
+      else {
+        rc = sendmsg(sock, &msgs[0].msg_hdr, 0);
+        rc = rc >= 0;
+      }
+      if( rc < 0 && errno != EAGAIN && errno != ENOBUFS ) {
+        fprintf(stderr, "ERROR: send failed (errno=%d %s)\n", errno,
+                strerror(errno));
+        exit(1);
+      }
+      if( rc > 0 )
+        n_msgs += rc;
+      ++n_calls;
+    }
+  } while( now_sec() < end );
+  t = now_sec() - t0;
+
+  printf("  %-8s %5u %12.0f %12.0f\n", use_mmsg ? "sendmmsg" : "sendmsg",
+         use_mmsg ? batch : 1, n_msgs / t, n_calls / t);
+  fflush(stdout);
+}
+
+
+static void do_send(const char* host)
+{
+  struct addrinfo hints = { .ai_socktype = tcp ? SOCK_STREAM : SOCK_DGRAM };
+  struct addrinfo* ai;
+  int sock, one = 1;
+
+  if( getaddrinfo(host, port, &hints, &ai) != 0 ) {
+    fprintf(stderr, "ERROR: cannot resolve '%s'\n", host);
+    exit(1);
+  }
+  TRY(sock = socket(ai->ai_family, ai->ai_socktype, 0));
+  if( tcp )
+    TRY(setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)));
+  TRY(connect(sock, ai->ai_addr, ai->ai_addrlen));
+  freeaddrinfo(ai);
+
+  init_msgs(msg_size);
+  printf("# %s msg_size=%u secs=%.1f\n", tcp ? "tcp" : "udp", msg_size,
+         duration);
+  printf("# %-8s %5s %12s %12s\n", "call", "batch", "msgs/s", "calls/s");
+  run(sock, 0);
+  run(sock, 1);
+  close(sock);
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage:\n"
+          "  mmsg_bench -s [-T] [-l] [-p port] [-b batch]\n"
+          "  mmsg_bench [-T] [-p port] [-m msg_size] [-b batch] [-d secs] "
+          "host\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  int c, sink = 0, loop = 0;
+
+  while( (c = getopt(argc, argv, "sTlp:m:b:d:")) != -1 )
+    switch( c ) {
+    case 's':
+      sink = 1;
+      break;
+    case 'T':
+      tcp = 1;
+      break;
+    case 'l':
+      loop = 1;
+      break;
+    case 'p':
+      port = optarg;
+      break;
+    case 'm':
+      msg_size = atoi(optarg);
+      if( msg_size == 0 || msg_size > MAX_MSG )
+        usage();
+      break;
+    case 'b':
+      batch = atoi(optarg);
+      if( batch == 0 || batch > MAX_BATCH )
+        usage();
+      break;
+    case 'd':
+      duration = atof(optarg);
+      if( duration <= 0 )
+        usage();
+      break;
+    default:
+      usage();
+    }
+
+  if( sink ) {
+    if( optind != argc )
+      usage();
+    do_sink(loop);
+  }
+  else {
+    if( optind != argc - 1 || loop )
+      usage();
+    do_send(argv[optind]);
+  }
+  return 0;
+}
@@ -0,0 +1,253 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Scaling of TCP send() from many threads sharing one stack.
+ *
+ * Run a sink on one host and the sender on another:
+ *
+ *   mt_send_bench -s [-p port]
+ *   mt_send_bench [-p port] [-m msg_size] [-d secs] [-t threads,...] host
+ *
+ * For each thread count (default 1, 2, 4, 8, 16 and 32) the sender opens
+ * that many connections to the sink.  It then runs one thread per
+ * connection, each sending [msg_size]-byte messages (default 64) as fast as
+ * it can for [secs] seconds (default 2).  It reports the total and
+ * per-thread message rates.
+ *
+ * Under Onload all the connections are in the same stack, so the threads
+ * contend for the stack lock.  A thread that finds the stack locked hands
+ * its packets to the lock holder.  The defer_ring_queued, defer_ring_full
+ * and deferred_work counters in "onload_stackdump lots" show how that
+ * hand-off went.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define TRY(x)                                                          \
+  do {                                                                  \
+    if( (x) < 0 ) {                                                     \
+      fprintf(stderr, "ERROR: %s failed at %s:%d (errno=%d %s)\n",      \
+              #x, __FILE__, __LINE__, errno, strerror(errno));          \
+      exit(1);                                                          \
+    }                                                                   \
+  } while( 0 )
+
+#define MAX_THREADS 256
+
+static const char* port = "8124";
+static unsigned msg_size = 64;
+static double duration = 2;
+
+struct sender {
+  pthread_t  thread;
+  int        sock;
+  uint64_t   n_msgs;
+};
+
+static volatile int go, stop;
+
+
+static double now_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/* Accept any number of connections and discard whatever arrives. */
+static void do_sink(void)
+{
+  struct addrinfo hints = { .ai_flags = AI_PASSIVE,
+                            .ai_socktype = SOCK_STREAM };
+  struct addrinfo* ai;
+  struct epoll_event ev, evs[64];
+  static char buf[1 << 16];
+  int one = 1;
+  int lsock, ep, i, n;
+
+  if( getaddrinfo(NULL, port, &hints, &ai) != 0 ) {
+    fprintf(stderr, "ERROR: bad port '%s'\n", port);
+    exit(1);
+  }
+  TRY(lsock = socket(ai->ai_family, SOCK_STREAM, 0));
+  TRY(setsockopt(lsock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)));
+  TRY(bind(lsock, ai->ai_addr, ai->ai_addrlen));
+  TRY(listen(lsock, MAX_THREADS));
+  freeaddrinfo(ai);
+
+  TRY(ep = epoll_create1(0));
+  ev.events = EPOLLIN;
+  ev.data.fd = lsock;
+  TRY(epoll_ctl(ep, EPOLL_CTL_ADD, lsock, &ev));
+
+  while( 1 ) {
+    TRY(n = epoll_wait(ep, evs, 64, -1));
+    for( i = 0; i < n; ++i ) {
+      int fd = evs[i].data.fd;
+      if( fd == lsock ) {
+        TRY(fd = accept(lsock, NULL, NULL));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        TRY(epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev));
+      }
+      else {
+        ssize_t rc = read(fd, buf, sizeof(buf));
+        if( rc <= 0 )
+          close(fd);
+      }
+    }
+  }
+}
+
+
+static void* sender_fn(void* arg)
+{
+  struct sender* s = arg;
+  char* msg = calloc(1, msg_size);
+  uint64_t n = 0;
+
+  while( ! go )
+    ;
+  while( ! stop ) {
+    TRY(send(s->sock, msg, msg_size, 0));
+    ++n;
+  }
+  s->n_msgs = n;
+  free(msg);
+  return NULL;
+}
+
+
+static void run(struct addrinfo* ai, int n_threads)
+{
+  struct sender s[MAX_THREADS];
+  uint64_t total = 0;
+  double t0, t;
+  int i, one = 1;
+
+  for( i = 0; i < n_threads; ++i ) {
+    TRY(s[i].sock = socket(ai->ai_family, SOCK_STREAM, 0));
+    TRY(setsockopt(s[i].sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)));
+    TRY(connect(s[i].sock, ai->ai_addr, ai->ai_addrlen));
+    s[i].n_msgs = 0;
+  }
+  go = stop = 0;
+  for( i = 0; i < n_threads; ++i )
+    if( pthread_create(&s[i].thread, NULL, sender_fn, &s[i]) != 0 ) {
+      fprintf(stderr, "ERROR: pthread_create failed\n");
+      exit(1);
+    }
+
+  t0 = now_sec();
+  go = 1;
+  usleep(duration * 1e6);
+  stop = 1;
+  for( i = 0; i < n_threads; ++i ) {
+    pthread_join(s[i].thread, NULL);
+    total += s[i].n_msgs;
+  }
+  t = now_sec() - t0;
+  for( i = 0; i < n_threads; ++i )
+    close(s[i].sock);
+
+  printf("  %7d %12.0f %12.0f %10.1f\n", n_threads, total / t,
+         total / t / n_threads, total * msg_size / t / 1e6);
+  fflush(stdout);
+}
+
+
+static void do_send(const char* host, const char* threads)
+{
+  struct addrinfo hints = { .ai_socktype = SOCK_STREAM };
+  struct addrinfo* ai;
+  char* list = strdup(threads);
+  char* tok;
+
+  if( getaddrinfo(host, port, &hints, &ai) != 0 ) {
+    fprintf(stderr, "ERROR: cannot resolve '%s'\n", host);
+    exit(1);
+  }
+
+  printf("# msg_size=%u secs=%.1f\n", msg_size, duration);
+  printf("# %7s %12s %12s %10s\n", "threads", "msgs/s", "msgs/s/thr",
+         "MB/s");
+  for( tok = strtok(list, ","); tok != NULL; tok = strtok(NULL, ",") ) {
+    int n = atoi(tok);
+    if( n < 1 || n > MAX_THREADS ) {
+      fprintf(stderr, "ERROR: bad thread count '%s'\n", tok);
+      exit(1);
+    }
+    run(ai, n);
+  }
+  freeaddrinfo(ai);
+  free(list);
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage:\n"
+          "  mt_send_bench -s [-p port]\n"
+          "  mt_send_bench [-p port] [-m msg_size] [-d secs] "
+          "[-t threads,...] host\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  const char* threads = "1,2,4,8,16,32";
+  int c, sink = 0;
+
+  while( (c = getopt(argc, argv, "sp:m:d:t:")) != -1 )
+    switch( c ) {
+    case 's':
+      sink = 1;
+      break;
+    case 'p':
+      port = optarg;
+      break;
+    case 'm':
+      msg_size = atoi(optarg);
+      if( msg_size == 0 )
+        usage();
+      break;
+    case 'd':
+      duration = atof(optarg);
+      if( duration <= 0 )
+        usage();
+      break;
+    case 't':
+      threads = optarg;
+      break;
+    default:
+      usage();
+    }
+
+  if( sink ) {
+    if( optind != argc )
+      usage();
+    do_sink();
+  }
+  else {
+    if( optind != argc - 1 )
+      usage();
+    do_send(argv[optind], threads);
+  }
+  return 0;
+}
@@ -0,0 +1,276 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Throughput of sendfile() to a TCP socket for files from 1MB to 1GB.
+ *
+ * Run a sink on one host and the sender on another:
+ *
+ *   sendfile_bench -s [-p port]
+ *   sendfile_bench [-p port] [-d dir] [-m sendfile|copy] [-n iters] host
+ *
+ * The sender creates a file of each size in [dir], reads it once so that it
+ * is in the page cache, then sends it [iters] times and reports MB/s.  Each
+ * transfer is timed from the first byte sent until the sink confirms it has
+ * received the whole file.  "-m copy" uses read() and send() through a user
+ * buffer for reference.
+ *
+ * To compare against kernel sendfile(), run the sender without Onload, then
+ * under Onload with EF_TCP_SENDFILE=0 (the kernel sendpage() path) and
+ * EF_TCP_SENDFILE=1 (the user-level path).
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define TRY(x)                                                          \
+  do {                                                                  \
+    if( (x) < 0 ) {                                                     \
+      fprintf(stderr, "ERROR: %s failed at %s:%d (errno=%d %s)\n",      \
+              #x, __FILE__, __LINE__, errno, strerror(errno));          \
+      exit(1);                                                          \
+    }                                                                   \
+  } while( 0 )
+
+#define MB (1024ull * 1024ull)
+
+static const uint64_t sizes[] = {
+  1 * MB, 4 * MB, 16 * MB, 64 * MB, 256 * MB, 1024 * MB,
+};
+#define N_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+static const char* port = "8123";
+static const char* dir = "/tmp";
+static int use_copy;
+static int iters = 5;
+
+static char buf[1 << 20];
+
+
+static double now_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void read_all(int fd, void* p, size_t len)
+{
+  ssize_t rc;
+  while( len > 0 ) {
+    TRY(rc = read(fd, p, len));
+    if( rc == 0 ) {
+      fprintf(stderr, "ERROR: unexpected EOF\n");
+      exit(1);
+    }
+    p = (char*) p + rc;
+    len -= rc;
+  }
+}
+
+
+static void write_all(int fd, const void* p, size_t len)
+{
+  ssize_t rc;
+  while( len > 0 ) {
+    TRY(rc = write(fd, p, len));
+    p = (const char*) p + rc;
+    len -= rc;
+  }
+}
+
+
+/* Each transfer is an 8-byte length followed by the data; the sink answers
+ * with a single byte once it has it all.  A zero length ends the session.
+ */
+static void do_sink(void)
+{
+  struct addrinfo hints = { .ai_flags = AI_PASSIVE,
+                            .ai_socktype = SOCK_STREAM };
+  struct addrinfo* ai;
+  int one = 1;
+  int lsock, sock;
+
+  if( getaddrinfo(NULL, port, &hints, &ai) != 0 ) {
+    fprintf(stderr, "ERROR: bad port '%s'\n", port);
+    exit(1);
+  }
+  TRY(lsock = socket(ai->ai_family, SOCK_STREAM, 0));
+  TRY(setsockopt(lsock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)));
+  TRY(bind(lsock, ai->ai_addr, ai->ai_addrlen));
+  TRY(listen(lsock, 1));
+  freeaddrinfo(ai);
+
+  while( 1 ) {
+    uint64_t len;
+    TRY(sock = accept(lsock, NULL, NULL));
+    while( 1 ) {
+      char ack = 0;
+      read_all(sock, &len, sizeof(len));
+      if( len == 0 )
+        break;
+      while( len > 0 ) {
+        ssize_t rc;
+        TRY(rc = read(sock, buf, len < sizeof(buf) ? len : sizeof(buf)));
+        if( rc == 0 )
+          break;
+        len -= rc;
+      }
+      write_all(sock, &ack, 1);
+    }
+    close(sock);
+  }
+}
+
+
+static int make_file(uint64_t size)
+{
+  char path[4096];
+  uint64_t done;
+  int fd;
+
+  snprintf(path, sizeof(path), "%s/sendfile_bench.XXXXXX", dir);
+  TRY(fd = mkstemp(path));
+  TRY(unlink(path));
+  memset(buf, 0xa5, sizeof(buf));
+  for( done = 0; done < size; done += sizeof(buf) )
+    write_all(fd, buf, sizeof(buf));
+  /* Read it back so every run is served from the page cache. */
+  TRY(lseek(fd, 0, SEEK_SET));
+  for( done = 0; done < size; done += sizeof(buf) )
+    read_all(fd, buf, sizeof(buf));
+  return fd;
+}
+
+
+static void send_file(int sock, int fd, uint64_t size)
+{
+  off_t off = 0;
+  ssize_t rc;
+
+  if( ! use_copy ) {
+    while( (uint64_t) off < size )
+      TRY(rc = sendfile(sock, fd, &off, size - off));
+    return;
+  }
+
+  TRY(lseek(fd, 0, SEEK_SET));
+  while( (uint64_t) off < size ) {
+    TRY(rc = read(fd, buf, sizeof(buf)));
+    write_all(sock, buf, rc);
+    off += rc;
+  }
+}
+
+
+static void do_send(const char* host)
+{
+  struct addrinfo hints = { .ai_socktype = SOCK_STREAM };
+  struct addrinfo* ai;
+  uint64_t zero = 0;
+  unsigned i;
+  int sock, it;
+
+  if( getaddrinfo(host, port, &hints, &ai) != 0 ) {
+    fprintf(stderr, "ERROR: cannot resolve '%s'\n", host);
+    exit(1);
+  }
+  TRY(sock = socket(ai->ai_family, SOCK_STREAM, 0));
+  TRY(connect(sock, ai->ai_addr, ai->ai_addrlen));
+  freeaddrinfo(ai);
+
+  printf("# mode=%s iters=%d\n", use_copy ? "copy" : "sendfile", iters);
+  printf("# %10s %10s %10s\n", "size_MB", "MB/s", "best_MB/s");
+  for( i = 0; i < N_SIZES; ++i ) {
+    uint64_t size = sizes[i];
+    double total = 0, best = 0;
+    int fd = make_file(size);
+
+    for( it = 0; it < iters; ++it ) {
+      double t0, t;
+      char ack;
+
+      t0 = now_sec();
+      write_all(sock, &size, sizeof(size));
+      send_file(sock, fd, size);
+      read_all(sock, &ack, 1);
+      t = now_sec() - t0;
+      total += t;
+      if( best == 0 || t < best )
+        best = t;
+    }
+    printf("  %10llu %10.1f %10.1f\n", (unsigned long long) (size / MB),
+           size * iters / total / MB, size / best / MB);
+    fflush(stdout);
+    close(fd);
+  }
+  write_all(sock, &zero, sizeof(zero));
+  close(sock);
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage:\n"
+          "  sendfile_bench -s [-p port]\n"
+          "  sendfile_bench [-p port] [-d dir] [-m sendfile|copy] "
+          "[-n iters] host\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  int c, sink = 0;
+
+  while( (c = getopt(argc, argv, "sp:d:m:n:")) != -1 )
+    switch( c ) {
+    case 's':
+      sink = 1;
+      break;
+    case 'p':
+      port = optarg;
+      break;
+    case 'd':
+      dir = optarg;
+      break;
+    case 'm':
+      if( ! strcmp(optarg, "copy") )
+        use_copy = 1;
+      else if( strcmp(optarg, "sendfile") )
+        usage();
+      break;
+    case 'n':
+      iters = atoi(optarg);
+      if( iters <= 0 )
+        usage();
+      break;
+    default:
+      usage();
+    }
+
+  if( sink ) {
+    if( optind != argc )
+      usage();
+    do_sink();
+  }
+  else {
+    if( optind != argc - 1 )
+      usage();
+    do_send(argv[optind]);
+  }
+  return 0;
+}
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Functions under test */
+#include <ci/internal/transport_config_opt.h>
+#include <ci/tools.h>
+#include <ci/tools/utils.h>
+
+#if defined(__aarch64__)
+#include <sys/auxv.h>
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#endif
+
+/* Test infrastructure */
+#include "unit_test.h"
+
+/* The keys used by __ci_netif_active_wild_hash() */
+static const ci_uint8 rx_hash_key[40] = {
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+
+__attribute__((aligned(sizeof(ci_uint32))))
+static const ci_uint8 rx_hash_key_sse[40] = {
+  0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c,
+  0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c,
+  0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c,
+  0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c,
+  0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c, 0xb5, 0x6c,
+};
+
+#define N_TUPLES 1024
+#define IP4_TUPLE 12
+#define IP6_TUPLE 36
+
+/* Only the low byte of the accelerated hash is accurate */
+#define HASH_MASK 0xff
+
+/* The library's feature check is not linked into unit tests */
+int ci_cpu_has_feature(char* feature)
+{
+#if defined(__x86_64__)
+  if( ! strcmp(feature, "pclmul") )
+    return __builtin_cpu_supports("pclmul");
+#elif defined(__aarch64__)
+  if( ! strcmp(feature, "pmull") )
+    return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#endif
+  return 0;
+}
+
+static void fill_tuples(ci_uint32* words, int n_words)
+{
+  int i;
+
+  srandom(0x70e9117);
+  for( i = 0; i < n_words; ++i )
+    words[i] = random() ^ (random() << 16);
+}
+
+static void check_size(int size)
+{
+  static ci_uint32 words[N_TUPLES * IP6_TUPLE / 4];
+  const ci_uint8* tuples = (const ci_uint8*) words;
+  int i;
+
+  fill_tuples(words, N_TUPLES * size / 4);
+
+  for( i = 0; i < N_TUPLES; ++i ) {
+    const ci_uint8* tuple = tuples + i * size;
+    CHECK(ci_toeplitz_hash_ul(rx_hash_key, rx_hash_key_sse, tuple, size) &
+          HASH_MASK, ==,
+          ci_toeplitz_hash(rx_hash_key, tuple, size) & HASH_MASK);
+  }
+}
+
+static void test_toeplitz_ip4(void)
+{
+  check_size(IP4_TUPLE);
+}
+
+#if CI_CFG_IPV6
+static void test_toeplitz_ip6(void)
+{
+  check_size(IP6_TUPLE);
+}
+#endif
+
+int main(void)
+{
+  TEST_RUN(test_toeplitz_ip4);
+#if CI_CFG_IPV6
+  TEST_RUN(test_toeplitz_ip6);
+#endif
+  TEST_END();
+}
@@ -0,0 +1,239 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Functions under test */
+#include <ci/internal/ip.h>
+
+/* Test infrastructure */
+#include "unit_test.h"
+
+/* Timers live after the stack state so that they can be addressed with
+ * oo_p, as they would be in socket buffers. */
+struct timer_netif {
+  ci_netif     ni;
+  ci_ip_timer* timers;
+  int          n_timers;
+};
+
+/* Expirations seen by the callbacks, by tick relative to [t0] */
+static ci_iptime_t t0;
+static unsigned* fired;
+static unsigned n_fired_ticks;
+static int last_fn;
+static int order_ok;
+
+static void record(ci_netif* ni, int fn)
+{
+  ci_iptime_t rel = IPTIMER_STATE(ni)->sched_ticks - t0;
+  if( rel < n_fired_ticks )
+    ++fired[rel];
+  if( fn < last_fn )
+    order_ok = 0;
+  last_fn = fn;
+}
+
+/* Callbacks of the timer kinds used here */
+void ci_netif_timeout_state(ci_netif* ni)
+{
+  record(ni, CI_IP_TIMER_NETIF_TIMEOUT);
+}
+
+void ci_udp_txtime_release(ci_netif* ni)
+{
+  record(ni, CI_IP_TIMER_UDP_TXTIME);
+}
+
+/* Other callbacks referenced by the dispatcher, not used here */
+void ci_tcp_timeout_rto(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_delack(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_zwin(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_kalive(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_listen(ci_netif* ni, ci_tcp_socket_listen* tls) {}
+void ci_tcp_timeout_cork(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_tcp_timeout_pacing(ci_netif* ni, ci_tcp_state* ts) {}
+void ci_pmtu_timeout_pmtu(ci_netif* ni, ci_pmtu_state_t* pmtu) {}
+void ci_netif_stats_action(ci_netif* ni, ci_ip_stats_action_type action,
+                           ci_ip_stats_output_fmt fmt, void* data,
+                           socklen_t* size) {}
+
+/* The scheduler part of ci_ip_timer_state_init(), which is kernel-only.
+ * Start away from a wheel boundary so that wraps happen mid-test. */
+static void timer_state_init(ci_netif* ni)
+{
+  ci_ip_timer_state* ipts = IPTIMER_STATE(ni);
+  int i;
+
+  ipts->sched_ticks = ipts->ci_ip_time_real_ticks = 0x12345678;
+  ipts->closest_timer = ipts->sched_ticks + 2 * CI_IPTIME_BUCKETS;
+  for( i = 0; i < CI_IP_TIMER_N_FN; i++ )
+    oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &ipts->fire_list[i]));
+  for( i = 0; i < CI_IPTIME_WHEELSIZE; i++ )
+    oo_p_dllink_init(ni, oo_p_dllink_ptr(ni, &ipts->warray[i]));
+}
+
+static struct timer_netif* alloc_netif(int n_timers)
+{
+  struct timer_netif* tn = calloc(1, sizeof(*tn));
+  ci_netif* ni = &tn->ni;
+  int i;
+
+  ni->state = calloc(1, sizeof(*ni->state) + n_timers * sizeof(ci_ip_timer));
+  tn->timers = (ci_ip_timer*) (ni->state + 1);
+  tn->n_timers = n_timers;
+  timer_state_init(ni);
+  t0 = IPTIMER_STATE(ni)->sched_ticks;
+  for( i = 0; i < n_timers; ++i ) {
+    ci_ip_timer_init(ni, &tn->timers[i],
+                     oo_state_ptr_to_statep(ni, &tn->timers[i]), "test");
+    tn->timers[i].fn = CI_IP_TIMER_NETIF_TIMEOUT;
+  }
+  return tn;
+}
+
+static void free_netif(struct timer_netif* tn)
+{
+  free(tn->ni.state);
+  free(tn);
+}
+
+static void reset_fired(unsigned n_ticks)
+{
+  free(fired);
+  fired = calloc(n_ticks, sizeof(*fired));
+  n_fired_ticks = n_ticks;
+}
+
+static void advance(ci_netif* ni, ci_iptime_t ticks)
+{
+  IPTIMER_STATE(ni)->ci_ip_time_real_ticks += ticks;
+  ci_ip_timer_poll(ni);
+}
+
+/* The earliest pending timer must never be before closest_timer, or the
+ * periodic timer would wake up too late. */
+static void check_closest(struct timer_netif* tn)
+{
+  ci_ip_timer_state* ipts = IPTIMER_STATE(&tn->ni);
+  int i;
+
+  for( i = 0; i < tn->n_timers; ++i )
+    if( ci_ip_timer_pending(&tn->ni, &tn->timers[i]) &&
+        TIME_LT(tn->timers[i].time, ipts->closest_timer) ) {
+      CHECK(tn->timers[i].time - ipts->sched_ticks, >=,
+            ipts->closest_timer - ipts->sched_ticks);
+      return;
+    }
+}
+
+/* Set timers at random times across all the wheels, move or cancel some,
+ * and check that each tick fires exactly the ones due at it. */
+static void test_expiry(void)
+{
+  enum { N = 20000, SPAN = 1 << 18 };
+  struct timer_netif* tn = alloc_netif(N);
+  ci_netif* ni = &tn->ni;
+  unsigned* expect = calloc(SPAN + 1, sizeof(*expect));
+  ci_iptime_t now;
+  int i;
+
+  reset_fired(SPAN + 1);
+  srandom(1);
+  for( i = 0; i < N; ++i ) {
+    ci_iptime_t t = t0 + 1 + random() % SPAN;
+    ci_ip_timer_set(ni, &tn->timers[i], t);
+  }
+  /* Move some timers and cancel others */
+  for( i = 0; i < N; i += 3 )
+    ci_ip_timer_modify(ni, &tn->timers[i], t0 + 1 + random() % SPAN);
+  for( i = 1; i < N; i += 7 )
+    ci_ip_timer_clear(ni, &tn->timers[i]);
+  for( i = 0; i < N; ++i )
+    if( ci_ip_timer_pending(ni, &tn->timers[i]) )
+      ++expect[tn->timers[i].time - t0];
+
+  now = t0;
+  while( now - t0 < SPAN ) {
+    ci_iptime_t step = 1 + random() % 700;
+    if( now - t0 + step > SPAN )
+      step = SPAN - (now - t0);
+    advance(ni, step);
+    now += step;
+    CHECK(IPTIMER_STATE(ni)->sched_ticks, ==, now);
+    /* Everything due has fired and nothing else has */
+    for( i = 0; i < N; i += 97 )
+      if( ci_ip_timer_pending(ni, &tn->timers[i]) )
+        CHECK_TRUE(TIME_GT(tn->timers[i].time, now));
+    check_closest(tn);
+  }
+  for( i = 0; i < N; ++i )
+    CHECK_FALSE(ci_ip_timer_pending(ni, &tn->timers[i]));
+  CHECK_MEM(fired, expect, (SPAN + 1) * sizeof(*expect));
+
+  free(expect);
+  free_netif(tn);
+}
+
+/* Timers for the next revolution of a wheel are moved down a few at a time
+ * rather than all when the wheel wraps. */
+static void test_drain(void)
+{
+  enum { N = 30000, REV1 = 1 << 16 };
+  struct timer_netif* tn = alloc_netif(N);
+  ci_netif* ni = &tn->ni;
+  ci_iptime_t start, now;
+  int i;
+
+  /* Start at the beginning of a revolution of wheel 1, with every timer
+   * due two revolutions later, so they start off in wheel 2. */
+  start = ((t0 >> 16) + 1) << 16;
+  advance(ni, start - t0);
+  reset_fired(1);
+  for( i = 0; i < N; ++i )
+    ci_ip_timer_set(ni, &tn->timers[i], start + 2 * REV1 + random() % REV1);
+  ni->state->stats.timer_drained = 0;
+  ni->state->stats.timer_cascade_max = 0;
+
+  for( now = start; now - start < 3 * REV1; ++now )
+    advance(ni, 1);
+
+  for( i = 0; i < N; ++i )
+    CHECK_FALSE(ci_ip_timer_pending(ni, &tn->timers[i]));
+  /* Each timer went from wheel 2 to 1 and then from 1 to 0 ahead of time,
+   * so nothing was left to move when the wheels wrapped. */
+  CHECK(ni->state->stats.timer_drained, ==, 2 * N);
+  CHECK(ni->state->stats.timer_cascade_max, ==, 0);
+
+  free_netif(tn);
+}
+
+/* Timers due at the same tick run grouped by kind. */
+static void test_grouping(void)
+{
+  enum { N = 64 };
+  struct timer_netif* tn = alloc_netif(N);
+  ci_netif* ni = &tn->ni;
+  int i;
+
+  reset_fired(4);
+  for( i = 0; i < N; ++i ) {
+    tn->timers[i].fn = (i & 1) ? CI_IP_TIMER_UDP_TXTIME :
+                                 CI_IP_TIMER_NETIF_TIMEOUT;
+    ci_ip_timer_set(ni, &tn->timers[i], t0 + 2);
+  }
+  last_fn = 0;
+  order_ok = 1;
+  advance(ni, 3);
+  CHECK(fired[2], ==, N);
+  CHECK_TRUE(order_ok);
+
+  free_netif(tn);
+}
+
+int main(void)
+{
+  TEST_RUN(test_expiry);
+  TEST_RUN(test_drain);
+  TEST_RUN(test_grouping);
+  free(fired);
+  TEST_END();
+}
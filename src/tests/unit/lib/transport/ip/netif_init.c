@@ -28,6 +28,8 @@ ssize_t (*ci_sys_read)(int, void*, size_t);
 int (*ci_sys_socket)(int, int, int);
 int (*ci_sys_execvpe)(const char *, char *const [], char *const []);
 
+void ci_netif_rx_adapt_init(ci_netif* ni, int intf_i) {}
+
 /* Parametrised test case */
 static void test_ci_netif_set_rxq_limit_(
     int rxq_limit, int rxq_min, int max_rx_packets, int nic_n, int vi_cap,
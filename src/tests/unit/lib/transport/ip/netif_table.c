@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Functions under test */
+#include <ci/internal/ip.h>
+
+/* Test infrastructure */
+#include "unit_test.h"
+
+/* Lookups assume a table of at least 2^16 entries.  Fill it to 75%, so that
+ * plenty of entries are away from their preferred slot. */
+#define TABLE_LG2  16
+#define TABLE_SIZE (1u << TABLE_LG2)
+#define N_SOCKS    (TABLE_SIZE * 3 / 4)
+
+#define LADDR  CI_BSWAP_BE32(0x0a000001)
+#define LPORT  CI_BSWAP_BE16(80)
+
+/* The tag bits of __id_and_state, as laid out in netif_table.c */
+#define TAG_LSB (1u << 22)
+
+/* Referenced by logging in the table code, which is disabled here. */
+const char* ip_addr_str(unsigned addr_be32) { return ""; }
+
+static ci_netif* alloc_netif(void)
+{
+  ci_netif* ni = calloc(1, sizeof(*ni));
+  size_t state_size = CI_ROUND_UP(sizeof(*ni->state), EP_BUF_SIZE);
+  unsigned i;
+
+  /* Socket buffers follow the stack state, as they do in a real stack. */
+  ni->state = calloc(1, state_size + (size_t) N_SOCKS * EP_BUF_SIZE);
+  *(ci_uint32*) &ni->state->ep_ofs = state_size;
+  *(ci_uint32*) &ni->state->n_ep_bufs = N_SOCKS;
+  ni->state->lock.lock = CI_EPLOCK_LOCKED;
+
+  /* An empty table, as ci_netif_filter_init() makes it */
+  ni->filter_table = calloc(1, sizeof(*ni->filter_table) +
+                            TABLE_SIZE * sizeof(ni->filter_table->table[0]));
+  ni->filter_table_ext = calloc(TABLE_SIZE, sizeof(ni->filter_table_ext[0]));
+  *(unsigned*) &ni->filter_table->table_size_mask = TABLE_SIZE - 1;
+  for( i = 0; i < TABLE_SIZE; ++i )
+    ni->filter_table->table[i].__id_and_state = 2u << 30;  /* EMPTY */
+
+  srandom(1);
+  for( i = 0; i < N_SOCKS; ++i ) {
+    ci_sock_cmn* s = ID_TO_SOCK(ni, i);
+    s->pkt.ether_type = CI_ETHERTYPE_IP;
+    /* Distinct remote endpoints: the id in the port, random addresses */
+    sock_raddr_be32(s) = CI_BSWAP_BE32(0x0a800000 | (random() & 0x7fffff));
+    sock_rport_be16(s) = CI_BSWAP_BE16(i);
+    sock_protocol(s) = IPPROTO_TCP;
+    s->rx_bind2dev_ifindex = CI_IFID_BAD;
+  }
+  return ni;
+}
+
+static void free_netif(ci_netif* ni)
+{
+  free(ni->filter_table_ext);
+  free(ni->filter_table);
+  free(ni->state);
+  free(ni);
+}
+
+static int insert(ci_netif* ni, unsigned id)
+{
+  ci_sock_cmn* s = ID_TO_SOCK(ni, id);
+  return ci_netif_filter_insert(ni, OO_SP_FROM_INT(ni, id), AF_SPACE_FLAG_IP4,
+                                CI_ADDR_FROM_IP4(LADDR), LPORT,
+                                CI_ADDR_FROM_IP4(sock_raddr_be32(s)),
+                                sock_rport_be16(s), IPPROTO_TCP);
+}
+
+static void remove_sock(ci_netif* ni, unsigned id)
+{
+  ci_sock_cmn* s = ID_TO_SOCK(ni, id);
+  ci_netif_filter_remove(ni, OO_SP_FROM_INT(ni, id), AF_SPACE_FLAG_IP4,
+                         CI_ADDR_FROM_IP4(LADDR), LPORT,
+                         CI_ADDR_FROM_IP4(sock_raddr_be32(s)),
+                         sock_rport_be16(s), IPPROTO_TCP);
+}
+
+static oo_sp lookup(ci_netif* ni, unsigned id)
+{
+  ci_sock_cmn* s = ID_TO_SOCK(ni, id);
+  return ci_netif_filter_lookup(ni, AF_SPACE_FLAG_IP4,
+                                CI_ADDR_FROM_IP4(LADDR), LPORT,
+                                CI_ADDR_FROM_IP4(sock_raddr_be32(s)),
+                                sock_rport_be16(s), IPPROTO_TCP);
+}
+
+static int found(ci_sock_cmn* s, void* arg)
+{
+  *(ci_sock_cmn**) arg = s;
+  return 1;
+}
+
+/* The fast path, which tests state and tag of the first probe together */
+static ci_sock_cmn* match(ci_netif* ni, unsigned id)
+{
+  ci_sock_cmn* s = ID_TO_SOCK(ni, id);
+  ci_sock_cmn* m = NULL;
+  ci_netif_filter_for_each_match(ni, LADDR, LPORT, sock_raddr_be32(s),
+                                 sock_rport_be16(s), IPPROTO_TCP, 0, 0,
+                                 found, &m, NULL);
+  return m;
+}
+
+/* The entry holding [id], or NULL */
+static ci_netif_filter_table_entry_fast* entry_of(ci_netif* ni, unsigned id)
+{
+  unsigned i;
+  for( i = 0; i < TABLE_SIZE; ++i ) {
+    ci_netif_filter_table_entry_fast* e = &ni->filter_table->table[i];
+    if( (e->__id_and_state >> 31) == 0 &&
+        (e->__id_and_state & (TAG_LSB - 1)) == id )
+      return e;
+  }
+  return NULL;
+}
+
+static void test_insert_lookup(void)
+{
+  ci_netif* ni = alloc_netif();
+  unsigned i, n_rehashed = 0;
+
+  for( i = 0; i < N_SOCKS; ++i )
+    CHECK(insert(ni, i), ==, 0);
+
+  /* Every socket is found by both lookups, so the tag stored by insert is
+   * the tag that each lookup compares, wherever the entry landed. */
+  for( i = 0; i < N_SOCKS; ++i ) {
+    CHECK(OO_SP_TO_INT(lookup(ni, i)), ==, i);
+    CHECK(match(ni, i), ==, ID_TO_SOCK(ni, i));
+  }
+  for( i = 0; i < TABLE_SIZE; ++i )
+    n_rehashed += (ni->filter_table->table[i].__id_and_state >> 30) == 1;
+  CHECK(n_rehashed, >, N_SOCKS / 10);
+
+  free_netif(ni);
+}
+
+static void test_tag_compared(void)
+{
+  ci_netif* ni = alloc_netif();
+  ci_netif_filter_table_entry_fast* e;
+  unsigned i;
+
+  for( i = 0; i < N_SOCKS; ++i )
+    CHECK(insert(ni, i), ==, 0);
+
+  /* With its tag changed, an entry is skipped even though the socket
+   * matches: lookups really do filter on the tag. */
+  for( i = 0; i < N_SOCKS; i += N_SOCKS / 16 ) {
+    e = entry_of(ni, i);
+    CHECK_TRUE(e != NULL);
+    e->__id_and_state ^= TAG_LSB;
+    CHECK_TRUE(OO_SP_IS_NULL(lookup(ni, i)));
+    CHECK(match(ni, i), ==, NULL);
+    e->__id_and_state ^= TAG_LSB;
+    CHECK(OO_SP_TO_INT(lookup(ni, i)), ==, i);
+    CHECK(match(ni, i), ==, ID_TO_SOCK(ni, i));
+  }
+
+  free_netif(ni);
+}
+
+static void test_remove(void)
+{
+  ci_netif* ni = alloc_netif();
+  unsigned i;
+
+  for( i = 0; i < N_SOCKS; ++i )
+    CHECK(insert(ni, i), ==, 0);
+
+  /* Remove half, leaving tombstones on the probe sequences of the rest */
+  for( i = 0; i < N_SOCKS; i += 2 )
+    remove_sock(ni, i);
+  for( i = 0; i < N_SOCKS; ++i ) {
+    if( i & 1 ) {
+      CHECK(OO_SP_TO_INT(lookup(ni, i)), ==, i);
+      CHECK(match(ni, i), ==, ID_TO_SOCK(ni, i));
+    }
+    else {
+      CHECK_TRUE(OO_SP_IS_NULL(lookup(ni, i)));
+      CHECK(match(ni, i), ==, NULL);
+    }
+  }
+
+  /* Re-inserted entries may reuse tombstones, and keep their tags */
+  for( i = 0; i < N_SOCKS; i += 2 )
+    CHECK(insert(ni, i), ==, 0);
+  for( i = 0; i < N_SOCKS; ++i )
+    CHECK(match(ni, i), ==, ID_TO_SOCK(ni, i));
+
+  free_netif(ni);
+}
+
+int main(void)
+{
+  TEST_RUN(test_insert_lookup);
+  TEST_RUN(test_tag_compared);
+  TEST_RUN(test_remove);
+  TEST_END();
+}
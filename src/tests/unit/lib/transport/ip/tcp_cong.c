@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Functions under test */
+#include <ci/internal/ip.h>
+
+/* Test infrastructure */
+#include "unit_test.h"
+
+#define MSS 1448
+
+static ci_netif* alloc_netif(void)
+{
+  ci_netif* ni = calloc(1, sizeof(*ni));
+  ni->state = calloc(1, sizeof(*ni->state));
+  /* The stack lock is held, as it is when ci_tcp_rx() calls in */
+  ni->state->lock.lock = CI_EPLOCK_LOCKED;
+  /* One tick per millisecond */
+  IPTIMER_STATE(ni)->ci_ip_time_ms2tick_fxp = 1ull << 32;
+  return ni;
+}
+
+static void free_netif(ci_netif* ni)
+{
+  free(ni->state);
+  free(ni);
+}
+
+static ci_tcp_state* alloc_ts(ci_netif* ni, int alg)
+{
+  ci_tcp_state* ts = calloc(1, sizeof(*ts));
+  ts->s.b.state = CI_TCP_CLOSED;
+  ts->eff_mss = MSS;
+  ci_tcp_cong_set_alg(ni, ts, alg);
+  return ts;
+}
+
+/* Deliver one RTT's worth of ACKs, one per segment, as ci_tcp_rx does. */
+static void ack_one_rtt(ci_netif* ni, ci_tcp_state* ts)
+{
+  unsigned i, n = ts->cwnd / MSS;
+  for( i = 0; i < n; ++i ) {
+    ts->bytes_acked += MSS;
+    ci_tcp_cong_ops(ts)->cong_avoid(ni, ts, MSS);
+  }
+  IPTIMER_STATE(ni)->ci_ip_time_real_ticks += tcp_srtt(ts);
+}
+
+static void test_cubic_root(void)
+{
+  static const ci_uint64 vals[] = {
+    0, 1, 7, 8, 9, 26, 27, 28, 999999, 1000000, 1000001,
+    (1ull << 60) - 1, 1ull << 60, ~0ull,
+  };
+  unsigned i;
+
+  for( i = 0; i < sizeof(vals) / sizeof(vals[0]); ++i ) {
+    ci_uint64 r = ci_tcp_cubic_root(vals[i]);
+    CHECK(r * r * r, <=, vals[i]);
+    /* (r+1)^3 may overflow only for the largest input */
+    if( r < 2642245 )
+      CHECK((r + 1) * (r + 1) * (r + 1), >, vals[i]);
+  }
+  CHECK(ci_tcp_cubic_root(1000000), ==, 100);
+  CHECK(ci_tcp_cubic_root(1ull << 60), ==, 1u << 20);
+}
+
+static void test_lookup(void)
+{
+  CHECK(ci_tcp_cong_alg_lookup("reno", 4), ==, CI_TCP_CONG_ALG_RENO);
+  CHECK(ci_tcp_cong_alg_lookup("cubic", 6), ==, CI_TCP_CONG_ALG_CUBIC);
+  CHECK(ci_tcp_cong_alg_lookup("cubic", 5), ==, CI_TCP_CONG_ALG_CUBIC);
+  CHECK(ci_tcp_cong_alg_lookup("cub", 3), ==, -ENOENT);
+  CHECK(ci_tcp_cong_alg_lookup("cubicx", 6), ==, -ENOENT);
+  CHECK(ci_tcp_cong_alg_lookup("bbr", 4), ==, -ENOENT);
+}
+
+static void test_bad_alg(void)
+{
+  ci_netif* ni = alloc_netif();
+  ci_tcp_state* ts = alloc_ts(ni, 200);
+
+  /* Out-of-range values from shared state fall back to Reno */
+  CHECK(ts->c.cong_alg, ==, CI_TCP_CONG_ALG_RENO);
+  ts->c.cong_alg = 0xff;
+  CHECK(ci_tcp_cong_ops(ts), ==, ci_tcp_cong_ops_tbl[CI_TCP_CONG_ALG_RENO]);
+  CHECK(ci_tcp_cong_alg_ops(CI_TCP_CONG_ALG_N),
+        ==, ci_tcp_cong_ops_tbl[CI_TCP_CONG_ALG_RENO]);
+
+  free(ts);
+  free_netif(ni);
+}
+
+static void test_reno(void)
+{
+  ci_netif* ni = alloc_netif();
+  ci_tcp_state* ts = alloc_ts(ni, CI_TCP_CONG_ALG_RENO);
+
+  ts->cwnd = 10 * MSS;
+  ts->sa = 10 << 3;
+
+  /* One segment of growth per cwnd of acked data */
+  ack_one_rtt(ni, ts);
+  CHECK(ts->cwnd, ==, 11 * MSS);
+  CHECK(ts->bytes_acked, ==, 0);
+
+  /* Loss window is unchanged from before */
+  CHECK(ci_tcp_cong_ops(ts)->ssthresh(ni, ts), ==, ci_tcp_losswnd(ts));
+
+  free(ts);
+  free_netif(ni);
+}
+
+static void test_cubic(void)
+{
+  ci_netif* ni = alloc_netif();
+  ci_tcp_state* ts = alloc_ts(ni, CI_TCP_CONG_ALG_CUBIC);
+  unsigned rtt, w_max = 1000;
+
+  IPTIMER_STATE(ni)->ci_ip_time_real_ticks = 1000;
+  ts->sa = 100 << 3;
+  ts->cwnd = w_max * MSS;
+
+  /* Multiplicative decrease by beta = 0.7 */
+  ts->ssthresh = ci_tcp_cong_ops(ts)->ssthresh(ni, ts);
+  CHECK(ts->ssthresh, ==, 700 * MSS);
+  CHECK(ts->cong.cubic.last_max_cwnd, ==, w_max);
+  ts->cwnd = ts->ssthresh;
+
+  /* K = cbrt(W_max * (1 - beta) / C) ~= 9.1s, i.e. 91 RTTs of 100ms.  The
+   * window grows concavely towards W_max, plateaus, then probes beyond. */
+  for( rtt = 0; rtt < 45; ++rtt )
+    ack_one_rtt(ni, ts);
+  CHECK(ts->cong.cubic.k, >, 9000);
+  CHECK(ts->cong.cubic.k, <, 9600);
+  CHECK(ts->cwnd / MSS, >, 900);
+  CHECK(ts->cwnd / MSS, <, w_max);
+
+  for( ; rtt < 91; ++rtt )
+    ack_one_rtt(ni, ts);
+  CHECK(ts->cwnd / MSS, >=, w_max - 5);
+  CHECK(ts->cwnd / MSS, <=, w_max + 5);
+
+  for( ; rtt < 150; ++rtt )
+    ack_one_rtt(ni, ts);
+  CHECK(ts->cwnd / MSS, >, w_max + 50);
+
+  /* Fast convergence: a loss below the previous W_max lowers it further */
+  ts->cwnd = 800 * MSS;
+  ci_tcp_cong_ops(ts)->ssthresh(ni, ts);
+  CHECK(ts->cong.cubic.last_max_cwnd, ==, 800 * 1741 / 2048);
+
+  free(ts);
+  free_netif(ni);
+}
+
+static void test_log(void)
+{
+  ci_netif* ni = alloc_netif();
+  ci_tcp_state* ts = alloc_ts(ni, CI_TCP_CONG_ALG_CUBIC);
+  struct oo_tcp_cong_log* cl = &ni->state->tcp_cong_log;
+  int i;
+
+  IPTIMER_STATE(ni)->ci_ip_time_real_ticks = 1234;
+  ts->cwnd = 20 * MSS;
+  ts->ssthresh = 14 * MSS;
+  ts->cong.cubic.last_max_cwnd = 20;
+
+  ci_tcp_cong_event(ni, ts, CI_TCP_CONG_EV_SAMPLE);
+  CHECK(cl->n, ==, 1);
+  CHECK(cl->ent[0].time, ==, 1234);
+  CHECK(cl->ent[0].cwnd, ==, 20 * MSS);
+  CHECK(cl->ent[0].ssthresh, ==, 14 * MSS);
+  CHECK(cl->ent[0].event, ==, CI_TCP_CONG_EV_SAMPLE);
+  CHECK(cl->ent[0].alg, ==, CI_TCP_CONG_ALG_CUBIC);
+  CHECK(ts->cong_sample_t, ==, 1234);
+  CHECK(ts->cong.cubic.last_max_cwnd, ==, 20);
+
+  /* An RTO makes CUBIC forget W_max */
+  ci_tcp_cong_event(ni, ts, CI_TCP_CONG_EV_RTO);
+  CHECK(cl->n, ==, 2);
+  CHECK(cl->ent[1].event, ==, CI_TCP_CONG_EV_RTO);
+  CHECK(ts->cong.cubic.last_max_cwnd, ==, 0);
+
+  /* The log wraps */
+  for( i = 0; i < CI_TCP_CONG_LOG_LEN; ++i )
+    ci_tcp_cong_event(ni, ts, CI_TCP_CONG_EV_SAMPLE);
+  CHECK(cl->n, ==, CI_TCP_CONG_LOG_LEN + 2);
+  CHECK(cl->ent[1].event, ==, CI_TCP_CONG_EV_SAMPLE);
+
+  free(ts);
+  free_netif(ni);
+}
+
+int main(void)
+{
+  TEST_RUN(test_cubic_root);
+  TEST_RUN(test_lookup);
+  TEST_RUN(test_bad_alg);
+  TEST_RUN(test_reno);
+  TEST_RUN(test_cubic);
+  TEST_RUN(test_log);
+  TEST_END();
+}
@@ -77,6 +77,9 @@ int ci_netif_pkt_pass_to_kernel(ci_netif* ni, ci_ip_pkt_fmt* pkt)
   return 1;
 }
 
+/* Congestion control is not reached by these tests */
+const struct ci_tcp_cong_ops* const ci_tcp_cong_ops_tbl[CI_TCP_CONG_ALG_N];
+
 /* TODO parametrise, or have multiple variants, to test multiple control paths.
  * This just tests a simple path: a TCP/IPv4 packet with no matching filter is
  * passed to the kernel. */
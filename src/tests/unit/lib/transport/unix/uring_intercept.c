@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-2-Clause */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Functions under test */
+#include "internal.h"
+
+/* Test infrastructure */
+#include "unit_test.h"
+
+#if CI_CFG_USERSPACE_SYSCALL && CI_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#endif
+
+/* Globals of the preload library */
+ci_cfg_opts_t ci_cfg_opts;
+citp_ul_lock_t citp_ul_lock;
+__thread struct oo_per_thread oo_per_thread;
+unsigned citp_log_level;
+citp_fdinfo citp_the_closed_fd;
+citp_fdinfo citp_the_reserved_fd;
+long (*ci_sys_syscall)(long, ...) = syscall;
+int (*ci_sys_close)(int) = close;
+
+CI_NORETURN __ci_sys_fail(const char* fn, int rc, const char* file, int line)
+{
+  abort();
+}
+
+void citp_signal_run_pending(citp_signal_info* info) {}
+
+void oo_per_thread_init_thread(void)
+{
+  oo_per_thread.initialised = 1;
+}
+
+/* The fd table lock is taken once, when the private ring is reserved, and
+ * never contended, so there are no readers to clear or writers to wake. */
+void rwlock_clear_readers(oo_rwlock* l) {}
+void rwlock_writers_dec(oo_rwlock* l, int locked)
+{
+  --l->writers;
+  l->val &= ~OO_RWLOCK_VAL_WRITER;
+}
+void __citp_fdinfo_ref_count_zero(citp_fdinfo* fdi, int fdt_locked) {}
+
+/* Each SQE that the intercept looks at asks the fd table whether its
+ * socket is accelerated.  None is, so every request goes to the kernel. */
+static int n_fd_lookups;
+
+citp_fdinfo* citp_fdtable_lookup(unsigned fd)
+{
+  ++n_fd_lookups;
+  return NULL;
+}
+
+void __citp_fdtable_reserve(int fd, int reserve) {}
+
+
+#if CI_CFG_USERSPACE_SYSCALL && CI_HAVE_IO_URING && \
+    defined(IORING_SETUP_SUBMIT_ALL)
+
+/* The most rings that the intercept will track */
+#define MAX_RINGS 16
+
+struct ring {
+  int                   fd;
+  void*                 sq;
+  size_t                sq_len;
+  struct io_uring_sqe*  sqes;
+  size_t                sqes_len;
+  unsigned*             sq_tail;
+  unsigned*             sq_array;
+  unsigned              sq_mask;
+};
+
+static int ring_setup(struct ring* rg)
+{
+  struct io_uring_params p;
+
+  memset(&p, 0, sizeof(p));
+  rg->fd = citp_io_uring_setup(4, &p);
+  if( rg->fd < 0 )
+    return -1;
+  rg->sq_len = p.sq_off.array + p.sq_entries * sizeof(__u32);
+  rg->sq = mmap(NULL, rg->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                rg->fd, IORING_OFF_SQ_RING);
+  rg->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+  rg->sqes = mmap(NULL, rg->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  rg->fd, IORING_OFF_SQES);
+  CHECK_TRUE(rg->sq != MAP_FAILED && rg->sqes != MAP_FAILED);
+  rg->sq_tail = (unsigned*) ((char*) rg->sq + p.sq_off.tail);
+  rg->sq_array = (unsigned*) ((char*) rg->sq + p.sq_off.array);
+  rg->sq_mask = *(unsigned*) ((char*) rg->sq + p.sq_off.ring_mask);
+  return 0;
+}
+
+static void ring_close(struct ring* rg)
+{
+  munmap(rg->sqes, rg->sqes_len);
+  munmap(rg->sq, rg->sq_len);
+  close(rg->fd);
+  citp_io_uring_close(rg->fd);
+}
+
+/* Submit a POLL_ADD on stdin, which the intercept looks at only if it is
+ * tracking the ring.  Returns the number of fd-table lookups it did. */
+static int ring_submit(struct ring* rg)
+{
+  unsigned tail = *rg->sq_tail;
+  struct io_uring_sqe* sqe = &rg->sqes[tail & rg->sq_mask];
+  int n = n_fd_lookups;
+
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = 0;
+  sqe->poll32_events = POLLIN;
+  rg->sq_array[tail & rg->sq_mask] = tail & rg->sq_mask;
+  __atomic_store_n(rg->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  CHECK(citp_io_uring_enter(rg->fd, 1, 0, 0, NULL, 0), ==, 1);
+  return n_fd_lookups - n;
+}
+
+static int have_uring(void)
+{
+  struct io_uring_params p;
+  long fd;
+
+  memset(&p, 0, sizeof(p));
+  fd = syscall(__NR_io_uring_setup, 4, &p);
+  if( fd < 0 )
+    return 0;
+  close(fd);
+  return 1;
+}
+
+static void test_register_lookup_remove(void)
+{
+  struct ring rings[MAX_RINGS + 1];
+  int i;
+
+  /* Each ring is found when it is entered, up to the size of the table. */
+  for( i = 0; i < MAX_RINGS; ++i ) {
+    CHECK(ring_setup(&rings[i]), ==, 0);
+    CHECK(ring_submit(&rings[i]), ==, 1);
+  }
+  /* Beyond that, rings are left to the kernel. */
+  CHECK(ring_setup(&rings[MAX_RINGS]), ==, 0);
+  CHECK(ring_submit(&rings[MAX_RINGS]), ==, 0);
+  ring_close(&rings[MAX_RINGS]);
+
+  /* Closing a ring frees its slot for the next one. */
+  ring_close(&rings[3]);
+  CHECK(ring_setup(&rings[3]), ==, 0);
+  CHECK(ring_submit(&rings[3]), ==, 1);
+
+  /* Once every ring has gone, a new one (likely on a reused fd number) is
+   * tracked afresh. */
+  for( i = 0; i < MAX_RINGS; ++i )
+    ring_close(&rings[i]);
+  CHECK(ring_setup(&rings[0]), ==, 0);
+  CHECK(ring_submit(&rings[0]), ==, 1);
+  ring_close(&rings[0]);
+}
+
+/* One thread enters a ring while another closes it and creates another in
+ * its place.  The enter looks at the SQ ring through the intercept's own
+ * mapping, which must not go away underneath it.  The SQ is empty, so
+ * nothing is submitted. */
+static volatile int race_stop;
+static volatile int race_fd = -1;
+
+static void* race_enter(void* arg)
+{
+  while( ! race_stop )
+    citp_io_uring_enter(race_fd, 1, 0, 0, NULL, 0);
+  return NULL;
+}
+
+static void test_enter_close_race(void)
+{
+  struct ring rg;
+  pthread_t t;
+  int i;
+
+  CHECK(ring_setup(&rg), ==, 0);
+  race_fd = rg.fd;
+  CHECK(pthread_create(&t, NULL, race_enter, NULL), ==, 0);
+  for( i = 0; i < 2000; ++i ) {
+    ring_close(&rg);
+    CHECK(ring_setup(&rg), ==, 0);
+    race_fd = rg.fd;
+    if( (i & 63) == 0 )
+      sched_yield();
+  }
+  race_stop = 1;
+  pthread_join(t, NULL);
+  ring_close(&rg);
+}
+
+int main(void)
+{
+  CITP_OPTS.io_uring = 1;
+  if( ! have_uring() ) {
+    printf("io_uring is not available: skipped\n");
+    return 0;
+  }
+  TEST_RUN(test_register_lookup_remove);
+  TEST_RUN(test_enter_close_race);
+  TEST_END();
+}
+
+#else
+
+int main(void)
+{
+  printf("io_uring intercept not built: skipped\n");
+  return 0;
+}
+
+#endif
@@ -25,6 +25,11 @@ ALL_UNIT_TESTS := \
   header/transport/unix/ul_epoll \
   lib/transport/ip/netif_init \
   lib/transport/ip/tcp_rx \
+  lib/transport/ip/tcp_cong \
+  lib/transport/ip/iptimer \
+  lib/transport/ip/netif_table \
+  lib/transport/unix/uring_intercept \
+  lib/citools/toeplitz \
   lib/ciul/checksum \
   lib/ciul/efct_vi \
   lib/ciul/efct_ubufs \
@@ -45,7 +50,7 @@ PASSED := $(TESTS:%=%.passed)
 # Library object names are mangled with a prefix. Deal with that madness here.
 LIB_PREFIXES := lib/transport/common/ci_tp_common_ \
 		lib/transport/ip/ci_ip_ \
-		lib/transport/unix/ci_unix_ \
+		lib/transport/unix/ci_tp_unix_ \
 		lib/ciapp/ci_app_ \
 		lib/citools/ci_tools_ \
 		lib/ciul/ci_ul_ \
@@ -1330,6 +1330,7 @@ static void stack_stats_describe(ci_netif* ni)
 static void stack_clear_stats(ci_netif* ni)
 {
   clear_stats(netif_stats_fields, N_NETIF_STATS_FIELDS, &ni->state->stats);
+  memset(&ni->state->lat_hist, 0, sizeof(ni->state->lat_hist));
 }
 
 static void stack_dstats(ci_netif* ni)
@@ -1472,7 +1473,8 @@ static void stack_analyse(ci_netif* ni)
       ++locked;
     if( ni->state->lock.lock & CI_EPLOCK_FL_NEED_WAKE )
       ++contended;
-    if( ni->state->lock.lock & CI_EPLOCK_NETIF_SOCKET_LIST )
+    if( ni->state->lock.lock & (CI_EPLOCK_NETIF_SOCKET_LIST |
+                                CI_EPLOCK_NETIF_DEFER_RING) )
       ++deferred;
     if( ci_netif_is_primed(ni) )
       ++primed_all;
@@ -1520,6 +1522,16 @@ static void stack_timers(ci_netif* ni)
   ci_ip_timer_state_dump(ni);
 }
 
+static void stack_cong_log(ci_netif* ni)
+{
+  ci_tcp_cong_log_dump(ni, OO_SP_NULL, ci_log_dump_fn, NULL);
+}
+
+static void stack_histograms(ci_netif* ni)
+{
+  ci_netif_dump_lat_hists(ni, ci_log_dump_fn, NULL);
+}
+
 static void stack_filter_table(ci_netif* ni)
 {
   ci_netif_filter_dump(ni);
@@ -2373,6 +2385,8 @@ static const stack_op_t stack_ops[] = {
   STACK_OP(time,               "show stack timers"),
   STACK_OP(time_init,          "(re-)initialize stack timers"),
   STACK_OP(timers,             "dump state of stack timers"),
+  STACK_OP(cong_log,           "show recent TCP cwnd/ssthresh trajectory"),
+  STACK_OP(histograms,         "show latency histograms (EF_LATENCY_HIST)"),
   STACK_OP(filter_table,       "show stack software filter table"),
   STACK_OP_F(filters,          "show stack hardware filters", FL_ONCE),
 #if CI_CFG_ENDPOINT_MOVE
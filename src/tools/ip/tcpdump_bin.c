@@ -54,18 +54,76 @@ struct oo_pcap_pkthdr {
   ci_uint32 len;
 };
 
+/* pcapng blocks */
+#define PCAPNG_BT_SHB           0x0A0D0D0A
+#define PCAPNG_BT_IDB           0x00000001
+#define PCAPNG_BT_EPB           0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_OPT_ENDOFOPT     0
+#define PCAPNG_OPT_IF_NAME      2
+#define PCAPNG_OPT_IF_TSRESOL   9
+#define PCAPNG_OPT_EPB_FLAGS    2
+#define PCAPNG_EPB_INBOUND      1
+#define PCAPNG_EPB_OUTBOUND     2
+
+struct pcapng_shb {
+  ci_uint32 block_type;
+  ci_uint32 block_len;
+  ci_uint32 byte_order_magic;
+  ci_uint16 version_major;
+  ci_uint16 version_minor;
+  ci_int64  section_len;
+  ci_uint32 block_len_trailer;
+} __attribute__((packed));
+
+struct pcapng_idb {
+  ci_uint32 block_type;
+  ci_uint32 block_len;
+  ci_uint16 linktype;
+  ci_uint16 reserved;
+  ci_uint32 snaplen;
+};
+
+struct pcapng_opt {
+  ci_uint16 code;
+  ci_uint16 len;
+};
+
+struct pcapng_epb {
+  ci_uint32 block_type;
+  ci_uint32 block_len;
+  ci_uint32 interface_id;
+  ci_uint32 ts_high;
+  ci_uint32 ts_low;
+  ci_uint32 caplen;
+  ci_uint32 len;
+};
+
+struct pcapng_epb_trailer {
+  ci_uint16 flags_code;
+  ci_uint16 flags_len;
+  ci_uint32 flags;
+  ci_uint32 endofopt;
+  ci_uint32 block_len;
+};
+
 #define MAXIMUM_SNAPLEN 65535
 static int cfg_snaplen = MAXIMUM_SNAPLEN;
 static int cfg_dump_os = 1;
 static int cfg_if_is_loop = 0;
 static int cfg_dump_no_match_only = 0;
+static int cfg_pcapng = 0;
 
 /* capture precision */
 static const char *cfg_precision = "micro";
-static const char *cfg_timestamp_type = "host";
+static const char *cfg_timestamp_type = NULL;
 static int do_nano = 0;
 static int hw_stamping = 0;
 
+/* Pre-filter to run in the stack */
+static const char *cfg_prefilter = NULL;
+static struct bpf_program prefilter;
+
 /* Interface to dump */
 static const char *cfg_interface = "any";
 static int cfg_ifindex = -1;
@@ -100,7 +158,12 @@ static ci_cfg_desc cfg_opts[] = {
   {  2, "time-stamp-precision", CI_CFG_STR, &cfg_precision,
                  "set the timestamp precision, default to \"micro\", man tcpdump"},
   {'j', "time-stamp-type", CI_CFG_STR, &cfg_timestamp_type,
-          "set the timestamp type, defaults to \"host\", man tcpdump"},
+          "set the timestamp type, defaults to \"host\" (\"adapter_unsynced\" "
+          "with --pcapng), man tcpdump"},
+  {  3, "pcapng",    CI_CFG_FLAG, &cfg_pcapng,
+          "write pcapng, with nanosecond timestamps and packet direction"},
+  {  4, "prefilter", CI_CFG_STR,  &cfg_prefilter,
+          "pcap filter expression for the stacks to apply before capture"},
 };
 #define N_CFG_OPTS (sizeof(cfg_opts) / sizeof(cfg_opts[0]))
 
@@ -266,10 +329,39 @@ suicide:
   exit(1);
 }
 
+/* Install the pre-filter in the stack.  When dumping a VLAN interface we
+ * strip the tag as we write packets out, so the filter would not see the
+ * packets that tcpdump sees: leave the filtering to tcpdump. */
+static void prefilter_install(ci_netif *ni)
+{
+  static int warned_vlan = 0;
+  unsigned i;
+
+  ci_assert(ci_netif_is_locked(ni));
+
+  ni->state->dump_filter_len = 0;
+  if( prefilter.bf_len == 0 )
+    return;
+  if( cfg_encap.type & CICP_LLAP_TYPE_VLAN ) {
+    if( ! warned_vlan )
+      ci_log("Pre-filter is not used on VLAN interface %s", cfg_interface);
+    warned_vlan = 1;
+    return;
+  }
+
+  for( i = 0; i < prefilter.bf_len; i++ ) {
+    ni->state->dump_filter[i].code = prefilter.bf_insns[i].code;
+    ni->state->dump_filter[i].jt = prefilter.bf_insns[i].jt;
+    ni->state->dump_filter[i].jf = prefilter.bf_insns[i].jf;
+    ni->state->dump_filter[i].k = prefilter.bf_insns[i].k;
+  }
+  ci_wmb();
+  ni->state->dump_filter_len = prefilter.bf_len;
+}
+
 /* Turn dumping on */
 static void stack_dump_on(ci_netif *ni)
 {
-  int i;
   ci_assert(ci_netif_is_locked(ni));
 
   cpu_khz = IPTIMER_STATE(ni)->khz;
@@ -301,17 +393,17 @@ static void stack_dump_on(ci_netif *ni)
         ni->state->stack_id, ni->state->name);
   }
 
-  /* No data from other tcpdump processes should be available. */
-  ci_assert_equal(ni->state->dump_read_i, ni->state->dump_write_i);
-
-  /* Init dump queue */
-  for( i = 0; i < CI_CFG_DUMPQUEUE_LEN; i++ )
-    ni->state->dump_queue[i] = OO_PP_NULL;
+  /* Release any packets left by an earlier tcpdump that did not exit
+   * cleanly. */
+  ni->state->dump_read_i = ni->state->dump_write_i;
+  oo_tcpdump_free_pkts(ni);
 
   /* Find interface details if unknown */
   if( dump_hwports[0] == -1 )
     ifindex_to_intf_i(ni);
 
+  prefilter_install(ni);
+
   /* Set up dumping */
   ci_log("Onload stack [%d,%s]: start packet dump",
          ni->state->stack_id, ni->state->name);
@@ -337,8 +429,9 @@ static void stack_dump_off(ci_netif *ni)
 {
   memset(ni->state->dump_intf, 0, sizeof(ni->state->dump_intf));
   libstack_netif_lock(ni);
-  oo_tcpdump_free_pkts(ni, ni->state->dump_read_i);
+  ni->state->dump_filter_len = 0;
   ni->state->dump_read_i = ni->state->dump_write_i;
+  oo_tcpdump_free_pkts(ni);
   ci_log("Onload stack [%d,%s]: stop packet dump",
          ni->state->stack_id, ni->state->name);
 }
@@ -359,13 +452,71 @@ static void dump_flush(void)
   }
 }
 
+/* Write the record header for a packet */
+static void dump_pkt_hdr(const ci_ip_pkt_fmt* pkt, ci_uint32 caplen,
+                         ci_uint32 len)
+{
+  struct timespec ts;
+
+  pkt_tstamp(pkt, &ts);
+
+  if( cfg_pcapng ) {
+    struct pcapng_epb epb;
+    ci_uint64 ns = (ci_uint64) ts.tv_sec * 1000000000 + ts.tv_nsec;
+
+    epb.block_type = PCAPNG_BT_EPB;
+    epb.block_len = sizeof(epb) + CI_ROUND_UP(caplen, 4) +
+                    sizeof(struct pcapng_epb_trailer);
+    epb.interface_id = 0;
+    epb.ts_high = ns >> 32;
+    epb.ts_low = (ci_uint32) ns;
+    epb.caplen = caplen;
+    epb.len = len;
+    dump_data(&epb, sizeof(epb));
+  }
+  else {
+    struct oo_pcap_pkthdr hdr;
+
+    hdr.caplen = caplen;
+    hdr.len = len;
+    hdr.t.ts.tv_sec = ts.tv_sec;
+    if( do_nano )
+      hdr.t.ts.tv_nsec = ts.tv_nsec;
+    else
+      hdr.t.tv.tv_usec = ts.tv_nsec / 1000;
+    dump_data(&hdr, sizeof(hdr));
+  }
+}
+
+/* Write whatever follows the data of a packet */
+static void dump_pkt_trailer(const ci_ip_pkt_fmt* pkt, ci_uint32 caplen)
+{
+  static const ci_uint8 pad[4];
+  struct pcapng_epb_trailer tr;
+
+  if( ! cfg_pcapng )
+    return;
+
+  if( caplen & 3 )
+    dump_data(pad, 4 - (caplen & 3));
+  tr.flags_code = PCAPNG_OPT_EPB_FLAGS;
+  tr.flags_len = sizeof(tr.flags);
+  tr.flags = (pkt->flags & CI_PKT_FLAG_RX) ? PCAPNG_EPB_INBOUND :
+                                             PCAPNG_EPB_OUTBOUND;
+  tr.endofopt = PCAPNG_OPT_ENDOFOPT;
+  tr.block_len = sizeof(struct pcapng_epb) + CI_ROUND_UP(caplen, 4) +
+                 sizeof(tr);
+  dump_data(&tr, sizeof(tr));
+}
+
 /* Do dump */
 static void stack_dump(ci_netif *ni)
 {
   int strip_vlan = cfg_encap.type & CICP_LLAP_TYPE_VLAN;
   int do_strip_vlan = strip_vlan;
-  ci_uint16 read_i = ni->state->dump_read_i;
-  ci_uint16 i, fill_level = ni->state->dump_write_i - read_i;
+  ci_uint32 mask = NI_OPTS(ni).tcpdump_ring - 1;
+  ci_uint32 read_i = ni->state->dump_read_i;
+  ci_uint32 i, fill_level = ni->state->dump_write_i - read_i;
   sigset_t sigset;
 
   if( fill_level == 0 )
@@ -376,10 +527,11 @@ static void stack_dump(ci_netif *ni)
 
   /* Dump a batch of packets, then update dump_read_i.  Avoid writing
    * dump_read_i frequently since dirtying the cache line adds overhead to
-   * the application we're monitoring.
+   * the application we're monitoring.  The stack will not release the
+   * packets until we do, so don't make the batch too big either.
    */
-  if( fill_level > CI_CFG_DUMPQUEUE_LEN / 4 )
-    fill_level = CI_CFG_DUMPQUEUE_LEN / 4;
+  if( fill_level > (mask + 1) / 4 )
+    fill_level = (mask + 1) / 4;
 
   /* Barrier to ensure entries in dump ring are written. */
   ci_rmb();
@@ -388,14 +540,13 @@ static void stack_dump(ci_netif *ni)
   CI_TEST( pthread_sigmask(SIG_BLOCK, &sigset, NULL) == 0 );
 
   for( i = 0; i < fill_level; ++i, ++read_i ) {
-    struct oo_pcap_pkthdr hdr;
-    struct timespec ts;
     int paylen;
     int fraglen;
+    ci_uint32 caplen;
     oo_pkt_p id;
     ci_ip_pkt_fmt *pkt;
 
-    id = ni->state->dump_queue[read_i % CI_CFG_DUMPQUEUE_LEN];
+    id = ni->dump_queue[read_i & mask];
     if( id == OO_PP_NULL )
       continue;
     pkt = PKT_CHK_NNL(ni, id);
@@ -434,20 +585,13 @@ static void stack_dump(ci_netif *ni)
 
     if( do_strip_vlan )
       paylen -= ETH_VLAN_HLEN;
-    hdr.caplen = CI_MIN(cfg_snaplen, paylen);
-    hdr.len = paylen;
-    pkt_tstamp(pkt, &ts);
-    hdr.t.ts.tv_sec = ts.tv_sec;
-    if( do_nano )
-      hdr.t.ts.tv_nsec = ts.tv_nsec;
-    else
-      hdr.t.tv.tv_usec = ts.tv_nsec / 1000;
+    caplen = CI_MIN(cfg_snaplen, paylen);
     LOG_DUMP(ci_log("%u: got ni %d pkt %d len %d ref %d",
                     read_i, ni->state->stack_id,
                     OO_PKT_FMT(pkt), paylen, pkt->refcount));
 
-    dump_data(&hdr, sizeof(hdr));
-    fraglen = hdr.caplen;
+    dump_pkt_hdr(pkt, caplen, paylen);
+    fraglen = caplen;
     if( do_strip_vlan ) {
       if( pkt->n_buffers > 1 )
         fraglen = CI_MIN(fraglen, pkt->buf_len - ETH_VLAN_HLEN);
@@ -463,10 +607,11 @@ static void stack_dump(ci_netif *ni)
 
     /* Dump all scatter-gather chain */
     if( pkt->n_buffers  > 1 ) {
+      ci_uint32 remaining = caplen;
       ci_ip_pkt_fmt *frag = PKT_CHK_NNL(ni, pkt->frag_next);
       do {
-        hdr.caplen -= fraglen;
-        fraglen = CI_MIN(hdr.caplen, frag->buf_len);
+        remaining -= fraglen;
+        fraglen = CI_MIN(remaining, frag->buf_len);
         if( fraglen > 0 )
           dump_data(frag->dma_start, fraglen);
         if( OO_PP_IS_NULL(frag->frag_next) )
@@ -474,6 +619,7 @@ static void stack_dump(ci_netif *ni)
         frag = PKT_CHK_NNL(ni, frag->frag_next);
       } while( frag != NULL );
     }
+    dump_pkt_trailer(pkt, caplen);
   }
 
   /* Ensure we've finished reading before we release. */
@@ -490,13 +636,14 @@ static void stack_pre_detach(ci_netif *ni)
 {
   memset(ni->state->dump_intf, 0, sizeof(ni->state->dump_intf));
   ci_wmb();
-  stack_dump(ni);
+  while( oo_tcpdump_queue_len(ni) != 0 )
+    stack_dump(ni);
 
   /* The stack is dying, but we should free the last packets to check that
    * there is no packet leak */
 #ifndef NDEBUG
   libstack_netif_lock(ni);
-  oo_tcpdump_free_pkts(ni, ni->state->dump_read_i);
+  oo_tcpdump_free_pkts(ni);
   libstack_netif_unlock(ni);
 #endif
 
@@ -578,10 +725,62 @@ static void signal_terminate(int sig)
   atexit_fn();
 }
 
+/* Section header block, then one interface description block with
+ * nanosecond timestamps, which all packets refer to. */
+static void write_pcapng_header(void)
+{
+  static const ci_uint8 pad[4];
+  static const ci_uint8 tsresol[4] = { 9 };   /* 10^-9 s, padded */
+  struct pcapng_shb shb;
+  struct pcapng_idb idb;
+  struct pcapng_opt opt;
+  ci_uint32 name_len = CI_MIN(strlen(cfg_interface), IFNAMSIZ);
+  ci_uint32 block_len;
+
+  shb.block_type = PCAPNG_BT_SHB;
+  shb.block_len = sizeof(shb);
+  shb.byte_order_magic = PCAPNG_BYTE_ORDER_MAGIC;
+  shb.version_major = 1;
+  shb.version_minor = 0;
+  shb.section_len = -1;
+  shb.block_len_trailer = sizeof(shb);
+  dump_data(&shb, sizeof(shb));
+
+  block_len = sizeof(idb) + sizeof(opt) + CI_ROUND_UP(name_len, 4) +
+              sizeof(opt) + sizeof(tsresol) + sizeof(opt) + sizeof(block_len);
+  idb.block_type = PCAPNG_BT_IDB;
+  idb.block_len = block_len;
+  idb.linktype = DLT_EN10MB;
+  idb.reserved = 0;
+  idb.snaplen = cfg_snaplen;
+  dump_data(&idb, sizeof(idb));
+  opt.code = PCAPNG_OPT_IF_NAME;
+  opt.len = name_len;
+  dump_data(&opt, sizeof(opt));
+  if( name_len )
+    dump_data(cfg_interface, name_len);
+  if( name_len & 3 )
+    dump_data(pad, 4 - (name_len & 3));
+  opt.code = PCAPNG_OPT_IF_TSRESOL;
+  opt.len = 1;
+  dump_data(&opt, sizeof(opt));
+  dump_data(tsresol, sizeof(tsresol));
+  opt.code = PCAPNG_OPT_ENDOFOPT;
+  opt.len = 0;
+  dump_data(&opt, sizeof(opt));
+  dump_data(&block_len, sizeof(block_len));
+  dump_flush();
+}
+
 static void write_pcap_header(void)
 {
   struct pcap_file_header hdr;
 
+  if( cfg_pcapng ) {
+    write_pcapng_header();
+    return;
+  }
+
   if( do_nano )
     hdr.magic = 0xa1b23c4d; //pcap-ns
   else
@@ -597,6 +796,33 @@ static void write_pcap_header(void)
   dump_flush();
 }
 
+/* Compile the pre-filter for the stacks to run on the packets as they
+ * have them, i.e. as Ethernet frames. */
+static void prefilter_compile(void)
+{
+  pcap_t* pcap = pcap_open_dead(DLT_EN10MB, cfg_snaplen);
+
+  if( pcap == NULL ) {
+    ci_log("Unable to open libpcap: pre-filter is not used");
+    return;
+  }
+  if( pcap_compile(pcap, &prefilter, cfg_prefilter, 1,
+                   PCAP_NETMASK_UNKNOWN) != 0 ) {
+    ci_log("Error: bad pre-filter \"%s\": %s", cfg_prefilter,
+           pcap_geterr(pcap));
+    exit(1);
+  }
+  pcap_close(pcap);
+
+  if( prefilter.bf_len > CI_CFG_TCPDUMP_FILTER_LEN ) {
+    ci_log("Pre-filter has %u instructions, but stacks can run at most %d: "
+           "pre-filter is not used", prefilter.bf_len,
+           CI_CFG_TCPDUMP_FILTER_LEN);
+    pcap_freecode(&prefilter);
+    prefilter.bf_len = 0;
+  }
+}
+
 /* Thread to catch stack list updates.  This thread should not call
  * list_all_stacks2(), since libstack is not thread-safe.  So, we just set
  * stacklist_has_update flag and main thread should call
@@ -717,7 +943,10 @@ int main(int argc, char* argv[])
     do_nano = 1;
   }
 
-  /* Set HW Timestamping. */
+  /* Set HW Timestamping.  pcapng is for the best timestamps we can get,
+   * so use HW timestamps there unless told otherwise. */
+  if( cfg_timestamp_type == NULL )
+    cfg_timestamp_type = cfg_pcapng ? "adapter_unsynced" : "host";
   if( strcmp(cfg_timestamp_type, "adapter") == 0
       || strcmp(cfg_timestamp_type, "adapter_unsynced") == 0 ) {
     hw_stamping = 1;
@@ -731,6 +960,9 @@ int main(int argc, char* argv[])
   cfg_snaplen = CI_MAX(cfg_snaplen, 80);
   cfg_snaplen = CI_MIN(cfg_snaplen, MAXIMUM_SNAPLEN);
 
+  if( cfg_prefilter != NULL )
+    prefilter_compile();
+
   /* Parse interfaces */
   parse_interface();
 
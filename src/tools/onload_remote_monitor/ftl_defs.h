@@ -264,6 +264,7 @@ typedef struct oo_p_dllink oo_p_dllink_t;
   FTL_TFIELD_CONSTINT(ctx, ci_uint8, vi_variant, ORM_OUTPUT_STACK)  \
   FTL_TFIELD_CONSTINT(ctx, ci_uint8, vi_revision, ORM_OUTPUT_STACK) \
   FTL_TFIELD_SSTR(ctx, dev_name, ORM_OUTPUT_STACK) \
+  FTL_TFIELD_CONSTINT(ctx, ci_int16, numa_node, ORM_OUTPUT_STACK)  \
   FTL_TFIELD_STRUCT(ctx, oo_pktq, dmaq, ORM_OUTPUT_STACK)           \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_bytes_added, ORM_OUTPUT_STACK)  \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_bytes_removed, ORM_OUTPUT_STACK) \
@@ -272,6 +273,9 @@ typedef struct oo_p_dllink oo_p_dllink_t;
                  tx_dmaq_insert_seq_last_poll, ORM_OUTPUT_STACK)                          \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_dmaq_done_seq, ORM_OUTPUT_STACK) \
   FTL_TFIELD_INT(ctx, ci_int32, rx_frags, ORM_OUTPUT_STACK)         \
+  FTL_TFIELD_INT(ctx, ci_int32, rxq_target, ORM_OUTPUT_STACK)       \
+  FTL_TFIELD_INT(ctx, ci_int32, rxq_batch, ORM_OUTPUT_STACK)        \
+  FTL_TFIELD_INT(ctx, ci_uint32, rxq_adapt_rate, ORM_OUTPUT_STACK)  \
   FTL_TFIELD_INT(ctx, ci_uint32, pd_owner, ORM_OUTPUT_STACK)        \
   ON_CI_CFG_TIMESTAMPING( \
     FTL_TFIELD_STRUCT(ctx, oo_timespec,           \
@@ -339,7 +343,8 @@ typedef struct oo_p_dllink oo_p_dllink_t;
     FTL_TFIELD_INT(ctx, ci_uint32, ci_ip_time_frc2us, ORM_OUTPUT_STACK)      \
     FTL_TFIELD_INT(ctx, ci_uint32, ci_ip_time_frc2isn, ORM_OUTPUT_STACK)     \
     FTL_TFIELD_INT(ctx, ci_uint32, khz, ORM_OUTPUT_STACK)                    \
-    FTL_TFIELD_STRUCT(ctx, oo_p_dllink_t, fire_list, ORM_OUTPUT_EXTRA)      \
+    FTL_TFIELD_ARRAYOFSTRUCT(ctx, \
+                             oo_p_dllink_t, fire_list, CI_IP_TIMER_N_FN, ORM_OUTPUT_EXTRA, 1) \
     FTL_TFIELD_ARRAYOFSTRUCT(ctx, \
                              oo_p_dllink_t, warray, CI_IPTIME_WHEELSIZE, ORM_OUTPUT_EXTRA, 1)   \
     FTL_TSTRUCT_END(ctx)                                                 
@@ -518,6 +523,9 @@ typedef struct oo_p_dllink oo_p_dllink_t;
   FTL_TFIELD_ARRAYOFSTRUCT(ctx, oo_p_dllink_t, timeout_q, \
                            OO_TIMEOUT_Q_MAX, ORM_OUTPUT_STACK, 1)         \
   FTL_TFIELD_STRUCT(ctx, oo_p_dllink_t, reap_list, ORM_OUTPUT_EXTRA)     \
+  FTL_TFIELD_STRUCT(ctx, oo_p_dllink_t, udp_txtime_list, ORM_OUTPUT_EXTRA) \
+  FTL_TFIELD_INT(ctx, ci_uint64, udp_txtime_next, ORM_OUTPUT_STACK)      \
+  FTL_TFIELD_STRUCT(ctx, ci_ip_timer, udp_txtime_tid, ORM_OUTPUT_STACK)  \
   ON_CI_CFG_SUPPORT_STATS_COLLECTION(                                   \
     FTL_TFIELD_INT(ctx, ci_int32, stats_fmt, ORM_OUTPUT_STACK)            \
     FTL_TFIELD_STRUCT(ctx, ci_ip_timer, stats_tid, ORM_OUTPUT_STACK)      \
@@ -578,12 +586,12 @@ typedef struct oo_p_dllink oo_p_dllink_t;
     FTL_TFIELD_STRUCT(ctx, ci_netif_stats, stats, 0 /* displayed separately */)  \
   )                                                                     \
   ON_CI_CFG_TCPDUMP(                                                    \
-    FTL_TFIELD_ARRAYOFINT(ctx, ci_int32, dump_queue,    \
-                          CI_CFG_DUMPQUEUE_LEN, ORM_OUTPUT_EXTRA)                      \
     FTL_TFIELD_ARRAYOFINT(ctx, ci_uint8, dump_intf,     \
                           OO_INTF_I_NUM, ORM_OUTPUT_STACK)                                \
-    FTL_TFIELD_INT(ctx, ci_uint16, dump_read_i, ORM_OUTPUT_STACK)         \
-    FTL_TFIELD_INT(ctx, ci_uint16, dump_write_i, ORM_OUTPUT_STACK)        \
+    FTL_TFIELD_INT(ctx, ci_uint32, dump_read_i, ORM_OUTPUT_STACK)         \
+    FTL_TFIELD_INT(ctx, ci_uint32, dump_write_i, ORM_OUTPUT_STACK)        \
+    FTL_TFIELD_INT(ctx, ci_uint32, dump_free_i, ORM_OUTPUT_STACK)         \
+    FTL_TFIELD_INT(ctx, ci_uint32, dump_filter_len, ORM_OUTPUT_STACK)     \
   ) \
   FTL_TFIELD_STRUCT(ctx, ef_vi_stats, vi_stats, ORM_OUTPUT_STACK) \
   FTL_TFIELD_INT(ctx, ci_int32, creation_numa_node, ORM_OUTPUT_STACK)     \
@@ -837,6 +845,8 @@ typedef struct oo_sock_cplane oo_sock_cplane_t;
   FTL_TFIELD_INT(ctx, ci_uint32, n_rx_mem_drop, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))    \
   FTL_TFIELD_INT(ctx, ci_uint32, n_rx_pktinfo, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))     \
   FTL_TFIELD_INT(ctx, ci_uint32, max_recvq_pkts, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))  \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_rx_gro, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))         \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_rx_gro_segs, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))    \
   FTL_TFIELD_INT(ctx, ci_uint32, n_tx_os, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))          \
   FTL_TFIELD_INT(ctx, ci_uint32, n_tx_os_slow, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))     \
   FTL_TFIELD_INT(ctx, ci_uint32, n_tx_onload_c, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))    \
@@ -859,6 +869,12 @@ typedef struct oo_sock_cplane oo_sock_cplane_t;
   FTL_TFIELD_INT(ctx, ci_uint32, n_tx_msg_confirm, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
   FTL_TFIELD_INT(ctx, ci_uint32, n_tx_os_late, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))     \
   FTL_TFIELD_INT(ctx, ci_uint32, n_tx_unconnect_late, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_tx_gso, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))         \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_tx_gso_segs, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))    \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_tx_mmsg, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))        \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_tx_mmsg_dgrams, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_tx_txtime, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))      \
+  FTL_TFIELD_INT(ctx, ci_uint32, n_tx_txtime_drop, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
   FTL_TSTRUCT_END(ctx)
 
 typedef struct oo_tcp_socket_stats oo_tcp_socket_stats;
@@ -874,6 +890,8 @@ typedef struct oo_tcp_socket_stats oo_tcp_socket_stats;
   ON_CI_CFG_BURST_CONTROL(                                              \
      FTL_TFIELD_INT(ctx, ci_uint32, tx_stop_burst, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
                                                                         ) \
+  FTL_TFIELD_INT(ctx, ci_uint32, tx_stop_pacing, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))   \
+  FTL_TFIELD_INT(ctx, ci_uint32, tx_pacing_held_us, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_nomac_defer, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))   \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_defer, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))         \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_msg_warm_abort, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
@@ -922,6 +940,9 @@ typedef struct oo_tcp_socket_stats oo_tcp_socket_stats;
   FTL_TFIELD_INT(ctx, ci_int32, tx_async_q, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))               \
   FTL_TFIELD_INT(ctx, oo_atomic_t, tx_async_q_level, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))        \
   FTL_TFIELD_INT(ctx, ci_uint32, tx_count, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))                \
+  FTL_TFIELD_INT(ctx, ci_uint16, gso_size, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))                \
+  FTL_TFIELD_INT(ctx, ci_int16, txtime_clockid, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))           \
+  FTL_TFIELD_INT(ctx, ci_uint16, txtime_flags, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))            \
   FTL_TFIELD_STRUCT(ctx, ci_udp_socket_stats, stats, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))      \
   FTL_TSTRUCT_END(ctx)
 
@@ -995,6 +1016,8 @@ typedef struct oo_tcp_socket_stats oo_tcp_socket_stats;
     FTL_TFIELD_INT(ctx, ci_iptime_t, t_ka_intvl_in_secs, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS)) \
     FTL_TFIELD_INT(ctx, ci_uint16, user_mss, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))               \
     FTL_TFIELD_INT(ctx, ci_uint8, tcp_defer_accept, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))	      \
+    FTL_TFIELD_INT(ctx, ci_uint8, cong_alg, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))               \
+    FTL_TFIELD_INT(ctx, ci_uint64, max_pacing_rate, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))        \
     FTL_TSTRUCT_END(ctx)
 
 #define STRUCT_TCP(ctx) \
@@ -1099,6 +1122,9 @@ typedef struct oo_tcp_socket_stats oo_tcp_socket_stats;
       FTL_TFIELD_STRUCT(ctx, ci_ip_timer, stats_tid, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))            \
     )                                                                         \
     FTL_TFIELD_STRUCT(ctx, ci_ip_timer, cork_tid, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))               \
+    FTL_TFIELD_STRUCT(ctx, ci_ip_timer, pacing_tid, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))             \
+    FTL_TFIELD_INT(ctx, ci_uint64, pacing_edt, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))                  \
+    FTL_TFIELD_INT(ctx, ci_uint64, pacing_hold_frc, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))             \
     ON_CI_CFG_TCP_SOCK_STATS(                                                 \
       FTL_TFIELD_STRUCT(ctx, ci_ip_sock_stats, stats_snapshot, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))  \
       FTL_TFIELD_STRUCT(ctx, ci_ip_sock_stats, stats_cumulative, (ORM_OUTPUT_STACK | ORM_OUTPUT_SOCKETS))\
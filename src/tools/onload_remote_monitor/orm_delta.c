@@ -0,0 +1,1066 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/**************************************************************************\
+*//*! \file
+** <L5_PRIVATE L5_SOURCE>
+**  \brief  Delta-encoded binary stream of Onload stack and socket counters.
+** </L5_PRIVATE>
+*//*
+\**************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <ci/internal/ip.h>
+#include <onload/ioctl.h>
+#include <onload/driveraccess.h>
+#include <onload/debug_intf.h>
+#include <onload/ul.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <limits.h>
+
+#include "ftl_defs.h"
+#include "../ip/sockbuf_filter.h"
+#include <ci/internal/more_stats.h>
+#include "orm_json_lib.h"
+#include "orm_delta.h"
+
+
+#define LOG(...) fprintf(stderr, __VA_ARGS__)
+
+/* Most bytes taken by a varint, and by one (gap, delta) pair. */
+#define ORM_DELTA_VARINT_MAX  10
+#define ORM_DELTA_CHANGE_MAX  (2 * ORM_DELTA_VARINT_MAX)
+/* Most bytes taken by the header of a record. */
+#define ORM_DELTA_REC_HDR_MAX (1 + 2 * ORM_DELTA_VARINT_MAX)
+
+/**********************************************************/
+/* Counter tables */
+/**********************************************************/
+
+/* The socket counters are those that orm_json gives for each socket, and
+ * come from the same FTL definitions.  [ctx] selects what each counter
+ * expands to. */
+#define FTL_TSTRUCT_BEGIN(ctx, name, tag)
+#define FTL_TSTRUCT_END(ctx)
+#define FTL_TFIELD_INT(ctx, type, field_name, display_flags) \
+  ORM_DELTA_##ctx(field_name)
+
+#define ORM_DELTA_COUNT(name)  + 1
+#define ORM_DELTA_NAME(name)   { #name, 'c' },
+
+#define OO_STAT_KIND_count      'c'
+#define OO_STAT_KIND_count_zero 'c'
+#define OO_STAT_KIND_val        'v'
+
+enum {
+  ORM_DELTA_N_STATS = 0
+#define OO_STAT(desc, type, name, kind)  + 1
+#include <ci/internal/stats_def.h>
+  ,
+  ORM_DELTA_N_MORE_STATS = 0
+#include <ci/internal/more_stats_def.h>
+  ,
+  ORM_DELTA_N_TCP_STATS = 0
+#include <ci/internal/tcp_stats_count_def.h>
+  ,
+  ORM_DELTA_N_TCP_EXT_STATS = 0
+#include <ci/internal/tcp_ext_stats_count_def.h>
+#undef OO_STAT
+  ,
+  ORM_DELTA_N_TCP_SOCKET = 0 STRUCT_TCP_SOCKET_STATS(COUNT),
+  ORM_DELTA_N_UDP_SOCKET = 0 STRUCT_UDP_SOCKET_STATS(COUNT),
+};
+
+struct orm_delta_counter {
+  const char* name;
+  char        kind;  /* 'c' for a counter, 'v' for a level */
+};
+
+#define OO_STAT(desc, type, name, kind)  { #name, OO_STAT_KIND_##kind },
+static const struct orm_delta_counter orm_delta_stats_names[] = {
+#include <ci/internal/stats_def.h>
+};
+static const struct orm_delta_counter orm_delta_more_stats_names[] = {
+#include <ci/internal/more_stats_def.h>
+};
+static const struct orm_delta_counter orm_delta_tcp_stats_names[] = {
+#include <ci/internal/tcp_stats_count_def.h>
+};
+static const struct orm_delta_counter orm_delta_tcp_ext_stats_names[] = {
+#include <ci/internal/tcp_ext_stats_count_def.h>
+};
+#undef OO_STAT
+static const struct orm_delta_counter orm_delta_tcp_socket_names[] = {
+  STRUCT_TCP_SOCKET_STATS(NAME)
+};
+static const struct orm_delta_counter orm_delta_udp_socket_names[] = {
+  STRUCT_UDP_SOCKET_STATS(NAME)
+};
+
+static const struct {
+  const char* name;
+  const struct orm_delta_counter* counters;
+  unsigned n_counters;
+} orm_delta_groups[ORM_DELTA_N_GROUPS] = {
+#define ORM_DELTA_GROUP(id, name, n)                                    \
+  [id] = { #name, orm_delta_##name##_names, (n) }
+  ORM_DELTA_GROUP(ORM_DELTA_STATS, stats, ORM_DELTA_N_STATS),
+  ORM_DELTA_GROUP(ORM_DELTA_MORE_STATS, more_stats, ORM_DELTA_N_MORE_STATS),
+  ORM_DELTA_GROUP(ORM_DELTA_TCP_STATS, tcp_stats, ORM_DELTA_N_TCP_STATS),
+  ORM_DELTA_GROUP(ORM_DELTA_TCP_EXT_STATS, tcp_ext_stats,
+                  ORM_DELTA_N_TCP_EXT_STATS),
+  ORM_DELTA_GROUP(ORM_DELTA_TCP_SOCKET, tcp_socket, ORM_DELTA_N_TCP_SOCKET),
+  ORM_DELTA_GROUP(ORM_DELTA_UDP_SOCKET, udp_socket, ORM_DELTA_N_UDP_SOCKET),
+#undef ORM_DELTA_GROUP
+};
+
+
+/**********************************************************/
+/* Encoding */
+/**********************************************************/
+
+static void orm_delta_reserve(struct orm_delta_buf* b, size_t n)
+{
+  if( b->len + n > b->cap ) {
+    size_t cap = CI_MAX(CI_MAX(b->cap * 2, b->len + n), (size_t) 4096);
+    b->data = realloc(b->data, cap);
+    CI_TEST(b->data != NULL);
+    b->cap = cap;
+  }
+}
+
+
+static inline ci_uint8* orm_delta_put_varint(ci_uint8* p, ci_uint64 v)
+{
+  while( v >= 0x80 ) {
+    *p++ = (ci_uint8) v | 0x80;
+    v >>= 7;
+  }
+  *p++ = (ci_uint8) v;
+  return p;
+}
+
+
+static inline ci_uint8* orm_delta_put_str(ci_uint8* p, const char* s,
+                                          size_t len)
+{
+  p = orm_delta_put_varint(p, len);
+  memcpy(p, s, len);
+  return p + len;
+}
+
+
+static inline ci_uint8* orm_delta_put_le(ci_uint8* p, ci_uint64 v, int len)
+{
+  int i;
+  for( i = 0; i < len; ++i, v >>= 8 )
+    *p++ = (ci_uint8) v;
+  return p;
+}
+
+
+/* Encode counter [idx] as having changed by [delta]. */
+static inline ci_uint8* orm_delta_put_change(ci_uint8* p, int idx, int* last,
+                                             ci_uint64 delta)
+{
+  p = orm_delta_put_varint(p, idx - *last);
+  p = orm_delta_put_varint(p, (delta << 1) ^ (0 - (delta >> 63)));
+  *last = idx;
+  return p;
+}
+
+
+/* The body of each encoder below.  The record header goes at [p], and each
+ * counter in [cur] that differs from [old] adds a change after it.  The
+ * record is kept only if something changed. */
+#define ORM_DELTA_CHANGES_BEGIN(b, n_counters)                          \
+  ci_uint8* p;                                                          \
+  int idx = 0, last = -1;                                               \
+  orm_delta_reserve((b), ORM_DELTA_REC_HDR_MAX +                        \
+                    (n_counters) * ORM_DELTA_CHANGE_MAX + 1);           \
+  p = (b)->data + (b)->len;
+
+#define ORM_DELTA_FIELD(name)                                           \
+  do {                                                                  \
+    ci_uint64 v = OO_ACCESS_ONCE(cur->name);                            \
+    if( v != (ci_uint64) old->name ) {                                  \
+      p = orm_delta_put_change(p, idx, &last, v - old->name);           \
+      old->name = v;                                                    \
+    }                                                                   \
+    ++idx;                                                              \
+  } while( 0 );
+
+#define ORM_DELTA_CHANGES_END(b)                                        \
+  if( last >= 0 ) {                                                     \
+    *p++ = 0;                                                           \
+    (b)->len = p - (b)->data;                                           \
+  }
+
+
+void orm_delta_msg_begin(struct orm_delta_buf* b, int type, ci_uint32 seq,
+                         ci_uint64 time_ns)
+{
+  ci_uint8* p;
+
+  b->len = 0;
+  orm_delta_reserve(b, ORM_DELTA_HDR_LEN);
+  p = b->data;
+  p = orm_delta_put_le(p, ORM_DELTA_MAGIC, 4);
+  *p++ = ORM_DELTA_VERSION;
+  *p++ = type;
+  p = orm_delta_put_le(p, 0, 2);
+  p = orm_delta_put_le(p, seq, 4);
+  p = orm_delta_put_le(p, time_ns, 8);
+  b->len = p - b->data;
+}
+
+
+void orm_delta_msg_end(struct orm_delta_buf* b)
+{
+  orm_delta_reserve(b, 1);
+  b->data[b->len++] = ORM_DELTA_REC_END;
+}
+
+
+/* Schema body: the number of groups, then for each its name, the number of
+ * counters, and the name and kind of each. */
+void orm_delta_schema(struct orm_delta_buf* b)
+{
+  ci_uint8* p;
+  int g;
+  unsigned i;
+
+  orm_delta_reserve(b, ORM_DELTA_VARINT_MAX);
+  p = orm_delta_put_varint(b->data + b->len, ORM_DELTA_N_GROUPS);
+  b->len = p - b->data;
+  for( g = 0; g < ORM_DELTA_N_GROUPS; ++g ) {
+    const char* name = orm_delta_groups[g].name;
+    orm_delta_reserve(b, 2 * ORM_DELTA_VARINT_MAX + strlen(name));
+    p = orm_delta_put_str(b->data + b->len, name, strlen(name));
+    p = orm_delta_put_varint(p, orm_delta_groups[g].n_counters);
+    b->len = p - b->data;
+    for( i = 0; i < orm_delta_groups[g].n_counters; ++i ) {
+      const struct orm_delta_counter* c = &orm_delta_groups[g].counters[i];
+      orm_delta_reserve(b, ORM_DELTA_VARINT_MAX + strlen(c->name) + 1);
+      p = orm_delta_put_str(b->data + b->len, c->name, strlen(c->name));
+      *p++ = c->kind;
+      b->len = p - b->data;
+    }
+  }
+}
+
+
+void orm_delta_stack(struct orm_delta_buf* b, int stack_id, const char* name)
+{
+  size_t name_len = strnlen(name, CI_CFG_STACK_NAME_LEN);
+  ci_uint8* p;
+
+  orm_delta_reserve(b, 1 + 2 * ORM_DELTA_VARINT_MAX + name_len);
+  p = b->data + b->len;
+  *p++ = ORM_DELTA_REC_STACK;
+  p = orm_delta_put_varint(p, stack_id);
+  p = orm_delta_put_str(p, name, name_len);
+  b->len = p - b->data;
+}
+
+
+void orm_delta_stack_gone(struct orm_delta_buf* b, int stack_id)
+{
+  ci_uint8* p;
+
+  orm_delta_reserve(b, 1 + ORM_DELTA_VARINT_MAX);
+  p = b->data + b->len;
+  *p++ = ORM_DELTA_REC_STACK_GONE;
+  p = orm_delta_put_varint(p, stack_id);
+  b->len = p - b->data;
+}
+
+
+#define OO_STAT(desc, type, name, kind)  ORM_DELTA_FIELD(name)
+
+void orm_delta_stats(struct orm_delta_buf* b, const ci_netif_stats* cur,
+                     ci_netif_stats* old)
+{
+  ORM_DELTA_CHANGES_BEGIN(b, ORM_DELTA_N_STATS);
+  *p++ = ORM_DELTA_REC_COUNTERS;
+  *p++ = ORM_DELTA_STATS;
+#include <ci/internal/stats_def.h>
+  ORM_DELTA_CHANGES_END(b);
+}
+
+
+void orm_delta_more_stats(struct orm_delta_buf* b, const more_stats_t* cur,
+                          more_stats_t* old)
+{
+  ORM_DELTA_CHANGES_BEGIN(b, ORM_DELTA_N_MORE_STATS);
+  *p++ = ORM_DELTA_REC_COUNTERS;
+  *p++ = ORM_DELTA_MORE_STATS;
+#include <ci/internal/more_stats_def.h>
+  ORM_DELTA_CHANGES_END(b);
+}
+
+
+void orm_delta_tcp_stats(struct orm_delta_buf* b,
+                         const ci_tcp_stats_count* cur,
+                         ci_tcp_stats_count* old)
+{
+  ORM_DELTA_CHANGES_BEGIN(b, ORM_DELTA_N_TCP_STATS);
+  *p++ = ORM_DELTA_REC_COUNTERS;
+  *p++ = ORM_DELTA_TCP_STATS;
+#include <ci/internal/tcp_stats_count_def.h>
+  ORM_DELTA_CHANGES_END(b);
+}
+
+
+void orm_delta_tcp_ext_stats(struct orm_delta_buf* b,
+                             const ci_tcp_ext_stats_count* cur,
+                             ci_tcp_ext_stats_count* old)
+{
+  ORM_DELTA_CHANGES_BEGIN(b, ORM_DELTA_N_TCP_EXT_STATS);
+  *p++ = ORM_DELTA_REC_COUNTERS;
+  *p++ = ORM_DELTA_TCP_EXT_STATS;
+#include <ci/internal/tcp_ext_stats_count_def.h>
+  ORM_DELTA_CHANGES_END(b);
+}
+
+#undef OO_STAT
+
+
+void orm_delta_socket_gone(struct orm_delta_buf* b, unsigned sock_id,
+                           struct orm_delta_sock* prev)
+{
+  ci_uint8* p;
+
+  if( prev->group < 0 )
+    return;
+  prev->group = -1;
+  orm_delta_reserve(b, 1 + ORM_DELTA_VARINT_MAX);
+  p = b->data + b->len;
+  *p++ = ORM_DELTA_REC_SOCKET_GONE;
+  p = orm_delta_put_varint(p, sock_id);
+  b->len = p - b->data;
+}
+
+
+/* Most sockets are idle between snapshots, so compare all of a socket's
+ * counters at once before looking at each. */
+static inline int orm_delta_socket_begin(struct orm_delta_buf* b,
+                                         unsigned sock_id, const void* cur,
+                                         size_t len,
+                                         struct orm_delta_sock* prev,
+                                         int group)
+{
+  if( prev->group == group )
+    return memcmp(cur, &prev->prev, len) != 0;
+  orm_delta_socket_gone(b, sock_id, prev);
+  memset(&prev->prev, 0, sizeof(prev->prev));
+  prev->group = group;
+  return 1;
+}
+
+
+void orm_delta_tcp_socket(struct orm_delta_buf* b, unsigned sock_id,
+                          const oo_tcp_socket_stats* cur,
+                          struct orm_delta_sock* prev)
+{
+  oo_tcp_socket_stats* old = &prev->prev.tcp;
+
+  if( ! orm_delta_socket_begin(b, sock_id, cur, sizeof(*cur), prev,
+                               ORM_DELTA_TCP_SOCKET) )
+    return;
+  {
+    ORM_DELTA_CHANGES_BEGIN(b, ORM_DELTA_N_TCP_SOCKET);
+    *p++ = ORM_DELTA_REC_SOCKET;
+    p = orm_delta_put_varint(p, sock_id);
+    *p++ = ORM_DELTA_TCP_SOCKET;
+    STRUCT_TCP_SOCKET_STATS(FIELD)
+    ORM_DELTA_CHANGES_END(b);
+  }
+}
+
+
+void orm_delta_udp_socket(struct orm_delta_buf* b, unsigned sock_id,
+                          const ci_udp_socket_stats* cur,
+                          struct orm_delta_sock* prev)
+{
+  ci_udp_socket_stats* old = &prev->prev.udp;
+
+  if( ! orm_delta_socket_begin(b, sock_id, cur, sizeof(*cur), prev,
+                               ORM_DELTA_UDP_SOCKET) )
+    return;
+  {
+    ORM_DELTA_CHANGES_BEGIN(b, ORM_DELTA_N_UDP_SOCKET);
+    *p++ = ORM_DELTA_REC_SOCKET;
+    p = orm_delta_put_varint(p, sock_id);
+    *p++ = ORM_DELTA_UDP_SOCKET;
+    STRUCT_UDP_SOCKET_STATS(FIELD)
+    ORM_DELTA_CHANGES_END(b);
+  }
+}
+
+
+/**********************************************************/
+/* Publishing from live stacks */
+/**********************************************************/
+
+struct orm_delta_pub_stack {
+  ci_netif               ni;
+  int                    id;
+  int                    seen;
+  ci_netif_stats         stats;
+  more_stats_t           more_stats;
+  ci_tcp_stats_count     tcp_stats;
+  ci_tcp_ext_stats_count tcp_ext_stats;
+  struct orm_delta_sock* socks;
+  unsigned               n_socks;
+};
+
+struct orm_delta_pub {
+  struct orm_cfg               cfg;
+  int                          output_flags;
+  oo_fd                        fd;
+  sockbuf_filter_t             sft;
+  struct orm_delta_pub_stack** stacks;
+  int                          n_stacks;
+  ci_uint32                    seq;
+};
+
+
+struct orm_delta_pub* orm_delta_pub_alloc(const struct orm_cfg* cfg,
+                                          int output_flags)
+{
+  struct orm_delta_pub* pub = calloc(1, sizeof(*pub));
+  int rc;
+
+  if( pub == NULL )
+    return NULL;
+  pub->cfg = *cfg;
+  pub->output_flags = output_flags;
+  if( cfg->filter && ! sockbuf_filter_prepare(&pub->sft, cfg->filter) ) {
+    free(pub);
+    return NULL;
+  }
+  if( (rc = oo_fd_open(&pub->fd)) != 0 ) {
+    LOG("%s: Fail: oo_fd_open()=%d.  Onload drivers loaded?\n",
+        __func__, rc);
+    sockbuf_filter_free(&pub->sft);
+    free(pub);
+    return NULL;
+  }
+  return pub;
+}
+
+
+static void orm_delta_pub_unmap(struct orm_delta_pub_stack* s)
+{
+  int fd = ci_netif_get_driver_handle(&s->ni);
+  ci_netif_dtor(&s->ni);
+  ef_onload_driver_close(fd);
+  free(s->socks);
+  free(s);
+}
+
+
+void orm_delta_pub_free(struct orm_delta_pub* pub)
+{
+  int i;
+  for( i = 0; i < pub->n_stacks; ++i )
+    orm_delta_pub_unmap(pub->stacks[i]);
+  free(pub->stacks);
+  oo_fd_close(pub->fd);
+  sockbuf_filter_free(&pub->sft);
+  free(pub);
+}
+
+
+static struct orm_delta_pub_stack*
+orm_delta_pub_find(struct orm_delta_pub* pub, int stack_id)
+{
+  int i;
+
+  for( i = 0; i < pub->n_stacks; ++i )
+    if( pub->stacks[i]->id == stack_id )
+      return pub->stacks[i];
+  return NULL;
+}
+
+
+static struct orm_delta_pub_stack*
+orm_delta_pub_map(struct orm_delta_pub* pub, int stack_id)
+{
+  struct orm_delta_pub_stack** stacks;
+  struct orm_delta_pub_stack* s;
+  int rc;
+
+  stacks = realloc(pub->stacks, (pub->n_stacks + 1) * sizeof(*stacks));
+  if( stacks == NULL )
+    return NULL;
+  pub->stacks = stacks;
+  if( (s = calloc(1, sizeof(*s))) == NULL )
+    return NULL;
+  if( (rc = ci_netif_restore_id(&s->ni, stack_id, true)) != 0 ) {
+    LOG("%s: Fail: ci_netif_restore_id(%d)=%d\n", __func__, stack_id, rc);
+    free(s);
+    return NULL;
+  }
+  s->id = stack_id;
+  pub->stacks[pub->n_stacks++] = s;
+  return s;
+}
+
+
+/* Find the stacks that exist now, mapping new ones that --name selects.
+ *
+ * Our mapping keeps a stack alive, so as onload_tcpdump does we look at
+ * the number of users: when we are the only one left the stack is treated
+ * as gone and unmapped, rather than being kept until we exit.
+ */
+static int orm_delta_pub_scan(struct orm_delta_pub* pub)
+{
+  ci_netif_info_t info;
+  int i, rc;
+
+  for( i = 0; i < pub->n_stacks; ++i )
+    pub->stacks[i]->seen = 0;
+
+  memset(&info, 0, sizeof(info));
+  i = 0;
+  while( i >= 0 ) {
+    info.ni_index = i;
+    info.ni_orphan = 0;
+    info.ni_subop = CI_DBG_NETIF_INFO_GET_NEXT_NETIF;
+    if( (rc = oo_ioctl(pub->fd, OO_IOC_DBG_GET_STACK_INFO, &info)) != 0 ) {
+      LOG("%s: Fail: oo_ioctl(OO_IOC_DBG_GET_STACK_INFO)=%d.\n",
+          __func__, rc);
+      return rc;
+    }
+    if( info.ni_exists ) {
+      struct orm_delta_pub_stack* s = orm_delta_pub_find(pub, info.ni_index);
+      if( s != NULL ) {
+        /* Our own mapping accounts for two references. */
+        s->seen = info.rs_ref_count != 2;
+      }
+      else if( info.rs_ref_count != 0 &&
+               (pub->cfg.stackname == NULL ||
+                strcmp(pub->cfg.stackname, info.ni_name) == 0) ) {
+        if( (s = orm_delta_pub_map(pub, info.ni_index)) != NULL )
+          s->seen = 1;
+      }
+    }
+    i = info.u.ni_next_ni.index;
+  }
+  return 0;
+}
+
+
+static void orm_delta_pub_sockets(struct orm_delta_pub* pub,
+                                  struct orm_delta_pub_stack* s,
+                                  struct orm_delta_buf* b)
+{
+  ci_netif* ni = &s->ni;
+  unsigned n = ni->state->n_ep_bufs;
+  unsigned id;
+
+  if( n > s->n_socks ) {
+    struct orm_delta_sock* socks = realloc(s->socks, n * sizeof(*socks));
+    CI_TEST(socks != NULL);
+    for( id = s->n_socks; id < n; ++id )
+      socks[id].group = -1;
+    s->socks = socks;
+    s->n_socks = n;
+  }
+
+  for( id = 0; id < n; ++id ) {
+    citp_waitable_obj* wo = ID_TO_WAITABLE_OBJ(ni, id);
+    unsigned state = wo->waitable.state;
+
+    if( state != CI_TCP_STATE_FREE && (state & CI_TCP_STATE_TCP) &&
+        state != CI_TCP_LISTEN && sockbuf_filter_matches(&pub->sft, wo) )
+      orm_delta_tcp_socket(b, id, &wo->tcp.stats, &s->socks[id]);
+    else if( state == CI_TCP_STATE_UDP &&
+             sockbuf_filter_matches(&pub->sft, wo) )
+      orm_delta_udp_socket(b, id, &wo->udp.stats, &s->socks[id]);
+    else
+      orm_delta_socket_gone(b, id, &s->socks[id]);
+  }
+}
+
+
+static void orm_delta_pub_encode_stack(struct orm_delta_pub* pub,
+                                       struct orm_delta_pub_stack* s,
+                                       int key, struct orm_delta_buf* b)
+{
+  ci_netif* ni = &s->ni;
+  int flags = pub->output_flags;
+  size_t len0 = b->len, len1;
+  unsigned i;
+
+  if( key ) {
+    memset(&s->stats, 0, sizeof(s->stats));
+    memset(&s->more_stats, 0, sizeof(s->more_stats));
+    memset(&s->tcp_stats, 0, sizeof(s->tcp_stats));
+    memset(&s->tcp_ext_stats, 0, sizeof(s->tcp_ext_stats));
+    for( i = 0; i < s->n_socks; ++i )
+      s->socks[i].group = -1;
+  }
+
+  orm_delta_stack(b, s->id, ni->state->name);
+  len1 = b->len;
+  if( flags & ORM_OUTPUT_STATS )
+    orm_delta_stats(b, &ni->state->stats, &s->stats);
+  if( flags & ORM_OUTPUT_MORE_STATS ) {
+    more_stats_t more_stats;
+    get_more_stats(ni, &more_stats);
+    orm_delta_more_stats(b, &more_stats, &s->more_stats);
+  }
+  if( flags & ORM_OUTPUT_TCP_STATS_COUNT )
+    orm_delta_tcp_stats(b, &ni->state->stats_snapshot.tcp, &s->tcp_stats);
+  if( flags & ORM_OUTPUT_TCP_EXT_STATS_COUNT )
+    orm_delta_tcp_ext_stats(b, &ni->state->stats_snapshot.tcp_ext,
+                            &s->tcp_ext_stats);
+  if( flags & ORM_OUTPUT_SOCKETS )
+    orm_delta_pub_sockets(pub, s, b);
+
+  /* Key frames name every stack; deltas only those that changed. */
+  if( ! key && b->len == len1 )
+    b->len = len0;
+}
+
+
+int orm_delta_pub_snapshot(struct orm_delta_pub* pub, int type,
+                           struct orm_delta_buf* b)
+{
+  struct timespec ts;
+  int i, rc;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  if( type == ORM_DELTA_MSG_SCHEMA ) {
+    orm_delta_msg_begin(b, type, 0, ts.tv_sec * 1000000000ull + ts.tv_nsec);
+    orm_delta_schema(b);
+    return 0;
+  }
+
+  if( (rc = orm_delta_pub_scan(pub)) != 0 )
+    return rc;
+  orm_delta_msg_begin(b, type, pub->seq++,
+                      ts.tv_sec * 1000000000ull + ts.tv_nsec);
+
+  for( i = 0; i < pub->n_stacks; ) {
+    struct orm_delta_pub_stack* s = pub->stacks[i];
+    if( ! s->seen ) {
+      if( type != ORM_DELTA_MSG_KEY )
+        orm_delta_stack_gone(b, s->id);
+      orm_delta_pub_unmap(s);
+      pub->stacks[i] = pub->stacks[--pub->n_stacks];
+      continue;
+    }
+    orm_delta_pub_encode_stack(pub, s, type == ORM_DELTA_MSG_KEY, b);
+    ++i;
+  }
+
+  orm_delta_msg_end(b);
+  return 0;
+}
+
+
+/**********************************************************/
+/* Decoding */
+/**********************************************************/
+
+struct orm_delta_dec_group {
+  char*     name;
+  unsigned  n_counters;
+  char**    counters;
+};
+
+struct orm_delta_dec_sock {
+  int        group;
+  ci_uint64* val;
+};
+
+struct orm_delta_dec_stack {
+  int                        id;
+  ci_uint64*                 val[ORM_DELTA_N_GROUPS];
+  struct orm_delta_dec_sock* socks;
+  unsigned                   n_socks;
+};
+
+struct orm_delta_dec {
+  /* The body of the schema message, which [groups] points into. */
+  ci_uint8*                   schema;
+  size_t                      schema_len;
+  struct orm_delta_dec_group  groups[ORM_DELTA_N_GROUPS];
+  int                         n_groups;
+  int                         synced;
+  ci_uint32                   seq;
+  struct orm_delta_dec_stack* stacks;
+  int                         n_stacks;
+};
+
+struct orm_delta_rd {
+  const ci_uint8* p;
+  const ci_uint8* end;
+  int             err;
+};
+
+
+static ci_uint64 orm_delta_rd_varint(struct orm_delta_rd* r)
+{
+  ci_uint64 v = 0;
+  int shift;
+
+  for( shift = 0; shift < 64 && r->p < r->end; shift += 7 ) {
+    ci_uint8 c = *r->p++;
+    v |= (ci_uint64) (c & 0x7f) << shift;
+    if( ! (c & 0x80) )
+      return v;
+  }
+  r->err = 1;
+  return 0;
+}
+
+
+static ci_uint64 orm_delta_rd_le(struct orm_delta_rd* r, int len)
+{
+  ci_uint64 v = 0;
+  int i;
+
+  if( r->end - r->p < len ) {
+    r->err = 1;
+    return 0;
+  }
+  for( i = 0; i < len; ++i )
+    v |= (ci_uint64) *r->p++ << (8 * i);
+  return v;
+}
+
+
+/* Returns a pointer to the string, which is not terminated, in the
+ * message. */
+static const char* orm_delta_rd_str(struct orm_delta_rd* r, size_t* len_out)
+{
+  ci_uint64 len = orm_delta_rd_varint(r);
+  const char* s = (const char*) r->p;
+
+  if( r->err || len > (ci_uint64) (r->end - r->p) ) {
+    r->err = 1;
+    return NULL;
+  }
+  r->p += len;
+  *len_out = len;
+  return s;
+}
+
+
+struct orm_delta_dec* orm_delta_dec_alloc(void)
+{
+  return calloc(1, sizeof(struct orm_delta_dec));
+}
+
+
+static void orm_delta_dec_stack_free(struct orm_delta_dec_stack* s)
+{
+  unsigned i;
+  for( i = 0; i < ORM_DELTA_N_GROUPS; ++i )
+    free(s->val[i]);
+  for( i = 0; i < s->n_socks; ++i )
+    free(s->socks[i].val);
+  free(s->socks);
+}
+
+
+static void orm_delta_dec_reset(struct orm_delta_dec* dec)
+{
+  int i;
+  for( i = 0; i < dec->n_stacks; ++i )
+    orm_delta_dec_stack_free(&dec->stacks[i]);
+  free(dec->stacks);
+  dec->stacks = NULL;
+  dec->n_stacks = 0;
+  dec->synced = 0;
+}
+
+
+static void orm_delta_dec_schema_free(struct orm_delta_dec* dec)
+{
+  int g;
+  for( g = 0; g < dec->n_groups; ++g )
+    free(dec->groups[g].counters);
+  free(dec->schema);
+  dec->schema = NULL;
+  dec->schema_len = 0;
+  dec->n_groups = 0;
+}
+
+
+void orm_delta_dec_free(struct orm_delta_dec* dec)
+{
+  orm_delta_dec_reset(dec);
+  orm_delta_dec_schema_free(dec);
+  free(dec);
+}
+
+
+/* Names are kept in a copy of the message, each terminated in place of the
+ * byte that follows it. */
+static int orm_delta_dec_schema(struct orm_delta_dec* dec,
+                                const ci_uint8* body, size_t len)
+{
+  struct orm_delta_rd r;
+  ci_uint64 n_groups;
+  int g;
+
+  if( dec->schema != NULL && len == dec->schema_len &&
+      memcmp(body, dec->schema, len) == 0 )
+    return 0;
+
+  orm_delta_dec_reset(dec);
+  orm_delta_dec_schema_free(dec);
+  if( (dec->schema = malloc(len)) == NULL )
+    return -ENOMEM;
+  memcpy(dec->schema, body, len);
+  dec->schema_len = len;
+  /* Parse a second copy, so that we can write to the first. */
+  r = (struct orm_delta_rd) { body, body + len, 0 };
+
+  n_groups = orm_delta_rd_varint(&r);
+  if( r.err || n_groups > ORM_DELTA_N_GROUPS )
+    goto bad;
+  for( g = 0; g < (int) n_groups; ++g ) {
+    struct orm_delta_dec_group* grp = &dec->groups[g];
+    size_t name_len;
+    const char* name = orm_delta_rd_str(&r, &name_len);
+    ci_uint64 n, i;
+
+    n = orm_delta_rd_varint(&r);
+    if( r.err || n > r.end - r.p )
+      goto bad;
+    /* The name is followed by the counter count, which we have read. */
+    grp->name = (char*) dec->schema + (name - (const char*) body);
+    grp->counters = calloc(n, sizeof(char*));
+    if( grp->counters == NULL )
+      goto bad;
+    grp->n_counters = n;
+    dec->n_groups = g + 1;
+    for( i = 0; i < n; ++i ) {
+      size_t clen;
+      const char* c = orm_delta_rd_str(&r, &clen);
+      orm_delta_rd_le(&r, 1);
+      if( r.err )
+        goto bad;
+      grp->counters[i] = (char*) dec->schema + (c - (const char*) body);
+      grp->counters[i][clen] = '\0';
+    }
+    grp->name[name_len] = '\0';
+  }
+  if( r.p != r.end )
+    goto bad;
+  return 0;
+
+ bad:
+  orm_delta_dec_schema_free(dec);
+  return -EPROTO;
+}
+
+
+static struct orm_delta_dec_stack*
+orm_delta_dec_find_stack(struct orm_delta_dec* dec, int id)
+{
+  struct orm_delta_dec_stack* stacks;
+  int i;
+
+  for( i = 0; i < dec->n_stacks; ++i )
+    if( dec->stacks[i].id == id )
+      return &dec->stacks[i];
+  stacks = realloc(dec->stacks, (dec->n_stacks + 1) * sizeof(*stacks));
+  if( stacks == NULL )
+    return NULL;
+  dec->stacks = stacks;
+  memset(&stacks[dec->n_stacks], 0, sizeof(stacks[0]));
+  stacks[dec->n_stacks].id = id;
+  return &stacks[dec->n_stacks++];
+}
+
+
+static int orm_delta_dec_changes(struct orm_delta_dec* dec,
+                                 struct orm_delta_rd* r, int stack_id,
+                                 int sock_id, int group, ci_uint64** val_p,
+                                 orm_delta_change_fn* fn, void* arg)
+{
+  struct orm_delta_dec_group* grp = &dec->groups[group];
+  ci_uint64* val = *val_p;
+  ci_uint64 idx = (ci_uint64) -1;
+
+  if( val == NULL ) {
+    if( (val = calloc(grp->n_counters + 1, sizeof(*val))) == NULL )
+      return -ENOMEM;
+    *val_p = val;
+  }
+  while( 1 ) {
+    ci_uint64 gap = orm_delta_rd_varint(r);
+    ci_uint64 z, delta;
+    if( r->err )
+      return -EPROTO;
+    if( gap == 0 )
+      return 0;
+    z = orm_delta_rd_varint(r);
+    idx += gap;
+    if( r->err || idx >= grp->n_counters )
+      return -EPROTO;
+    delta = (z >> 1) ^ (0 - (z & 1));
+    val[idx] += delta;
+    fn(arg, stack_id, sock_id, grp->name, grp->counters[idx], val[idx],
+       (ci_int64) delta);
+  }
+}
+
+
+static int orm_delta_dec_records(struct orm_delta_dec* dec,
+                                 struct orm_delta_rd* r,
+                                 orm_delta_change_fn* fn, void* arg)
+{
+  struct orm_delta_dec_stack* s = NULL;
+  int i, rc;
+
+  while( 1 ) {
+    ci_uint64 type = orm_delta_rd_varint(r);
+    ci_uint64 id, group;
+    size_t len;
+
+    if( r->err )
+      return -EPROTO;
+    switch( type ) {
+    case ORM_DELTA_REC_END:
+      return r->p == r->end ? 0 : -EPROTO;
+
+    case ORM_DELTA_REC_STACK:
+      id = orm_delta_rd_varint(r);
+      orm_delta_rd_str(r, &len);
+      if( r->err || id > INT_MAX )
+        return -EPROTO;
+      if( (s = orm_delta_dec_find_stack(dec, id)) == NULL )
+        return -ENOMEM;
+      break;
+
+    case ORM_DELTA_REC_STACK_GONE:
+      id = orm_delta_rd_varint(r);
+      if( r->err )
+        return -EPROTO;
+      for( i = 0; i < dec->n_stacks; ++i )
+        if( dec->stacks[i].id == id ) {
+          orm_delta_dec_stack_free(&dec->stacks[i]);
+          dec->stacks[i] = dec->stacks[--dec->n_stacks];
+          fn(arg, id, -1, NULL, NULL, 0, 0);
+          break;
+        }
+      s = NULL;
+      break;
+
+    case ORM_DELTA_REC_COUNTERS:
+      group = orm_delta_rd_varint(r);
+      if( r->err || s == NULL || group >= dec->n_groups )
+        return -EPROTO;
+      rc = orm_delta_dec_changes(dec, r, s->id, -1, group, &s->val[group],
+                                 fn, arg);
+      if( rc != 0 )
+        return rc;
+      break;
+
+    case ORM_DELTA_REC_SOCKET: {
+      struct orm_delta_dec_sock* sock;
+      id = orm_delta_rd_varint(r);
+      group = orm_delta_rd_varint(r);
+      /* Bound the id by what a stack can hold, as it sizes the table. */
+      if( r->err || s == NULL || group >= dec->n_groups ||
+          id >= CI_CFG_NETIF_MAX_ENDPOINTS_MAX )
+        return -EPROTO;
+      if( id >= s->n_socks ) {
+        unsigned n = CI_MAX(id + 1, s->n_socks * 2);
+        sock = realloc(s->socks, n * sizeof(*sock));
+        if( sock == NULL )
+          return -ENOMEM;
+        memset(sock + s->n_socks, 0, (n - s->n_socks) * sizeof(*sock));
+        s->socks = sock;
+        s->n_socks = n;
+      }
+      sock = &s->socks[id];
+      if( sock->val != NULL && sock->group != group ) {
+        free(sock->val);
+        sock->val = NULL;
+      }
+      sock->group = group;
+      rc = orm_delta_dec_changes(dec, r, s->id, id, group, &sock->val,
+                                 fn, arg);
+      if( rc != 0 )
+        return rc;
+      break;
+    }
+
+    case ORM_DELTA_REC_SOCKET_GONE:
+      id = orm_delta_rd_varint(r);
+      if( r->err || s == NULL )
+        return -EPROTO;
+      if( id < s->n_socks && s->socks[id].val != NULL ) {
+        free(s->socks[id].val);
+        s->socks[id].val = NULL;
+        fn(arg, s->id, id, NULL, NULL, 0, 0);
+      }
+      break;
+
+    default:
+      return -EPROTO;
+    }
+  }
+}
+
+
+int orm_delta_dec_msg(struct orm_delta_dec* dec, const void* msg, size_t len,
+                      orm_delta_change_fn* fn, void* arg)
+{
+  struct orm_delta_rd r = { msg, (const ci_uint8*) msg + len, 0 };
+  ci_uint32 magic, seq;
+  int version, type, rc;
+
+  magic = orm_delta_rd_le(&r, 4);
+  version = orm_delta_rd_le(&r, 1);
+  type = orm_delta_rd_le(&r, 1);
+  orm_delta_rd_le(&r, 2);
+  seq = orm_delta_rd_le(&r, 4);
+  orm_delta_rd_le(&r, 8);
+  if( r.err || magic != ORM_DELTA_MAGIC || version != ORM_DELTA_VERSION )
+    return -EPROTO;
+
+  switch( type ) {
+  case ORM_DELTA_MSG_SCHEMA:
+    return orm_delta_dec_schema(dec, r.p, r.end - r.p);
+  case ORM_DELTA_MSG_KEY:
+    if( dec->schema == NULL )
+      return -EAGAIN;
+    orm_delta_dec_reset(dec);
+    break;
+  case ORM_DELTA_MSG_DELTA:
+    if( ! dec->synced )
+      return -EAGAIN;
+    /* We have missed a message, so must wait for the next key frame. */
+    if( seq != dec->seq + 1 ) {
+      orm_delta_dec_reset(dec);
+      return -EAGAIN;
+    }
+    break;
+  default:
+    return -EPROTO;
+  }
+
+  dec->seq = seq;
+  if( (rc = orm_delta_dec_records(dec, &r, fn, arg)) != 0 ) {
+    orm_delta_dec_reset(dec);
+    return rc;
+  }
+  dec->synced = 1;
+  return 0;
+}
@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+
+/* Compact binary stream of Onload counters, sending only the counters that
+ * changed since the previous snapshot.
+ *
+ * A stream is a sequence of messages, each starting with a fixed header:
+ *
+ *   u32 magic, u8 version, u8 type, u16 reserved, u32 seq, u64 time (ns)
+ *
+ * all little-endian.  A SCHEMA message gives the name of each counter in
+ * each group.  A KEY message carries every non-zero counter, and a DELTA
+ * message the change in each counter since the message before it, so a
+ * subscriber needs the schema and a key frame before it can decode deltas,
+ * and must wait for the next key frame if it misses a message.
+ *
+ * The body of KEY and DELTA messages is a list of records, ending with
+ * ORM_DELTA_REC_END.  Numbers are LEB128 varints, and strings a varint
+ * length followed by the bytes:
+ *
+ *   STACK id name          following records are for this stack
+ *   STACK_GONE id          the stack has gone away
+ *   COUNTERS group changes counters of the current stack
+ *   SOCKET id group changes counters of a socket of the current stack
+ *   SOCKET_GONE id         the socket has been freed
+ *
+ * [changes] is a list of (gap, delta) pairs ending with a zero gap, where
+ * [gap] is the index of the counter minus that of the one before it (or -1
+ * for the first) and [delta] the zigzag-encoded change in its value.
+ * Deltas are modulo 2^64, so are exact for counters that wrap.
+ */
+
+#ifndef __ORM_DELTA_H__
+#define __ORM_DELTA_H__
+
+#define ORM_DELTA_MAGIC    0x444d524f  /* "ORMD" */
+#define ORM_DELTA_VERSION  1
+#define ORM_DELTA_HDR_LEN  20
+
+#define ORM_DELTA_MSG_SCHEMA  'S'
+#define ORM_DELTA_MSG_KEY     'K'
+#define ORM_DELTA_MSG_DELTA   'D'
+
+#define ORM_DELTA_REC_END          0
+#define ORM_DELTA_REC_STACK        1
+#define ORM_DELTA_REC_STACK_GONE   2
+#define ORM_DELTA_REC_COUNTERS     3
+#define ORM_DELTA_REC_SOCKET       4
+#define ORM_DELTA_REC_SOCKET_GONE  5
+
+enum orm_delta_group {
+  ORM_DELTA_STATS,
+  ORM_DELTA_MORE_STATS,
+  ORM_DELTA_TCP_STATS,
+  ORM_DELTA_TCP_EXT_STATS,
+  ORM_DELTA_TCP_SOCKET,
+  ORM_DELTA_UDP_SOCKET,
+  ORM_DELTA_N_GROUPS
+};
+
+typedef struct oo_tcp_socket_stats oo_tcp_socket_stats;
+
+struct orm_delta_buf {
+  ci_uint8* data;
+  size_t    len;
+  size_t    cap;
+};
+
+/* Counters of a socket as at the previous snapshot.  [group] is
+ * ORM_DELTA_TCP_SOCKET or ORM_DELTA_UDP_SOCKET, or -1 if the socket was not
+ * in use. */
+struct orm_delta_sock {
+  union {
+    oo_tcp_socket_stats tcp;
+    ci_udp_socket_stats udp;
+  } prev;
+  ci_int8 group;
+};
+
+
+/**********************************************************/
+/* Encoding */
+/**********************************************************/
+
+/* Start a message of [type] in [b], discarding what it held before. */
+extern void orm_delta_msg_begin(struct orm_delta_buf* b, int type,
+                                ci_uint32 seq, ci_uint64 time_ns);
+extern void orm_delta_msg_end(struct orm_delta_buf* b);
+
+/* The names of all counters, as the body of a SCHEMA message. */
+extern void orm_delta_schema(struct orm_delta_buf* b);
+
+extern void orm_delta_stack(struct orm_delta_buf* b, int stack_id,
+                            const char* name);
+extern void orm_delta_stack_gone(struct orm_delta_buf* b, int stack_id);
+
+/* These encode a COUNTERS or SOCKET record for the counters in [cur] that
+ * differ from [prev], and then update [prev].  Nothing is written if none
+ * have changed.  To send every non-zero counter, zero [prev] first. */
+extern void orm_delta_stats(struct orm_delta_buf* b,
+                            const ci_netif_stats* cur, ci_netif_stats* prev);
+extern void orm_delta_more_stats(struct orm_delta_buf* b,
+                                 const more_stats_t* cur, more_stats_t* prev);
+extern void orm_delta_tcp_stats(struct orm_delta_buf* b,
+                                const ci_tcp_stats_count* cur,
+                                ci_tcp_stats_count* prev);
+extern void orm_delta_tcp_ext_stats(struct orm_delta_buf* b,
+                                    const ci_tcp_ext_stats_count* cur,
+                                    ci_tcp_ext_stats_count* prev);
+extern void orm_delta_tcp_socket(struct orm_delta_buf* b, unsigned sock_id,
+                                 const oo_tcp_socket_stats* cur,
+                                 struct orm_delta_sock* prev);
+extern void orm_delta_udp_socket(struct orm_delta_buf* b, unsigned sock_id,
+                                 const ci_udp_socket_stats* cur,
+                                 struct orm_delta_sock* prev);
+/* Send SOCKET_GONE if [prev] was in use. */
+extern void orm_delta_socket_gone(struct orm_delta_buf* b, unsigned sock_id,
+                                  struct orm_delta_sock* prev);
+
+
+/**********************************************************/
+/* Publishing from live stacks */
+/**********************************************************/
+
+struct orm_delta_pub;
+
+/* Stacks are mapped as they appear and stay mapped, so that each snapshot
+ * costs only the walk over the counters. */
+extern struct orm_delta_pub* orm_delta_pub_alloc(const struct orm_cfg* cfg,
+                                                 int output_flags);
+extern void orm_delta_pub_free(struct orm_delta_pub* pub);
+
+/* Encode the next message into [b]: the schema if [type] is
+ * ORM_DELTA_MSG_SCHEMA, or else a snapshot of all stacks.
+ * Returns 0 on success, or negative error code. */
+extern int orm_delta_pub_snapshot(struct orm_delta_pub* pub, int type,
+                                  struct orm_delta_buf* b);
+
+
+/**********************************************************/
+/* Decoding */
+/**********************************************************/
+
+struct orm_delta_dec;
+
+/* Called for each counter that a message changes, with the new value and
+ * the change in it.  [sock_id] is -1 for counters of the stack. */
+typedef void orm_delta_change_fn(void* arg, int stack_id, int sock_id,
+                                 const char* group, const char* counter,
+                                 ci_uint64 value, ci_int64 delta);
+
+extern struct orm_delta_dec* orm_delta_dec_alloc(void);
+extern void orm_delta_dec_free(struct orm_delta_dec* dec);
+
+/* Apply message [msg] to the decoder's copy of the counters.  Returns 0 on
+ * success, -EAGAIN if the message cannot be used until a schema or key
+ * frame arrives, or -EPROTO if it is malformed. */
+extern int orm_delta_dec_msg(struct orm_delta_dec* dec, const void* msg,
+                             size_t len, orm_delta_change_fn* fn, void* arg);
+
+#endif  /* __ORM_DELTA_H__ */
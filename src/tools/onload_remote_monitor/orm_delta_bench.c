@@ -0,0 +1,255 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* SPDX-FileCopyrightText: (c) Copyright 2026 Advanced Micro Devices, Inc. */
+/* orm_delta_bench
+ *
+ * CPU cost of the delta-encoded stats stream of orm_zmq_publisher --delta,
+ * for a stack with a given number of sockets.
+ *
+ *   orm_delta_bench [-a active%] [-s snapshots] [n_sockets...]
+ *
+ * Sockets are synthetic, half TCP and half UDP, so that this needs neither
+ * Onload stacks nor ZMQ.  Between snapshots [active]% of the sockets
+ * (default 1) have some of their counters bumped, as do the stack's own
+ * counters.  For each number of sockets (default 10000 100000 1000000) we
+ * give the CPU time and size of a key frame, and the CPU time to encode and
+ * to decode each delta snapshot and its size.  The total of the decoded
+ * deltas is checked against the total of the increments, and each decoded
+ * value against the counter it came from.
+ */
+
+#define _GNU_SOURCE
+
+#include <ci/internal/ip.h>
+#include <ci/internal/more_stats.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "orm_json_lib.h"
+#include "orm_delta.h"
+
+
+union sock_stats {
+  oo_tcp_socket_stats tcp;
+  ci_udp_socket_stats udp;
+};
+
+static ci_uint64 delta_sum;
+static unsigned n_bad_values;
+
+/* The counters that were encoded, for checking what is decoded. */
+static ci_netif_stats* chk_stats;
+static union sock_stats* chk_socks;
+static unsigned chk_n;
+
+
+static double cpu_sec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/* The current value of the counter [counter] of [sock_id] (or of the stack
+ * if negative).  Only the counters that bump() touches can be non-zero. */
+static int counter_value(int sock_id, const char* counter, ci_uint64* v)
+{
+  if( sock_id < 0 ) {
+    if( ! strcmp(counter, "rx_evs") )
+      *v = chk_stats->rx_evs;
+    else if( ! strcmp(counter, "tx_evs") )
+      *v = chk_stats->tx_evs;
+    else
+      return 0;
+  }
+  else if( (unsigned) sock_id >= chk_n ) {
+    return 0;
+  }
+  else if( sock_id & 1 ) {
+    if( ! strcmp(counter, "n_rx_os") )
+      *v = chk_socks[sock_id].udp.n_rx_os;
+    else if( ! strcmp(counter, "n_tx_onload_uc") )
+      *v = chk_socks[sock_id].udp.n_tx_onload_uc;
+    else
+      return 0;
+  }
+  else {
+    if( ! strcmp(counter, "rx_pkts") )
+      *v = chk_socks[sock_id].tcp.rx_pkts;
+    else if( ! strcmp(counter, "tx_stop_cwnd") )
+      *v = chk_socks[sock_id].tcp.tx_stop_cwnd;
+    else
+      return 0;
+  }
+  return 1;
+}
+
+
+static void on_change(void* arg, int stack_id, int sock_id,
+                      const char* group, const char* counter,
+                      ci_uint64 value, ci_int64 delta)
+{
+  ci_uint64 want;
+
+  delta_sum += delta;
+  if( counter == NULL )  /* the socket or stack has gone */
+    return;
+  if( ! counter_value(sock_id, counter, &want) || value != want ) {
+    if( n_bad_values++ == 0 )
+      fprintf(stderr, "ERROR: socket %d %s.%s decoded as %llu\n",
+              sock_id, group, counter, (unsigned long long) value);
+  }
+}
+
+
+static void encode(struct orm_delta_buf* b, int type, ci_uint32 seq,
+                   ci_netif_stats* stats, ci_netif_stats* old_stats,
+                   union sock_stats* socks, struct orm_delta_sock* old,
+                   unsigned n)
+{
+  unsigned i;
+
+  orm_delta_msg_begin(b, type, seq, 0);
+  orm_delta_stack(b, 0, "bench");
+  orm_delta_stats(b, stats, old_stats);
+  for( i = 0; i < n; ++i )
+    if( i & 1 )
+      orm_delta_udp_socket(b, i, &socks[i].udp, &old[i]);
+    else
+      orm_delta_tcp_socket(b, i, &socks[i].tcp, &old[i]);
+  orm_delta_msg_end(b);
+}
+
+
+/* Bump counters of [n_active] sockets picked at random.  Returns the total
+ * of the increments. */
+static ci_uint64 bump(ci_netif_stats* stats, union sock_stats* socks,
+                      unsigned n, unsigned n_active)
+{
+  ci_uint64 sum = 0;
+  unsigned i;
+
+  stats->rx_evs += n_active;
+  stats->tx_evs += n_active;
+  sum += 2 * n_active;
+  for( i = 0; i < n_active; ++i ) {
+    unsigned id = random() % n;
+    unsigned k = 1 + random() % 8;
+    if( id & 1 ) {
+      socks[id].udp.n_rx_os += k;
+      socks[id].udp.n_tx_onload_uc += 1;
+    }
+    else {
+      socks[id].tcp.rx_pkts += k;
+      socks[id].tcp.tx_stop_cwnd += 1;
+    }
+    sum += k + 1;
+  }
+  return sum;
+}
+
+
+static void run(unsigned n, double active, int n_snaps)
+{
+  union sock_stats* socks = calloc(n, sizeof(*socks));
+  struct orm_delta_sock* old = calloc(n, sizeof(*old));
+  ci_netif_stats stats = {}, old_stats = {};
+  struct orm_delta_buf b = {};
+  struct orm_delta_dec* dec = orm_delta_dec_alloc();
+  unsigned n_active = n * active / 100, i;
+  double t, t_enc = 0, t_dec = 0, key_t;
+  ci_uint64 bytes = 0, want_sum = 0;
+  size_t key_len;
+
+  if( socks == NULL || old == NULL || dec == NULL ) {
+    fprintf(stderr, "ERROR: out of memory for %u sockets\n", n);
+    exit(1);
+  }
+  for( i = 0; i < n; ++i )
+    old[i].group = -1;
+  chk_stats = &stats;
+  chk_socks = socks;
+  chk_n = n;
+  n_bad_values = 0;
+
+  orm_delta_msg_begin(&b, ORM_DELTA_MSG_SCHEMA, 0, 0);
+  orm_delta_schema(&b);
+  CI_TEST(orm_delta_dec_msg(dec, b.data, b.len, on_change, NULL) == 0);
+
+  /* A key frame of sockets that have all seen some traffic. */
+  bump(&stats, socks, n, n);
+  t = cpu_sec();
+  encode(&b, ORM_DELTA_MSG_KEY, 0, &stats, &old_stats, socks, old, n);
+  key_t = cpu_sec() - t;
+  key_len = b.len;
+  CI_TEST(orm_delta_dec_msg(dec, b.data, b.len, on_change, NULL) == 0);
+
+  delta_sum = 0;
+  for( i = 1; i <= n_snaps; ++i ) {
+    want_sum += bump(&stats, socks, n, n_active);
+    t = cpu_sec();
+    encode(&b, ORM_DELTA_MSG_DELTA, i, &stats, &old_stats, socks, old, n);
+    t_enc += cpu_sec() - t;
+    bytes += b.len;
+    t = cpu_sec();
+    CI_TEST(orm_delta_dec_msg(dec, b.data, b.len, on_change, NULL) == 0);
+    t_dec += cpu_sec() - t;
+  }
+  if( n_bad_values != 0 ) {
+    fprintf(stderr, "ERROR: %u decoded values differ from the counters\n",
+            n_bad_values);
+    exit(1);
+  }
+  if( delta_sum != want_sum ) {
+    fprintf(stderr, "ERROR: decoded %llu of %llu counts\n",
+            (unsigned long long) delta_sum, (unsigned long long) want_sum);
+    exit(1);
+  }
+
+  printf("%9u %7.2f %9.3f %10zu %9.3f %9.3f %10.0f\n", n, active,
+         key_t * 1e3, key_len, t_enc * 1e3 / n_snaps, t_dec * 1e3 / n_snaps,
+         (double) bytes / n_snaps);
+
+  orm_delta_dec_free(dec);
+  free(b.data);
+  free(old);
+  free(socks);
+}
+
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: orm_delta_bench [-a active%%] [-s snapshots] "
+          "[n_sockets...]\n");
+  exit(1);
+}
+
+
+int main(int argc, char* argv[])
+{
+  static const unsigned default_n[] = { 10000, 100000, 1000000 };
+  double active = 1;
+  int n_snaps = 20, c, i;
+
+  while( (c = getopt(argc, argv, "a:s:")) != -1 )
+    switch( c ) {
+    case 'a':  active = atof(optarg);   break;
+    case 's':  n_snaps = atoi(optarg);  break;
+    default:   usage();
+    }
+  if( active < 0 || active > 100 || n_snaps < 1 )
+    usage();
+
+  printf("#%8s %7s %9s %10s %9s %9s %10s\n", "sockets", "active%",
+         "key_ms", "key_bytes", "enc_ms", "dec_ms", "bytes");
+  if( optind == argc )
+    for( i = 0; i < sizeof(default_n) / sizeof(default_n[0]); ++i )
+      run(default_n[i], active, n_snaps);
+  for( i = optind; i < argc; ++i )
+    run(strtoul(argv[i], NULL, 0), active, n_snaps);
+  return 0;
+}
@@ -905,6 +905,53 @@ static int orm_vis_dump(ci_netif* ni, int output_flags)
 }
 
 
+/**********************************************************/
+/* Dump latency histograms */
+/**********************************************************/
+
+/* Summary and non-empty buckets of each histogram, in ns.  Each bucket is
+ * given as [lower bound, count]. */
+static int orm_lat_hists_dump(ci_netif* ni)
+{
+  struct oo_lat_hist h;
+  ci_uint64 total;
+  ci_uint64 max_ns;
+  int which, b, max_b;
+
+  dump_buf_literal("\"histograms\":{");
+  for( which = 0; which < OO_LAT_HIST_N; ++which ) {
+    total = ci_netif_lat_hist_sum(ni, which, &h);
+    for( max_b = OO_LAT_HIST_N_BUCKETS - 1; max_b > 0; --max_b )
+      if( h.bucket[max_b] )
+        break;
+#define Q(ppm)                                                          \
+    ci_netif_lat_hist_ns(ni, oo_lat_hist_bucket_lo(                     \
+                           oo_lat_hist_quantile(&h, total, (ppm))))
+    dump_buf_cat("\"%s\":{", oo_lat_hist_names[which]);
+    dump_buf_cat_comma("\"count\":%"CI_PRIu64, total);
+    if( total != 0 ) {
+      dump_buf_cat_comma("\"p50_ns\":%"CI_PRIu64, Q(500000));
+      dump_buf_cat_comma("\"p99_ns\":%"CI_PRIu64, Q(990000));
+      dump_buf_cat_comma("\"p999_ns\":%"CI_PRIu64, Q(999000));
+      max_ns = ci_netif_lat_hist_ns(ni, oo_lat_hist_bucket_lo(max_b));
+      dump_buf_cat_comma("\"max_ns\":%"CI_PRIu64, max_ns);
+    }
+#undef Q
+    dump_buf_literal("\"buckets\":[");
+    for( b = 0; b < OO_LAT_HIST_N_BUCKETS; ++b )
+      if( h.bucket[b] )
+        dump_buf_cat_comma("[%"CI_PRIu64",%u]",
+                           ci_netif_lat_hist_ns(ni, oo_lat_hist_bucket_lo(b)),
+                           (unsigned) h.bucket[b]);
+    dump_buf_cleanup();
+    dump_buf_literal_comma("]}");
+  }
+  dump_buf_cleanup();
+  dump_buf_literal_comma("}");
+  return 0;
+}
+
+
 /**********************************************************/
 /* Main */
 /**********************************************************/
@@ -991,6 +1038,12 @@ static int orm_netif_dump(ci_netif* ni, int id, int output_flags, bool cfg_flat,
       return rc;
     }
   }
+  if (output_flags & ORM_OUTPUT_HISTOGRAMS) {
+    if( (rc = orm_lat_hists_dump(ni)) != 0 ) {
+      LOG("histograms error code %d\n",rc);
+      return rc;
+    }
+  }
   dump_buf_cleanup();
   if( ! cfg_flat )
     dump_buf_literal("}}");
@@ -1041,6 +1094,8 @@ int orm_parse_output_flags(int argc, const char* const* argv)
       output_flags |= ORM_OUTPUT_VIS;
     else if ( !strcmp(argv[i], "opts") )
       output_flags |= ORM_OUTPUT_OPTS;
+    else if ( !strcmp(argv[i], "histograms") )
+      output_flags |= ORM_OUTPUT_HISTOGRAMS;
     else if ( !strcmp(argv[i], "lots") )
       output_flags |= ORM_OUTPUT_LOTS;
     else if ( !strcmp(argv[i], "extra") )
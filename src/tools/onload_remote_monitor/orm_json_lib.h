@@ -11,6 +11,7 @@
 #define ORM_OUTPUT_SOCKETS 0x20
 #define ORM_OUTPUT_VIS 0x40
 #define ORM_OUTPUT_OPTS 0x100
+#define ORM_OUTPUT_HISTOGRAMS 0x200
 #define ORM_OUTPUT_EXTRA 0x100000
 #define ORM_OUTPUT_LOTS 0xFFFFF
 #define ORM_OUTPUT_SUM (ORM_OUTPUT_STATS | ORM_OUTPUT_MORE_STATS | \
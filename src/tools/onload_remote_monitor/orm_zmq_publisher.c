@@ -3,6 +3,9 @@
 /*
  * Example ZMQ publisher for stats
  *
+ * With --delta, publishes a binary stream of the counters that have changed
+ * since the previous snapshot (see orm_delta.h) in place of the JSON.
+ *
  * Additional build dependencies are czmq-devel and zeromq-devel
  */
 
@@ -11,10 +14,15 @@
 #include <czmq.h>
 
 #include "orm_json_lib.h"
+#include <ci/internal/more_stats.h>
+#include "orm_delta.h"
 
 
 static struct orm_cfg cfg;
 static int cfg_interval = 10;
+static int cfg_interval_ms;
+static bool cfg_delta;
+static int cfg_keyframe = 100;
 static char* cfg_endpoint = "tcp://*:5556";
 
 static ci_cfg_desc cfg_opts[] = {
@@ -32,16 +40,73 @@ static ci_cfg_desc cfg_opts[] = {
     "ZMQ endpoint to publish stats (default tcp://*:5556)" },
   { 0, "interval",  CI_CFG_INT,  &cfg_interval,
     "Interval between stats in seconds (default 10s)" },
+  { 0, "interval-ms",  CI_CFG_INT,  &cfg_interval_ms,
+    "Interval between stats in milliseconds (overrides --interval)" },
+  { 0, "delta", CI_CFG_FLAG,    &cfg_delta,
+    "publish a binary stream of the counters that have changed" },
+  { 0, "keyframe",  CI_CFG_INT,  &cfg_keyframe,
+    "with --delta, snapshots between full key frames (default 100)" },
 };
 #define N_CFG_OPTS (sizeof(cfg_opts) / sizeof(cfg_opts[0]))
 
 
+/* Publish the schema and a key frame every [cfg_keyframe] snapshots, and
+ * the changes to the counters in between.  Snapshots are paced from the
+ * start, so that the time taken by each does not stretch the interval. */
+static int publish_delta(zsock_t* publisher, int output_flags,
+                         int interval_ms)
+{
+  struct orm_delta_pub* pub = orm_delta_pub_alloc(&cfg, output_flags);
+  struct orm_delta_buf b = {};
+  int64_t next = zclock_mono();
+  unsigned n = 0;
+
+  if( pub == NULL ) {
+    printf("Not able to start publishing deltas\n");
+    return EXIT_FAILURE;
+  }
+
+  while( ! zsys_interrupted ) {
+    int key = cfg_keyframe <= 1 || n % cfg_keyframe == 0;
+    int rc;
+
+    if( key ) {
+      orm_delta_pub_snapshot(pub, ORM_DELTA_MSG_SCHEMA, &b);
+      zsock_send(publisher, "b", b.data, b.len);
+    }
+    rc = orm_delta_pub_snapshot(pub, key ? ORM_DELTA_MSG_KEY :
+                                ORM_DELTA_MSG_DELTA, &b);
+    if( rc == 0 ) {
+      zsock_send(publisher, "b", b.data, b.len);
+      if( key )
+        printf("Key frame published #%u (%zu bytes)\n", n, b.len);
+      ++n;
+    }
+    else {
+      printf("Not able to generate snapshot rc=%d\n", rc);
+    }
+    fflush(stdout);
+
+    int64_t now = zclock_mono();
+    next += interval_ms;
+    if( next > now )
+      zclock_sleep(next - now);
+    else
+      next = now;
+  }
+
+  free(b.data);
+  orm_delta_pub_free(pub);
+  return 0;
+}
+
+
 int main(int argc, char** argv)
 {
   ci_app_standard_opts = 0;
   ci_app_getopt(
     "[stats] [more_stats] [tcp_stats] [stack] [stack_state] [vis] [opts] "
-    "[lots] [extra] [all]",
+    "[histograms] [lots] [extra] [all]",
     &argc, argv, cfg_opts, N_CFG_OPTS);
   ++argv;  --argc;
 
@@ -50,6 +115,8 @@ int main(int argc, char** argv)
     printf("Invalid option specified\n");
     return EXIT_FAILURE;
   }
+  int interval_ms = cfg_interval_ms > 0 ? cfg_interval_ms :
+                                          cfg_interval * 1000;
   unsigned int n = 0;
 
   printf("Publishing stats to ZMQ endpoint: %s\n", cfg_endpoint);
@@ -57,6 +124,12 @@ int main(int argc, char** argv)
   // allow ^C etc to stop the app
   zsys_catch_interrupts();
 
+  if( cfg_delta ) {
+    int rc = publish_delta(publisher, output_flags, interval_ms);
+    zsock_destroy(&publisher);
+    return rc;
+  }
+
   while( 1 ) {
     if( zsys_interrupted )
       break;
@@ -80,7 +153,7 @@ int main(int argc, char** argv)
     fflush(stdout);
     free(data);
 
-    sleep(cfg_interval);
+    zclock_sleep(interval_ms);
   }
 
   // clean up
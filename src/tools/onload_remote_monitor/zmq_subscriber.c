@@ -3,6 +3,9 @@
 /*
  * Example ZMQ subscriber to receive stats from orm_zmq_publisher
  *
+ * With --delta, decodes the stream of orm_zmq_publisher --delta and prints
+ * each counter that changes.
+ *
  * Additional build dependencies are czmq-devel and zeromq-devel
  */
 
@@ -11,16 +14,78 @@
 
 #include <czmq.h>
 
+#include <ci/internal/more_stats.h>
+#include "orm_json_lib.h"
+#include "orm_delta.h"
+
 static char* cfg_endpoint = "tcp://localhost:5556";
+static bool cfg_delta;
 
 static ci_cfg_desc cfg_opts[] = {
   { 'h', "help", CI_CFG_USAGE, 0, "this message" },
   { 0, "endpoint",  CI_CFG_STR,  &cfg_endpoint,
     "ZMQ endpoint to subscribe to stats (default tcp://localhost:5556)" },
+  { 0, "delta", CI_CFG_FLAG,    &cfg_delta,
+    "decode the binary stream of orm_zmq_publisher --delta" },
 };
 #define N_CFG_OPTS (sizeof(cfg_opts) / sizeof(cfg_opts[0]))
 
 
+static void print_change(void* arg, int stack_id, int sock_id,
+                         const char* group, const char* counter,
+                         ci_uint64 value, ci_int64 delta)
+{
+  if( counter == NULL ) {
+    if( sock_id < 0 )
+      printf("stack %d: gone\n", stack_id);
+    else
+      printf("stack %d socket %d: gone\n", stack_id, sock_id);
+  }
+  else if( sock_id < 0 ) {
+    printf("stack %d: %s.%s = %llu (%+lld)\n", stack_id, group, counter,
+           (unsigned long long) value, (long long) delta);
+  }
+  else {
+    printf("stack %d socket %d: %s.%s = %llu (%+lld)\n", stack_id, sock_id,
+           group, counter, (unsigned long long) value, (long long) delta);
+  }
+}
+
+
+static void subscribe_delta(zsock_t* subscriber)
+{
+  struct orm_delta_dec* dec = orm_delta_dec_alloc();
+  unsigned int update_n = 0;
+  int waiting = 0;
+
+  while( 1 ) {
+    zframe_t* frame = zframe_recv(subscriber);
+    if( zsys_interrupted || frame == NULL ) {
+      zframe_destroy(&frame);
+      break;
+    }
+    ++update_n;
+    int rc = orm_delta_dec_msg(dec, zframe_data(frame), zframe_size(frame),
+                               print_change, NULL);
+    if( rc == -EAGAIN ) {
+      if( ! waiting )
+        fprintf(stderr, "Waiting for schema and key frame...\n");
+      waiting = 1;
+    }
+    else if( rc != 0 ) {
+      fprintf(stderr, "Bad update #%u rc=%d\n", update_n, rc);
+    }
+    else {
+      waiting = 0;
+    }
+    fflush(stdout);
+    zframe_destroy(&frame);
+  }
+
+  orm_delta_dec_free(dec);
+}
+
+
 int main (int argc, char *argv [])
 {
   ci_app_standard_opts = 0;
@@ -38,6 +103,12 @@ int main (int argc, char *argv [])
 
   fprintf(stderr, "Waiting for update from publisher...\n");
 
+  if( cfg_delta ) {
+    subscribe_delta(subscriber);
+    zsock_destroy(&subscriber);
+    return 0;
+  }
+
   while( 1 ) {
     buffer = zstr_recv(subscriber);
     if( zsys_interrupted )